@@ -79,3 +79,9 @@
 #ifndef RP2350_GEEK_LCD_BL_PIN
 #define RP2350_GEEK_LCD_BL_PIN 13
 #endif
+
+// TE (tearing effect) output of the controller, or -1 if it is not wired (as
+// on the RP2350-GEEK); frames are then paced by a timer instead.
+#ifndef RP2350_GEEK_LCD_TE_PIN
+#define RP2350_GEEK_LCD_TE_PIN -1
+#endif
@@ -0,0 +1,179 @@
+#include "lcd_pio.h"
+
+#include <string.h>
+
+#include "hardware/clocks.h"
+#include "hardware/dma.h"
+#include "hardware/pio.h"
+
+#include "gfx/color.h"
+#include "lcd_pio.pio.h"
+
+#ifndef LCD_PIO
+#define LCD_PIO pio0
+#endif
+
+static struct {
+    PIO pio;
+    uint tx_sm;
+    uint pal_sm;
+    int px_chan;     // framebuffer -> lcd_tx
+    int idx_chan;    // indices -> lcd_pal
+    int addr_chan;   // one lcd_pal address -> pal_px_chan's read address
+    int pal_px_chan; // that palette entry -> lcd_tx
+} lcd_pio = { .px_chan = -1 };
+
+// lcd_pal builds entry addresses from the upper bits of the table address.
+static uint16_t lcd_pio_palette[256] __attribute__((aligned(512)));
+
+static inline void lcd_pio_put_header(bool dc, uint32_t bits) {
+    pio_sm_put_blocking(lcd_pio.pio, lcd_pio.tx_sm, ((uint32_t)dc << 31) | (bits - 1));
+}
+
+static inline void lcd_pio_wait_stall(uint sm) {
+    PIO pio = lcd_pio.pio;
+    uint32_t stall = 1u << (PIO_FDEBUG_TXSTALL_LSB + sm);
+    while (!pio_sm_is_tx_fifo_empty(pio, sm)) {
+        tight_loop_contents();
+    }
+    // With the FIFO empty the program can only stall at its next pull, i.e.
+    // once everything it was given has been processed.
+    pio->fdebug = stall;
+    while (!(pio->fdebug & stall)) {
+        tight_loop_contents();
+    }
+}
+
+static dma_channel_config lcd_pio_pixel_config(int chan) {
+    dma_channel_config c = dma_channel_get_default_config(chan);
+    channel_config_set_transfer_data_size(&c, DMA_SIZE_16);
+    channel_config_set_write_increment(&c, false);
+    channel_config_set_dreq(&c, pio_get_dreq(lcd_pio.pio, lcd_pio.tx_sm, true));
+    // The state machine shifts each halfword out MSB first; wire-order pixels
+    // are swapped back to native order on the way.
+    channel_config_set_bswap(&c, GFX_FB_WIRE_ORDER);
+    return c;
+}
+
+// --- Palette lookup chain ---
+// idx_chan feeds indices to lcd_pal, which returns entry addresses. addr_chan
+// and pal_px_chan then alternate one transfer each through their chain
+// triggers: addr_chan writes an address into pal_px_chan's (non-triggering)
+// read address and chains to it, and pal_px_chan copies that entry into the
+// lcd_tx FIFO once there is room and chains back. So an address is never
+// handed over while the previous entry is still waiting for FIFO space. The
+// chain is started once and then idles in addr_chan, waiting for lcd_pal.
+static void lcd_pio_palette_chain_init(void) {
+    PIO pio = lcd_pio.pio;
+    lcd_pio.idx_chan = dma_claim_unused_channel(true);
+    lcd_pio.addr_chan = dma_claim_unused_channel(true);
+    lcd_pio.pal_px_chan = dma_claim_unused_channel(true);
+
+    dma_channel_config c = lcd_pio_pixel_config(lcd_pio.pal_px_chan);
+    channel_config_set_read_increment(&c, false);
+    channel_config_set_chain_to(&c, (uint)lcd_pio.addr_chan);
+    dma_channel_configure(lcd_pio.pal_px_chan, &c, &pio->txf[lcd_pio.tx_sm], lcd_pio_palette, 1, false);
+
+    c = dma_channel_get_default_config(lcd_pio.addr_chan);
+    channel_config_set_transfer_data_size(&c, DMA_SIZE_32);
+    channel_config_set_read_increment(&c, false);
+    channel_config_set_write_increment(&c, false);
+    channel_config_set_dreq(&c, pio_get_dreq(pio, lcd_pio.pal_sm, false));
+    channel_config_set_chain_to(&c, (uint)lcd_pio.pal_px_chan);
+    dma_channel_configure(lcd_pio.addr_chan, &c, &dma_hw->ch[lcd_pio.pal_px_chan].read_addr,
+                          &pio->rxf[lcd_pio.pal_sm], 1, true);
+
+    c = dma_channel_get_default_config(lcd_pio.idx_chan);
+    channel_config_set_transfer_data_size(&c, DMA_SIZE_8);
+    channel_config_set_read_increment(&c, true);
+    channel_config_set_write_increment(&c, false);
+    channel_config_set_dreq(&c, pio_get_dreq(pio, lcd_pio.pal_sm, true));
+    dma_channel_configure(lcd_pio.idx_chan, &c, &pio->txf[lcd_pio.pal_sm], NULL, 0, false);
+}
+
+// Waits until every queued index has reached the lcd_tx FIFO.
+static void lcd_pio_palette_drain(void) {
+    while (dma_channel_is_busy(lcd_pio.idx_chan)) {
+        tight_loop_contents();
+    }
+    lcd_pio_wait_stall(lcd_pio.pal_sm);
+    // Drained when the last address has been taken (RX empty) and the chain
+    // is back in addr_chan, re-armed for a single transfer.
+    while (!pio_sm_is_rx_fifo_empty(lcd_pio.pio, lcd_pio.pal_sm) || dma_channel_is_busy(lcd_pio.pal_px_chan) ||
+           !dma_channel_is_busy(lcd_pio.addr_chan) ||
+           (dma_hw->ch[lcd_pio.addr_chan].transfer_count & 0x0FFFFFFFu) != 1) {
+        tight_loop_contents();
+    }
+}
+
+void lcd_pio_init(const lcd_pio_config_t *cfg) {
+    PIO pio = LCD_PIO;
+    lcd_pio.pio = pio;
+
+    uint offset = pio_add_program(pio, &lcd_tx_program);
+    lcd_pio.tx_sm = (uint)pio_claim_unused_sm(pio, true);
+    float div = (float)clock_get_hz(clk_sys) / (2.0f * (float)cfg->sck_hz);
+    lcd_tx_program_init(pio, lcd_pio.tx_sm, offset, cfg->mosi_pin, cfg->sck_pin, cfg->dc_pin, div < 1.0f ? 1.0f : div);
+
+    uint pal_offset = pio_add_program(pio, &lcd_pal_program);
+    lcd_pio.pal_sm = (uint)pio_claim_unused_sm(pio, true);
+    lcd_pal_program_init(pio, lcd_pio.pal_sm, pal_offset);
+    lcd_pal_program_set_base(pio, lcd_pio.pal_sm, lcd_pio_palette);
+    pio_sm_set_enabled(pio, lcd_pio.pal_sm, true);
+
+    lcd_pio.px_chan = dma_claim_unused_channel(true);
+    dma_channel_config c = lcd_pio_pixel_config(lcd_pio.px_chan);
+    channel_config_set_read_increment(&c, true);
+    dma_channel_configure(lcd_pio.px_chan, &c, &pio->txf[lcd_pio.tx_sm], NULL, 0, false);
+
+    lcd_pio_palette_chain_init();
+}
+
+void lcd_pio_write(bool dc, const uint8_t *data, size_t len) {
+    if (!len) {
+        return;
+    }
+    lcd_pio_put_header(dc, (uint32_t)len * 8);
+    for (size_t i = 0; i < len; i += 2) {
+        uint32_t word = (uint32_t)data[i] << 24;
+        if (i + 1 < len) {
+            word |= (uint32_t)data[i + 1] << 16;
+        }
+        pio_sm_put_blocking(lcd_pio.pio, lcd_pio.tx_sm, word);
+    }
+}
+
+void lcd_pio_begin_pixels(size_t count) {
+    lcd_pio_put_header(true, (uint32_t)count * 16);
+}
+
+void lcd_pio_stream_pixels(const uint16_t *pixels, size_t count) {
+    dma_channel_transfer_from_buffer_now(lcd_pio.px_chan, pixels, count);
+}
+
+int lcd_pio_pixel_dma_chan(void) {
+    return lcd_pio.px_chan;
+}
+
+void lcd_pio_set_palette(const uint16_t *palette, size_t count) {
+    lcd_pio_palette_drain(); // a previous run may still be reading the table
+    memcpy(lcd_pio_palette, palette, (count < 256 ? count : 256) * sizeof(uint16_t));
+}
+
+void lcd_pio_stream_indexed(const uint8_t *indices, size_t count) {
+    dma_channel_transfer_from_buffer_now(lcd_pio.idx_chan, indices, count);
+}
+
+int lcd_pio_index_dma_chan(void) {
+    return lcd_pio.idx_chan;
+}
+
+void lcd_pio_wait_idle(void) {
+    while (dma_channel_is_busy(lcd_pio.px_chan)) {
+        tight_loop_contents();
+    }
+    lcd_pio_palette_drain();
+    // The last pixel and the CS release are out once lcd_tx stalls on the
+    // next header.
+    lcd_pio_wait_stall(lcd_pio.tx_sm);
+}
@@ -0,0 +1,46 @@
+#pragma once
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+// PIO transmitter for the ST7789 (see lcd_pio.pio). The state machine drives
+// SCK, MOSI, DC and CS itself: every transfer is framed by a header word, so
+// commands, parameters and DMA-fed pixel runs can be queued back to back.
+// Pixels are read from the framebuffer with 16-bit DMA (byte-swapped by the
+// DMA when the framebuffer is in wire order), so no CPU staging is needed in
+// either pixel order. A second state machine plus a DMA chain expands 8-bit
+// palette indices to RGB565 on the way to the panel.
+
+typedef struct {
+    unsigned mosi_pin;
+    unsigned sck_pin;
+    unsigned dc_pin; // CS must be dc_pin + 1
+    uint32_t sck_hz;
+} lcd_pio_config_t;
+
+void lcd_pio_init(const lcd_pio_config_t *cfg);
+
+// Blocking CPU path for commands (dc = false) and parameters (dc = true).
+void lcd_pio_write(bool dc, const uint8_t *data, size_t len);
+
+// Opens a data transfer of count pixels; CS stays low until that many have
+// been fed, so a window can be streamed in several DMA runs (one per row).
+void lcd_pio_begin_pixels(size_t count);
+
+// Starts the pixel DMA channel on count framebuffer pixels and returns
+// immediately. Completion raises the channel's IRQ if the caller enabled it
+// (see lcd_pio_pixel_dma_chan()).
+void lcd_pio_stream_pixels(const uint16_t *pixels, size_t count);
+int lcd_pio_pixel_dma_chan(void);
+
+// Palette expansion: after lcd_pio_begin_pixels(), streams count 8-bit indices
+// as RGB565 pixels, each looked up in the table set by lcd_pio_set_palette()
+// (up to 256 storage-order entries) by DMA. Completion raises the index
+// channel's IRQ once the indices are queued, like lcd_pio_stream_pixels().
+void lcd_pio_set_palette(const uint16_t *palette, size_t count);
+void lcd_pio_stream_indexed(const uint8_t *indices, size_t count);
+int lcd_pio_index_dma_chan(void);
+
+// Waits until everything queued has been clocked out and CS is released.
+void lcd_pio_wait_idle(void);
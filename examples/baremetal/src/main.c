@@ -1,4 +1,5 @@
 #include <stdbool.h>
+#include <stdint.h>
 #include <stdio.h>
 #include <string.h>
 #include <ctype.h>
@@ -6,20 +7,110 @@
 #include "pico/stdlib.h"
 #include "pico/binary_info.h"
 #include "pico/bootrom.h"
+#include "pico/critical_section.h"
+#include "pico/multicore.h"
+#include "pico/stdio/driver.h"
 #include "hardware/adc.h"
+#include "hardware/clocks.h"
+#include "hardware/dma.h"
 #include "hardware/gpio.h"
 #include "hardware/i2c.h"
+#include "hardware/irq.h"
 #include "hardware/spi.h"
+#include "hardware/sync.h"
 
 #include "board_config.h"
+#include "gfx/assets.h"
+#include "gfx/console.h"
+#include "gfx/dlist.h"
+#include "gfx/fb.h"
+#include "gfx/font.h"
+#include "gfx/pace.h"
+#include "gfx/perf.h"
+#include "gfx/shade.h"
+#include "gfx/snap.h"
+#include "gfx/st7789.h"
+#include "gfx/stream.h"
+#include "gfx/swap.h"
+#include "gfx/text.h"
+#include "lcd_pio.h"
+#include "rt/adc.h"
+#include "rt/bus.h"
+#include "rt/i2c.h"
+#include "rt/i2c_scan.h"
+#include "rt/sched.h"
+#include "rt/spi.h"
+#include "rt/spi_bench.h"
 
 #define HEARTBEAT_MS 5000
 #define I2C_BAUD 400000
+// The bus is scanned in the background: every I2C_SCAN_TICK_MS a timer
+// queues probes to the next I2C_SCAN_PER_TICK addresses (a full pass of the
+// 112 takes 112 / I2C_SCAN_PER_TICK ticks). A probe still on the bus after
+// I2C_TIMEOUT_US is aborted.
+#ifndef I2C_SCAN_TICK_MS
+#define I2C_SCAN_TICK_MS 10
+#endif
+#ifndef I2C_SCAN_PER_TICK
+#define I2C_SCAN_PER_TICK 4
+#endif
+#define I2C_TIMEOUT_US 5000
+// The ADC converts continuously, the channels of the ADC_CHANNELS mask in
+// turn at ADC_SAMPLE_HZ in all (the test pin and the temperature sensor by
+// default), and DMA copies its FIFO into a ring of ADC_RING_SAMPLES. Every
+// ADC_DRAIN_MS core 1 feeds what arrived to per-channel statistics and a CIC
+// decimator of order ADC_DECIM_ORDER and ratio ADC_DECIM. The dashboard shows
+// the test pin's filtered value every ADC_SAMPLE_MS and the heartbeat logs
+// each channel's statistics.
+#define ADC_PIN_CHANNEL (RP2350_GEEK_ADC_PIN >= 26 ? RP2350_GEEK_ADC_PIN - 26 : 0)
+#ifndef ADC_CHANNELS
+#define ADC_CHANNELS ((1u << ADC_PIN_CHANNEL) | (1u << ADC_TEMPERATURE_CHANNEL_NUM))
+#endif
+#ifndef ADC_SAMPLE_HZ
+#define ADC_SAMPLE_HZ 20000
+#endif
+#ifndef ADC_DECIM
+#define ADC_DECIM 64
+#endif
+#ifndef ADC_DECIM_ORDER
+#define ADC_DECIM_ORDER 3
+#endif
+#ifndef ADC_RING_SAMPLES
+#define ADC_RING_SAMPLES 4096 // power of two; the DMA ring wraps at most 32 KB
+#endif
+#ifndef ADC_DRAIN_MS
+#define ADC_DRAIN_MS 10
+#endif
+#ifndef ADC_SAMPLE_MS
+#define ADC_SAMPLE_MS 100
+#endif
+#if ADC_SAMPLE_HZ > 500000 || ADC_SAMPLE_HZ < 733
+#error "ADC_SAMPLE_HZ: the ADC clock divider covers 733 Hz to 500 kHz"
+#endif
+#if !(ADC_CHANNELS & (1u << ADC_PIN_CHANNEL))
+#error "ADC_CHANNELS must include the test pin's channel"
+#endif
+// SPI0 transfers are queued and moved by DMA. The loopback self-test runs
+// at SPI_BAUD once per heartbeat. The sweep runs at boot (SPI_BENCH_BOOT) and
+// on the SPIBENCH command: SPI_BENCH_BYTES at every clock of
+// spi_bench_rates and size of spi_bench_sizes, each row logged with its
+// throughput and bit errors. Both need MOSI wired to MISO.
 #define SPI_BAUD 2000000
+#ifndef SPI_BENCH_BOOT
+#define SPI_BENCH_BOOT 1
+#endif
+#ifndef SPI_BENCH_BYTES
+#define SPI_BENCH_BYTES 32768
+#endif
+#define SPI_BENCH_MAX_LEN 4096
 #define LCD_SPI_BAUD 40000000
 #ifndef LCD_INVERT_DISPLAY
 #define LCD_INVERT_DISPLAY 1
 #endif
+// Framebuffers are in panel wire order unless the gfx library is built with
+// RP2350_GEEK_GFX_WIRE_ORDER=OFF; native-order pixels are byte-swapped while
+// staging, and indexed ones (RP2350_GEEK_GFX_BPP=8/4) are looked up in the palette.
+#define LCD_DMA_CHUNK_PX 512 // pixels per DMA staging buffer (two buffers, ping-pong)
 
 // ST7789 1.14" LCD settings (240x135 panel on 240x240 controller window).
 #define LCD_WIDTH 240
@@ -43,10 +134,207 @@ typedef enum {
     LCD_PAGE_GRAPHIC = 1,
     LCD_PAGE_ICON = 2,
     LCD_PAGE_GIF = 3,
+    LCD_PAGE_DASHBOARD = 4,
+    LCD_PAGE_CONSOLE = 5,
     LCD_PAGE_COUNT
 } lcd_page_t;
 
-static uint16_t lcd_fb[LCD_WIDTH * LCD_HEIGHT];
+// LCD_STRIP_LINES=N renders pages N lines at a time into two frame-wide strip
+// buffers instead of full framebuffers (2 x 240 x 16 px is 15 KB at 16bpp
+// against 64,800 bytes per frame): core 0 draws strip k + 1 while the DMA
+// engine sends strip k. 0 keeps whole frames.
+#ifndef LCD_STRIP_LINES
+#define LCD_STRIP_LINES 0
+#endif
+
+// Frames are flushed on a fixed grid of panel refreshes: every
+// LCD_REFRESH_HZ / LCD_FRAME_HZ-th TE pulse when RP2350_GEEK_LCD_TE_PIN is
+// wired, otherwise every that many ticks of a timer at LCD_REFRESH_HZ. A frame
+// that misses its slot waits for the next one instead of going out late.
+#ifndef LCD_FRAME_HZ
+#define LCD_FRAME_HZ 30
+#endif
+#define LCD_REFRESH_HZ 60 // the controller's power-on frame rate
+
+// Render and flush times are measured in CPU cycles (gfx/perf.h) and
+// summarised on every heartbeat. LCD_PERF_OVERLAY=1 also draws the last
+// summary into the top-right corner of every frame.
+#ifndef LCD_PERF_OVERLAY
+#define LCD_PERF_OVERLAY 0
+#endif
+
+// Render on core 1 into a back buffer while core 0 DMAs the front buffer to
+// the panel. Set to 0 to render and flush a single buffer on core 0.
+#ifndef LCD_DOUBLE_BUFFER
+#define LCD_DOUBLE_BUFFER (LCD_STRIP_LINES == 0)
+#endif
+#if LCD_DOUBLE_BUFFER && LCD_STRIP_LINES
+#error "LCD_STRIP_LINES replaces the full-frame buffers; build it with LCD_DOUBLE_BUFFER=0"
+#endif
+#if LCD_STRIP_LINES && LCD_PERF_OVERLAY
+#error "LCD_PERF_OVERLAY draws into a whole frame; build it with LCD_STRIP_LINES=0"
+#endif
+#if LCD_STRIP_LINES
+#define LCD_FB_COUNT 2
+#define LCD_FB_LINES LCD_STRIP_LINES
+#else
+#define LCD_FB_COUNT (LCD_DOUBLE_BUFFER ? 2 : 1)
+#define LCD_FB_LINES LCD_HEIGHT
+#endif
+
+// LCD_USE_PIO=1 drives the panel from a PIO state machine (lcd_pio.pio)
+// instead of SPI1: DC/CS are framed by the state machine and pixels go to it
+// by 16-bit DMA, byte-swapped by the DMA when needed, so neither pixel order
+// needs the staging buffers. 8bpp frames are expanded by the DMA palette
+// chain; 4bpp frames need the SPI path.
+#ifndef LCD_USE_PIO
+#define LCD_USE_PIO 0
+#endif
+#define LCD_PIO_SCK_HZ 62500000
+#define LCD_DMA_DIRECT (LCD_USE_PIO || (!GFX_FB_INDEXED && GFX_FB_WIRE_ORDER))
+#if LCD_USE_PIO && GFX_FB_BPP == 4
+#error "LCD_USE_PIO streams 16bpp or 8bpp framebuffers"
+#endif
+#if LCD_USE_PIO && RP2350_GEEK_LCD_SPI_CS_PIN != RP2350_GEEK_LCD_DC_PIN + 1
+#error "LCD_USE_PIO drives DC and CS from one SET group: CS must be the pin after DC"
+#endif
+
+// LCD_CONSOLE=1 adds a page that mirrors stdout (the USB/UART log) onto the
+// panel as a scrolling console, using the ST7789's hardware scroll; 0 drops
+// the page and its 135x240 framebuffer.
+#ifndef LCD_CONSOLE
+#define LCD_CONSOLE 1
+#endif
+#define LCD_CONSOLE_FIFO 1024  // bytes of output waiting to be drawn
+#define LCD_CONSOLE_POLL_MS 50 // how often the console page picks up new output
+
+// SCREENSHOT streams the frame on the panel as "@snap" log lines (decode
+// them with tools/gfx_snapshot.py): LCD_SNAP_CHUNK compressed bytes per line,
+// LCD_SNAP_LINES lines every LCD_SNAP_POLL_MS, so a slow link is never
+// waited on for long. Needs whole frames, so not with LCD_STRIP_LINES.
+#define LCD_SNAP (!LCD_STRIP_LINES)
+#ifndef LCD_SNAP_CHUNK
+#define LCD_SNAP_CHUNK 48
+#endif
+#ifndef LCD_SNAP_LINES
+#define LCD_SNAP_LINES 8
+#endif
+#define LCD_SNAP_POLL_MS 10
+
+static gfx_pixel_t lcd_pixels[LCD_FB_COUNT][GFX_FB_LEN(LCD_WIDTH, LCD_FB_LINES)];
+static gfx_fb_t lcd_frames[LCD_FB_COUNT]; // fb_target is the one being rendered (frames or strips)
+
+// --- Scheduler ---
+// Each core runs its work as tasks of its own scheduler (rt/sched.h). Core 0,
+// app_sched: host commands, the I2C scan, snapshots, the status task and the
+// heartbeat, and the LCD pages when they render on core 0. Core 1,
+// core1_sched: the sensor reads, and the LCD pages with LCD_DOUBLE_BUFFER.
+// Interrupt handlers only post events, and a core with nothing ready sleeps
+// in __wfe() until its next deadline.
+#define TASK_PRIO_HOST 0
+#define TASK_PRIO_IO 1
+#define TASK_PRIO_LCD 2
+#define TASK_PRIO_BACKGROUND 3
+
+static rt_sched_t app_sched;
+static rt_sched_t core1_sched;
+
+static uint64_t sched_now(void *ctx) {
+    (void)ctx;
+    return time_us_64();
+}
+
+static void sched_idle(void *ctx, uint64_t deadline_us) {
+    (void)ctx;
+    if (deadline_us == UINT64_MAX) {
+        __wfe();
+    } else {
+        best_effort_wfe_or_timeout(from_us_since_boot(deadline_us));
+    }
+}
+
+static uint32_t sched_lock(void *ctx) {
+    return spin_lock_blocking((spin_lock_t *)ctx);
+}
+
+static void sched_unlock(void *ctx, uint32_t state) {
+    spin_unlock((spin_lock_t *)ctx, state);
+}
+
+static void sched_wake(void *ctx) {
+    (void)ctx;
+    __sev(); // also sets this core's event flag, so a post just before __wfe() is not missed
+}
+
+// A hardware spin lock per scheduler lets interrupts and the other core post.
+static void sched_init(rt_sched_t *s) {
+    spin_lock_t *lock = spin_lock_init(spin_lock_claim_unused(true));
+    rt_sched_init(s, (rt_sched_port_t){ (void *)lock, sched_now, sched_idle, sched_lock, sched_unlock, sched_wake });
+}
+
+// Logs and restarts a scheduler's statistics: per task, runs and the worst
+// wait and run time in us.
+static void sched_report(const char *name, rt_sched_t *s) {
+    rt_sched_stats_t stats;
+    rt_sched_take_stats(s, &stats);
+    printf("[sched %s] idle=%lu late=%luus", name, (unsigned long)stats.idles, (unsigned long)stats.timer_late_max_us);
+    for (rt_task_t *t = s->tasks; t; t = t->next_all) {
+        rt_task_stats_t ts;
+        rt_task_take_stats(t, &ts);
+        printf(" %s=%lu/%lu/%lu", t->name, (unsigned long)ts.runs, (unsigned long)ts.latency_max_us,
+               (unsigned long)ts.run_max_us);
+    }
+    printf("\n");
+}
+
+// --- Message bus ---
+// The cores pass messages over app_bus (rt/bus.h): lock-free rings in shared
+// SRAM, with the SIO FIFOs as doorbells. A token in the other core's FIFO
+// raises its SIO FIFO interrupt, whose handler drains the tokens and posts
+// the readers of the channels with messages waiting. The rings use only
+// loads, stores and fences, so the Arm and Hazard3 builds run the same code.
+static rt_bus_t app_bus;
+
+static uint8_t bus_core(void *ctx) {
+    (void)ctx;
+    return (uint8_t)get_core_num();
+}
+
+// If the FIFO is full, the tokens already in it raise the interrupt.
+static void bus_ring(void *ctx, uint8_t core) {
+    (void)ctx;
+    (void)core; // the FIFO only reaches the other core
+    uint32_t irq = save_and_disable_interrupts();
+    if (multicore_fifo_wready()) {
+        multicore_fifo_push_blocking(0);
+    }
+    restore_interrupts(irq);
+}
+
+static void bus_fifo_irq_handler(void) {
+    multicore_fifo_drain();
+    multicore_fifo_clear_irq();
+    rt_bus_doorbell(&app_bus, (uint8_t)get_core_num());
+}
+
+// On each core, once core 1 is running: the launch handshake uses the FIFOs.
+static void bus_irq_enable(void) {
+    irq_set_exclusive_handler(SIO_FIFO_IRQ_NUM(get_core_num()), bus_fifo_irq_handler);
+    irq_set_enabled(SIO_FIFO_IRQ_NUM(get_core_num()), true);
+}
+
+// Logs what each channel has carried: messages, doorbells, sends refused.
+static void bus_report(void) {
+    printf("[bus]");
+    for (int core = 0; core < RT_BUS_CORES; ++core) {
+        for (int i = 0; i < app_bus.chan_count[core]; ++i) {
+            const rt_chan_t *chan = app_bus.chans[core][i];
+            printf(" %s=%lu/%lu/%lu", chan->name, (unsigned long)chan->sent, (unsigned long)chan->bells,
+                   (unsigned long)chan->full);
+        }
+    }
+    printf("\n");
+}
 
 static void init_led(void) {
     gpio_init(RP2350_GEEK_LED_PIN);
@@ -62,23 +350,212 @@ static void init_i2c(void) {
     gpio_pull_up(RP2350_GEEK_I2C_SCL_PIN);
 }
 
-static int i2c_scan(uint8_t *first_address) {
-    int found = 0;
-    for (uint8_t addr = 0x08; addr < 0x78; addr++) {
-        uint8_t rx = 0;
-        int ret = i2c_read_blocking(RP2350_GEEK_I2C_PORT, addr, &rx, 1, false);
-        if (ret >= 0) {
-            if (found == 0 && first_address) {
-                *first_address = addr;
-            }
-            found++;
+// Interrupt-driven port for rt/i2c.h on the DW controller. start() sets the
+// target and lets the TX_EMPTY interrupt feed the command FIFO: tx bytes,
+// then one read command per rx byte behind a RESTART, STOP on the last. The
+// handler drains RX as it fills and reports the end at STOP_DET, which the
+// controller also raises after an abort (a NACK included).
+#define I2C_FIFO_DEPTH 16
+
+static struct {
+    rt_i2c_t bus;
+    const rt_i2c_xfer_t *cur;
+    uint16_t cmds; // commands written to the FIFO
+    uint16_t rxd;  // bytes read back
+    int8_t status; // set by TX_ABRT, reported at STOP_DET
+} i2c_async;
+
+static rt_i2c_scan_t i2c_scanner;
+static rt_task_t i2c_task;
+static rt_timer_t i2c_scan_timer;
+static volatile uint32_t i2c_appeared[4], i2c_vanished[4]; // since the last heartbeat
+
+static void i2c_async_start(void *ctx, const rt_i2c_xfer_t *x) {
+    (void)ctx;
+    i2c_hw_t *hw = i2c_get_hw(RP2350_GEEK_I2C_PORT);
+    hw->enable = 0;
+    hw->tar = x->addr;
+    (void)hw->clr_intr; // leftovers of an aborted transfer
+    hw->enable = 1;
+    i2c_async.cur = x;
+    i2c_async.cmds = 0;
+    i2c_async.rxd = 0;
+    i2c_async.status = RT_I2C_OK;
+    hw->intr_mask = I2C_IC_INTR_MASK_M_TX_EMPTY_BITS | I2C_IC_INTR_MASK_M_TX_ABRT_BITS |
+                    I2C_IC_INTR_MASK_M_STOP_DET_BITS | I2C_IC_INTR_MASK_M_RX_FULL_BITS;
+}
+
+static void i2c_async_abort(void *ctx) {
+    (void)ctx;
+    i2c_hw_t *hw = i2c_get_hw(RP2350_GEEK_I2C_PORT);
+    hw->intr_mask = 0;
+    i2c_async.cur = NULL;
+    hw->enable |= I2C_IC_ENABLE_ABORT_BITS;
+}
+
+static void i2c_async_irq(void) {
+    i2c_hw_t *hw = i2c_get_hw(RP2350_GEEK_I2C_PORT);
+    const rt_i2c_xfer_t *x = i2c_async.cur;
+    if (!x) {
+        hw->intr_mask = 0;
+        return;
+    }
+    uint32_t stat = hw->intr_stat;
+    while (hw->rxflr && i2c_async.rxd < x->rx_len) {
+        x->rx[i2c_async.rxd++] = (uint8_t)hw->data_cmd;
+    }
+    if (stat & I2C_IC_INTR_STAT_R_TX_ABRT_BITS) {
+        uint32_t source = hw->tx_abrt_source;
+        (void)hw->clr_tx_abrt;
+        i2c_async.status = (source & I2C_IC_TX_ABRT_SOURCE_ABRT_7B_ADDR_NOACK_BITS) ? RT_I2C_NACK : RT_I2C_ERROR;
+    }
+    if (stat & I2C_IC_INTR_STAT_R_STOP_DET_BITS) {
+        (void)hw->clr_stop_det;
+        int status = i2c_async.status;
+        if (status == RT_I2C_OK && i2c_async.rxd < x->rx_len) {
+            status = RT_I2C_ERROR;
         }
+        hw->intr_mask = 0;
+        i2c_async.cur = NULL;
+        rt_i2c_port_done(&i2c_async.bus, status, time_us_64());
+        return;
     }
-    return found;
+    uint16_t total = x->tx_len + x->rx_len;
+    // Reads in flight are capped at the RX FIFO depth, so none overflow.
+    while (i2c_async.cmds < total && hw->txflr < I2C_FIFO_DEPTH &&
+           i2c_async.cmds - x->tx_len - i2c_async.rxd < I2C_FIFO_DEPTH) {
+        uint16_t i = i2c_async.cmds++;
+        uint32_t cmd = i < x->tx_len ? x->tx[i] : I2C_IC_DATA_CMD_CMD_BITS;
+        if (i == x->tx_len && i) {
+            cmd |= I2C_IC_DATA_CMD_RESTART_BITS;
+        }
+        if (i + 1 == total) {
+            cmd |= I2C_IC_DATA_CMD_STOP_BITS;
+        }
+        hw->data_cmd = cmd;
+    }
+    if (i2c_async.cmds == total) {
+        hw->intr_mask &= ~I2C_IC_INTR_MASK_M_TX_EMPTY_BITS;
+    }
+}
+
+static void i2c_scan_changed(rt_i2c_scan_t *scan, uint8_t addr, bool present) {
+    (void)scan;
+    volatile uint32_t *set = present ? i2c_appeared : i2c_vanished;
+    set[addr >> 5] |= 1u << (addr & 31);
+}
+
+static uint i2c_irq_num(void) {
+    return i2c_get_index(RP2350_GEEK_I2C_PORT) ? I2C1_IRQ : I2C0_IRQ;
+}
+
+// Scan ticks run as a task, with the controller's interrupt masked so the
+// engine is not entered from two places at once.
+static void i2c_task_run(rt_task_t *task, uint32_t events) {
+    (void)task;
+    (void)events;
+    irq_set_enabled(i2c_irq_num(), false);
+    uint64_t now = time_us_64();
+    rt_i2c_poll(&i2c_async.bus, now);
+    rt_i2c_scan_tick(&i2c_scanner, now);
+    irq_set_enabled(i2c_irq_num(), true);
+}
+
+static void i2c_scan_start(void) {
+    i2c_hw_t *hw = i2c_get_hw(RP2350_GEEK_I2C_PORT);
+    hw->intr_mask = 0;
+    hw->rx_tl = 0; // RX_FULL at the first byte
+    hw->tx_tl = 0;
+    rt_i2c_init(&i2c_async.bus, (rt_i2c_port_t){ NULL, i2c_async_start, i2c_async_abort });
+    rt_i2c_scan_init(&i2c_scanner, &i2c_async.bus, I2C_SCAN_PER_TICK, I2C_TIMEOUT_US, i2c_scan_changed, NULL);
+
+    irq_set_exclusive_handler(i2c_irq_num(), i2c_async_irq);
+    irq_set_enabled(i2c_irq_num(), true);
+
+    i2c_task = (rt_task_t){ .name = "i2c", .prio = TASK_PRIO_IO, .run = i2c_task_run };
+    rt_sched_add(&app_sched, &i2c_task);
+    rt_timer_init(&i2c_scan_timer, &i2c_task, 1u);
+    rt_timer_start(&i2c_scan_timer, time_us_64(), I2C_SCAN_TICK_MS * 1000u);
+}
+
+// Logs the devices that came or went since the last call.
+static void i2c_scan_report(void) {
+    uint32_t appeared[4], vanished[4];
+    uint32_t irq = save_and_disable_interrupts();
+    for (int i = 0; i < 4; ++i) {
+        appeared[i] = i2c_appeared[i];
+        vanished[i] = i2c_vanished[i];
+        i2c_appeared[i] = i2c_vanished[i] = 0;
+    }
+    restore_interrupts(irq);
+    for (int addr = RT_I2C_SCAN_FIRST; addr <= RT_I2C_SCAN_LAST; ++addr) {
+        uint32_t bit = 1u << (addr & 31);
+        if ((appeared[addr >> 5] | vanished[addr >> 5]) & bit) {
+            printf("[i2c] 0x%02X %s\n", addr, rt_i2c_scan_present(&i2c_scanner, (uint8_t)addr) ? "present" : "gone");
+        }
+    }
+}
+
+// --- SPI0 ---
+// Transfers go through the rt/spi.h queue. The port moves each one with two
+// DMA channels on the controller's DREQs, RX and TX, started together, and
+// finishes on the RX channel's interrupt (DMA_IRQ_1, taken on core 1, whose
+// sensor task is the one submitting). A device is a chip-select GPIO with
+// its own clock and mode; the engine reprograms the controller between
+// devices.
+static struct {
+    rt_spi_t bus;
+    uint tx_chan, rx_chan;
+    dma_channel_config tx_cfg, rx_cfg;
+    uint8_t fill; // sent by transfers without tx
+    uint8_t sink; // receives for transfers without rx
+} spi_engine;
+
+static uint32_t spi_port_configure(void *ctx, const rt_spi_dev_t *dev) {
+    (void)ctx;
+    spi_inst_t *spi = RP2350_GEEK_SPI_PORT;
+    uint hz = spi_set_baudrate(spi, dev->hz);
+    spi_set_format(spi, 8, (dev->mode & 2) ? SPI_CPOL_1 : SPI_CPOL_0, (dev->mode & 1) ? SPI_CPHA_1 : SPI_CPHA_0,
+                   SPI_MSB_FIRST);
+    return hz;
+}
+
+static void spi_port_select(void *ctx, const rt_spi_dev_t *dev, bool active) {
+    (void)ctx;
+    gpio_put((uint)dev->cs, !active);
+}
+
+static void spi_port_start(void *ctx, const rt_spi_xfer_t *x) {
+    (void)ctx;
+    spi_inst_t *spi = RP2350_GEEK_SPI_PORT;
+    spi_hw_t *hw = spi_get_hw(spi);
+    while (spi_is_readable(spi)) {
+        (void)hw->dr; // leftovers of a failed transfer
+    }
+    hw->icr = SPI_SSPICR_RORIC_BITS;
+    channel_config_set_write_increment(&spi_engine.rx_cfg, x->rx != NULL);
+    dma_channel_configure(spi_engine.rx_chan, &spi_engine.rx_cfg, x->rx ? x->rx : &spi_engine.sink, &hw->dr, x->len,
+                          false);
+    channel_config_set_read_increment(&spi_engine.tx_cfg, x->tx != NULL);
+    dma_channel_configure(spi_engine.tx_chan, &spi_engine.tx_cfg, &hw->dr, x->tx ? x->tx : &spi_engine.fill, x->len,
+                          false);
+    dma_start_channel_mask((1u << spi_engine.rx_chan) | (1u << spi_engine.tx_chan));
+}
+
+// The last byte is in once the RX channel is done; an overrun means the RX
+// FIFO filled before DMA emptied it and bytes were lost.
+static void spi_dma_irq_handler(void) {
+    if (!dma_channel_get_irq1_status(spi_engine.rx_chan)) {
+        return;
+    }
+    dma_channel_acknowledge_irq1(spi_engine.rx_chan);
+    int status = (spi_get_hw(RP2350_GEEK_SPI_PORT)->ris & SPI_SSPRIS_RORRIS_BITS) ? RT_SPI_ERROR : RT_SPI_OK;
+    rt_spi_port_done(&spi_engine.bus, status, time_us_64());
 }
 
 static void init_spi(void) {
-    spi_init(RP2350_GEEK_SPI_PORT, SPI_BAUD);
+    spi_inst_t *spi = RP2350_GEEK_SPI_PORT;
+    spi_init(spi, SPI_BAUD);
     gpio_set_function(RP2350_GEEK_SPI_MOSI_PIN, GPIO_FUNC_SPI);
     gpio_set_function(RP2350_GEEK_SPI_MISO_PIN, GPIO_FUNC_SPI);
     gpio_set_function(RP2350_GEEK_SPI_SCK_PIN, GPIO_FUNC_SPI);
@@ -86,32 +563,94 @@ static void init_spi(void) {
     gpio_init(RP2350_GEEK_SPI_CS_PIN);
     gpio_set_dir(RP2350_GEEK_SPI_CS_PIN, GPIO_OUT);
     gpio_put(RP2350_GEEK_SPI_CS_PIN, 1);
-}
 
-static bool spi_loopback_test(void) {
-    uint8_t tx[] = {0xAA, 0x55, 0xF0, 0x0F, 0x12, 0x34};
-    uint8_t rx[sizeof(tx)] = {0};
+    spi_engine.fill = RT_SPI_FILL;
+    spi_engine.rx_chan = (uint)dma_claim_unused_channel(true);
+    spi_engine.rx_cfg = dma_channel_get_default_config(spi_engine.rx_chan);
+    channel_config_set_transfer_data_size(&spi_engine.rx_cfg, DMA_SIZE_8);
+    channel_config_set_read_increment(&spi_engine.rx_cfg, false);
+    channel_config_set_dreq(&spi_engine.rx_cfg, spi_get_dreq(spi, false));
+    channel_config_set_high_priority(&spi_engine.rx_cfg, true); // the RX FIFO is only 8 deep
+    spi_engine.tx_chan = (uint)dma_claim_unused_channel(true);
+    spi_engine.tx_cfg = dma_channel_get_default_config(spi_engine.tx_chan);
+    channel_config_set_transfer_data_size(&spi_engine.tx_cfg, DMA_SIZE_8);
+    channel_config_set_write_increment(&spi_engine.tx_cfg, false);
+    channel_config_set_dreq(&spi_engine.tx_cfg, spi_get_dreq(spi, true));
+    dma_channel_set_irq1_enabled(spi_engine.rx_chan, true);
+    rt_spi_init(&spi_engine.bus, (rt_spi_port_t){ NULL, spi_port_configure, spi_port_select, spi_port_start });
+}
 
-    // Requires MOSI and MISO tied together externally for loopback.
-    gpio_put(RP2350_GEEK_SPI_CS_PIN, 0);
-    spi_write_read_blocking(RP2350_GEEK_SPI_PORT, tx, rx, sizeof(tx));
-    gpio_put(RP2350_GEEK_SPI_CS_PIN, 1);
+// On the core that submits.
+static void spi_irq_enable(void) {
+    irq_add_shared_handler(DMA_IRQ_1, spi_dma_irq_handler, PICO_SHARED_IRQ_HANDLER_DEFAULT_ORDER_PRIORITY);
+    irq_set_enabled(DMA_IRQ_1, true);
+}
 
-    return memcmp(tx, rx, sizeof(tx)) == 0;
+// Engine calls from a task go in with the port's interrupt masked.
+static void spi_submit(rt_spi_xfer_t *x) {
+    irq_set_enabled(DMA_IRQ_1, false);
+    rt_spi_submit(&spi_engine.bus, x, time_us_64());
+    irq_set_enabled(DMA_IRQ_1, true);
 }
 
+static uint16_t adc_ring[ADC_RING_SAMPLES] __attribute__((aligned(ADC_RING_SAMPLES * sizeof(uint16_t))));
+
+static struct {
+    uint dma_chan;
+    rt_adc_acq_t acq;
+    rt_adc_ring_t ring;
+} adc_stream;
+
+// Conversion errors go into the FIFO as bit 15 (RT_ADC_ERR); the sample
+// period is 1 + div cycles of the 48 MHz ADC clock.
 static void init_adc(void) {
     adc_init();
     adc_gpio_init(RP2350_GEEK_ADC_PIN);
+    adc_set_temp_sensor_enabled((ADC_CHANNELS & (1u << ADC_TEMPERATURE_CHANNEL_NUM)) != 0);
+    adc_set_round_robin(ADC_CHANNELS);
+    adc_fifo_setup(true, true, 1, true, false);
+    adc_set_clkdiv(48000000.0f / ADC_SAMPLE_HZ - 1.0f);
+    adc_stream.dma_chan = (uint)dma_claim_unused_channel(true);
+    rt_adc_acq_init(&adc_stream.acq, ADC_CHANNELS, (uint8_t)__builtin_ctz(ADC_CHANNELS), ADC_DECIM_ORDER, ADC_DECIM);
+    rt_adc_ring_init(&adc_stream.ring, adc_ring, ADC_RING_SAMPLES, ADC_SAMPLE_HZ, time_us_64());
 }
 
-static uint16_t read_adc_raw(void) {
-    uint input = 0;
-    if (RP2350_GEEK_ADC_PIN >= 26) {
-        input = RP2350_GEEK_ADC_PIN - 26;
+// (Re)starts conversions at the lowest channel into an empty ring. The DMA
+// channel runs in endless mode, wrapping its write address on the ring.
+static void adc_stream_start(void) {
+    adc_run(false);
+    dma_channel_abort(adc_stream.dma_chan);
+    while (!(adc_hw->cs & ADC_CS_READY_BITS)) {
+        tight_loop_contents(); // a conversion still under way
     }
-    adc_select_input(input);
-    return adc_read();
+    adc_fifo_drain();
+
+    dma_channel_config c = dma_channel_get_default_config(adc_stream.dma_chan);
+    channel_config_set_transfer_data_size(&c, DMA_SIZE_16);
+    channel_config_set_read_increment(&c, false);
+    channel_config_set_write_increment(&c, true);
+    channel_config_set_ring(&c, true, (uint)__builtin_ctz(sizeof(adc_ring)));
+    channel_config_set_dreq(&c, DREQ_ADC);
+    dma_channel_configure(adc_stream.dma_chan, &c, adc_ring, &adc_hw->fifo,
+                          DMA_CH0_TRANS_COUNT_MODE_VALUE_ENDLESS << DMA_CH0_TRANS_COUNT_MODE_LSB, true);
+
+    rt_adc_ring_restart(&adc_stream.ring, time_us_64());
+    rt_adc_acq_restart(&adc_stream.acq);
+    adc_select_input(adc_stream.acq.seq[0]);
+    adc_run(true);
+}
+
+static void adc_stream_drain(void) {
+    uint32_t write_addr = dma_channel_hw_addr(adc_stream.dma_chan)->write_addr;
+    uint32_t write_idx = (write_addr - (uint32_t)(uintptr_t)adc_ring) / sizeof(uint16_t);
+    if (!rt_adc_ring_drain(&adc_stream.ring, write_idx, time_us_64(), &adc_stream.acq)) {
+        adc_stream_start(); // fell a ring behind: samples were overwritten
+    }
+}
+
+// Millivolts from 1/16 LSB.
+static uint32_t adc_q4_mv(uint32_t q4) {
+    return q4 * 3300u / (4095u * 16u);
 }
 
 static const char *arch_name(void) {
@@ -128,50 +667,22 @@ static const char *lcd_page_name(lcd_page_t page) {
         case LCD_PAGE_GRAPHIC: return "gradient";
         case LCD_PAGE_ICON: return "icon";
         case LCD_PAGE_GIF: return "gif";
+        case LCD_PAGE_DASHBOARD: return "dashboard";
+        case LCD_PAGE_CONSOLE: return "console";
         default: return "unknown";
     }
 }
 
-static void check_bootsel_command(void) {
-    static char buf[8];
-    static uint8_t pos = 0;
-    int ch;
-    while ((ch = getchar_timeout_us(0)) != PICO_ERROR_TIMEOUT) {
-        if (ch == '\r' || ch == '\n') {
-            if (pos == 7) {
-                const char magic[7] = {'B','O','O','T','S','E','L'};
-                bool match = true;
-                for (uint8_t i = 0; i < 7; ++i) {
-                    char c = (char)toupper((int)buf[i]);
-                    if (c != magic[i]) {
-                        match = false;
-                        break;
-                    }
-                }
-                if (match) {
-                    printf("BOOTSEL command received; entering ROM USB.\n");
-                    sleep_ms(50);
-                    reset_usb_boot(0, 0);
-                }
-            }
-            pos = 0;
-            continue;
-        }
-        if (pos < sizeof(buf)) {
-            buf[pos++] = (char)ch;
-        } else {
-            pos = 0; // overflow, reset
-        }
-    }
-}
-
 // --- LCD helpers ---
-static inline uint16_t rgb565(uint8_t r, uint8_t g, uint8_t b) {
-    return (uint16_t)(((r & 0xF8) << 8) | ((g & 0xFC) << 3) | (b >> 3));
+#if LCD_USE_PIO
+static void lcd_write_cmd(uint8_t cmd) {
+    lcd_pio_write(false, &cmd, 1);
 }
 
-#define RGB565_CONST(r, g, b) (uint16_t)((((r) & 0xF8) << 8) | (((g) & 0xFC) << 3) | ((b) >> 3))
-
+static void lcd_write_data(const uint8_t *data, size_t len) {
+    lcd_pio_write(true, data, len);
+}
+#else
 static inline void lcd_cs(bool level) {
     gpio_put(RP2350_GEEK_LCD_SPI_CS_PIN, level);
 }
@@ -197,27 +708,631 @@ static void lcd_write_data(const uint8_t *data, size_t len) {
     lcd_write_bytes(data, len);
     lcd_cs(1);
 }
+#endif
 
-static void lcd_set_addr_window(uint16_t x, uint16_t y, uint16_t w, uint16_t h) {
-    uint16_t x0 = x + LCD_X_OFFSET;
-    uint16_t x1 = x0 + w - 1;
-    uint16_t y0 = y + LCD_Y_OFFSET;
-    uint16_t y1 = y0 + h - 1;
+static void lcd_bus_write_cmd(void *ctx, uint8_t cmd) {
+    (void)ctx;
+    lcd_write_cmd(cmd);
+}
 
-    uint8_t caset[] = {
-        (uint8_t)(x0 >> 8), (uint8_t)(x0 & 0xFF),
-        (uint8_t)(x1 >> 8), (uint8_t)(x1 & 0xFF)
-    };
-    uint8_t raset[] = {
-        (uint8_t)(y0 >> 8), (uint8_t)(y0 & 0xFF),
-        (uint8_t)(y1 >> 8), (uint8_t)(y1 & 0xFF)
-    };
+static void lcd_bus_write_data(void *ctx, const uint8_t *data, size_t len) {
+    (void)ctx;
+    lcd_write_data(data, len);
+}
+
+static void lcd_bus_delay_ms(void *ctx, uint32_t ms) {
+    (void)ctx;
+    sleep_ms(ms);
+}
+
+static const gfx_bus_t lcd_bus = {
+    .write_cmd = lcd_bus_write_cmd,
+    .write_data = lcd_bus_write_data,
+    .delay_ms = lcd_bus_delay_ms,
+};
+
+static const st7789_config_t lcd_panel = {
+    .width = LCD_WIDTH,
+    .height = LCD_HEIGHT,
+    .x_offset = LCD_X_OFFSET,
+    .y_offset = LCD_Y_OFFSET,
+    .madctl = LCD_MADCTL,
+    .invert = LCD_INVERT_DISPLAY, // override via -DLCD_INVERT_DISPLAY=0
+    .tear_sync = RP2350_GEEK_LCD_TE_PIN >= 0,
+};
+
+// --- LCD DMA flush engine ---
+// A flush is a list of windows. Each window gets its own CASET/RASET/RAMWR
+// and is then streamed by one DMA channel into SPI1 TX; the DMA IRQ advances
+// through the window and on to the next one, so callers return immediately.
+//
+// In wire-order mode the frame is already laid out as the panel expects: a
+// full-width window is a single transfer straight out of the framebuffer and a
+// narrower one is one transfer per row. In native order, or with an indexed
+// framebuffer, the pixels are converted into two staging buffers in turn: the
+// IRQ restarts the channel on the freshly filled buffer and then refills the
+// one that just drained. With LCD_USE_PIO the channel feeds the PIO
+// transmitter instead, which takes 16-bit pixels in either order (or 8-bit
+// indices through its palette chain), and a window is one PIO transfer split
+// into per-row DMA runs.
+//
+// Frames are LCD_WIDTH wide; a strip is flushed with origin_y set to the
+// panel row its first line belongs to.
+typedef void (*lcd_flush_cb_t)(void *user);
+
+static struct {
+    int chan;
+    const gfx_fb_t *frame;
+    int16_t origin_y; // panel row of the frame's row 0
+    gfx_rect_t windows[GFX_DIRTY_MAX];
+    uint8_t window_count;
+    uint8_t window_idx;
+#if LCD_DMA_DIRECT
+    // Cursor within the current window. A full-width window is treated as a
+    // single row of w * h pixels so it streams without row breaks.
+    size_t row_px;
+    size_t rows_left;
+    const gfx_pixel_t *row;
+#else
+    gfx_stream_t stream; // stages the window into the ping-pong buffers
+    uint8_t staging[2][LCD_DMA_CHUNK_PX * 2];
+#endif
+    volatile bool busy;
+    lcd_flush_cb_t done_cb;
+    void *done_user;
+    uint32_t flush_px;
+    uint32_t started; // gfx_perf_now()
+    volatile uint32_t last_flush_us;
+    volatile uint32_t last_flush_px;
+} lcd_dma = { .chan = -1 };
+
+static volatile uint32_t lcd_frames_flushed;
+
+// Render and flush durations (gfx/perf.h). Renders are recorded by the
+// rendering core and flushes by core 0's DMA interrupt, so both stages sit
+// behind a critical section.
+static struct {
+    critical_section_t lock;
+    gfx_perf_stage_t render, flush;
+#if LCD_PERF_OVERLAY
+    char overlay[2][28]; // "rnd avg/p99us"
+#endif
+} lcd_perf;
+
+static void lcd_perf_add(gfx_perf_stage_t *stage, uint32_t ticks, uint32_t units) {
+    critical_section_enter_blocking(&lcd_perf.lock);
+    gfx_perf_record(stage, ticks, units);
+    critical_section_exit(&lcd_perf.lock);
+}
+
+#if !LCD_DMA_DIRECT
+// Sends the chunk the stream has ready, then stages the next one into the
+// other buffer while it is on the wire; the DMA IRQ fires when it drained.
+static void lcd_dma_send(size_t px) {
+    dma_channel_transfer_from_buffer_now(lcd_dma.chan, gfx_stream_chunk(&lcd_dma.stream), px * 2);
+    gfx_stream_refill(&lcd_dma.stream);
+}
+#endif
+
+#if LCD_DMA_DIRECT
+static inline void lcd_dma_stream_row(void) {
+#if LCD_USE_PIO && GFX_FB_INDEXED
+    lcd_pio_stream_indexed(lcd_dma.row, lcd_dma.row_px);
+#elif LCD_USE_PIO
+    lcd_pio_stream_pixels(lcd_dma.row, lcd_dma.row_px);
+#else
+    dma_channel_transfer_from_buffer_now(lcd_dma.chan, lcd_dma.row, lcd_dma.row_px * 2);
+#endif
+}
+#endif
+
+// Wait for SPI to drain the TX FIFO, discard what it clocked in, and release CS.
+static void lcd_dma_end_window(void) {
+#if LCD_USE_PIO
+    lcd_pio_wait_idle();
+#else
+    spi_inst_t *spi = RP2350_GEEK_LCD_SPI_PORT;
+    while (spi_is_busy(spi)) {
+        tight_loop_contents();
+    }
+    while (spi_is_readable(spi)) {
+        (void)spi_get_hw(spi)->dr;
+    }
+    spi_get_hw(spi)->icr = SPI_SSPICR_RORIC_BITS;
+    lcd_cs(1);
+#endif
+}
+
+static void lcd_dma_begin_window(const gfx_rect_t *r) {
+    uint16_t w = (uint16_t)(r->x1 - r->x0);
+    uint16_t h = (uint16_t)(r->y1 - r->y0);
+    st7789_set_window(&lcd_bus, &lcd_panel, (uint16_t)r->x0, (uint16_t)(r->y0 + lcd_dma.origin_y), w, h);
+#if LCD_USE_PIO
+    lcd_pio_begin_pixels((size_t)w * h);
+#else
+    lcd_cs(0);
+    lcd_dc(1);
+#endif
+
+    lcd_dma.flush_px += (uint32_t)w * h;
+
+#if LCD_DMA_DIRECT
+    lcd_dma.row = &lcd_dma.frame->pixels[r->y0 * LCD_WIDTH + r->x0];
+    if (w == LCD_WIDTH) {
+        lcd_dma.row_px = (size_t)w * h;
+        lcd_dma.rows_left = 1;
+    } else {
+        lcd_dma.row_px = w;
+        lcd_dma.rows_left = h;
+    }
+    lcd_dma_stream_row();
+#else
+    lcd_dma_send(gfx_stream_begin(&lcd_dma.stream, lcd_dma.frame, r));
+#endif
+}
+
+static void lcd_dma_finish(void) {
+    uint32_t ticks = gfx_perf_now() - lcd_dma.started;
+    lcd_dma.last_flush_us = gfx_perf_us(ticks);
+    lcd_dma.last_flush_px = lcd_dma.flush_px;
+    if (lcd_dma.flush_px) {
+        lcd_perf_add(&lcd_perf.flush, ticks, lcd_dma.flush_px * 2);
+    }
+
+    lcd_flush_cb_t cb = lcd_dma.done_cb;
+    void *user = lcd_dma.done_user;
+    lcd_dma.busy = false;
+    if (cb) {
+        cb(user);
+    }
+}
+
+// Called when the current window has been fully handed to SPI.
+static void lcd_dma_window_done(void) {
+    lcd_dma_end_window();
+    if (++lcd_dma.window_idx < lcd_dma.window_count) {
+        lcd_dma_begin_window(&lcd_dma.windows[lcd_dma.window_idx]);
+    } else {
+        lcd_dma_finish();
+    }
+}
+
+static void lcd_dma_irq_handler(void) {
+    if (lcd_dma.chan < 0 || !dma_channel_get_irq0_status(lcd_dma.chan)) {
+        return;
+    }
+    dma_channel_acknowledge_irq0(lcd_dma.chan);
+
+#if LCD_DMA_DIRECT
+    if (--lcd_dma.rows_left) {
+        lcd_dma.row += LCD_WIDTH;
+        lcd_dma_stream_row();
+        return;
+    }
+    lcd_dma_window_done();
+#else
+    size_t px = gfx_stream_next(&lcd_dma.stream);
+    if (!px) {
+        lcd_dma_window_done();
+        return;
+    }
+    lcd_dma_send(px);
+#endif
+}
+
+static void lcd_dma_init(void) {
+#if LCD_USE_PIO && GFX_FB_INDEXED
+    lcd_dma.chan = lcd_pio_index_dma_chan();
+#elif LCD_USE_PIO
+    lcd_dma.chan = lcd_pio_pixel_dma_chan();
+#else
+    lcd_dma.chan = dma_claim_unused_channel(true);
+    dma_channel_config c = dma_channel_get_default_config(lcd_dma.chan);
+    channel_config_set_transfer_data_size(&c, DMA_SIZE_8);
+    channel_config_set_read_increment(&c, true);
+    channel_config_set_write_increment(&c, false);
+    channel_config_set_dreq(&c, spi_get_dreq(RP2350_GEEK_LCD_SPI_PORT, true));
+    dma_channel_configure(lcd_dma.chan, &c, &spi_get_hw(RP2350_GEEK_LCD_SPI_PORT)->dr, NULL, 0, false);
+#endif
+#if !LCD_DMA_DIRECT
+    gfx_stream_init(&lcd_dma.stream, lcd_dma.staging[0], lcd_dma.staging[1], LCD_DMA_CHUNK_PX);
+#endif
+
+    irq_add_shared_handler(DMA_IRQ_0, lcd_dma_irq_handler, PICO_SHARED_IRQ_HANDLER_DEFAULT_ORDER_PRIORITY);
+    dma_channel_set_irq0_enabled(lcd_dma.chan, true);
+    irq_set_enabled(DMA_IRQ_0, true);
+}
+
+static inline bool lcd_flush_busy(void) {
+    return lcd_dma.busy;
+}
+
+// Fence: block until the in-flight flush (if any) has released the framebuffer.
+static void lcd_flush_wait(void) {
+    while (lcd_dma.busy) {
+        tight_loop_contents();
+    }
+}
+
+// Starts streaming the damaged windows of a frame to the panel and returns
+// immediately; the frame's dirty list is consumed. The frame must not be
+// modified until the callback fires or lcd_flush_wait() returns. With nothing
+// dirty the callback runs before this returns. The frame's row 0 goes to panel
+// row origin_y.
+static void lcd_flush_frame_at(gfx_fb_t *frame, int origin_y, lcd_flush_cb_t cb, void *user) {
+    lcd_flush_wait();
+
+    lcd_dma.frame = frame;
+    lcd_dma.origin_y = (int16_t)origin_y;
+    lcd_dma.done_cb = cb;
+    lcd_dma.done_user = user;
+    lcd_dma.flush_px = 0;
+    lcd_dma.started = gfx_perf_now();
+    lcd_dma.window_count = frame->dirty_count;
+    lcd_dma.window_idx = 0;
+    memcpy(lcd_dma.windows, frame->dirty, frame->dirty_count * sizeof(gfx_rect_t));
+    frame->dirty_count = 0;
+#if LCD_USE_PIO && GFX_FB_INDEXED
+    if (lcd_dma.window_count) {
+        // The DMA chain reads its own copy, so the palette can change while this flushes.
+        lcd_pio_set_palette(frame->palette->color, GFX_PALETTE_SIZE);
+    }
+#endif
+
+    lcd_dma.busy = true;
+    if (lcd_dma.window_count == 0) {
+        lcd_dma_finish();
+        return;
+    }
+    lcd_dma_begin_window(&lcd_dma.windows[0]);
+}
 
-    lcd_write_cmd(0x2A);
-    lcd_write_data(caset, sizeof(caset));
-    lcd_write_cmd(0x2B);
-    lcd_write_data(raset, sizeof(raset));
-    lcd_write_cmd(0x2C);
+static void lcd_flush_frame(gfx_fb_t *frame, lcd_flush_cb_t cb, void *user) {
+    lcd_flush_frame_at(frame, 0, cb, user);
+}
+
+static void lcd_flush_dirty(lcd_flush_cb_t cb, void *user) {
+    lcd_flush_frame(fb_target, cb, user);
+}
+
+// Pushes the whole render target regardless of what was drawn.
+static void lcd_flush_framebuffer_async(lcd_flush_cb_t cb, void *user) {
+    lcd_flush_wait();
+    fb_mark_all_dirty();
+    lcd_flush_dirty(cb, user);
+}
+
+static void lcd_flush_framebuffer(void) {
+    lcd_flush_framebuffer_async(NULL, NULL);
+    lcd_flush_wait();
+}
+
+// Completion callback for the page flushes (runs in the DMA IRQ).
+static void lcd_flush_done(void *user) {
+    (void)user;
+    lcd_frames_flushed++;
+}
+
+// --- Snapshots ---
+// A snapshot is streamed from core 0 a few lines at a time. The frame it
+// reads stays untouched until it is done: the page task renders nothing
+// meanwhile, with double buffering the front buffer is not replaced either
+// (the slots it misses count as dropped), and the console page stops drawing.
+// Its own lines are kept off the console page.
+#if LCD_SNAP
+static struct {
+    gfx_snap_t snap;
+    volatile bool active;
+    uint32_t id, seq;
+} lcd_snap;
+
+static void base64_encode(const uint8_t *in, size_t n, char *out) {
+    static const char digits[] = "ABCDEFGHIJKLMNOPQRSTUVWXYZabcdefghijklmnopqrstuvwxyz0123456789+/";
+    for (size_t i = 0; i < n; i += 3) {
+        uint32_t v = (uint32_t)in[i] << 16;
+        if (i + 1 < n) {
+            v |= (uint32_t)in[i + 1] << 8;
+        }
+        if (i + 2 < n) {
+            v |= in[i + 2];
+        }
+        *out++ = digits[v >> 18];
+        *out++ = digits[(v >> 12) & 63];
+        *out++ = i + 1 < n ? digits[(v >> 6) & 63] : '=';
+        *out++ = i + 2 < n ? digits[v & 63] : '=';
+    }
+    *out = '\0';
+}
+
+// Core 0: prints the next LCD_SNAP_LINES lines of the snapshot in progress;
+// returns whether it still is.
+static bool lcd_snap_pump(void) {
+    if (!lcd_snap.active) {
+        return false;
+    }
+    for (int i = 0; i < LCD_SNAP_LINES; ++i) {
+        uint8_t chunk[LCD_SNAP_CHUNK];
+        char text[(LCD_SNAP_CHUNK + 2) / 3 * 4 + 1];
+        size_t n = gfx_snap_read(&lcd_snap.snap, chunk, sizeof(chunk));
+        if (!n) {
+            printf("@snap end %lu %lu %08lx\n", (unsigned long)lcd_snap.id, (unsigned long)lcd_snap.snap.bytes,
+                   (unsigned long)lcd_snap.snap.crc);
+            __dmb(); // done reading before the frame is released
+            lcd_snap.active = false;
+            return false;
+        }
+        base64_encode(chunk, n, text);
+        printf("@snap %lu %s\n", (unsigned long)lcd_snap.seq++, text);
+    }
+    return true;
+}
+#endif
+
+// --- Frame presentation ---
+// lcd_show() replays a page's display list: into the back buffer between
+// lcd_begin_frame() and lcd_present(), or, with LCD_STRIP_LINES, strip by
+// strip straight to the DMA engine.
+//
+// With LCD_DOUBLE_BUFFER, core 1 owns the back buffer and core 0 owns the
+// front buffer. Buffer indices are the only thing exchanged, over two bus
+// channels: lcd_ready_chan carries "frame ready" to core 0, lcd_free_chan
+// carries "buffer free" to core 1. Core 0 starts the ready frame's DMA flush
+// from the doorbell or DMA IRQ as soon as the previous flush completes and
+// then frees the old front buffer, so core 1 renders frame N+1 while frame N
+// is on the wire. Because a recycled buffer still holds the frame before
+// last, core 1 copies the damage of the frame it just submitted into it
+// before drawing, keeping the buffers in step without repainting everything.
+static gfx_pacer_t lcd_pacer;
+static volatile lcd_page_t lcd_shown_page = LCD_PAGE_TEXT;
+
+#if LCD_DOUBLE_BUFFER
+static gfx_swap_t lcd_swap;           // front and pending frames (core 0)
+static uint32_t lcd_frames_presented; // core 1
+static rt_chan_t lcd_ready_chan, lcd_free_chan;
+static int8_t lcd_ready_buf[LCD_FB_COUNT], lcd_free_buf[LCD_FB_COUNT];
+
+static void lcd_free_frame(int idx) {
+    if (idx >= 0) {
+        int8_t i = (int8_t)idx;
+        rt_chan_send(&lcd_free_chan, &i);
+    }
+}
+
+// Core 0, IRQ context: flush the pending frame once the engine is idle.
+static void lcd_present_pending(void) {
+    int prev;
+    if (lcd_flush_busy() || !gfx_swap_flip(&lcd_swap, &prev)) {
+        return;
+    }
+    lcd_flush_frame(&lcd_frames[lcd_swap.front], lcd_flush_done, NULL);
+    lcd_free_frame(prev);
+}
+
+// Core 0, doorbell IRQ. A ready frame waits in lcd_swap.pending for its slot
+// (lcd_vsync()); the ring publishes its pixels and dirty list with the index.
+// A frame superseded before its slot (before the first one, with two buffers)
+// passes its damage on and is free again.
+static void lcd_ready_notify(rt_chan_t *chan) {
+    int8_t idx;
+    while (rt_chan_recv(chan, &idx)) {
+        lcd_free_frame(gfx_swap_ready(&lcd_swap, idx));
+    }
+    gfx_pacer_submit(&lcd_pacer, time_us_64());
+}
+
+static void lcd_begin_frame(void) {
+    gfx_pacer_begin(&lcd_pacer, time_us_64());
+}
+
+// Core 1: hand the finished back buffer to core 0 and continue in the buffer it frees.
+static void lcd_present(void) {
+    gfx_fb_t *done = fb_target;
+    gfx_rect_t carry[GFX_DIRTY_MAX];
+    uint8_t carry_count = done->dirty_count;
+    memcpy(carry, done->dirty, carry_count * sizeof(gfx_rect_t));
+
+    lcd_frames_presented++;
+    int8_t idx = (int8_t)(done - lcd_frames);
+    rt_chan_send(&lcd_ready_chan, &idx); // a slot per buffer: never full
+    while (!rt_chan_recv(&lcd_free_chan, &idx)) {
+        __wfe(); // the doorbell interrupt wakes this core
+    }
+    fb_bind(&lcd_frames[idx]);
+
+    // Both sides only read `done` from here on, so copying while it is flushed is safe.
+    gfx_fb_copy_rects(fb_target, done, carry, carry_count);
+}
+
+// Before core 1 starts: it begins in frame 0 with frame 1 spare.
+static void lcd_display_start(void) {
+    rt_chan_init(&lcd_ready_chan, lcd_ready_buf, sizeof(int8_t), LCD_FB_COUNT, 0);
+    lcd_ready_chan.name = "lcd_ready";
+    lcd_ready_chan.notify = lcd_ready_notify;
+    rt_bus_add(&app_bus, &lcd_ready_chan);
+    rt_chan_init(&lcd_free_chan, lcd_free_buf, sizeof(int8_t), LCD_FB_COUNT, 1);
+    lcd_free_chan.name = "lcd_free"; // polled by lcd_present()
+    rt_bus_add(&app_bus, &lcd_free_chan);
+
+    gfx_swap_init(&lcd_swap, lcd_frames);
+    fb_bind(&lcd_frames[0]);
+    int8_t spare = 1;
+    rt_ring_push(&lcd_free_chan.ring, &spare, NULL); // no doorbell before the launch
+}
+#elif LCD_STRIP_LINES
+// Strips alternate between lcd_frames[0] and [1]; gfx_dl_render_strips() waits
+// for the engine before handing it the next one. Only the last strip of a
+// page counts as a flushed frame.
+static void lcd_strip_send(void *ctx, gfx_fb_t *strip, int y, bool last) {
+    (void)ctx;
+    lcd_flush_frame_at(strip, y, last ? lcd_flush_done : NULL, NULL);
+}
+
+static void lcd_strip_wait(void *ctx) {
+    (void)ctx;
+    lcd_flush_wait();
+}
+
+static const gfx_strip_sink_t lcd_strip_sink = { lcd_strip_send, lcd_strip_wait, NULL };
+#else
+// The vsync tick starts the flush of a submitted frame, so the framebuffer is
+// busy until that flush is done.
+static void lcd_begin_frame(void) {
+    while (lcd_pacer.ready) {
+        __wfe();
+    }
+    lcd_flush_wait();
+    while (lcd_snap_pump()) { // the snapshot reads this frame
+        sleep_ms(LCD_SNAP_POLL_MS);
+    }
+    gfx_pacer_begin(&lcd_pacer, time_us_64());
+}
+
+static void lcd_present(void) {
+    __dmb(); // the pixels before the vsync interrupt that flushes them
+    gfx_pacer_submit(&lcd_pacer, time_us_64());
+}
+#endif
+
+#if LCD_STRIP_LINES
+// Strips are drawn and sent in one pass, so it is the first strip that waits
+// for the slot.
+static void lcd_wait_slot(void) {
+    gfx_pacer_begin(&lcd_pacer, time_us_64());
+    gfx_pacer_submit(&lcd_pacer, time_us_64());
+    while (lcd_pacer.ready) {
+        __wfe();
+    }
+}
+#endif
+
+// Core 0, IRQ context: one panel refresh (a TE pulse or a frame timer tick).
+// At a frame slot the submitted frame's flush starts.
+static void lcd_vsync(void) {
+    bool idle = !lcd_flush_busy();
+#if LCD_DOUBLE_BUFFER
+    idle = idle && !lcd_snap.active; // the front buffer is being streamed
+#endif
+    if (!gfx_pacer_tick(&lcd_pacer, time_us_64(), idle)) {
+        return;
+    }
+#if LCD_DOUBLE_BUFFER
+    lcd_present_pending();
+#elif !LCD_STRIP_LINES
+    lcd_flush_dirty(lcd_flush_done, NULL);
+#endif
+    __sev(); // wake a core waiting for its slot
+}
+
+#if RP2350_GEEK_LCD_TE_PIN >= 0
+static void lcd_te_irq(uint gpio, uint32_t events) {
+    (void)gpio;
+    (void)events;
+    lcd_vsync();
+}
+#else
+static repeating_timer_t lcd_refresh_timer;
+
+static bool lcd_refresh_tick(repeating_timer_t *timer) {
+    (void)timer;
+    lcd_vsync();
+    return true;
+}
+#endif
+
+// Starts the vsync ticks on core 0.
+static void lcd_pace_start(void) {
+    gfx_pacer_init(&lcd_pacer, LCD_REFRESH_HZ / LCD_FRAME_HZ);
+#if RP2350_GEEK_LCD_TE_PIN >= 0
+    gpio_init(RP2350_GEEK_LCD_TE_PIN);
+    gpio_set_dir(RP2350_GEEK_LCD_TE_PIN, GPIO_IN);
+    gpio_set_irq_enabled_with_callback(RP2350_GEEK_LCD_TE_PIN, GPIO_IRQ_EDGE_RISE, true, lcd_te_irq);
+#else
+    // A negative interval keeps the ticks at a fixed rate, however long a callback takes.
+    add_repeating_timer_us(-(1000000 / LCD_REFRESH_HZ), lcd_refresh_tick, NULL, &lcd_refresh_timer);
+#endif
+}
+
+static volatile uint32_t lcd_last_render_us; // of the last lcd_show() or lcd_update()
+
+// Records a render begun at start; in strip mode that includes sending. The
+// overlay goes on top afterwards, outside the measured time.
+static void lcd_render_done(uint32_t start) {
+    uint32_t ticks = gfx_perf_now() - start;
+    lcd_last_render_us = gfx_perf_us(ticks);
+    lcd_perf_add(&lcd_perf.render, ticks, 0);
+#if LCD_PERF_OVERLAY
+    char lines[2][sizeof(lcd_perf.overlay[0])];
+    critical_section_enter_blocking(&lcd_perf.lock);
+    memcpy(lines, lcd_perf.overlay, sizeof(lines));
+    critical_section_exit(&lcd_perf.lock);
+    uint16_t fg = rgb565(255, 255, 0), bg = rgb565(0, 0, 0);
+    int x = LCD_WIDTH - (int)strlen(lines[0]) * 6;
+    fb_draw_text(x, 0, lines[0], fg, bg);
+    fb_draw_text(x, 8, lines[1], fg, bg);
+#endif
+}
+
+// Prints the render and flush times since the last report and, with the
+// overlay, keeps their averages and p99s for the following frames.
+static void lcd_perf_report(void) {
+    gfx_perf_stage_t render, flush;
+    critical_section_enter_blocking(&lcd_perf.lock);
+    gfx_perf_take(&lcd_perf.render, &render);
+    gfx_perf_take(&lcd_perf.flush, &flush);
+    critical_section_exit(&lcd_perf.lock);
+
+    gfx_perf_summary_t r, f;
+    gfx_perf_summarize(&render, &r);
+    gfx_perf_summarize(&flush, &f);
+    printf("[perf] render n=%lu min/avg/p99/max=%lu/%lu/%lu/%luus flush n=%lu min/avg/p99/max=%lu/%lu/%lu/%luus %.2fMB/s\n",
+           (unsigned long)r.count, (unsigned long)r.min_us, (unsigned long)r.avg_us, (unsigned long)r.p99_us,
+           (unsigned long)r.max_us, (unsigned long)f.count, (unsigned long)f.min_us, (unsigned long)f.avg_us,
+           (unsigned long)f.p99_us, (unsigned long)f.max_us, (double)f.units_per_s / 1e6);
+#if LCD_PERF_OVERLAY
+    char lines[2][sizeof(lcd_perf.overlay[0])];
+    snprintf(lines[0], sizeof(lines[0]), "rnd %5lu/%5luus", (unsigned long)r.avg_us, (unsigned long)r.p99_us);
+    snprintf(lines[1], sizeof(lines[1]), "spi %5lu/%5luus", (unsigned long)f.avg_us, (unsigned long)f.p99_us);
+    critical_section_enter_blocking(&lcd_perf.lock);
+    memcpy(lcd_perf.overlay, lines, sizeof(lines));
+    critical_section_exit(&lcd_perf.lock);
+#endif
+}
+
+// Renders and presents area of a page (NULL for all of it). Only that area
+// is redrawn and sent.
+static void lcd_show(const gfx_dlist_t *dl, const gfx_rect_t *area) {
+#if LCD_STRIP_LINES
+    lcd_wait_slot();
+    uint32_t start = gfx_perf_now();
+    gfx_dl_render_strips(dl, lcd_frames, LCD_HEIGHT, area, &lcd_strip_sink);
+    lcd_render_done(start);
+#else
+    lcd_begin_frame();
+    uint32_t start = gfx_perf_now();
+    gfx_dl_render_area(dl, area);
+    lcd_render_done(start);
+    lcd_present();
+#endif
+}
+
+// Redraws and presents only what the gfx_dl_set_*() calls changed since the
+// page was last shown.
+static void lcd_update(gfx_dlist_t *dl) {
+    if (!dl->damage_count) {
+        return;
+    }
+#if LCD_STRIP_LINES
+    lcd_wait_slot();
+    uint32_t start = gfx_perf_now();
+    gfx_dl_render_damage_strips(dl, lcd_frames, LCD_HEIGHT, &lcd_strip_sink);
+    lcd_render_done(start);
+#else
+    lcd_begin_frame();
+    uint32_t start = gfx_perf_now();
+    gfx_dl_render_damage(dl);
+    lcd_render_done(start);
+    lcd_present();
+#endif
 }
 
 static void lcd_reset_panel(void) {
@@ -228,6 +1343,20 @@ static void lcd_reset_panel(void) {
 }
 
 static void lcd_init_panel(void) {
+    for (int i = 0; i < LCD_FB_COUNT; ++i) {
+        gfx_fb_init(&lcd_frames[i], lcd_pixels[i], LCD_WIDTH, LCD_FB_LINES);
+    }
+    fb_bind(&lcd_frames[0]);
+
+#if LCD_USE_PIO
+    // SCK/MOSI/DC/CS belong to the PIO transmitter
+    lcd_pio_init(&(lcd_pio_config_t){
+        .mosi_pin = RP2350_GEEK_LCD_SPI_MOSI_PIN,
+        .sck_pin = RP2350_GEEK_LCD_SPI_SCK_PIN,
+        .dc_pin = RP2350_GEEK_LCD_DC_PIN,
+        .sck_hz = LCD_PIO_SCK_HZ,
+    });
+#else
     // SPI pins
     spi_init(RP2350_GEEK_LCD_SPI_PORT, LCD_SPI_BAUD);
     spi_set_format(RP2350_GEEK_LCD_SPI_PORT, 8, SPI_CPOL_0, SPI_CPHA_0, SPI_MSB_FIRST);
@@ -242,6 +1371,7 @@ static void lcd_init_panel(void) {
     gpio_init(RP2350_GEEK_LCD_DC_PIN);
     gpio_set_dir(RP2350_GEEK_LCD_DC_PIN, GPIO_OUT);
     lcd_dc(1);
+#endif
 
     gpio_init(RP2350_GEEK_LCD_RST_PIN);
     gpio_set_dir(RP2350_GEEK_LCD_RST_PIN, GPIO_OUT);
@@ -251,285 +1381,914 @@ static void lcd_init_panel(void) {
 
     lcd_reset_panel();
 
-    // Minimal ST7789 init sequence for 16-bit color.
-    lcd_write_cmd(0x36); // MADCTL
-    uint8_t madctl = LCD_MADCTL;
-    lcd_write_data(&madctl, 1);
+    st7789_init(&lcd_bus, &lcd_panel);
 
-    lcd_write_cmd(0x3A); // COLMOD
-    uint8_t colmod = 0x55; // 16-bit
-    lcd_write_data(&colmod, 1);
+    gpio_put(RP2350_GEEK_LCD_BL_PIN, 1);
 
-    // Optional display inversion (1 = inverted). Override via -DLCD_INVERT_DISPLAY=0.
-#if LCD_INVERT_DISPLAY
-    lcd_write_cmd(0x21); // INVON
-#else
-    lcd_write_cmd(0x20); // INVOFF
-#endif
-    lcd_write_cmd(0x11); // SLPOUT
-    sleep_ms(120);
+    critical_section_init(&lcd_perf.lock);
+    gfx_perf_reset(&lcd_perf.render);
+    gfx_perf_reset(&lcd_perf.flush);
+    gfx_perf_init(clock_get_hz(clk_sys));
 
-    lcd_set_addr_window(0, 0, LCD_WIDTH, LCD_HEIGHT);
-    lcd_write_cmd(0x29); // DISPON
+    lcd_dma_init();
+    lcd_pace_start();
+}
 
-    gpio_put(RP2350_GEEK_LCD_BL_PIN, 1);
+// --- Pages ---
+// Pages are display lists, so the same description is drawn into a whole
+// frame or replayed strip by strip.
+static gfx_dlist_t lcd_page_dl;
+
+static void render_text_page(void) {
+    gfx_dlist_t *dl = &lcd_page_dl;
+    uint16_t bg = rgb565(8, 16, 32);
+    gfx_dl_reset(dl);
+    gfx_dl_clear(dl, bg);
+    gfx_dl_text(dl, 8, 10, "RP2350-GEEK", rgb565(255, 215, 64), bg, 2);
+    gfx_dl_label(dl, 8, 34, &sans16, "Bare-metal demo", rgb565(200, 240, 255));
+    gfx_dl_label(dl, 8, 54, &sans16, "I2C/SPI/ADC+LCD", rgb565(180, 255, 200));
+    gfx_dl_label(dl, 8, 74, &sans16, "Send BOOTSEL to flash", rgb565(180, 180, 255));
+    gfx_dl_label(dl, 8, 104, &sans11, "Anti-aliased text: 4-bit 16 px, 2-bit 11 px", rgb565(140, 160, 190));
+    lcd_show(dl, NULL);
 }
 
-static void lcd_flush_framebuffer(void) {
-    lcd_set_addr_window(0, 0, LCD_WIDTH, LCD_HEIGHT);
-    lcd_cs(0);
-    lcd_dc(1);
+// The gradient is laid out over the whole panel; (ox, oy) is where the
+// current view (a strip or damaged area) sits in it.
+static void draw_gradient(int ox, int oy, void *user) {
+    (void)user;
+    gfx_gradient_t g = {
+        .r = gfx_ramp(0, 255, 1, 0, LCD_WIDTH),
+        .g = gfx_ramp(0, 255, 0, 1, LCD_HEIGHT),
+        .b = gfx_ramp(0, 255, 1, 1, LCD_WIDTH + LCD_HEIGHT),
+        .x0 = (int16_t)-ox,
+        .y0 = (int16_t)-oy,
+    };
+    fb_fill_gradient(0, 0, fb_target->width, fb_target->height, &g);
+}
 
-    // Stream the framebuffer in manageable chunks to avoid large stack buffers.
-    const size_t total = LCD_WIDTH * LCD_HEIGHT;
-    uint8_t chunk[256]; // 128 pixels per burst
-    size_t sent = 0;
-    while (sent < total) {
-        size_t px = total - sent;
-        if (px > 128) px = 128;
-        for (size_t i = 0; i < px; i++) {
-            uint16_t c = lcd_fb[sent + i];
-            chunk[2 * i] = (uint8_t)(c >> 8);
-            chunk[2 * i + 1] = (uint8_t)(c & 0xFF);
+static void render_gradient_page(void) {
+    gfx_dlist_t *dl = &lcd_page_dl;
+    gfx_dl_reset(dl);
+    gfx_dl_custom(dl, 0, 0, LCD_WIDTH, LCD_HEIGHT, draw_gradient, NULL);
+    gfx_dl_rect(dl, 12, 12, LCD_WIDTH - 24, LCD_HEIGHT - 24, rgb565(0, 0, 0));
+    gfx_dl_rect(dl, 14, 14, LCD_WIDTH - 28, LCD_HEIGHT - 28, rgb565(255, 255, 255));
+    gfx_dl_text(dl, 20, 18, "Gradient + frame", rgb565(0, 0, 0), rgb565(255, 255, 255), 2);
+    lcd_show(dl, NULL);
+}
+
+static void render_icon_page(void) {
+    gfx_dlist_t *dl = &lcd_page_dl;
+    gfx_dl_reset(dl);
+    gfx_dl_clear(dl, rgb565(12, 12, 18));
+    gfx_dl_text(dl, 12, 12, "Icon demo", rgb565(220, 220, 255), rgb565(12, 12, 18), 2);
+    gfx_dl_sheet(dl, (LCD_WIDTH - HEART_W) / 2, (LCD_HEIGHT - HEART_H) / 2, &heart_sheet, 0, GFX_SHEET_OPAQUE);
+    lcd_show(dl, NULL);
+}
+
+// The pulse loops on gif_timeline while the page is shown (see
+// lcd_page_step()); each step only changes the pulse node, so only its 12x12
+// window is redrawn and sent.
+static struct {
+    gfx_anim_t anim;
+    gfx_dl_op_t *pulse;
+} lcd_gif;
+
+static void render_gif_page(void) {
+    gfx_dlist_t *dl = &lcd_page_dl;
+    gfx_dl_reset(dl);
+    gfx_dl_clear(dl, rgb565(0, 0, 0));
+    gfx_dl_text(dl, 8, 8, "GIF-ish pulse", rgb565(120, 220, 255), rgb565(0, 0, 0), 2);
+    gfx_anim_start(&lcd_gif.anim, gif_timeline, GIF_TIMELINE_STEPS, true);
+    lcd_gif.pulse = gfx_dl_sheet(dl, (LCD_WIDTH - GIF_W) / 2, (LCD_HEIGHT - GIF_H) / 2, &gif_sheet,
+                                 gfx_anim_frame(&lcd_gif.anim), GFX_SHEET_OPAQUE);
+    lcd_show(dl, NULL);
+}
+
+// --- Dashboard page ---
+// A retained page: the labels, background and bar track are drawn once, and
+// every LCD_DASH_UPDATE_MS the values are re-formatted and only the nodes
+// whose text or size changed are redrawn (a few hundred pixels instead of the
+// whole frame).
+#define LCD_DASH_UPDATE_MS 50
+#define LCD_DASH_VALUES 4
+#define LCD_DASH_BAR_W (LCD_WIDTH - 16)
+
+// What the dashboard shows, sent by the status task and the heartbeat on core
+// 0 over lcd_status_chan; the LCD task keeps the latest in lcd_status.
+typedef struct {
+    uint32_t counter;
+    uint16_t adc_raw;
+    uint8_t i2c_devices;
+} lcd_status_t;
+
+static lcd_status_t lcd_status;
+static rt_chan_t lcd_status_chan;
+static lcd_status_t lcd_status_buf[4];
+
+static struct {
+    gfx_dl_op_t *value[LCD_DASH_VALUES];
+    gfx_dl_op_t *bar;
+    gfx_dl_op_t *heart;
+    char text[LCD_DASH_VALUES][24];
+} lcd_dash;
+
+static void lcd_dash_format(int i, char *buf, size_t len) {
+    uint32_t ms = to_ms_since_boot(get_absolute_time());
+    switch (i) {
+        case 0:
+            snprintf(buf, len, "%lu i2c=%u", (unsigned long)lcd_status.counter, lcd_status.i2c_devices);
+            break;
+        case 1: {
+            uint32_t mv = (uint32_t)lcd_status.adc_raw * 3300u / 4095u;
+            snprintf(buf, len, "%lu.%03luV", (unsigned long)(mv / 1000), (unsigned long)(mv % 1000));
+            break;
         }
-        lcd_write_bytes(chunk, px * 2);
-        sent += px;
+        case 2:
+            snprintf(buf, len, "%lu.%02lus", (unsigned long)(ms / 1000), (unsigned long)(ms % 1000 / 10));
+            break;
+        default:
+            snprintf(buf, len, "%lu frames", (unsigned long)lcd_frames_flushed);
+            break;
     }
+}
 
-    lcd_cs(1);
+static int lcd_dash_bar_width(void) {
+    return (int)((uint32_t)lcd_status.adc_raw * LCD_DASH_BAR_W / 4095u);
 }
 
-static inline void fb_set_pixel(int x, int y, uint16_t color) {
-    if ((unsigned)x < LCD_WIDTH && (unsigned)y < LCD_HEIGHT) {
-        lcd_fb[y * LCD_WIDTH + x] = color;
+static void render_dashboard_page(void) {
+    static const char *const labels[LCD_DASH_VALUES] = { "beat", "adc", "up", "lcd" };
+    gfx_dlist_t *dl = &lcd_page_dl;
+    uint16_t bg = rgb565(6, 10, 16);
+    gfx_dl_reset(dl);
+    gfx_dl_clear(dl, bg);
+    gfx_dl_text(dl, 8, 6, "Dashboard", rgb565(120, 220, 255), bg, 2);
+    lcd_dash.heart = gfx_dl_sheet(dl, LCD_WIDTH - 24, 5, &heart_sheet, 0, 0);
+    for (int i = 0; i < LCD_DASH_VALUES; ++i) {
+        int y = 30 + i * 20;
+        lcd_dash_format(i, lcd_dash.text[i], sizeof(lcd_dash.text[i]));
+        gfx_dl_text(dl, 8, y, labels[i], rgb565(140, 160, 190), bg, 2);
+        lcd_dash.value[i] = gfx_dl_text(dl, 68, y, lcd_dash.text[i], rgb565(255, 255, 255), bg, 2);
     }
+    gfx_dl_rect(dl, 8, 116, LCD_DASH_BAR_W, 12, rgb565(30, 40, 60));
+    lcd_dash.bar = gfx_dl_rect(dl, 8, 116, lcd_dash_bar_width(), 12, rgb565(80, 220, 120));
+    lcd_show(dl, NULL);
 }
 
-static void fb_clear(uint16_t color) {
-    for (size_t i = 0; i < LCD_WIDTH * LCD_HEIGHT; ++i) {
-        lcd_fb[i] = color;
+static void lcd_dash_update(void) {
+    gfx_dlist_t *dl = &lcd_page_dl;
+    for (int i = 0; i < LCD_DASH_VALUES; ++i) {
+        char buf[sizeof(lcd_dash.text[i])];
+        lcd_dash_format(i, buf, sizeof(buf));
+        if (strcmp(buf, lcd_dash.text[i]) != 0) {
+            memcpy(lcd_dash.text[i], buf, sizeof(buf));
+            gfx_dl_set_text(dl, lcd_dash.value[i], lcd_dash.text[i]);
+        }
     }
+    gfx_dl_set_rect(dl, lcd_dash.bar, 8, 116, lcd_dash_bar_width(), 12);
+    gfx_dl_set_visible(dl, lcd_dash.heart, (to_ms_since_boot(get_absolute_time()) / 500) & 1);
+    lcd_update(dl);
 }
 
-static void fb_draw_rect(int x, int y, int w, int h, uint16_t color) {
-    for (int iy = 0; iy < h; ++iy) {
-        int yy = y + iy;
-        if (yy < 0 || yy >= LCD_HEIGHT) continue;
-        for (int ix = 0; ix < w; ++ix) {
-            int xx = x + ix;
-            if (xx < 0 || xx >= LCD_WIDTH) continue;
-            fb_set_pixel(xx, yy, color);
+// --- Console ---
+// stdout is mirrored onto the console page: a stdio driver queues what is
+// printed and the rendering core draws it into its own framebuffer, used as a
+// ring of text lines, so a new line costs one line of text plus one cleared
+// line on the wire, and the panel's vertical scroll does the rest. The
+// controller scrolls along frame-memory lines, which with MV set (the
+// landscape addressing of the other pages) would be across the screen, so the
+// console page clears MV and reads in portrait, 22 columns by 30 lines.
+#if LCD_CONSOLE
+static const st7789_config_t lcd_console_panel = {
+    .width = LCD_HEIGHT,
+    .height = LCD_WIDTH,
+    .x_offset = LCD_Y_OFFSET,
+    .y_offset = LCD_X_OFFSET,
+    .madctl = LCD_MADCTL & ~ST7789_MADCTL_MV,
+    .invert = LCD_INVERT_DISPLAY,
+};
+
+// Waits until the panel has every presented frame and no flush is queued, so
+// the bus can be driven directly.
+static void lcd_display_idle(void) {
+#if LCD_DOUBLE_BUFFER
+    while (lcd_frames_flushed != lcd_frames_presented) {
+        tight_loop_contents();
+    }
+#else
+    while (lcd_pacer.ready) {
+        __wfe();
+    }
+    lcd_flush_wait();
+#endif
+}
+
+static gfx_pixel_t lcd_console_pixels[GFX_FB_LEN(LCD_HEIGHT, LCD_WIDTH)];
+
+static struct {
+    gfx_fb_t fb;
+    gfx_console_t con;
+    bool shown; // the panel is in console (portrait, scrolled) mode
+    // Printed but not yet drawn. Only the stdio driver (serialised by the
+    // stdio mutex) moves head and only the rendering core moves tail.
+    char fifo[LCD_CONSOLE_FIFO];
+    volatile uint16_t head, tail;
+    volatile bool drawing; // the rendering core is in lcd_console_drain()
+} lcd_console;
+
+static void lcd_console_out_chars(const char *buf, int len) {
+#if LCD_SNAP
+    if (lcd_snap.active) {
+        return; // the snapshot's lines, and whatever else is printed meanwhile
+    }
+#endif
+    uint16_t head = lcd_console.head;
+    for (int i = 0; i < len; ++i) {
+        uint16_t next = (uint16_t)((head + 1) % LCD_CONSOLE_FIFO);
+        if (next == lcd_console.tail) {
+            break; // full: the rest is lost to the console, not to the other outputs
         }
+        lcd_console.fifo[head] = buf[i];
+        head = next;
     }
+    __dmb(); // the characters before the index that publishes them
+    lcd_console.head = head;
 }
 
-// 5x7 ASCII font (public-domain style), columns LSB->MSB for rows.
-static const uint8_t font5x7[96][5] = {
-    {0x00,0x00,0x00,0x00,0x00}, {0x00,0x00,0x5F,0x00,0x00}, {0x00,0x07,0x00,0x07,0x00}, {0x14,0x7F,0x14,0x7F,0x14}, {0x24,0x2A,0x7F,0x2A,0x12}, {0x23,0x13,0x08,0x64,0x62}, {0x36,0x49,0x55,0x22,0x50}, {0x00,0x05,0x03,0x00,0x00}, {0x00,0x1C,0x22,0x41,0x00}, {0x00,0x41,0x22,0x1C,0x00}, {0x14,0x08,0x3E,0x08,0x14}, {0x08,0x08,0x3E,0x08,0x08}, {0x00,0x50,0x30,0x00,0x00}, {0x08,0x08,0x08,0x08,0x08}, {0x00,0x60,0x60,0x00,0x00}, {0x20,0x10,0x08,0x04,0x02},
-    {0x3E,0x51,0x49,0x45,0x3E}, {0x00,0x42,0x7F,0x40,0x00}, {0x72,0x49,0x49,0x49,0x46}, {0x21,0x41,0x49,0x4D,0x33}, {0x18,0x14,0x12,0x7F,0x10}, {0x27,0x45,0x45,0x45,0x39}, {0x3C,0x4A,0x49,0x49,0x31}, {0x41,0x21,0x11,0x09,0x07}, {0x36,0x49,0x49,0x49,0x36}, {0x46,0x49,0x49,0x29,0x1E}, {0x00,0x36,0x36,0x00,0x00}, {0x00,0x56,0x36,0x00,0x00}, {0x08,0x14,0x22,0x41,0x00}, {0x14,0x14,0x14,0x14,0x14}, {0x00,0x41,0x22,0x14,0x08}, {0x02,0x01,0x59,0x09,0x06},
-    {0x3E,0x41,0x5D,0x59,0x4E}, {0x7C,0x12,0x11,0x12,0x7C}, {0x7F,0x49,0x49,0x49,0x36}, {0x3E,0x41,0x41,0x41,0x22}, {0x7F,0x41,0x41,0x22,0x1C}, {0x7F,0x49,0x49,0x49,0x41}, {0x7F,0x09,0x09,0x09,0x01}, {0x3E,0x41,0x49,0x49,0x7A}, {0x7F,0x08,0x08,0x08,0x7F}, {0x00,0x41,0x7F,0x41,0x00}, {0x20,0x40,0x41,0x3F,0x01}, {0x7F,0x08,0x14,0x22,0x41}, {0x7F,0x40,0x40,0x40,0x40}, {0x7F,0x02,0x0C,0x02,0x7F}, {0x7F,0x04,0x08,0x10,0x7F}, {0x3E,0x41,0x41,0x41,0x3E}, {0x7F,0x09,0x09,0x09,0x06},
-    {0x3E,0x41,0x51,0x21,0x5E}, {0x7F,0x09,0x19,0x29,0x46}, {0x46,0x49,0x49,0x49,0x31}, {0x01,0x01,0x7F,0x01,0x01}, {0x3F,0x40,0x40,0x40,0x3F}, {0x1F,0x20,0x40,0x20,0x1F}, {0x3F,0x40,0x38,0x40,0x3F}, {0x63,0x14,0x08,0x14,0x63}, {0x07,0x08,0x70,0x08,0x07}, {0x61,0x51,0x49,0x45,0x43}, {0x00,0x7F,0x41,0x41,0x00}, {0x02,0x04,0x08,0x10,0x20}, {0x00,0x41,0x41,0x7F,0x00}, {0x04,0x02,0x01,0x02,0x04}, {0x40,0x40,0x40,0x40,0x40}, {0x00,0x01,0x02,0x04,0x00}, {0x20,0x54,0x54,0x54,0x78},
-    {0x7F,0x48,0x44,0x44,0x38}, {0x38,0x44,0x44,0x44,0x20}, {0x38,0x44,0x44,0x48,0x7F}, {0x38,0x54,0x54,0x54,0x18}, {0x08,0x7E,0x09,0x01,0x02}, {0x0C,0x52,0x52,0x52,0x3E}, {0x7F,0x08,0x04,0x04,0x78}, {0x00,0x44,0x7D,0x40,0x00}, {0x20,0x40,0x44,0x3D,0x00}, {0x7F,0x10,0x28,0x44,0x00}, {0x00,0x41,0x7F,0x40,0x00}, {0x7C,0x04,0x18,0x04,0x78}, {0x7C,0x08,0x04,0x04,0x78}, {0x38,0x44,0x44,0x44,0x38}, {0x7C,0x14,0x14,0x14,0x08}, {0x08,0x14,0x14,0x18,0x7C}, {0x7C,0x08,0x04,0x04,0x08},
-    {0x48,0x54,0x54,0x54,0x20}, {0x04,0x3F,0x44,0x40,0x20}, {0x3C,0x40,0x40,0x20,0x7C}, {0x1C,0x20,0x40,0x20,0x1C}, {0x3C,0x40,0x30,0x40,0x3C}, {0x44,0x28,0x10,0x28,0x44}, {0x0C,0x50,0x50,0x50,0x3C}, {0x44,0x64,0x54,0x4C,0x44}, {0x00,0x08,0x36,0x41,0x00}, {0x00,0x00,0x7F,0x00,0x00}, {0x00,0x41,0x36,0x08,0x00}, {0x10,0x08,0x08,0x10,0x08}, {0x78,0x46,0x41,0x46,0x78}
+static stdio_driver_t lcd_console_stdio = {
+    .out_chars = lcd_console_out_chars,
 };
 
-static void fb_draw_char(int x, int y, char c, uint16_t fg, uint16_t bg) {
-    if (c < 32 || c > 127) c = '?';
-    const uint8_t *glyph = font5x7[c - 32];
-    for (int row = 0; row < 7; ++row) {
-        for (int col = 0; col < 5; ++col) {
-            bool on = (glyph[col] >> row) & 0x01;
-            fb_set_pixel(x + col, y + row, on ? fg : bg);
-        }
-        fb_set_pixel(x + 5, y + row, bg); // 1px spacing
+static void lcd_console_init(void) {
+    gfx_fb_init(&lcd_console.fb, lcd_console_pixels, LCD_HEIGHT, LCD_WIDTH);
+    gfx_console_init(&lcd_console.con, &lcd_console.fb, rgb565(140, 230, 140), rgb565(8, 16, 12));
+    stdio_set_driver_enabled(&lcd_console_stdio, true);
+}
+
+// Rendering core: draws what has been printed since the last call, unless a
+// snapshot is reading the console.
+static void lcd_console_drain(void) {
+    lcd_console.drawing = true;
+    __dmb(); // against lcd_snap_start(): flag first, then check
+#if LCD_SNAP
+    if (lcd_snap.active) {
+        lcd_console.drawing = false;
+        return;
     }
+#endif
+    uint16_t tail = lcd_console.tail, head = lcd_console.head;
+    __dmb();
+    if (head < tail) {
+        gfx_console_write(&lcd_console.con, &lcd_console.fifo[tail], LCD_CONSOLE_FIFO - tail);
+        tail = 0;
+    }
+    gfx_console_write(&lcd_console.con, &lcd_console.fifo[tail], head - tail);
+    __dmb();
+    lcd_console.tail = head;
+    lcd_console.drawing = false;
 }
 
-static void fb_draw_text(int x, int y, const char *text, uint16_t fg, uint16_t bg) {
-    int cursor_x = x;
-    while (*text) {
-        if (*text == '\n') {
-            y += 8;
-            cursor_x = x;
-            text++;
-            continue;
-        }
-        fb_draw_char(cursor_x, y, *text, fg, bg);
-        cursor_x += 6;
-        text++;
+// Sends the changed lines and scrolls the oldest one to the top. The flush is
+// blocking and reported like a page flush.
+static void lcd_console_present(void) {
+    uint32_t start = gfx_perf_now();
+    uint32_t px = (uint32_t)st7789_flush_dirty(&lcd_bus, &lcd_console_panel, &lcd_console.fb);
+    st7789_scroll_to(&lcd_bus, &lcd_console_panel, gfx_console_scroll_row(&lcd_console.con));
+    uint32_t ticks = gfx_perf_now() - start;
+    lcd_dma.last_flush_us = gfx_perf_us(ticks);
+    lcd_dma.last_flush_px = px;
+    if (px) {
+        lcd_perf_add(&lcd_perf.flush, ticks, px * 2);
     }
 }
 
-static void fb_draw_char_2x(int x, int y, char c, uint16_t fg, uint16_t bg) {
-    if (c < 32 || c > 127) c = '?';
-    const uint8_t *glyph = font5x7[c - 32];
-    for (int row = 0; row < 7; ++row) {
-        for (int col = 0; col < 5; ++col) {
-            bool on = (glyph[col] >> row) & 0x01;
-            uint16_t color = on ? fg : bg;
-            fb_draw_rect(x + col * 2, y + row * 2, 2, 2, color);
-        }
-        fb_draw_rect(x + 10, y + row * 2, 2, 2, bg); // spacing column at 2x
+static void render_console_page(void) {
+    lcd_display_idle();
+    lcd_console_drain();
+    gfx_fb_t *prev = fb_target;
+    fb_bind(&lcd_console.fb);
+    fb_mark_all_dirty();
+    fb_bind(prev);
+    st7789_scroll_begin(&lcd_bus, &lcd_console_panel);
+    lcd_console.shown = true;
+    lcd_console_present();
+}
+
+// Puts the panel back into landscape before another page is drawn; the page
+// overwrites the whole screen.
+static void lcd_console_leave(void) {
+    if (lcd_console.shown) {
+        st7789_scroll_end(&lcd_bus, &lcd_panel);
+        lcd_console.shown = false;
     }
 }
+#endif
 
-static void fb_draw_text_2x(int x, int y, const char *text, uint16_t fg, uint16_t bg) {
-    int cursor_x = x;
-    while (*text) {
-        if (*text == '\n') {
-            y += 16;
-            cursor_x = x;
-            text++;
-            continue;
-        }
-        fb_draw_char_2x(cursor_x, y, *text, fg, bg);
-        cursor_x += 12;
-        text++;
+#if LCD_SNAP
+// Core 0: starts streaming what the panel shows, the console or the last
+// frame flushed.
+static void lcd_snap_start(void) {
+    if (lcd_snap.active) {
+        return;
+    }
+    lcd_snap.active = true;
+    __dmb(); // stops new frames and console drawing before the frame is chosen
+    const gfx_fb_t *fb = NULL;
+    int first_row = 0;
+    const char *page = "frame";
+#if LCD_CONSOLE
+    while (lcd_console.drawing) {
+        tight_loop_contents();
+    }
+    if (lcd_console.shown) {
+        fb = &lcd_console.fb;
+        first_row = gfx_console_scroll_row(&lcd_console.con);
+        page = "console";
+    }
+#endif
+    if (!fb) {
+#if LCD_DOUBLE_BUFFER
+        int8_t front = lcd_swap.front;
+        fb = front >= 0 ? &lcd_frames[front] : NULL;
+#else
+        fb = &lcd_frames[0];
+#endif
+    }
+    if (!fb) {
+        lcd_snap.active = false;
+        printf("SCREENSHOT: nothing shown yet\n");
+        return;
+    }
+    gfx_snap_begin(&lcd_snap.snap, fb, first_row);
+    lcd_snap.id++;
+    lcd_snap.seq = 0;
+    printf("@snap begin %lu %d %d %s\n", (unsigned long)lcd_snap.id, fb->width, fb->height, page);
+}
+#endif
+
+// --- Live pages ---
+// Advances a live page by elapsed_ms, presenting whatever changed; returns
+// the ms until it next needs a step (UINT32_MAX for a static page).
+static uint32_t lcd_page_step(lcd_page_t page, uint32_t elapsed_ms) {
+    switch (page) {
+        case LCD_PAGE_GIF:
+            if (gfx_anim_advance(&lcd_gif.anim, elapsed_ms)) {
+                gfx_dl_set_frame(&lcd_page_dl, lcd_gif.pulse, gfx_anim_frame(&lcd_gif.anim));
+                lcd_update(&lcd_page_dl);
+            }
+            return gfx_anim_next_ms(&lcd_gif.anim);
+        case LCD_PAGE_DASHBOARD:
+            if (elapsed_ms) {
+                lcd_dash_update();
+            }
+            return LCD_DASH_UPDATE_MS;
+#if LCD_CONSOLE
+        case LCD_PAGE_CONSOLE:
+            if (elapsed_ms) {
+                lcd_console_drain();
+                lcd_console_present();
+            }
+            return LCD_CONSOLE_POLL_MS;
+#endif
+        default:
+            return UINT32_MAX;
+    }
+}
+
+// Renders and presents one page; returns the page to show next.
+static lcd_page_t lcd_render_page(lcd_page_t page) {
+#if LCD_CONSOLE
+    lcd_console_leave();
+#endif
+    switch (page) {
+        case LCD_PAGE_TEXT:
+            render_text_page();
+            return LCD_PAGE_GRAPHIC;
+        case LCD_PAGE_GRAPHIC:
+            render_gradient_page();
+            return LCD_PAGE_ICON;
+        case LCD_PAGE_ICON:
+            render_icon_page();
+            return LCD_PAGE_GIF;
+        case LCD_PAGE_GIF:
+            render_gif_page();
+            return LCD_PAGE_DASHBOARD;
+        case LCD_PAGE_DASHBOARD:
+            render_dashboard_page();
+#if LCD_CONSOLE
+            return LCD_PAGE_CONSOLE;
+        case LCD_PAGE_CONSOLE:
+            render_console_page();
+#endif
+            return LCD_PAGE_TEXT;
+        default:
+            return LCD_PAGE_TEXT;
     }
 }
 
-static void fb_draw_icon16(int x, int y, const uint8_t *pixels, const uint16_t *palette) {
-    for (int iy = 0; iy < 16; ++iy) {
-        for (int ix = 0; ix < 16; ++ix) {
-            uint8_t idx = pixels[iy * 16 + ix];
-            fb_set_pixel(x + ix, y + iy, palette[idx]);
+// The page cycle is a task: LCD_EV_PAGE every HEARTBEAT_MS renders the next
+// page, and a one-shot timer set for a live page's next change steps it
+// (LCD_EV_STEP). Each step is given the real time elapsed, so a late one
+// skips frames instead of stretching the timeline. It runs in whichever
+// scheduler renders: core1_sched with LCD_DOUBLE_BUFFER, otherwise app_sched.
+// A snapshot holds it back until the snapshot task posts LCD_EV_RESUME: the
+// single framebuffer is being read, and with double buffering the front one
+// is, so a presented frame would only wait for it with the rest of core 1's
+// tasks stalled behind it. New status arrives as LCD_EV_STATUS.
+#define LCD_EV_PAGE 1u
+#define LCD_EV_STEP 2u
+#define LCD_EV_RESUME 4u
+#define LCD_EV_STATUS 8u
+
+static struct {
+    rt_task_t task;
+    rt_timer_t page_timer, step_timer;
+    lcd_page_t next;   // rendered by the next LCD_EV_PAGE
+    uint64_t last_us;  // time_us_64() the shown page's timeline has reached
+    uint32_t deferred; // events held back by a snapshot
+} lcd_pages;
+
+static void lcd_task_run(rt_task_t *task, uint32_t events) {
+    (void)task;
+    if (events & LCD_EV_STATUS) {
+        while (rt_chan_recv(&lcd_status_chan, &lcd_status)) {
         }
     }
+#if LCD_SNAP
+    if (lcd_snap.active) {
+        lcd_pages.deferred |= events & ~(LCD_EV_RESUME | LCD_EV_STATUS);
+        return;
+    }
+    events |= lcd_pages.deferred;
+    lcd_pages.deferred = 0;
+#endif
+    uint32_t next;
+    if (events & LCD_EV_PAGE) {
+        lcd_page_t page = lcd_pages.next;
+        lcd_shown_page = page;
+        lcd_pages.next = lcd_render_page(page);
+        lcd_pages.last_us = time_us_64();
+        next = lcd_page_step(page, 0);
+    } else if (events & LCD_EV_STEP) {
+        // Whole milliseconds only; the remainder counts towards the next step.
+        uint32_t elapsed_ms = (uint32_t)((time_us_64() - lcd_pages.last_us) / 1000u);
+        lcd_pages.last_us += (uint64_t)elapsed_ms * 1000u;
+        next = lcd_page_step(lcd_shown_page, elapsed_ms);
+    } else {
+        return;
+    }
+    if (next == UINT32_MAX) {
+        rt_timer_stop(&lcd_pages.step_timer);
+    } else {
+        rt_timer_start(&lcd_pages.step_timer, lcd_pages.last_us + (uint64_t)next * 1000u, 0);
+    }
 }
 
-static void render_text_page(void) {
-    uint16_t bg = rgb565(8, 16, 32);
-    fb_clear(bg);
-    fb_draw_text_2x(8, 10, "RP2350-GEEK", rgb565(255, 215, 64), bg);
-    fb_draw_text_2x(8, 34, "Bare-metal demo", rgb565(200, 240, 255), bg);
-    fb_draw_text_2x(8, 58, "I2C/SPI/ADC+LCD", rgb565(180, 255, 200), bg);
-    fb_draw_text_2x(8, 82, "Send BOOTSEL to flash", rgb565(180, 180, 255), bg);
+static void lcd_task_start(rt_sched_t *s, uint8_t core) {
+    lcd_pages.task = (rt_task_t){ .name = "lcd", .prio = TASK_PRIO_LCD, .run = lcd_task_run };
+    lcd_pages.next = LCD_PAGE_TEXT;
+    rt_sched_add(s, &lcd_pages.task);
+    rt_chan_init(&lcd_status_chan, lcd_status_buf, sizeof(lcd_status_t), 4, core);
+    lcd_status_chan.name = "lcd_status";
+    lcd_status_chan.task = &lcd_pages.task;
+    lcd_status_chan.event = LCD_EV_STATUS;
+    rt_bus_add(&app_bus, &lcd_status_chan);
+    rt_timer_init(&lcd_pages.page_timer, &lcd_pages.task, LCD_EV_PAGE);
+    rt_timer_init(&lcd_pages.step_timer, &lcd_pages.task, LCD_EV_STEP);
+    rt_timer_start(&lcd_pages.page_timer, time_us_64(), HEARTBEAT_MS * 1000u);
 }
 
-static void render_gradient_page(void) {
-    for (int y = 0; y < LCD_HEIGHT; ++y) {
-        for (int x = 0; x < LCD_WIDTH; ++x) {
-            uint8_t r = (uint8_t)((x * 255) / LCD_WIDTH);
-            uint8_t g = (uint8_t)((y * 255) / LCD_HEIGHT);
-            uint8_t b = (uint8_t)(((x + y) * 255) / (LCD_WIDTH + LCD_HEIGHT));
-            lcd_fb[y * LCD_WIDTH + x] = rgb565(r, g, b);
+#if LCD_SNAP
+// Streams the snapshot in progress, LCD_SNAP_LINES lines every
+// LCD_SNAP_POLL_MS.
+static struct {
+    rt_task_t task;
+    rt_timer_t timer;
+} lcd_snap_pump_task;
+
+static void lcd_snap_task_run(rt_task_t *task, uint32_t events) {
+    (void)task;
+    (void)events;
+    if (lcd_snap_pump()) {
+        rt_timer_start(&lcd_snap_pump_task.timer, time_us_64() + LCD_SNAP_POLL_MS * 1000u, 0);
+        return;
+    }
+    rt_task_post(&lcd_pages.task, LCD_EV_RESUME);
+}
+
+static void lcd_snap_task_start(void) {
+    lcd_snap_pump_task.task = (rt_task_t){ .name = "snap", .prio = TASK_PRIO_IO, .run = lcd_snap_task_run };
+    rt_sched_add(&app_sched, &lcd_snap_pump_task.task);
+    rt_timer_init(&lcd_snap_pump_task.timer, &lcd_snap_pump_task.task, 1u);
+}
+#endif
+
+// --- Sensors ---
+// Core 1 drains the ADC stream every ADC_DRAIN_MS, queues the SPI loopback
+// once per heartbeat, and runs the SPI sweep when asked. It sends the
+// readings over sensors.chan to the status task on core 0: the test pin's
+// filtered value every ADC_SAMPLE_MS (the dashboard shows it live), once per
+// heartbeat each ADC channel's statistics, the loopback result when its
+// transfer is done, and each row of the sweep as it finishes. The status
+// task keeps the latest, logs the sweep and sends the dashboard's share on
+// to the rendering core.
+#define SENSOR_EV_START 1u
+#define SENSOR_EV_DRAIN 2u
+#define SENSOR_EV_ADC 4u
+#define SENSOR_EV_BEAT 8u
+#define SENSOR_EV_SPI_LOOP 16u  // the loopback transfer finished
+#define SENSOR_EV_SPI_ROW 32u   // a row of the sweep finished
+#define SENSOR_EV_SPI_SWEEP 64u // start a sweep
+
+typedef enum {
+    SENSOR_ADC,
+    SENSOR_ADC_STATS,
+    SENSOR_ADC_FAULTS,
+    SENSOR_SPI_LOOP,
+    SENSOR_SPI_ROW,
+} sensor_kind_t;
+
+typedef struct {
+    uint8_t kind; // sensor_kind_t
+    union {
+        uint16_t value; // SENSOR_ADC: test pin in LSB; SENSOR_SPI_LOOP: passed
+        struct {
+            uint8_t channel;
+            rt_adc_summary_t summary;
+        } adc_stats;
+        struct {
+            uint32_t overruns, errors;
+        } adc_faults;
+        rt_spi_bench_row_t spi_row;
+    };
+} sensor_msg_t;
+
+static struct {
+    rt_task_t task;
+    rt_timer_t drain_timer, adc_timer, beat_timer;
+    rt_chan_t chan;
+    sensor_msg_t buf[16]; // a heartbeat's worth
+} sensors;
+
+// The loopback and the sweep share the chip select but not the clock, so
+// the engine switches between them when their transfers interleave.
+static const uint8_t spi_loop_pattern[] = { 0xAA, 0x55, 0xF0, 0x0F, 0x12, 0x34 };
+static const uint32_t spi_bench_rates[] = { 1000000, 8000000, 25000000, 50000000, 75000000 };
+static const uint16_t spi_bench_sizes[] = { 16, 256, SPI_BENCH_MAX_LEN };
+#define SPI_BENCH_RATES (sizeof(spi_bench_rates) / sizeof(spi_bench_rates[0]))
+#define SPI_BENCH_SIZES (sizeof(spi_bench_sizes) / sizeof(spi_bench_sizes[0]))
+
+static struct {
+    rt_spi_dev_t dev;
+    rt_spi_xfer_t x;
+    uint8_t rx[sizeof(spi_loop_pattern)];
+} spi_loop;
+
+static struct {
+    rt_spi_bench_t bench;
+    uint8_t buf[4 * SPI_BENCH_MAX_LEN];
+    rt_spi_bench_row_t rows[SPI_BENCH_RATES * SPI_BENCH_SIZES];
+    uint16_t sent; // rows passed on to the status task
+} spi_sweep;
+
+// Both run in the DMA interrupt and leave the rest to the task.
+static void spi_loop_done(rt_spi_xfer_t *x) {
+    (void)x;
+    rt_task_post(&sensors.task, SENSOR_EV_SPI_LOOP);
+}
+
+static void spi_sweep_row_done(rt_spi_bench_t *b, uint16_t row) {
+    (void)b;
+    (void)row;
+    rt_task_post(&sensors.task, SENSOR_EV_SPI_ROW);
+}
+
+static void spi_sweep_start(void) {
+    irq_set_enabled(DMA_IRQ_1, false);
+    bool started = rt_spi_bench_start(&spi_sweep.bench, time_us_64());
+    irq_set_enabled(DMA_IRQ_1, true);
+    if (started) {
+        spi_sweep.sent = 0;
+    }
+}
+
+// Rows that do not fit in the channel go with the next row or heartbeat.
+static void spi_sweep_send(void) {
+    while (spi_sweep.sent < spi_sweep.bench.rows_done) {
+        sensor_msg_t msg = { .kind = SENSOR_SPI_ROW };
+        msg.spi_row = spi_sweep.rows[spi_sweep.sent];
+        if (!rt_chan_send(&sensors.chan, &msg)) {
+            break;
         }
+        spi_sweep.sent++;
     }
-    fb_draw_rect(12, 12, LCD_WIDTH - 24, LCD_HEIGHT - 24, rgb565(0, 0, 0));
-    fb_draw_rect(14, 14, LCD_WIDTH - 28, LCD_HEIGHT - 28, rgb565(255, 255, 255));
-    fb_draw_text_2x(20, 18, "Gradient + frame", rgb565(0, 0, 0), rgb565(255, 255, 255));
-}
-
-static const uint8_t heart_icon[16 * 16] = {
-    0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,
-    0,0,1,1,0,0,0,0,0,0,1,1,0,0,0,0,
-    0,1,2,2,1,0,0,0,0,1,2,2,1,0,0,0,
-    1,2,3,3,2,1,0,0,1,2,3,3,2,1,0,0,
-    1,3,3,3,3,2,1,1,2,3,3,3,3,2,1,0,
-    1,3,3,3,3,3,2,2,3,3,3,3,3,2,1,0,
-    0,2,3,3,3,3,3,3,3,3,3,3,2,2,0,0,
-    0,1,2,3,3,3,3,3,3,3,3,2,1,0,0,0,
-    0,0,1,2,3,3,3,3,3,3,2,1,0,0,0,0,
-    0,0,0,1,2,3,3,3,3,2,1,0,0,0,0,0,
-    0,0,0,0,1,2,3,3,2,1,0,0,0,0,0,0,
-    0,0,0,0,0,1,2,2,1,0,0,0,0,0,0,0,
-    0,0,0,0,0,0,1,1,0,0,0,0,0,0,0,0,
-    0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,
-    0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,
-    0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,
-};
+}
 
-static const uint16_t heart_palette[4] = {
-        RGB565_CONST(10, 10, 20),
-        RGB565_CONST(255, 120, 120),
-        RGB565_CONST(255, 70, 70),
-        RGB565_CONST(200, 20, 20),
-};
+static void sensor_task_run(rt_task_t *task, uint32_t events) {
+    (void)task;
+    if (events & SENSOR_EV_START) {
+        adc_stream_start();
+        spi_irq_enable();
+#if SPI_BENCH_BOOT
+        spi_sweep_start();
+#endif
+    }
+    if (events & SENSOR_EV_DRAIN) {
+        adc_stream_drain();
+    }
+    if (events & SENSOR_EV_ADC) {
+        sensor_msg_t msg = { .kind = SENSOR_ADC, .value = (uint16_t)((adc_stream.acq.ch[ADC_PIN_CHANNEL].out + 8u) / 16u) };
+        rt_chan_send(&sensors.chan, &msg);
+    }
+    if (events & SENSOR_EV_BEAT) {
+        if (spi_loop.x.status != RT_SPI_PENDING) {
+            memset(spi_loop.rx, 0, sizeof(spi_loop.rx));
+            spi_submit(&spi_loop.x);
+        }
+        sensor_msg_t msg;
+        for (int i = 0; i < adc_stream.acq.seq_len; ++i) {
+            msg = (sensor_msg_t){ .kind = SENSOR_ADC_STATS };
+            msg.adc_stats.channel = adc_stream.acq.seq[i];
+            rt_adc_acq_take(&adc_stream.acq, msg.adc_stats.channel, &msg.adc_stats.summary);
+            rt_chan_send(&sensors.chan, &msg);
+        }
+        msg = (sensor_msg_t){ .kind = SENSOR_ADC_FAULTS };
+        msg.adc_faults.overruns = adc_stream.ring.overruns;
+        msg.adc_faults.errors = adc_stream.acq.errors;
+        rt_chan_send(&sensors.chan, &msg);
+    }
+    if (events & SENSOR_EV_SPI_LOOP) {
+        bool passed = spi_loop.x.status == RT_SPI_OK && memcmp(spi_loop.rx, spi_loop_pattern, sizeof(spi_loop.rx)) == 0;
+        sensor_msg_t msg = { .kind = SENSOR_SPI_LOOP, .value = passed };
+        rt_chan_send(&sensors.chan, &msg);
+    }
+    if (events & (SENSOR_EV_SPI_ROW | SENSOR_EV_BEAT)) {
+        spi_sweep_send();
+    }
+    if (events & SENSOR_EV_SPI_SWEEP) {
+        spi_sweep_start();
+    }
+}
 
-static void render_icon_page(void) {
-    fb_clear(rgb565(12, 12, 18));
-    fb_draw_text_2x(12, 12, "Icon demo", rgb565(220, 220, 255), rgb565(12, 12, 18));
-    fb_draw_icon16((LCD_WIDTH - 16) / 2, (LCD_HEIGHT - 16) / 2, heart_icon, heart_palette);
+// Core 0: the latest readings, the heartbeat's counter and the I2C count.
+static struct {
+    rt_task_t task;
+    lcd_status_t lcd; // as last sent to the rendering core
+    bool spi_ok;
+    rt_adc_summary_t adc[RT_ADC_CHANNELS]; // of the last heartbeat period
+    uint32_t adc_overruns, adc_errors;     // since boot
+} app_status;
+
+// A full channel already holds news for the LCD task; the next send catches up.
+static void status_publish(void) {
+    rt_chan_send(&lcd_status_chan, &app_status.lcd);
 }
 
-static const uint16_t gif_palette[3] = {
-        RGB565_CONST(0, 0, 0),
-        RGB565_CONST(80, 220, 255),
-        RGB565_CONST(255, 255, 255),
-};
+// One row of the SPI sweep: the clock the controller gave, the transfer size
+// and count, the throughput and its share of the line rate, and what the
+// loopback got wrong.
+static void spi_row_log(const rt_spi_bench_row_t *r) {
+    uint32_t kbps = rt_spi_bench_kbps(r);
+    uint32_t eff = rt_spi_bench_efficiency(r);
+    printf("[spi bench] clk=%lukHz len=%u xfers=%lu %lu.%03luMB/s (%lu.%lu%% of line rate) bit_errors=%lu failed=%lu\n",
+           (unsigned long)(r->hz / 1000u), (unsigned)r->len, (unsigned long)r->xfers, (unsigned long)(kbps / 1000u),
+           (unsigned long)(kbps % 1000u), (unsigned long)(eff / 10u), (unsigned long)(eff % 10u),
+           (unsigned long)r->bit_errors, (unsigned long)r->failed);
+}
+
+static void status_task_run(rt_task_t *task, uint32_t events) {
+    (void)task;
+    (void)events;
+    sensor_msg_t msg;
+    bool adc = false;
+    while (rt_chan_recv(&sensors.chan, &msg)) {
+        switch (msg.kind) {
+            case SENSOR_ADC:
+                app_status.lcd.adc_raw = msg.value;
+                adc = true;
+                break;
+            case SENSOR_ADC_STATS:
+                app_status.adc[msg.adc_stats.channel] = msg.adc_stats.summary;
+                break;
+            case SENSOR_ADC_FAULTS:
+                app_status.adc_overruns = msg.adc_faults.overruns;
+                app_status.adc_errors = msg.adc_faults.errors;
+                break;
+            case SENSOR_SPI_ROW:
+                spi_row_log(&msg.spi_row);
+                break;
+            default:
+                app_status.spi_ok = msg.value != 0;
+                break;
+        }
+    }
+    if (adc) {
+        status_publish();
+    }
+}
 
-static const uint8_t gif_frames[3][12 * 12] = {
-    { // frame 0: small dot
-        0,0,0,0,0,0,0,0,0,0,0,0,
-        0,0,0,0,0,0,0,0,0,0,0,0,
-        0,0,0,0,0,0,0,0,0,0,0,0,
-        0,0,0,0,1,1,1,0,0,0,0,0,
-        0,0,0,0,1,2,1,0,0,0,0,0,
-        0,0,0,0,1,1,1,0,0,0,0,0,
-        0,0,0,0,0,0,0,0,0,0,0,0,
-        0,0,0,0,0,0,0,0,0,0,0,0,
-        0,0,0,0,0,0,0,0,0,0,0,0,
-        0,0,0,0,0,0,0,0,0,0,0,0,
-        0,0,0,0,0,0,0,0,0,0,0,0,
-        0,0,0,0,0,0,0,0,0,0,0,0,
-    },
-    { // frame 1: medium ring
-        0,0,0,0,0,0,0,0,0,0,0,0,
-        0,0,0,1,1,1,1,1,1,0,0,0,
-        0,0,1,2,2,2,2,2,2,1,0,0,
-        0,1,2,1,1,1,1,1,1,2,1,0,
-        0,1,2,1,0,0,0,0,1,2,1,0,
-        0,1,2,1,0,0,0,0,1,2,1,0,
-        0,1,2,1,0,0,0,0,1,2,1,0,
-        0,1,2,1,1,1,1,1,1,2,1,0,
-        0,0,1,2,2,2,2,2,2,1,0,0,
-        0,0,0,1,1,1,1,1,1,0,0,0,
-        0,0,0,0,0,0,0,0,0,0,0,0,
-        0,0,0,0,0,0,0,0,0,0,0,0,
-    },
-    { // frame 2: large ring
-        0,0,1,1,1,1,1,1,1,1,1,0,
-        0,1,2,2,2,2,2,2,2,2,2,1,
-        1,2,1,1,1,1,1,1,1,1,1,2,
-        1,2,1,0,0,0,0,0,0,0,1,2,
-        1,2,1,0,0,0,0,0,0,0,1,2,
-        1,2,1,0,0,0,0,0,0,0,1,2,
-        1,2,1,0,0,0,0,0,0,0,1,2,
-        1,2,1,0,0,0,0,0,0,0,1,2,
-        1,2,1,0,0,0,0,0,0,0,1,2,
-        1,2,1,1,1,1,1,1,1,1,1,2,
-        0,1,2,2,2,2,2,2,2,2,2,1,
-        0,0,1,1,1,1,1,1,1,1,1,0,
+// The sensor task runs on core 1 and reports to the status task on core 0.
+static void sensor_task_start(void) {
+    app_status.task = (rt_task_t){ .name = "status", .prio = TASK_PRIO_IO, .run = status_task_run };
+    rt_sched_add(&app_sched, &app_status.task);
+    rt_chan_init(&sensors.chan, sensors.buf, sizeof(sensor_msg_t), 16, 0);
+    sensors.chan.name = "sensors";
+    sensors.chan.task = &app_status.task;
+    sensors.chan.event = 1u;
+    rt_bus_add(&app_bus, &sensors.chan);
+
+    sensors.task = (rt_task_t){ .name = "sensors", .prio = TASK_PRIO_IO, .run = sensor_task_run };
+    rt_sched_add(&core1_sched, &sensors.task);
+    spi_loop.dev = (rt_spi_dev_t){ .cs = RP2350_GEEK_SPI_CS_PIN, .hz = SPI_BAUD };
+    spi_loop.x = (rt_spi_xfer_t){
+        .dev = &spi_loop.dev,
+        .tx = spi_loop_pattern,
+        .rx = spi_loop.rx,
+        .len = sizeof(spi_loop_pattern),
+        .done = spi_loop_done,
+    };
+    spi_sweep.bench = (rt_spi_bench_t){
+        .bus = &spi_engine.bus,
+        .dev = { .cs = RP2350_GEEK_SPI_CS_PIN },
+        .rates = spi_bench_rates,
+        .rate_count = SPI_BENCH_RATES,
+        .sizes = spi_bench_sizes,
+        .size_count = SPI_BENCH_SIZES,
+        .max_len = SPI_BENCH_MAX_LEN,
+        .bytes_per_row = SPI_BENCH_BYTES,
+        .buf = spi_sweep.buf,
+        .rows = spi_sweep.rows,
+        .row_done = spi_sweep_row_done,
+    };
+    rt_timer_init(&sensors.drain_timer, &sensors.task, SENSOR_EV_DRAIN);
+    rt_timer_init(&sensors.adc_timer, &sensors.task, SENSOR_EV_ADC);
+    rt_timer_init(&sensors.beat_timer, &sensors.task, SENSOR_EV_BEAT);
+    rt_task_post(&sensors.task, SENSOR_EV_START); // the stream starts once core 1 drains it
+    // The statistics are sent just ahead of the heartbeat that logs them.
+    uint64_t now = time_us_64();
+    rt_timer_start(&sensors.drain_timer, now + ADC_DRAIN_MS * 1000u, ADC_DRAIN_MS * 1000u);
+    rt_timer_start(&sensors.adc_timer, now + ADC_SAMPLE_MS * 1000u, ADC_SAMPLE_MS * 1000u);
+    rt_timer_start(&sensors.beat_timer, now + HEARTBEAT_MS * 1000u - 1000u, HEARTBEAT_MS * 1000u);
+}
+
+// Logs each ADC channel's statistics over the last heartbeat period, with
+// the temperature sensor's mean as degrees (27 C at 706 mV, -1.721 mV/C).
+static void adc_report(void) {
+    printf("[adc] rate=%luHz decim=%u/%u overruns=%lu errors=%lu\n", (unsigned long)ADC_SAMPLE_HZ,
+           ADC_DECIM_ORDER, ADC_DECIM, (unsigned long)app_status.adc_overruns, (unsigned long)app_status.adc_errors);
+    for (int ch = 0; ch < RT_ADC_CHANNELS; ++ch) {
+        const rt_adc_summary_t *s = &app_status.adc[ch];
+        if (!(ADC_CHANNELS & (1u << ch)) || !s->n) {
+            continue;
+        }
+        printf("[adc ch%d] n=%lu min=%lumV mean=%lumV max=%lumV rms=%lumV sd=%luuV", ch, (unsigned long)s->n,
+               (unsigned long)adc_q4_mv(s->min), (unsigned long)adc_q4_mv(s->mean), (unsigned long)adc_q4_mv(s->max),
+               (unsigned long)adc_q4_mv(s->rms), (unsigned long)(s->sd * 3300000ull / (4095u * 16u)));
+        if (ch == ADC_TEMPERATURE_CHANNEL_NUM) {
+            float v = (float)s->mean * 3.3f / (4095.0f * 16.0f);
+            printf(" temp=%.1fC", 27.0f - (v - 0.706f) / 0.001721f);
+        }
+        printf("\n");
     }
-};
+}
 
-static void render_gif_page(void) {
-    fb_clear(rgb565(0, 0, 0));
-    fb_draw_text_2x(8, 8, "GIF-ish pulse", rgb565(120, 220, 255), rgb565(0, 0, 0));
-    int origin_x = (LCD_WIDTH - 12) / 2;
-    int origin_y = (LCD_HEIGHT - 12) / 2;
-    for (int f = 0; f < 3; ++f) {
-        fb_draw_rect(0, 32, LCD_WIDTH, LCD_HEIGHT - 32, rgb565(0, 0, 0));
-        for (int iy = 0; iy < 12; ++iy) {
-            for (int ix = 0; ix < 12; ++ix) {
-                uint8_t idx = gif_frames[f][iy * 12 + ix];
-                fb_set_pixel(origin_x + ix, origin_y + iy, gif_palette[idx]);
+// Commands from the host over USB CDC/UART, one per line, in any case:
+//   BOOTSEL     reboot into the ROM's USB bootloader
+//   SCREENSHOT  stream what the panel shows (lcd_snap_start())
+//   SPIBENCH    run the SPI0 loopback sweep (logged as [spi bench] lines)
+static void check_host_commands(void) {
+    static char buf[12];
+    static uint8_t pos = 0;
+    int ch;
+    while ((ch = getchar_timeout_us(0)) != PICO_ERROR_TIMEOUT) {
+        if (ch == '\r' || ch == '\n') {
+            buf[pos] = '\0';
+            if (strcmp(buf, "BOOTSEL") == 0) {
+                printf("BOOTSEL command received; entering ROM USB.\n");
+                sleep_ms(50);
+                reset_usb_boot(0, 0);
+            } else if (strcmp(buf, "SCREENSHOT") == 0) {
+#if LCD_SNAP
+                lcd_snap_start();
+                rt_task_post(&lcd_snap_pump_task.task, 1u);
+#else
+                printf("SCREENSHOT needs whole frames; build with LCD_STRIP_LINES=0\n");
+#endif
+            } else if (strcmp(buf, "SPIBENCH") == 0) {
+                rt_task_post(&sensors.task, SENSOR_EV_SPI_SWEEP);
             }
+            pos = 0;
+            continue;
+        }
+        if (pos < sizeof(buf) - 1) {
+            buf[pos++] = (char)toupper(ch);
+        } else {
+            pos = 0; // overflow, reset
         }
-        lcd_flush_framebuffer();
-        sleep_ms(160);
     }
 }
 
+static rt_task_t host_task;
+
+static void host_task_run(rt_task_t *task, uint32_t events) {
+    (void)task;
+    (void)events;
+    check_host_commands();
+}
+
+// Called by the USB and UART stdio drivers, from their interrupts.
+static void host_chars_available(void *param) {
+    (void)param;
+    rt_task_post(&host_task, 1u);
+}
+
+// --- Heartbeat ---
+static struct {
+    rt_task_t task;
+    rt_timer_t timer;
+    uint32_t counter;
+} heartbeat;
+
+static void heartbeat_run(rt_task_t *task, uint32_t events) {
+    (void)task;
+    (void)events;
+    uint32_t counter = ++heartbeat.counter;
+    lcd_page_t shown = lcd_shown_page;
+    uint8_t first_i2c = 0;
+    int i2c_devices = rt_i2c_scan_count(&i2c_scanner, &first_i2c);
+    uint16_t adc_raw = app_status.lcd.adc_raw;
+    float adc_v = (float)adc_raw * 3.3f / 4095.0f;
+    app_status.lcd.counter = counter;
+    app_status.lcd.i2c_devices = (uint8_t)i2c_devices;
+    status_publish();
+
+    gfx_pace_stats_t pace;
+    uint32_t irq = save_and_disable_interrupts(); // the vsync tick runs on this core
+    gfx_pacer_take_stats(&lcd_pacer, &pace);
+    restore_interrupts(irq);
+    uint32_t pace_mean_us = pace.latency_count ? (uint32_t)(pace.latency_sum_us / pace.latency_count) : 0;
+
+    printf("[heartbeat %lu] arch=%s led=%d i2c_devices=%d first=0x%02X spi_loop=%s adc=%.2fV lcd_page=%s lcd_render=%luus lcd_flush=%luus/%lupx frames=%lu drop=%lu lat=%lu/%luus\n",
+           (unsigned long)counter,
+           arch_name(),
+           gpio_get_out_level(RP2350_GEEK_LED_PIN),
+           i2c_devices,
+           first_i2c,
+           app_status.spi_ok ? "ok" : "check wiring",
+           adc_v,
+           lcd_page_name(shown),
+           (unsigned long)lcd_last_render_us,
+           (unsigned long)lcd_dma.last_flush_us,
+           (unsigned long)lcd_dma.last_flush_px,
+           (unsigned long)lcd_frames_flushed,
+           (unsigned long)pace.dropped,
+           (unsigned long)pace_mean_us,
+           (unsigned long)pace.latency_max_us);
+    i2c_scan_report();
+    adc_report();
+    lcd_perf_report();
+    sched_report("core0", &app_sched);
+    sched_report("core1", &core1_sched);
+    bus_report();
+}
+
+static void heartbeat_start(void) {
+    heartbeat.task = (rt_task_t){ .name = "heartbeat", .prio = TASK_PRIO_BACKGROUND, .run = heartbeat_run };
+    rt_sched_add(&app_sched, &heartbeat.task);
+    rt_timer_init(&heartbeat.timer, &heartbeat.task, 1u);
+    // One period in, so the first line has core 1's readings.
+    rt_timer_start(&heartbeat.timer, time_us_64() + HEARTBEAT_MS * 1000u, HEARTBEAT_MS * 1000u);
+}
+
+// --- Core 1 ---
+// Runs core1_sched, whose tasks core 0 has set up.
+static void core1_main(void) {
+    gfx_perf_init(clock_get_hz(clk_sys)); // stages are timed with this core's counter
+    bus_irq_enable();
+    rt_sched_run_until(&core1_sched, UINT64_MAX);
+}
+
+static void core1_start(void) {
+    multicore_launch_core1(core1_main);
+    bus_irq_enable();
+}
+
 int main(void) {
     stdio_init_all();
     sleep_ms(500);
 
+    sched_init(&app_sched);
+    sched_init(&core1_sched);
+    rt_bus_init(&app_bus, (rt_bell_port_t){ NULL, bus_core, bus_ring });
     init_led();
     init_i2c();
+    i2c_scan_start();
     init_spi();
     init_adc();
     lcd_init_panel();
+#if LCD_CONSOLE
+    lcd_console_init();
+#endif
 
     bi_decl(bi_program_description("RP2350-GEEK bare-metal bring-up demo"));
     bi_decl(bi_1pin_with_name(RP2350_GEEK_LED_PIN, "Onboard LED"));
@@ -545,55 +2304,21 @@ int main(void) {
     printf("USB CDC and UART logging enabled. Heartbeat is %d ms.\n", HEARTBEAT_MS);
     printf("I2C baud %d, SPI baud %d.\n", I2C_BAUD, SPI_BAUD);
 
-    uint32_t counter = 0;
-    lcd_page_t page = LCD_PAGE_TEXT;
-    while (true) {
-        counter++;
-
-        uint8_t first_i2c = 0;
-        int i2c_devices = i2c_scan(&first_i2c);
-        bool spi_ok = spi_loopback_test();
-        uint16_t adc_raw = read_adc_raw();
-        float adc_v = (float)adc_raw * 3.3f / 4095.0f;
-
-         printf("[heartbeat %lu] arch=%s led=%d i2c_devices=%d first=0x%02X spi_loop=%s adc=%.2fV lcd_page=%s\n",
-             (unsigned long)counter,
-             arch_name(),
-             gpio_get_out_level(RP2350_GEEK_LED_PIN),
-             i2c_devices,
-             first_i2c,
-             spi_ok ? "ok" : "check wiring",
-             adc_v,
-             lcd_page_name(page));
-
-        switch (page) {
-            case LCD_PAGE_TEXT:
-                render_text_page();
-                lcd_flush_framebuffer();
-                page = LCD_PAGE_GRAPHIC;
-                break;
-            case LCD_PAGE_GRAPHIC:
-                render_gradient_page();
-                lcd_flush_framebuffer();
-                page = LCD_PAGE_ICON;
-                break;
-            case LCD_PAGE_ICON:
-                render_icon_page();
-                lcd_flush_framebuffer();
-                page = LCD_PAGE_GIF;
-                break;
-            case LCD_PAGE_GIF:
-                render_gif_page();
-                page = LCD_PAGE_TEXT;
-                break;
-            default:
-                page = LCD_PAGE_TEXT;
-                break;
-        }
-
-        // Allow host to request BOOTSEL via USB CDC/UART by sending "BOOTSEL" + Enter.
-        check_bootsel_command();
-
-        sleep_ms(HEARTBEAT_MS);
-    }
+    // Host commands (BOOTSEL, SCREENSHOT) are read as soon as a line arrives.
+    host_task = (rt_task_t){ .name = "host", .prio = TASK_PRIO_HOST, .run = host_task_run };
+    rt_sched_add(&app_sched, &host_task);
+    stdio_set_chars_available_callback(host_chars_available, NULL);
+#if LCD_SNAP
+    lcd_snap_task_start();
+#endif
+    sensor_task_start();
+    heartbeat_start();
+#if LCD_DOUBLE_BUFFER
+    lcd_task_start(&core1_sched, 1);
+    lcd_display_start();
+#else
+    lcd_task_start(&app_sched, 0);
+#endif
+    core1_start();
+    rt_sched_run_until(&app_sched, UINT64_MAX);
 }
@@ -0,0 +1,295 @@
+// Host test of sprite sheets and timelines (gfx/anim.h).
+//
+//  - Sheets: random 3-frame sheets of odd sizes are encoded both ways
+//    (GFX_SHEET_PACKED2 with padded rows, GFX_SHEET_RLE with runs crossing
+//    rows and up to 64 long) and every frame is drawn opaque and with each
+//    key, at aligned, odd and clipped positions. The frame must match a
+//    per-pixel reference drawn from the indices, pixels outside the frame
+//    must be untouched and the damage must be the clipped frame box. Frames
+//    past the end draw nothing.
+//  - Timelines: the step shown after any run of gfx_anim_advance() calls,
+//    single milliseconds or random jumps, is the one a reference computes
+//    from the total time, looping or not, zero-length steps included; the
+//    return value says whether the frame changed. Driven by
+//    gfx_anim_next_ms() alone, as the demo's timer does, every wake-up lands
+//    on a step change. Empty timelines and zero-length loops finish instead
+//    of spinning, and the generated gif_timeline loops.
+// Exits non-zero if a check fails.
+//
+// Built with the host library (-DRP2350_GEEK_HOST_BUILD=ON); run
+// gfx_anim_test.
+#include <stdio.h>
+#include <string.h>
+
+#include "gfx/anim.h"
+#include "gfx/assets.h"
+#include "gfx/fb.h"
+
+#define TEST_W 40
+#define TEST_H 30
+#define TEST_FRAMES
+#define SHEET_FRAMES 3
+#define SHEET_MAX_W 19
+#define SHEET_MAX_H 13
+
+#include "test_util.h"
+
+static const uint16_t sheet_pal[4] = {
+    RGB565_CONST(0, 0, 0), RGB565_CONST(255, 0, 0), RGB565_CONST(0, 255, 0), RGB565_CONST(255, 255, 255),
+};
+
+// --- Sheets ---
+static uint8_t indices[SHEET_FRAMES][SHEET_MAX_H * SHEET_MAX_W];
+static uint8_t packed[SHEET_FRAMES * SHEET_MAX_H * ((SHEET_MAX_W + 3) / 4)];
+static uint8_t rle[SHEET_FRAMES * SHEET_MAX_H * SHEET_MAX_W];
+static uint16_t rle_offsets[SHEET_FRAMES];
+
+// Random indices in runs, so the RLE has long runs as well as short ones.
+static void make_frames(int w, int h, uint32_t *seed) {
+    for (int f = 0; f < SHEET_FRAMES; ++f) {
+        int i = 0;
+        while (i < w * h) {
+            uint8_t idx = (uint8_t)(test_rand(seed) & 3);
+            int run = test_rand(seed) % 4 == 0 ? 1 + (int)(test_rand(seed) % 90) : 1 + (int)(test_rand(seed) % 3);
+            for (; run && i < w * h; --run) {
+                indices[f][i++] = idx;
+            }
+        }
+    }
+}
+
+static gfx_sheet_t encode_packed(int w, int h) {
+    int row_bytes = (w + 3) / 4;
+    memset(packed, 0, sizeof(packed));
+    for (int f = 0; f < SHEET_FRAMES; ++f) {
+        for (int y = 0; y < h; ++y) {
+            for (int x = 0; x < w; ++x) {
+                packed[(f * h + y) * row_bytes + x / 4] |= (uint8_t)(indices[f][y * w + x] << (6 - 2 * (x & 3)));
+            }
+        }
+    }
+    return (gfx_sheet_t){ GFX_SHEET_PACKED2, (uint8_t)w, (uint8_t)h, SHEET_FRAMES, packed, NULL, sheet_pal };
+}
+
+static gfx_sheet_t encode_rle(int w, int h) {
+    size_t n = 0;
+    for (int f = 0; f < SHEET_FRAMES; ++f) {
+        rle_offsets[f] = (uint16_t)n;
+        for (int i = 0; i < w * h;) {
+            int run = 1;
+            while (i + run < w * h && run < 64 && indices[f][i + run] == indices[f][i]) {
+                run++;
+            }
+            rle[n++] = (uint8_t)((run - 1) << 2 | indices[f][i]);
+            i += run;
+        }
+    }
+    return (gfx_sheet_t){ GFX_SHEET_RLE, (uint8_t)w, (uint8_t)h, SHEET_FRAMES, rle, rle_offsets, sheet_pal };
+}
+
+static void ref_sheet(int x, int y, int w, int h, unsigned frame, int key) {
+    for (int iy = 0; iy < h; ++iy) {
+        for (int ix = 0; ix < w; ++ix) {
+            int idx = indices[frame][iy * w + ix];
+            if (idx != key) {
+                fb_set_pixel(x + ix, y + iy, sheet_pal[idx]);
+            }
+        }
+    }
+}
+
+static bool damage_is(const gfx_fb_t *fb, int x, int y, int w, int h, const char *what) {
+    int x0 = x < 0 ? 0 : x, y0 = y < 0 ? 0 : y;
+    int x1 = x + w > TEST_W ? TEST_W : x + w, y1 = y + h > TEST_H ? TEST_H : y + h;
+    uint8_t want_count = x0 < x1 && y0 < y1;
+    if (fb->dirty_count != want_count ||
+        (want_count && (fb->dirty[0].x0 != x0 || fb->dirty[0].y0 != y0 || fb->dirty[0].x1 != x1 ||
+                        fb->dirty[0].y1 != y1))) {
+        printf("%s: %u dirty rects, want (%d, %d)-(%d, %d)\n", what, fb->dirty_count, x0, y0, x1, y1);
+        return false;
+    }
+    return true;
+}
+
+static bool test_sheets(void) {
+    static const int sizes[][2] = { { 1, 1 }, { 4, 4 }, { 7, 5 }, { 12, 12 }, { SHEET_MAX_W, SHEET_MAX_H } };
+    static const int xs[] = { 0, 3, -4, 35 };
+    static const int ys[] = { 0, 7, -6, 25 };
+    uint32_t seed = 13;
+    char what[96];
+    for (size_t si = 0; si < sizeof(sizes) / sizeof(sizes[0]); ++si) {
+        int w = sizes[si][0], h = sizes[si][1];
+        make_frames(w, h, &seed);
+        gfx_sheet_t sheets[2] = { encode_packed(w, h), encode_rle(w, h) };
+        for (int s = 0; s < 2; ++s) {
+            for (unsigned f = 0; f <= SHEET_FRAMES; ++f) {
+                for (int key = GFX_SHEET_OPAQUE; key < 4; ++key) {
+                    for (size_t p = 0; p < sizeof(xs) / sizeof(xs[0]); ++p) {
+                        int x = xs[p], y = ys[p];
+                        memset(ref_px, 0x3C, sizeof(ref_px));
+                        memset(out_px, 0x3C, sizeof(out_px));
+                        if (f < SHEET_FRAMES) {
+                            fb_bind(&ref_fb);
+                            ref_sheet(x, y, w, h, f, key);
+                        }
+                        fb_bind(&out_fb);
+                        out_fb.dirty_count = 0;
+                        fb_draw_sheet(x, y, &sheets[s], f, key);
+                        snprintf(what, sizeof(what), "%s %dx%d frame %u key %d at (%d, %d)", s ? "rle" : "packed2",
+                                 w, h, f, key, x, y);
+                        if (!frames_equal(what, &ref_fb, &out_fb) ||
+                            !damage_is(&out_fb, x, y, f < SHEET_FRAMES ? w : 0, h, what)) {
+                            return false;
+                        }
+                    }
+                }
+            }
+        }
+    }
+    return true;
+}
+
+// --- Timelines ---
+// Step a timeline is on after t ms from the start, and the time spent in
+// it; done once a non-looping timeline has played out.
+static uint8_t ref_step(const gfx_anim_step_t *steps, uint8_t count, bool loop, uint64_t t, uint32_t *in_step,
+                        bool *done) {
+    uint64_t period = 0;
+    for (uint8_t i = 0; i < count; ++i) {
+        period += steps[i].ms;
+    }
+    *done = false;
+    if (loop && period) {
+        t %= period;
+    } else if (t >= period) {
+        *done = true;
+        *in_step = 0;
+        return (uint8_t)(count - 1);
+    }
+    for (uint8_t i = 0;; ++i) {
+        if (t < steps[i].ms) {
+            *in_step = (uint32_t)t;
+            return i;
+        }
+        t -= steps[i].ms;
+    }
+}
+
+static bool anim_matches(const gfx_anim_t *a, const gfx_anim_step_t *steps, uint8_t count, bool loop, uint64_t t,
+                         const char *what) {
+    uint32_t in_step;
+    bool done;
+    uint8_t step = ref_step(steps, count, loop, t, &in_step, &done);
+    uint32_t next = done ? UINT32_MAX : steps[step].ms - in_step;
+    if (a->step != step || a->step_ms != in_step || a->done != done || gfx_anim_next_ms(a) != next) {
+        printf("%s at %llu ms: step %u (+%lu ms)%s, next in %lu; want step %u (+%lu ms)%s, next in %lu\n", what,
+               (unsigned long long)t, a->step, (unsigned long)a->step_ms, a->done ? " done" : "",
+               (unsigned long)gfx_anim_next_ms(a), step, (unsigned long)in_step, done ? " done" : "",
+               (unsigned long)next);
+        return false;
+    }
+    return true;
+}
+
+static const gfx_anim_step_t steps_a[] = { { 0, 100 }, { 1, 50 }, { 2, 0 }, { 1, 30 }, { 1, 20 }, { 3, 7 } };
+#define STEPS_A_COUNT ((uint8_t)(sizeof(steps_a) / sizeof(steps_a[0])))
+
+static bool test_timeline(void) {
+    char what[64];
+    for (int loop = 0; loop < 2; ++loop) {
+        // One millisecond at a time.
+        gfx_anim_t a;
+        gfx_anim_start(&a, steps_a, STEPS_A_COUNT, loop);
+        snprintf(what, sizeof(what), "%s, 1 ms steps", loop ? "loop" : "once");
+        for (uint64_t t = 1; t <= 700; ++t) {
+            uint8_t before = gfx_anim_frame(&a);
+            bool changed = gfx_anim_advance(&a, 1);
+            if (!anim_matches(&a, steps_a, STEPS_A_COUNT, loop, t, what)) {
+                return false;
+            }
+            if (changed != (gfx_anim_frame(&a) != before)) {
+                printf("%s at %llu ms: advance returned %d for frame %u -> %u\n", what, (unsigned long long)t, changed,
+                       before, gfx_anim_frame(&a));
+                return false;
+            }
+        }
+
+        // Random jumps, many periods long now and then.
+        uint32_t seed = 17;
+        gfx_anim_start(&a, steps_a, STEPS_A_COUNT, loop);
+        snprintf(what, sizeof(what), "%s, random jumps", loop ? "loop" : "once");
+        uint64_t t = 0;
+        for (int i = 0; i < 2000; ++i) {
+            uint32_t dt = test_rand(&seed) % 16 == 0 ? test_rand(&seed) % 5000 : test_rand(&seed) % 60;
+            uint8_t before = gfx_anim_frame(&a);
+            bool changed = gfx_anim_advance(&a, dt);
+            t += dt;
+            if (!anim_matches(&a, steps_a, STEPS_A_COUNT, loop, t, what)) {
+                return false;
+            }
+            if (changed != (gfx_anim_frame(&a) != before)) {
+                printf("%s at %llu ms: advance returned %d for frame %u -> %u\n", what, (unsigned long long)t, changed,
+                       before, gfx_anim_frame(&a));
+                return false;
+            }
+        }
+    }
+
+    // Timer-driven: sleeping exactly gfx_anim_next_ms() wakes on each
+    // non-empty step in turn.
+    gfx_anim_t a;
+    gfx_anim_start(&a, steps_a, STEPS_A_COUNT, true);
+    uint8_t want = 0;
+    for (int wake = 0; wake < 50; ++wake) {
+        gfx_anim_advance(&a, gfx_anim_next_ms(&a));
+        do {
+            want = (uint8_t)((want + 1) % STEPS_A_COUNT);
+        } while (steps_a[want].ms == 0);
+        if (a.step != want || a.step_ms != 0) {
+            printf("timer: wake-up %d on step %u (+%lu ms), want step %u\n", wake, a.step, (unsigned long)a.step_ms,
+                   want);
+            return false;
+        }
+    }
+
+    // Degenerate timelines finish rather than spin.
+    gfx_anim_start(&a, steps_a, 0, true);
+    if (!a.done || gfx_anim_advance(&a, 10) || gfx_anim_next_ms(&a) != UINT32_MAX) {
+        printf("empty timeline: not done\n");
+        return false;
+    }
+    static const gfx_anim_step_t zero[] = { { 0, 0 }, { 1, 0 } };
+    gfx_anim_start(&a, zero, 2, true);
+    if (!gfx_anim_advance(&a, 0) || !a.done || gfx_anim_frame(&a) != 1) {
+        printf("zero-length loop: step %u%s\n", a.step, a.done ? " done" : "");
+        return false;
+    }
+
+    // The generated pulse timeline loops through every sheet frame.
+    gfx_anim_start(&a, gif_timeline, GIF_TIMELINE_STEPS, true);
+    unsigned seen = 1u << gfx_anim_frame(&a);
+    for (int i = 0; i < 4 * GIF_TIMELINE_STEPS; ++i) {
+        uint32_t next = gfx_anim_next_ms(&a);
+        if (next == 0 || next == UINT32_MAX || gfx_anim_frame(&a) >= gif_sheet.frame_count) {
+            printf("gif_timeline: step %u shows frame %u for %lu ms\n", a.step, gfx_anim_frame(&a),
+                   (unsigned long)next);
+            return false;
+        }
+        gfx_anim_advance(&a, next);
+        seen |= 1u << gfx_anim_frame(&a);
+    }
+    if (a.done || seen != (1u << gif_sheet.frame_count) - 1) {
+        printf("gif_timeline: frames seen 0x%x%s\n", seen, a.done ? ", finished" : "");
+        return false;
+    }
+    return true;
+}
+
+int main(void) {
+    test_frames_init();
+    static const test_case_t tests[] = {
+        { "sheets", test_sheets },
+        { "timeline", test_timeline },
+    };
+    return test_run_all(tests, sizeof(tests) / sizeof(tests[0]));
+}
@@ -0,0 +1,244 @@
+// Host test of the scrolling log console (gfx/console.h).
+//
+// Random writes (text runs, '\n', '\r', tabs and lines longer than the grid)
+// go to a console and to a model that counts logical lines and keeps the
+// last screenful. After each write:
+//  - the frame matches the model's last screenful drawn in ring order, line
+//    k at rows k * GFX_CONSOLE_LINE_H, with the cells past the grid left bg;
+//  - gfx_console_scroll_row() puts the oldest visible line at the top, so
+//    the panel shows the lines in the order they were written;
+//  - every changed pixel is marked dirty, and a write that stays on one line
+//    (a new line once the screen is full, say) dirties only that line's rows;
+//  - fb_target is what it was before the call.
+// Exits non-zero if a check fails.
+//
+// Built with the host library (-DRP2350_GEEK_HOST_BUILD=ON); run
+// gfx_console_test.
+#include <stdio.h>
+#include <string.h>
+
+#include "gfx/console.h"
+
+// 10 columns and 5 lines, with 4 columns and 3 rows left over.
+#define TEST_COLS 10
+#define TEST_LINES 5
+#define TEST_W (TEST_COLS * FB_GLYPH_W + 4)
+#define TEST_H (TEST_LINES * GFX_CONSOLE_LINE_H + 3)
+#define TEST_FRAMES
+
+#include "test_util.h"
+
+static gfx_pixel_t old_px[GFX_FB_LEN(TEST_W, TEST_H)];
+static gfx_pixel_t other_px[GFX_FB_LEN(1, 1)];
+static gfx_fb_t other_fb;
+
+static const uint16_t fg = RGB565_CONST(140, 230, 140), bg = RGB565_CONST(8, 16, 12);
+
+// The console as the reader sees it: logical lines 0..count - 1, of which
+// the last TEST_LINES are on screen (line L in text[L % TEST_LINES]).
+typedef struct {
+    char text[TEST_LINES][TEST_COLS];
+    uint32_t count;
+    int col;
+} model_t;
+
+static void model_newline(model_t *m) {
+    memset(m->text[m->count % TEST_LINES], ' ', TEST_COLS);
+    m->count++;
+    m->col = 0;
+}
+
+static void model_init(model_t *m) {
+    memset(m->text, ' ', sizeof(m->text));
+    m->count = 1;
+    m->col = 0;
+}
+
+// Writes text to the model; returns the ring lines it touched as a bit mask.
+static unsigned model_write(model_t *m, const char *text, size_t len) {
+    unsigned touched = 0;
+    for (size_t i = 0; i < len; ++i) {
+        char c = text[i];
+        if (c == '\r') {
+            m->col = 0;
+            continue;
+        }
+        if (c == '\n' || m->col == TEST_COLS) {
+            model_newline(m);
+            touched |= 1u << ((m->count - 1) % TEST_LINES);
+            if (c == '\n') {
+                continue;
+            }
+        }
+        m->text[(m->count - 1) % TEST_LINES][m->col++] = c == '\t' ? ' ' : c;
+        touched |= 1u << ((m->count - 1) % TEST_LINES);
+    }
+    return touched;
+}
+
+// Draws the model's screen into ref_fb in ring (framebuffer) order.
+static void model_draw(const model_t *m) {
+    fb_bind(&ref_fb);
+    fb_clear(bg);
+    for (int k = 0; k < TEST_LINES; ++k) {
+        char line[TEST_COLS + 1];
+        memcpy(line, m->text[k], TEST_COLS);
+        line[TEST_COLS] = '\0';
+        fb_draw_text(0, k * GFX_CONSOLE_LINE_H, line, fg, bg);
+    }
+}
+
+static bool check_console(const gfx_console_t *con, const model_t *m, unsigned touched, const char *what) {
+    // Pixels: the frame against the model.
+    model_draw(m);
+    if (!frames_equal(what, &ref_fb, &out_fb)) {
+        return false;
+    }
+
+    // Scrolling: the oldest line on screen is at the top, the cursor on the
+    // newest one.
+    uint32_t first = m->count > TEST_LINES ? m->count - TEST_LINES : 0;
+    if (gfx_console_scroll_row(con) != first % TEST_LINES * GFX_CONSOLE_LINE_H ||
+        con->line != (m->count - 1) % TEST_LINES || con->col != m->col) {
+        printf("%s: scroll row %u, cursor %u:%u; want %u, %u:%d\n", what, gfx_console_scroll_row(con), con->line,
+               con->col, (unsigned)(first % TEST_LINES * GFX_CONSOLE_LINE_H), (unsigned)((m->count - 1) % TEST_LINES),
+               m->col);
+        return false;
+    }
+
+    // Damage: covers every change; a one-line write stays in its rows.
+    int band = -1;
+    for (int k = 0; k < TEST_LINES; ++k) {
+        if (touched == 1u << k) {
+            band = k;
+        }
+    }
+    for (uint8_t i = 0; i < out_fb.dirty_count; ++i) {
+        const gfx_rect_t *r = &out_fb.dirty[i];
+        if (band >= 0 && (r->y0 < band * GFX_CONSOLE_LINE_H || r->y1 > (band + 1) * GFX_CONSOLE_LINE_H)) {
+            printf("%s: dirty rows %d..%d outside line %d\n", what, r->y0, r->y1 - 1, band);
+            return false;
+        }
+    }
+    gfx_fb_t old_fb;
+    gfx_fb_init(&old_fb, old_px, TEST_W, TEST_H);
+    for (int y = 0; y < TEST_H; ++y) {
+        for (int x = 0; x < TEST_W; ++x) {
+            if (gfx_fb_get(&old_fb, x, y) == gfx_fb_get(&out_fb, x, y)) {
+                continue;
+            }
+            bool dirty = false;
+            for (uint8_t i = 0; i < out_fb.dirty_count; ++i) {
+                const gfx_rect_t *r = &out_fb.dirty[i];
+                dirty |= x >= r->x0 && x < r->x1 && y >= r->y0 && y < r->y1;
+            }
+            if (!dirty) {
+                printf("%s: (%d, %d) changed but not marked dirty\n", what, x, y);
+                return false;
+            }
+        }
+    }
+    return true;
+}
+
+// Writes text to both, with another frame bound, and checks the result.
+static bool write_both(gfx_console_t *con, model_t *m, const char *text, size_t len, const char *what) {
+    memcpy(old_px, out_px, sizeof(out_px));
+    out_fb.dirty_count = 0;
+    unsigned touched = model_write(m, text, len);
+    fb_bind(&other_fb);
+    gfx_console_write(con, text, len);
+    if (fb_target != &other_fb) {
+        printf("%s: fb_target not restored\n", what);
+        return false;
+    }
+    return check_console(con, m, touched, what);
+}
+
+static bool test_scroll(void) {
+    gfx_console_t con;
+    model_t m;
+    memcpy(old_px, out_px, sizeof(out_px));
+    out_fb.dirty_count = 0;
+    fb_bind(&other_fb);
+    gfx_console_init(&con, &out_fb, fg, bg);
+    model_init(&m);
+    if (fb_target != &other_fb || con.cols != TEST_COLS || con.lines != TEST_LINES) {
+        printf("scroll: init gave a %ux%u grid, fb_target %s\n", con.cols, con.lines,
+               fb_target == &other_fb ? "restored" : "not restored");
+        return false;
+    }
+    if (!check_console(&con, &m, 0, "scroll: init")) {
+        return false;
+    }
+
+    // Fill the screen, then keep going: each new line clears the oldest
+    // one and moves the scroll row down a line, wrapping to 0.
+    char what[64];
+    for (int i = 0; i < 3 * TEST_LINES; ++i) {
+        char text[16];
+        int len = snprintf(text, sizeof(text), "\nline %d", i);
+        snprintf(what, sizeof(what), "scroll: line %d", i);
+        if (!write_both(&con, &m, text, (size_t)len, what)) {
+            return false;
+        }
+        // Once scrolling, a bare new line is one clear of one line.
+        if (i >= TEST_LINES) {
+            if (!write_both(&con, &m, "\n", 1, what)) {
+                return false;
+            }
+            gfx_rect_t r = out_fb.dirty[0];
+            if (out_fb.dirty_count != 1 || r.x0 != 0 || r.x1 != TEST_W ||
+                r.y0 != con.line * GFX_CONSOLE_LINE_H || r.y1 != r.y0 + GFX_CONSOLE_LINE_H) {
+                printf("%s: new line dirtied %u rects, first (%d, %d)-(%d, %d)\n", what, out_fb.dirty_count, r.x0,
+                       r.y0, r.x1, r.y1);
+                return false;
+            }
+        }
+    }
+
+    // A line of exactly the grid's width, then one that wraps twice, then
+    // '\r' overwriting the start of a line.
+    static const char *const texts[] = { "\n0123456789", "\nabcdefghijklmnopqrstuvwxyz", "\rXY\tZ" };
+    for (size_t t = 0; t < sizeof(texts) / sizeof(texts[0]); ++t) {
+        snprintf(what, sizeof(what), "scroll: text %zu", t);
+        if (!write_both(&con, &m, texts[t], strlen(texts[t]), what)) {
+            return false;
+        }
+    }
+    return true;
+}
+
+static bool test_random(void) {
+    static const char alphabet[] = "\n\n\r\tabcXYZ019 .:";
+    gfx_console_t con;
+    model_t m;
+    gfx_console_init(&con, &out_fb, fg, bg);
+    model_init(&m);
+    uint32_t seed = 31;
+    char text[48], what[64];
+    for (int round = 0; round < 3000; ++round) {
+        // Mostly short chunks, as a log FIFO drains them; now and then a
+        // long unbroken run that wraps.
+        size_t len = round % 17 == 0 ? 25 + test_rand(&seed) % 23 : test_rand(&seed) % 8;
+        bool run = round % 17 == 0;
+        for (size_t i = 0; i < len; ++i) {
+            text[i] = run ? (char)('a' + test_rand(&seed) % 26) : alphabet[test_rand(&seed) % (sizeof(alphabet) - 1)];
+        }
+        snprintf(what, sizeof(what), "random: round %d", round);
+        if (!write_both(&con, &m, text, len, what)) {
+            return false;
+        }
+    }
+    return true;
+}
+
+int main(void) {
+    test_frames_init();
+    gfx_fb_init(&other_fb, other_px, 1, 1);
+    static const test_case_t tests[] = {
+        { "scroll", test_scroll },
+        { "random", test_random },
+    };
+    return test_run_all(tests, sizeof(tests) / sizeof(tests[0]));
+}
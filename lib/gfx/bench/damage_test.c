@@ -0,0 +1,140 @@
+// Host test of damage-driven flushes into the memory panel (gfx/panel_mem.h).
+//
+// Frames are drawn with the fb_* primitives and flushed with
+// st7789_flush_dirty(). Hand-picked cases check that the merged damage
+// sends exactly the expected number of pixels and windows: a lone sprite,
+// touching and overlapping rects that merge, distant ones that stay
+// separate, more rects than the list holds, a text line and a clear. Random
+// rounds then check that every flush sends the area of its dirty list and at
+// least every pixel drawn, and that the panel matches the frame exactly
+// after each one. Exits non-zero if a check fails.
+//
+// Built with the host library (-DRP2350_GEEK_HOST_BUILD=ON); run
+// gfx_damage_test.
+#include <stdio.h>
+#include <string.h>
+
+#include "gfx/fb.h"
+#include "gfx/font.h"
+#include "gfx/panel_mem.h"
+#include "gfx/st7789.h"
+
+#define TEST_W 240
+#define TEST_H 135
+
+#include "test_util.h"
+
+static gfx_pixel_t frame_px[GFX_FB_LEN(TEST_W, TEST_H)];
+static uint16_t panel_px[TEST_W * TEST_H];
+static gfx_fb_t fb;
+static gfx_panel_mem_t panel;
+static gfx_bus_t bus;
+static const st7789_config_t cfg = { .width = TEST_W, .height = TEST_H };
+
+// Flushes fb's damage; checks the pixel and window counts (-1: any), the
+// bytes on the bus (CASET and RASET take 4 each per window) and the panel
+// contents.
+static bool flush_check(const char *what, long want_px, int want_windows) {
+    int32_t area = 0;
+    for (uint8_t i = 0; i < fb.dirty_count; ++i) {
+        area += gfx_rect_area(&fb.dirty[i]);
+    }
+    int windows = fb.dirty_count;
+    gfx_panel_mem_reset_stats(&panel);
+    size_t sent = st7789_flush_dirty(&bus, &cfg, &fb);
+    if (sent != (size_t)area || panel.pixels_written != sent || panel.data_bytes != 2 * sent + 8u * windows) {
+        printf("%s: sent %zu, panel got %lu pixels in %lu data bytes, dirty area %ld\n", what, sent,
+               (unsigned long)panel.pixels_written, (unsigned long)panel.data_bytes, (long)area);
+        return false;
+    }
+    if ((want_px >= 0 && (long)sent != want_px) || (want_windows >= 0 && windows != want_windows)) {
+        printf("%s: %zu pixels in %d windows, want %ld in %d\n", what, sent, windows, want_px, want_windows);
+        return false;
+    }
+    return panel_matches(what, &fb, &panel);
+}
+
+static bool test_cases(void) {
+    fb_bind(&fb);
+    fb_clear(rgb565(0, 0, 40));
+    if (!flush_check("clear", TEST_W * TEST_H, 1)) {
+        return false;
+    }
+    fb_draw_rect(114, 10, 12, 12, rgb565(255, 0, 0));
+    if (!flush_check("12x12 sprite", 144, 1)) {
+        return false;
+    }
+    fb_draw_rect(10, 10, 10, 10, rgb565(0, 255, 0));
+    fb_draw_rect(20, 10, 10, 10, rgb565(0, 0, 255));
+    if (!flush_check("touching rects", 200, 1)) {
+        return false;
+    }
+    fb_draw_rect(50, 50, 10, 10, rgb565(255, 255, 0));
+    fb_draw_rect(55, 55, 10, 10, rgb565(0, 255, 255));
+    if (!flush_check("overlapping rects", 225, 1)) { // 25 px of slack beats a second window
+        return false;
+    }
+    fb_draw_rect(0, 0, 10, 10, rgb565(255, 0, 255));
+    fb_draw_rect(200, 100, 10, 10, rgb565(255, 128, 0));
+    if (!flush_check("distant rects", 200, 2)) {
+        return false;
+    }
+    for (int i = 0; i < GFX_DIRTY_MAX + 4; ++i) {
+        fb_draw_rect(i * 19, (i * 11) % 120, 4, 4, rgb565((uint8_t)(i * 20), 0, 0));
+    }
+    if (!flush_check("more rects than the list holds", -1, GFX_DIRTY_MAX)) {
+        return false;
+    }
+    fb_draw_text(8, 60, "status: 42 ok", rgb565(255, 255, 255), rgb565(0, 0, 40));
+    if (!flush_check("text line", 13 * FB_GLYPH_W * FB_GLYPH_H, 1)) {
+        return false;
+    }
+    return flush_check("nothing drawn", 0, 0);
+}
+
+static bool test_random(void) {
+    static uint8_t drawn[TEST_H][TEST_W];
+    uint32_t seed = 3;
+    fb_bind(&fb);
+    for (int round = 0; round < 300; ++round) {
+        memset(drawn, 0, sizeof(drawn));
+        long drawn_px = 0;
+        int n = 1 + (int)(test_rand(&seed) % 16);
+        for (int i = 0; i < n; ++i) {
+            int x = (int)(test_rand(&seed) % (TEST_W + 20)) - 10, y = (int)(test_rand(&seed) % (TEST_H + 20)) - 10;
+            int w = 1 + (int)(test_rand(&seed) % 50), h = 1 + (int)(test_rand(&seed) % 30);
+            fb_draw_rect(x, y, w, h, (uint16_t)test_rand(&seed));
+            for (int yy = y < 0 ? 0 : y; yy < y + h && yy < TEST_H; ++yy) {
+                for (int xx = x < 0 ? 0 : x; xx < x + w && xx < TEST_W; ++xx) {
+                    drawn_px += !drawn[yy][xx];
+                    drawn[yy][xx] = 1;
+                }
+            }
+        }
+        int32_t area = 0;
+        for (uint8_t i = 0; i < fb.dirty_count; ++i) {
+            area += gfx_rect_area(&fb.dirty[i]);
+        }
+        if (area < drawn_px) {
+            printf("random, round %d: %ld pixels drawn, %ld dirty\n", round, drawn_px, (long)area);
+            return false;
+        }
+        char what[32];
+        snprintf(what, sizeof(what), "random, round %d", round);
+        if (!flush_check(what, -1, -1)) {
+            return false;
+        }
+    }
+    return true;
+}
+
+int main(void) {
+    gfx_fb_init(&fb, frame_px, TEST_W, TEST_H);
+    gfx_panel_mem_init(&panel, panel_px, TEST_W, TEST_H);
+    bus = gfx_panel_mem_bus(&panel);
+    static const test_case_t tests[] = {
+        { "damage cases", test_cases },
+        { "damage random", test_random },
+    };
+    return test_run_all(tests, sizeof(tests) / sizeof(tests[0]));
+}
@@ -0,0 +1,361 @@
+// Host test of display-list replay (gfx/dlist.h).
+//
+// A page using every op kind (clear, rects, 5x7 text at several scales, an
+// anti-aliased label, an icon, a keyed sprite, sheet frames and a custom op,
+// some of them hanging off the edges) is rendered once straight into a full
+// framebuffer as the reference.
+//
+//  - Strips: the same list rendered with gfx_dl_render_strips() in bands of
+//    1 to 40 lines, for the whole frame and for clipped areas, lands on a
+//    simulated panel identical to the reference inside the area and
+//    untouched outside it. The sink copies a strip out only when the next
+//    wait() says its transfer is over, so drawing into a strip still being
+//    sent shows up as wrong pixels; it also checks that every band is sent
+//    once, and that only the last one is flagged last.
+//  - Damage: random rounds of property updates (text rewritten in place,
+//    colours, sheet frames, moves partly off the frame, hiding, resizing,
+//    pixel swaps, bare invalidations) re-rendered with gfx_dl_render_damage()
+//    and with gfx_dl_render_damage_strips() give exactly a fresh full render.
+//    Every changed pixel must be inside the frame's dirty rects, and a
+//    one-label update must redraw only that label's old and new boxes, which
+//    are the cells the text fills.
+// Exits non-zero if a check fails.
+//
+// Built with the host library (-DRP2350_GEEK_HOST_BUILD=ON); run
+// gfx_dlist_test.
+#include <stdio.h>
+#include <string.h>
+
+#include "gfx/assets.h"
+#include "gfx/dlist.h"
+#include "gfx/font.h"
+
+#define TEST_W 240
+#define TEST_H 135
+#define TEST_STRIP_MAX 40
+#define TEST_FRAMES
+
+#include "test_util.h"
+
+static gfx_pixel_t strip_px[2][GFX_FB_LEN(TEST_W, TEST_STRIP_MAX)];
+static gfx_pixel_t prev_px[GFX_FB_LEN(TEST_W, TEST_H)];
+static gfx_pixel_t pan_px[GFX_FB_LEN(TEST_W, TEST_H)];
+static gfx_fb_t prev_fb, pan_fb;
+
+#define BG_FILL 0x5A // byte the simulated panel starts out holding
+
+static const uint8_t icon_px[4 * 4] = {
+    0, 1, 1, 0,
+    1, 2, 2, 1,
+    1, 2, 2, 1,
+    0, 1, 1, 0,
+};
+static const uint8_t icon_alt_px[4 * 4] = {
+    2, 2, 2, 2,
+    2, 0, 0, 2,
+    2, 0, 0, 2,
+    2, 2, 2, 2,
+};
+static const uint16_t icon_pal[3] = { RGB565_CONST(0, 0, 0), RGB565_CONST(255, 128, 0), RGB565_CONST(0, 200, 255) };
+
+// Colour depends on the frame position, so a custom op drawn at the wrong
+// origin shows.
+static void draw_checker(int ox, int oy, void *user) {
+    (void)user;
+    gfx_fb_t *fb = fb_target;
+    for (int y = 0; y < fb->height; ++y) {
+        for (int x = 0; x < fb->width; ++x) {
+            int fx = ox + x, fy = oy + y;
+            uint16_t c = ((fx / 3 + fy / 3) & 1) ? rgb565((uint8_t)(fx * 2), (uint8_t)(fy * 3), 90) : rgb565(10, 10, 10);
+            fb_set_pixel(x, y, c);
+        }
+    }
+}
+
+// The page's ops, for the damage test to update.
+enum { OP_BAR, OP_BLOCK, OP_STATUS, OP_BIG, OP_EDGE, OP_LABEL, OP_SMALL, OP_ICON, OP_SPRITE, OP_HEART, OP_PULSE,
+       OP_CUSTOM, OP_COUNT };
+
+static char status_text[32];
+static char label_text[32];
+
+static void build_page(gfx_dlist_t *dl, gfx_dl_op_t *ops[OP_COUNT]) {
+    strcpy(status_text, "STATUS 12:34");
+    strcpy(label_text, "Anti-aliased");
+    gfx_dl_reset(dl);
+    gfx_dl_clear(dl, rgb565(0, 0, 40));
+    ops[OP_BAR] = gfx_dl_rect(dl, 0, 0, TEST_W, 18, rgb565(30, 60, 120));
+    ops[OP_BLOCK] = gfx_dl_rect(dl, -10, 120, 40, 30, rgb565(200, 40, 40));
+    ops[OP_STATUS] = gfx_dl_text(dl, 4, 5, status_text, rgb565(255, 255, 255), rgb565(30, 60, 120), 1);
+    ops[OP_BIG] = gfx_dl_text(dl, 8, 24, "2x text\nsecond line", rgb565(255, 255, 0), rgb565(0, 0, 40), 2);
+    ops[OP_EDGE] = gfx_dl_text(dl, 200, 60, "edge", rgb565(0, 255, 0), rgb565(0, 0, 0), 3);
+    ops[OP_LABEL] = gfx_dl_label(dl, 10, 64, &sans16, label_text, rgb565(255, 220, 180));
+    ops[OP_SMALL] = gfx_dl_label(dl, 120, 100, &sans11, "over a rect", rgb565(255, 255, 255));
+    ops[OP_ICON] = gfx_dl_icon(dl, 150, 30, 4, 4, icon_px, icon_pal);
+    ops[OP_SPRITE] = gfx_dl_sprite(dl, 156, 30, 4, 4, icon_px, icon_pal, 0);
+    ops[OP_HEART] = gfx_dl_sheet(dl, 180, 8, &heart_sheet, 0, 0);
+    ops[OP_PULSE] = gfx_dl_sheet(dl, 230, 128, &gif_sheet, 1, GFX_SHEET_OPAQUE);
+    ops[OP_CUSTOM] = gfx_dl_custom(dl, 100, 84, 36, 30, draw_checker, NULL);
+}
+
+// --- Strips ---
+// A panel taking strips the way a DMA transfer would: a sent strip is read
+// only when the transfer ends, which the next wait() stands for.
+typedef struct {
+    gfx_fb_t *frame;
+    gfx_fb_t *in_flight;
+    gfx_rect_t rect; // in_flight's dirty rect when it was sent
+    int y;           // frame row of its row 0
+    int sends, lasts;
+    bool last_was_last, overlapped;
+} strip_panel_t;
+
+static void strip_land(strip_panel_t *p) {
+    for (int y = p->rect.y0; y < p->rect.y1; ++y) {
+        for (int x = p->rect.x0; x < p->rect.x1; ++x) {
+            gfx_fb_put(p->frame, x, p->y + y, gfx_fb_get(p->in_flight, x, y));
+        }
+    }
+    p->in_flight = NULL;
+}
+
+static void strip_send(void *ctx, gfx_fb_t *strip, int y, bool last) {
+    strip_panel_t *p = ctx;
+    if (p->in_flight) {
+        p->overlapped = true;
+        strip_land(p);
+    }
+    p->in_flight = strip;
+    p->rect = strip->dirty[0];
+    p->y = y;
+    p->sends++;
+    p->lasts += last;
+    p->last_was_last = last;
+}
+
+static void strip_wait(void *ctx) {
+    strip_panel_t *p = ctx;
+    if (p->in_flight) {
+        strip_land(p);
+    }
+}
+
+static bool test_strips(void) {
+    static gfx_dlist_t dl;
+    gfx_dl_op_t *ops[OP_COUNT];
+    build_page(&dl, ops);
+    fb_bind(&ref_fb);
+    gfx_dl_render(&dl);
+
+    static const int heights[] = { 1, 7, 16, 29, TEST_STRIP_MAX };
+    static const gfx_rect_t areas[] = {
+        { 0, 0, TEST_W, TEST_H }, { 10, 5, 200, 60 }, { -20, 100, 300, 200 }, { 33, 0, 34, TEST_H }, { 50, 70, 50, 90 },
+    };
+    char what[64];
+    for (size_t hi = 0; hi < sizeof(heights) / sizeof(heights[0]); ++hi) {
+        gfx_fb_t strips[2];
+        gfx_fb_init(&strips[0], strip_px[0], TEST_W, heights[hi]);
+        gfx_fb_init(&strips[1], strip_px[1], TEST_W, heights[hi]);
+        for (size_t ai = 0; ai < sizeof(areas) / sizeof(areas[0]); ++ai) {
+            const gfx_rect_t *area = ai == 0 ? NULL : &areas[ai];
+            memset(out_px, BG_FILL, sizeof(out_px));
+            strip_panel_t panel = { .frame = &out_fb };
+            gfx_strip_sink_t sink = { strip_send, strip_wait, &panel };
+            gfx_dl_render_strips(&dl, strips, TEST_H, area, &sink);
+            strip_wait(&panel);
+            snprintf(what, sizeof(what), "%d-line strips, area %zu", heights[hi], ai);
+
+            // What the panel should now hold: the reference inside the
+            // clipped area (byte-aligned at 4bpp), its old contents outside.
+            gfx_rect_t a = areas[ai];
+            a.x0 = (int16_t)(a.x0 < 0 ? 0 : a.x0);
+            a.y0 = (int16_t)(a.y0 < 0 ? 0 : a.y0);
+            a.x1 = (int16_t)(a.x1 > TEST_W ? TEST_W : a.x1);
+            a.y1 = (int16_t)(a.y1 > TEST_H ? TEST_H : a.y1);
+#if GFX_FB_BPP == 4
+            a.x0 &= ~1;
+#endif
+            static gfx_pixel_t want_px[GFX_FB_LEN(TEST_W, TEST_H)];
+            gfx_fb_t want;
+            gfx_fb_init(&want, want_px, TEST_W, TEST_H);
+            memset(want_px, BG_FILL, sizeof(want_px));
+            for (int y = a.y0; y < a.y1; ++y) {
+                for (int x = a.x0; x < a.x1; ++x) {
+                    gfx_fb_put(&want, x, y, gfx_fb_get(&ref_fb, x, y));
+                }
+            }
+            if (!frames_equal(what, &want, &out_fb)) {
+                return false;
+            }
+
+            int bands = a.x1 > a.x0 && a.y1 > a.y0 ? (a.y1 - a.y0 + heights[hi] - 1) / heights[hi] : 0;
+            if (panel.overlapped || panel.sends != bands || panel.lasts != (bands > 0) ||
+                (bands > 0 && !panel.last_was_last)) {
+                printf("%s: %d sends (want %d), %d flagged last%s%s\n", what, panel.sends, bands, panel.lasts,
+                       bands > 0 && !panel.last_was_last ? ", not the final one" : "",
+                       panel.overlapped ? ", sent before the previous strip was waited for" : "");
+                return false;
+            }
+        }
+    }
+    return true;
+}
+
+// --- Damage ---
+// One random property update.
+static void update_random(gfx_dlist_t *dl, gfx_dl_op_t *ops[OP_COUNT], uint32_t *seed) {
+    gfx_dl_op_t *op = ops[test_rand(seed) % OP_COUNT];
+    int x = (int)(test_rand(seed) % (TEST_W + 40)) - 20, y = (int)(test_rand(seed) % (TEST_H + 40)) - 20;
+    switch (test_rand(seed) % 8) {
+        case 0:
+            snprintf(status_text, sizeof(status_text), "%.*s%u", (int)(test_rand(seed) % 12), "STATUS: busy",
+                     (unsigned)test_rand(seed) % 100000);
+            gfx_dl_set_text(dl, ops[OP_STATUS], status_text);
+            break;
+        case 1:
+            snprintf(label_text, sizeof(label_text), "%u mV", (unsigned)test_rand(seed) % 4000);
+            gfx_dl_set_text(dl, ops[OP_LABEL], label_text);
+            break;
+        case 2:
+            gfx_dl_set_color(dl, op, (uint16_t)test_rand(seed), op == ops[OP_LABEL] ? 0 : (uint16_t)test_rand(seed));
+            break;
+        case 3:
+            gfx_dl_set_frame(dl, ops[OP_PULSE], test_rand(seed) % gif_sheet.frame_count);
+            break;
+        case 4:
+            if (op != ops[OP_BAR]) {
+                gfx_dl_move(dl, op, x, y);
+            }
+            break;
+        case 5:
+            gfx_dl_set_visible(dl, op, (op->flags & GFX_DL_HIDDEN) != 0);
+            break;
+        case 6:
+            gfx_dl_set_rect(dl, ops[OP_BLOCK], x, y, 1 + (int)(test_rand(seed) % 60), 1 + (int)(test_rand(seed) % 40));
+            gfx_dl_set_pixels(dl, ops[OP_ICON], ops[OP_ICON]->icon.pixels == icon_px ? icon_alt_px : icon_px);
+            break;
+        default: {
+            gfx_rect_t r = { (int16_t)x, (int16_t)y, (int16_t)(x + 30), (int16_t)(y + 20) };
+            gfx_dl_invalidate(dl, &r);
+            break;
+        }
+    }
+}
+
+static bool in_dirty(const gfx_fb_t *fb, int x, int y) {
+    for (uint8_t i = 0; i < fb->dirty_count; ++i) {
+        const gfx_rect_t *r = &fb->dirty[i];
+        if (x >= r->x0 && x < r->x1 && y >= r->y0 && y < r->y1) {
+            return true;
+        }
+    }
+    return false;
+}
+
+static bool test_damage(void) {
+    static gfx_dlist_t dl;
+    gfx_dl_op_t *ops[OP_COUNT];
+    build_page(&dl, ops);
+    fb_bind(&out_fb);
+    gfx_dl_render(&dl);
+    memcpy(pan_px, out_px, sizeof(pan_px));
+
+    gfx_fb_t strips[2];
+    gfx_fb_init(&strips[0], strip_px[0], TEST_W, 16);
+    gfx_fb_init(&strips[1], strip_px[1], TEST_W, 16);
+    strip_panel_t panel = { .frame = &pan_fb };
+    gfx_strip_sink_t sink = { strip_send, strip_wait, &panel };
+
+    // 5x7 text ops are bounded by the cells they fill.
+    static const gfx_rect_t text_boxes[] = {
+        { 4, 5, 4 + 12 * FB_GLYPH_W, 5 + FB_GLYPH_H },
+        { 8, 24, 8 + 11 * 2 * FB_GLYPH_W, 24 + (2 * FB_GLYPH_H + 1) * 2 },
+        { 200, 60, 200 + 4 * 3 * FB_GLYPH_W, 60 + 3 * FB_GLYPH_H },
+    };
+    for (int i = 0; i < 3; ++i) {
+        const gfx_rect_t *b = &ops[OP_STATUS + i]->bounds, *want = &text_boxes[i];
+        if (memcmp(b, want, sizeof(*b)) != 0) {
+            printf("damage: text op %d bounds (%d, %d)-(%d, %d), want (%d, %d)-(%d, %d)\n", i, b->x0, b->y0, b->x1,
+                   b->y1, want->x0, want->y0, want->x1, want->y1);
+            return false;
+        }
+    }
+
+    // One label changes: only its old and new boxes are redrawn.
+    gfx_rect_t before = ops[OP_STATUS]->bounds;
+    strcpy(status_text, "STATUS 9");
+    gfx_dl_set_text(&dl, ops[OP_STATUS], status_text);
+    int32_t boxes = gfx_rect_area(&before) + gfx_rect_area(&ops[OP_STATUS]->bounds);
+    out_fb.dirty_count = 0;
+    fb_bind(&out_fb);
+    gfx_dl_render_damage(&dl);
+    int32_t redrawn = 0;
+    for (uint8_t i = 0; i < out_fb.dirty_count; ++i) {
+        redrawn += gfx_rect_area(&out_fb.dirty[i]);
+    }
+    if (redrawn == 0 || redrawn > boxes) {
+        printf("damage: one label update redrew %ld pixels, its boxes cover %ld\n", (long)redrawn, (long)boxes);
+        return false;
+    }
+    fb_bind(&ref_fb);
+    gfx_dl_render(&dl);
+    if (!frames_equal("damage, one label", &ref_fb, &out_fb)) {
+        return false;
+    }
+    memcpy(pan_px, out_px, sizeof(pan_px));
+
+    uint32_t seed = 7;
+    char what[64];
+    for (int round = 0; round < 300; ++round) {
+        int updates = 1 + (int)(test_rand(&seed) % 4);
+        for (int i = 0; i < updates; ++i) {
+            update_random(&dl, ops, &seed);
+        }
+        fb_bind(&ref_fb);
+        gfx_dl_render(&dl);
+
+        // Odd rounds go through strips; the damage is cleared either way, so
+        // the other output catches up with a full render.
+        memcpy(prev_px, out_px, sizeof(prev_px));
+        if (round & 1) {
+            gfx_dl_render_damage_strips(&dl, strips, TEST_H, &sink);
+            strip_wait(&panel);
+            fb_bind(&out_fb);
+            gfx_dl_render(&dl);
+            snprintf(what, sizeof(what), "damage strips, round %d", round);
+            if (!frames_equal(what, &ref_fb, &pan_fb)) {
+                return false;
+            }
+            continue;
+        }
+        out_fb.dirty_count = 0;
+        fb_bind(&out_fb);
+        gfx_dl_render_damage(&dl);
+        snprintf(what, sizeof(what), "damage, round %d", round);
+        if (dl.damage_count != 0 || !frames_equal(what, &ref_fb, &out_fb)) {
+            return false;
+        }
+        for (int y = 0; y < TEST_H; ++y) {
+            for (int x = 0; x < TEST_W; ++x) {
+                if (gfx_fb_get(&prev_fb, x, y) != gfx_fb_get(&out_fb, x, y) && !in_dirty(&out_fb, x, y)) {
+                    printf("%s: (%d, %d) changed but not marked dirty\n", what, x, y);
+                    return false;
+                }
+            }
+        }
+        fb_bind(&pan_fb);
+        gfx_dl_render(&dl);
+    }
+    return true;
+}
+
+int main(void) {
+    test_frames_init();
+    gfx_fb_init(&prev_fb, prev_px, TEST_W, TEST_H);
+    gfx_fb_init(&pan_fb, pan_px, TEST_W, TEST_H);
+    static const test_case_t tests[] = {
+        { "strips", test_strips },
+        { "damage", test_damage },
+    };
+    return test_run_all(tests, sizeof(tests) / sizeof(tests[0]));
+}
@@ -0,0 +1,206 @@
+// Host regression test for the framebuffer core (gfx/fb.h).
+//
+//  - fb_fill_span() at every alignment and length up to a few words writes
+//    exactly its n units and nothing around them;
+//  - fb_fill_rect(), fb_draw_rect() and fb_clear() match a per-pixel
+//    reference over random rects, clipped ones included, on the full frame
+//    and on views into it, and record the expected damage;
+//  - gfx_damage_add() keeps at most GFX_DIRTY_MAX rects that together cover
+//    every rect added and no pixel outside their bounding box, merges
+//    touching and repeated rects, keeps distant ones apart and ignores empty
+//    ones.
+// Exits non-zero if a check fails.
+//
+// Built with the host library (-DRP2350_GEEK_HOST_BUILD=ON); run gfx_fb_test.
+#include <stdio.h>
+#include <string.h>
+
+#include "gfx/fb.h"
+
+#define TEST_W 61 // odd, so 4bpp rows end mid-byte
+#define TEST_H 37
+#define TEST_FRAMES
+
+#include "test_util.h"
+
+static bool test_span(void) {
+    enum { SLACK = 16, MAX_N = 70 };
+    gfx_pixel_t buf[SLACK + MAX_N + SLACK];
+    const gfx_pixel_t sentinel = (gfx_pixel_t)0x5A5A, value = (gfx_pixel_t)0xC3A1;
+    for (int off = 0; off < SLACK; ++off) {
+        for (int n = 0; n <= MAX_N; ++n) {
+            for (size_t i = 0; i < sizeof(buf) / sizeof(buf[0]); ++i) {
+                buf[i] = sentinel;
+            }
+            fb_fill_span(&buf[off], (size_t)n, value);
+            for (int i = 0; i < (int)(sizeof(buf) / sizeof(buf[0])); ++i) {
+                gfx_pixel_t want = i >= off && i < off + n ? value : sentinel;
+                if (buf[i] != want) {
+                    printf("span: offset %d, %d units: unit %d is 0x%x, want 0x%x\n", off, n, i, (unsigned)buf[i],
+                           (unsigned)want);
+                    return false;
+                }
+            }
+        }
+    }
+    return true;
+}
+
+static void ref_fill(gfx_fb_t *fb, int x, int y, int w, int h, uint16_t color) {
+    for (int yy = y; yy < y + h; ++yy) {
+        for (int xx = x; xx < x + w; ++xx) {
+            if (xx >= 0 && yy >= 0 && xx < fb->width && yy < fb->height) {
+                gfx_fb_put(fb, xx, yy, gfx_fb_value(fb, color));
+            }
+        }
+    }
+}
+
+static bool test_fill(void) {
+    uint32_t seed = 7;
+    for (int round = 0; round < 400; ++round) {
+        uint16_t bg = (uint16_t)test_rand(&seed);
+        fb_bind(&ref_fb);
+        ref_fill(&ref_fb, 0, 0, TEST_W, TEST_H, bg);
+        fb_bind(&out_fb);
+        fb_clear(bg);
+        if (out_fb.dirty_count != 1 || out_fb.dirty[0].x1 != TEST_W || out_fb.dirty[0].y1 != TEST_H) {
+            printf("clear, round %d: damage is not the whole frame\n", round);
+            return false;
+        }
+
+        // A view at an even x (4bpp views share bytes otherwise).
+        gfx_rect_t vr = { (int16_t)(test_rand(&seed) % 16 * 2), (int16_t)(test_rand(&seed) % 20), 0, 0 };
+        vr.x1 = (int16_t)(vr.x0 + 1 + test_rand(&seed) % (TEST_W - vr.x0));
+        vr.y1 = (int16_t)(vr.y0 + 1 + test_rand(&seed) % (TEST_H - vr.y0));
+        gfx_fb_t ref_view, out_view;
+        gfx_fb_view(&ref_view, &ref_fb, &vr);
+        gfx_fb_view(&out_view, &out_fb, &vr);
+
+        for (int i = 0; i < 6; ++i) {
+            bool view = i & 1;
+            gfx_fb_t *ref = view ? &ref_view : &ref_fb, *out = view ? &out_view : &out_fb;
+            int x = (int)(test_rand(&seed) % (TEST_W + 20)) - 10, y = (int)(test_rand(&seed) % (TEST_H + 20)) - 10;
+            int w = (int)(test_rand(&seed) % 40), h = (int)(test_rand(&seed) % 20);
+            uint16_t color = (uint16_t)test_rand(&seed);
+            ref_fill(ref, x, y, w, h, color);
+            fb_bind(out);
+            out->dirty_count = 0;
+            fb_draw_rect(x, y, w, h, color);
+
+            // The damage is the rect clipped to the target, or none.
+            int x0 = x < 0 ? 0 : x, y0 = y < 0 ? 0 : y;
+            int x1 = x + w > out->width ? out->width : x + w, y1 = y + h > out->height ? out->height : y + h;
+            bool empty = x0 >= x1 || y0 >= y1;
+            const gfx_rect_t *d = &out->dirty[0];
+            if (empty ? out->dirty_count != 0
+                      : out->dirty_count != 1 || d->x0 != x0 || d->y0 != y0 || d->x1 != x1 || d->y1 != y1) {
+                printf("draw_rect, round %d: damage does not match (%d, %d, %d, %d)\n", round, x, y, w, h);
+                return false;
+            }
+        }
+        char what[32];
+        snprintf(what, sizeof(what), "fill, round %d", round);
+        if (!frames_equal(what, &ref_fb, &out_fb)) {
+            return false;
+        }
+    }
+    return true;
+}
+
+// Checks a damage list against the rects added to it, pixel by pixel.
+static bool damage_covers(const gfx_rect_t *list, uint8_t count, const gfx_rect_t *added, int n, int round) {
+    static uint8_t in_list[TEST_H][TEST_W];
+    memset(in_list, 0, sizeof(in_list));
+    for (uint8_t i = 0; i < count; ++i) {
+        for (int y = list[i].y0; y < list[i].y1; ++y) {
+            for (int x = list[i].x0; x < list[i].x1; ++x) {
+                in_list[y][x] = 1;
+            }
+        }
+    }
+    gfx_rect_t box = { TEST_W, TEST_H, 0, 0 };
+    for (int i = 0; i < n; ++i) {
+        const gfx_rect_t *r = &added[i];
+        if (r->x0 >= r->x1 || r->y0 >= r->y1) {
+            continue;
+        }
+        box.x0 = r->x0 < box.x0 ? r->x0 : box.x0;
+        box.y0 = r->y0 < box.y0 ? r->y0 : box.y0;
+        box.x1 = r->x1 > box.x1 ? r->x1 : box.x1;
+        box.y1 = r->y1 > box.y1 ? r->y1 : box.y1;
+        for (int y = r->y0; y < r->y1; ++y) {
+            for (int x = r->x0; x < r->x1; ++x) {
+                if (!in_list[y][x]) {
+                    printf("damage, round %d: (%d, %d) was added but is not in the list\n", round, x, y);
+                    return false;
+                }
+            }
+        }
+    }
+    for (uint8_t i = 0; i < count; ++i) {
+        const gfx_rect_t *r = &list[i];
+        if (r->x0 < box.x0 || r->y0 < box.y0 || r->x1 > box.x1 || r->y1 > box.y1 || r->x0 >= r->x1 ||
+            r->y0 >= r->y1) {
+            printf("damage, round %d: rect %u reaches outside what was added\n", round, (unsigned)i);
+            return false;
+        }
+    }
+    return true;
+}
+
+static bool test_damage(void) {
+    uint32_t seed = 99;
+    for (int round = 0; round < 2000; ++round) {
+        gfx_rect_t list[GFX_DIRTY_MAX], added[24];
+        uint8_t count = 0;
+        int n = 1 + (int)(test_rand(&seed) % 24);
+        for (int i = 0; i < n; ++i) {
+            gfx_rect_t r;
+            r.x0 = (int16_t)(test_rand(&seed) % TEST_W);
+            r.y0 = (int16_t)(test_rand(&seed) % TEST_H);
+            r.x1 = (int16_t)(r.x0 + test_rand(&seed) % 12); // may be empty
+            r.y1 = (int16_t)(r.y0 + test_rand(&seed) % 8);
+            r.x1 = r.x1 > TEST_W ? TEST_W : r.x1;
+            r.y1 = r.y1 > TEST_H ? TEST_H : r.y1;
+            added[i] = r;
+            gfx_damage_add(list, &count, r);
+            if (count > GFX_DIRTY_MAX) {
+                printf("damage, round %d: %u rects\n", round, (unsigned)count);
+                return false;
+            }
+        }
+        if (!damage_covers(list, count, added, n, round)) {
+            return false;
+        }
+    }
+
+    // Touching rects become one, far ones stay two, repeats and empty rects
+    // change nothing.
+    gfx_rect_t list[GFX_DIRTY_MAX];
+    uint8_t count = 0;
+    gfx_damage_add(list, &count, (gfx_rect_t){ 0, 0, 10, 10 });
+    gfx_damage_add(list, &count, (gfx_rect_t){ 10, 0, 20, 10 });
+    gfx_damage_add(list, &count, (gfx_rect_t){ 0, 0, 10, 10 });
+    gfx_damage_add(list, &count, (gfx_rect_t){ 5, 5, 5, 9 });
+    if (count != 1 || list[0].x0 != 0 || list[0].x1 != 20 || list[0].y1 != 10) {
+        printf("damage: touching rects were not merged into one\n");
+        return false;
+    }
+    gfx_damage_add(list, &count, (gfx_rect_t){ 40, 25, 50, 35 });
+    if (count != 2) {
+        printf("damage: distant rects were merged\n");
+        return false;
+    }
+    return true;
+}
+
+int main(void) {
+    test_frames_init();
+    static const test_case_t tests[] = {
+        { "span fill", test_span },
+        { "rect fill", test_fill },
+        { "damage merge", test_damage },
+    };
+    return test_run_all(tests, sizeof(tests) / sizeof(tests[0]));
+}
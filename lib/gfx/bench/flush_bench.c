@@ -0,0 +1,148 @@
+// Host benchmark of the memory traffic per flush, by framebuffer pixel order.
+//
+// The demo's flush path depends on how pixels are stored: 16bpp frames in
+// wire order (GFX_FB_WIRE_ORDER=1) go straight from the framebuffer to the
+// transmitter by DMA, while native-order and indexed frames are expanded by
+// the CPU into the ping-pong staging buffers (gfx/stream.h), which the DMA
+// then reads. For typical flushes (the whole frame, a text line, the GIF
+// pulse, scattered damage) this runs the path the build would take and
+// reports the bytes touched per flush: framebuffer bytes the CPU reads,
+// staging bytes it writes and bytes the DMA reads, plus the CPU time spent
+// staging. The staged bytes are checked against gfx_fb_expand_wire() over
+// each window. Exits non-zero on a mismatch.
+//
+// The host build runs it twice: gfx_flush_bench against the library as
+// configured and gfx_flush_bench_other against a copy built with the other
+// pixel order, so one build shows both. Run gfx_flush_bench [iterations].
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+#include "gfx/fb.h"
+#include "gfx/stream.h"
+
+#define BENCH_W 240
+#define BENCH_H 135
+#define BENCH_CHUNK_PX 512 // the demo's LCD_DMA_CHUNK_PX
+
+// The demo streams from the framebuffer only at 16bpp in wire order.
+#define BENCH_DIRECT (!GFX_FB_INDEXED && GFX_FB_WIRE_ORDER)
+
+static gfx_pixel_t frame_px[GFX_FB_LEN(BENCH_W, BENCH_H)];
+static uint8_t staging[2][BENCH_CHUNK_PX * 2];
+#if !BENCH_DIRECT
+static uint8_t wire[BENCH_W * BENCH_H * 2];
+#endif
+
+static double bench_now_ns(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (double)ts.tv_sec * 1e9 + (double)ts.tv_nsec;
+}
+
+typedef struct {
+    const char *name;
+    gfx_rect_t rects[GFX_DIRTY_MAX];
+    uint8_t count;
+} flush_case_t;
+
+typedef struct {
+    uint64_t px;
+    uint64_t cpu_read, cpu_written, dma_read;
+} flush_traffic_t;
+
+// Bytes of framebuffer storage behind a window.
+static uint64_t window_bytes(const gfx_rect_t *r) {
+    uint64_t h = (uint64_t)(r->y1 - r->y0);
+#if GFX_FB_BPP == 4
+    return (uint64_t)((r->x1 + 1) / 2 - r->x0 / 2) * h; // whole bytes, shared at odd edges
+#else
+    return (uint64_t)(r->x1 - r->x0) * h * sizeof(gfx_pixel_t);
+#endif
+}
+
+// Stages every window of fc as the DMA interrupt would and counts the
+// traffic; with check, compares the chunks with the window in wire order.
+static bool flush_run(gfx_stream_t *s, const gfx_fb_t *fb, const flush_case_t *fc, flush_traffic_t *t, bool check) {
+    for (uint8_t i = 0; i < fc->count; ++i) {
+        const gfx_rect_t *r = &fc->rects[i];
+        size_t w = (size_t)(r->x1 - r->x0), h = (size_t)(r->y1 - r->y0);
+        t->px += w * h;
+#if BENCH_DIRECT
+        (void)s;
+        (void)fb;
+        (void)check;
+        t->dma_read += window_bytes(r);
+#else
+        if (check) {
+            for (size_t y = 0; y < h; ++y) {
+                gfx_fb_expand_wire(fb, r->x0, r->y0 + (int)y, w, &wire[2 * y * w]);
+            }
+        }
+        size_t sent = 0;
+        for (size_t px = gfx_stream_begin(s, fb, r); px; px = gfx_stream_next(s)) {
+            if (check && memcmp(gfx_stream_chunk(s), &wire[2 * sent], px * 2) != 0) {
+                printf("%s: staged bytes differ in window %u\n", fc->name, (unsigned)i);
+                return false;
+            }
+            sent += px;
+            gfx_stream_refill(s);
+        }
+        t->cpu_read += window_bytes(r);
+        t->cpu_written += 2 * sent;
+        t->dma_read += 2 * sent;
+#endif
+    }
+    return true;
+}
+
+int main(int argc, char **argv) {
+    int iterations = argc > 1 ? atoi(argv[1]) : 200;
+    if (iterations < 1) {
+        iterations = 1;
+    }
+    gfx_fb_t fb;
+    gfx_fb_init(&fb, frame_px, BENCH_W, BENCH_H);
+    fb_bind(&fb);
+    fb_clear(rgb565(8, 16, 32));
+    for (int i = 0; i < 40; ++i) {
+        fb_draw_rect(i * 6, (i * 37) % BENCH_H, 9, 7, rgb565((uint8_t)(i * 6), 200, (uint8_t)(255 - i * 6)));
+    }
+    gfx_stream_t s;
+    gfx_stream_init(&s, staging[0], staging[1], BENCH_CHUNK_PX);
+
+    static const flush_case_t cases[] = {
+        { "full frame", { { 0, 0, BENCH_W, BENCH_H } }, 1 },
+        { "text line", { { 8, 60, 232, 76 } }, 1 },
+        { "gif pulse 12x12", { { 114, 10, 126, 22 } }, 1 },
+        { "8 scattered rects",
+          { { 0, 0, 16, 8 }, { 60, 10, 75, 30 }, { 200, 4, 240, 12 }, { 31, 50, 47, 66 },
+            { 120, 70, 121, 135 }, { 90, 100, 130, 103 }, { 170, 80, 190, 120 }, { 5, 120, 25, 135 } },
+          8 },
+    };
+    printf("%dx%d, %d bpp, %s order: %s\n", BENCH_W, BENCH_H, GFX_FB_BPP, GFX_FB_WIRE_ORDER ? "wire" : "native",
+           BENCH_DIRECT ? "DMA straight from the framebuffer" : "staged by the CPU, then DMA");
+    printf("%-18s %7s %9s %9s %9s %9s %7s %9s\n", "flush", "px", "cpu rd B", "cpu wr B", "dma rd B", "total B",
+           "B/px", "cpu us");
+    int failed = 0;
+    for (size_t i = 0; i < sizeof(cases) / sizeof(cases[0]); ++i) {
+        const flush_case_t *fc = &cases[i];
+        flush_traffic_t t = { 0 };
+        if (!flush_run(&s, &fb, fc, &t, true)) {
+            failed = 1;
+            continue;
+        }
+        flush_traffic_t scratch = { 0 };
+        double start = bench_now_ns();
+        for (int k = 0; k < iterations; ++k) {
+            flush_run(&s, &fb, fc, &scratch, false);
+        }
+        double us = (bench_now_ns() - start) / iterations / 1000.0;
+        uint64_t total = t.cpu_read + t.cpu_written + t.dma_read;
+        printf("%-18s %7llu %9llu %9llu %9llu %9llu %7.2f %9.2f\n", fc->name, (unsigned long long)t.px,
+               (unsigned long long)t.cpu_read, (unsigned long long)t.cpu_written, (unsigned long long)t.dma_read,
+               (unsigned long long)total, (double)total / (double)t.px, BENCH_DIRECT ? 0.0 : us);
+    }
+    return failed;
+}
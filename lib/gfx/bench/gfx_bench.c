@@ -0,0 +1,537 @@
+// Host benchmark for the shading kernels (gfx/shade.h) and text (gfx/text.h).
+//
+// Each kernel is checked bit for bit against a straightforward per-pixel
+// reference (shade_ref.h, shared with gfx_shade_test), over the full frame
+// and over offset strips as a display list replays them, and then both are
+// timed. Anti-aliased text is checked the same way against gfx_blend565()
+// per pixel, then timed against the 5x7 font at 2x. Span fills (full-screen
+// clears and small rects) are checked and timed in pixels per second against
+// the per-pixel loops they replaced, and a full screen of 5x7 text at 1x and
+// 2x against the column-by-column renderers the glyph cache replaced.
+// Snapshots (gfx/snap.h) are decoded and compared with the frame for several
+// chunk sizes and start rows, then timed. Exits non-zero on the first
+// mismatch.
+//
+// Built with the host library (-DRP2350_GEEK_HOST_BUILD=ON); run gfx_bench
+// [iterations].
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+#include "gfx/assets.h"
+#include "gfx/fb.h"
+#include "gfx/font.h"
+#include "gfx/shade.h"
+#include "gfx/snap.h"
+#include "gfx/text.h"
+#include "shade_ref.h"
+
+#define BENCH_W 240
+#define BENCH_H 135
+
+static gfx_pixel_t ref_px[GFX_FB_LEN(BENCH_W, BENCH_H)];
+static gfx_pixel_t out_px[GFX_FB_LEN(BENCH_W, BENCH_H)];
+static gfx_fb_t ref_fb, out_fb;
+
+static double bench_now_ns(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (double)ts.tv_sec * 1e9 + (double)ts.tv_nsec;
+}
+
+// --- References ---
+// The shading references are in shade_ref.h. Each case draws the frame from
+// (ox, oy) on into fb_target, which is a view of that part of it.
+static gfx_gradient_t bench_gradient(int ox, int oy) {
+    return (gfx_gradient_t){
+        .r = gfx_ramp(0, 255, 1, 0, BENCH_W),
+        .g = gfx_ramp(0, 255, 0, 1, BENCH_H),
+        .b = gfx_ramp(0, 255, 1, 1, BENCH_W + BENCH_H),
+        .x0 = (int16_t)-ox,
+        .y0 = (int16_t)-oy,
+    };
+}
+
+static void bench_ref_gradient(int ox, int oy) {
+    gfx_gradient_t g = bench_gradient(ox, oy);
+    ref_gradient(0, 0, fb_target->width, fb_target->height, &g);
+}
+
+static void new_gradient(int ox, int oy) {
+    gfx_gradient_t g = bench_gradient(ox, oy);
+    fb_fill_gradient(0, 0, fb_target->width, fb_target->height, &g);
+}
+
+static const uint16_t *bench_corners(void) {
+    static uint16_t c[4];
+    c[0] = rgb565(255, 0, 40);
+    c[1] = rgb565(0, 200, 255);
+    c[2] = rgb565(20, 255, 0);
+    c[3] = rgb565(250, 250, 250);
+    return c;
+}
+
+static void bench_ref_corners(int ox, int oy) {
+    ref_corners(-ox, -oy, BENCH_W, BENCH_H, bench_corners());
+}
+
+static void new_corners(int ox, int oy) {
+    const uint16_t *c = bench_corners();
+    fb_fill_corners(-ox, -oy, BENCH_W, BENCH_H, c[0], c[1], c[2], c[3]);
+}
+
+static void bench_ref_blend(int ox, int oy) {
+    (void)ox;
+    (void)oy;
+    ref_blend(0, 0, fb_target->width, fb_target->height, rgb565(30, 60, 200), 100);
+}
+
+static void new_blend(int ox, int oy) {
+    (void)ox;
+    (void)oy;
+    fb_blend_rect(0, 0, fb_target->width, fb_target->height, rgb565(30, 60, 200), 100);
+}
+
+// Lays the text out and blends every covered pixel with gfx_blend565().
+static const char bench_text[] = "Sphinx of black quartz,\njudge my vow! 0123456789";
+
+static void ref_label_font(const gfx_font_t *font, int ox, int oy) {
+    gfx_glyph_pos_t run[64];
+    size_t n = gfx_text_layout(font, 4 - ox, 20 - oy, bench_text, run, 64);
+    unsigned max = (1u << font->bpp) - 1;
+    for (size_t i = 0; i < n; ++i) {
+        const gfx_glyph_t *g = run[i].glyph;
+        int row_bytes = (g->w * font->bpp + 7) / 8;
+        for (int r = 0; r < g->h; ++r) {
+            for (int c = 0; c < g->w; ++c) {
+                int x = run[i].x + c, y = run[i].y + r, bit = c * font->bpp;
+                unsigned lvl = (font->bitmaps[g->offset + r * row_bytes + (bit >> 3)] >> (8 - font->bpp - (bit & 7))) & max;
+                if (!lvl || x < 0 || y < 0 || x >= fb_target->width || y >= fb_target->height) {
+                    continue;
+                }
+#if GFX_FB_INDEXED
+                uint16_t under = fb_target->palette->color[gfx_fb_get(fb_target, x, y)];
+#else
+                uint16_t under = gfx_fb_get(fb_target, x, y);
+#endif
+                uint16_t fg = rgb565(255, 230, 120);
+                uint8_t alpha = (uint8_t)((lvl * 255 + max / 2) / max);
+                fb_set_pixel(x, y, lvl == max ? fg : gfx_blend565(under, fg, alpha));
+            }
+        }
+    }
+}
+
+static void ref_label16(int ox, int oy) {
+    ref_label_font(&sans16, ox, oy);
+}
+
+static void new_label16(int ox, int oy) {
+    fb_draw_string(&sans16, 4 - ox, 20 - oy, bench_text, rgb565(255, 230, 120));
+}
+
+static void ref_label11(int ox, int oy) {
+    ref_label_font(&sans11, ox, oy);
+}
+
+static void new_label11(int ox, int oy) {
+    fb_draw_string(&sans11, 4 - ox, 20 - oy, bench_text, rgb565(255, 230, 120));
+}
+
+// --- Fills ---
+// The demo's original fills: a store per pixel, and fb_set_pixel() (bounds
+// check included) per pixel of a rect.
+static void ref_clear(uint16_t color) {
+    gfx_fb_t *fb = fb_target;
+    gfx_pixel_t v = gfx_fb_value(fb, color);
+    for (int y = 0; y < fb->height; ++y) {
+        for (int x = 0; x < fb->width; ++x) {
+            gfx_fb_put(fb, x, y, v);
+        }
+    }
+}
+
+static void ref_fill_rect(int x, int y, int w, int h, uint16_t color) {
+    for (int iy = 0; iy < h; ++iy) {
+        int yy = y + iy;
+        if (yy < 0 || yy >= fb_target->height) continue;
+        for (int ix = 0; ix < w; ++ix) {
+            int xx = x + ix;
+            if (xx < 0 || xx >= fb_target->width) continue;
+            fb_set_pixel(xx, yy, color);
+        }
+    }
+}
+
+// The demo's original 5x7 text: font5x7 read bit by bit per pixel, at 2x a
+// 2x2 rect per dot, and the character's box marked dirty.
+static void ref_char(int x, int y, char c, uint16_t fg, uint16_t bg, int scale) {
+    unsigned char u = (unsigned char)c;
+    if (u < 32 || u > 127) u = '?';
+    const uint8_t *glyph = font5x7[u - 32];
+    for (int row = 0; row < 7; ++row) {
+        for (int col = 0; col < 5; ++col) {
+            bool on = (glyph[col] >> row) & 0x01;
+            if (scale == 1) {
+                fb_set_pixel(x + col, y + row, on ? fg : bg);
+            } else {
+                ref_fill_rect(x + col * 2, y + row * 2, 2, 2, on ? fg : bg);
+            }
+        }
+        if (scale == 1) {
+            fb_set_pixel(x + 5, y + row, bg); // 1px spacing
+        } else {
+            ref_fill_rect(x + 10, y + row * 2, 2, 2, bg); // spacing column at 2x
+        }
+    }
+    fb_mark_dirty(x, y, FB_GLYPH_W * scale, FB_GLYPH_H * scale);
+}
+
+// Fills the frame with lines of text at scale 1 or 2; returns the characters drawn.
+static long text_screen(bool ref, int scale) {
+    static const char line[] = "The quick brown fox jumps over the lazy dog. 0123456789";
+    int cols = BENCH_W / (FB_GLYPH_W * scale), rows = BENCH_H / ((FB_GLYPH_H + 1) * scale);
+    long chars = 0;
+    for (int r = 0; r < rows; ++r) {
+        const char *text = &line[r % 8];
+        int y = r * (FB_GLYPH_H + 1) * scale;
+        uint16_t fg = rgb565(255, 255, (uint8_t)(r * 16)), bg = rgb565(0, 0, 64);
+        if (ref) {
+            for (int i = 0; i < cols; ++i) {
+                ref_char(i * FB_GLYPH_W * scale, y, text[i], fg, bg, scale);
+            }
+        } else {
+            char buf[64];
+            memcpy(buf, text, (size_t)cols);
+            buf[cols] = '\0';
+            fb_draw_text_scaled(0, y, buf, fg, bg, scale);
+        }
+        chars += cols;
+    }
+    return chars;
+}
+
+static bool text_bench(int scale, int iterations) {
+    memset(ref_px, 0x5A, sizeof(ref_px));
+    memset(out_px, 0x5A, sizeof(out_px));
+    fb_bind(&ref_fb);
+    text_screen(true, scale);
+    fb_bind(&out_fb);
+    text_screen(false, scale);
+    if (memcmp(ref_px, out_px, sizeof(ref_px)) != 0) {
+        printf("5x7 screen at %dx: differs from the per-pixel renderer\n", scale);
+        return false;
+    }
+    double ns[2];
+    for (int r = 0; r < 2; ++r) {
+        fb_bind(r ? &out_fb : &ref_fb);
+        long chars = 0;
+        double start = bench_now_ns();
+        for (int i = 0; i < iterations; ++i) {
+            chars += text_screen(r == 0, scale);
+        }
+        ns[r] = (bench_now_ns() - start) / (double)chars;
+    }
+    char name[32];
+    snprintf(name, sizeof(name), "5x7 screen at %dx", scale);
+    printf("%-18s %12.1f %12.1f %7.1fx  bit-exact\n", name, ns[0], ns[1], ns[0] / ns[1]);
+    return true;
+}
+
+typedef struct {
+    const char *name;
+    int w, h; // 0: full-screen clears
+} fill_case_t;
+
+#define FILL_RECTS 256
+
+// Draws the case's clears or FILL_RECTS rects (some clipped by the edges)
+// with the reference or the span fills; returns the pixels written.
+static long fill_run(const fill_case_t *fc, bool ref, uint32_t seed) {
+    long px = 0;
+    if (!fc->w) {
+        for (int i = 0; i < 4; ++i) {
+            uint16_t color = rgb565((uint8_t)(i * 60), 80, (uint8_t)(255 - i * 60));
+            ref ? ref_clear(color) : fb_clear(color);
+            px += (long)BENCH_W * BENCH_H;
+        }
+        return px;
+    }
+    for (int i = 0; i < FILL_RECTS; ++i) {
+        seed = seed * 1664525u + 1013904223u;
+        int x = (int)((seed >> 8) % (BENCH_W + fc->w)) - fc->w / 2;
+        int y = (int)((seed >> 20) % (BENCH_H + fc->h)) - fc->h / 2;
+        uint16_t color = (uint16_t)(seed >> 4);
+        ref ? ref_fill_rect(x, y, fc->w, fc->h, color) : fb_fill_rect(x, y, fc->w, fc->h, color);
+        int x0 = x < 0 ? 0 : x, y0 = y < 0 ? 0 : y;
+        int x1 = x + fc->w > BENCH_W ? BENCH_W : x + fc->w, y1 = y + fc->h > BENCH_H ? BENCH_H : y + fc->h;
+        px += (long)(x1 - x0) * (y1 - y0);
+    }
+    return px;
+}
+
+// Checks the case bit for bit, then prints reference and span-fill rates.
+static bool fill_bench(const fill_case_t *fc, int iterations) {
+    memset(ref_px, 0x5A, sizeof(ref_px));
+    memset(out_px, 0x5A, sizeof(out_px));
+    fb_bind(&ref_fb);
+    fill_run(fc, true, 7);
+    fb_bind(&out_fb);
+    fill_run(fc, false, 7);
+    for (int y = 0; y < BENCH_H; ++y) {
+        for (int x = 0; x < BENCH_W; ++x) {
+            if (gfx_fb_get(&ref_fb, x, y) != gfx_fb_get(&out_fb, x, y)) {
+                printf("%s: mismatch at (%d, %d): ref 0x%04x, got 0x%04x\n", fc->name, x, y,
+                       (unsigned)gfx_fb_get(&ref_fb, x, y), (unsigned)gfx_fb_get(&out_fb, x, y));
+                return false;
+            }
+        }
+    }
+    double rate[2];
+    for (int r = 0; r < 2; ++r) {
+        fb_bind(r ? &out_fb : &ref_fb);
+        long px = 0;
+        double start = bench_now_ns();
+        for (int i = 0; i < iterations; ++i) {
+            px += fill_run(fc, r == 0, (uint32_t)i);
+        }
+        rate[r] = (double)px / (bench_now_ns() - start) * 1e3; // Mpx/s
+    }
+    printf("%-18s %12.1f %12.1f %7.1fx  bit-exact\n", fc->name, rate[0], rate[1], rate[1] / rate[0]);
+    return true;
+}
+
+// --- Harness ---
+typedef void (*bench_fn)(int ox, int oy);
+
+typedef struct {
+    const char *name;
+    bench_fn ref, fn;
+    bool needs_base; // draws over the previous contents
+} bench_case_t;
+
+static void bench_run(gfx_fb_t *fb, bench_fn fn, int band) {
+    for (int y0 = 0; y0 < BENCH_H; y0 += band) {
+        gfx_rect_t r = { 0, (int16_t)y0, BENCH_W, (int16_t)(y0 + band < BENCH_H ? y0 + band : BENCH_H) };
+        gfx_fb_t view;
+        gfx_fb_view(&view, fb, &r);
+        fb_bind(&view);
+        fn(r.x0, r.y0);
+    }
+}
+
+// Fills both frames with the gradient so blends have varied pixels to mix.
+static void bench_base(void) {
+    fb_bind(&ref_fb);
+    bench_ref_gradient(0, 0);
+    memcpy(out_px, ref_px, sizeof(ref_px));
+}
+
+static bool bench_check(const bench_case_t *bc) {
+    static const int bands[] = { BENCH_H, 16, 7, 1 };
+    for (size_t i = 0; i < sizeof(bands) / sizeof(bands[0]); ++i) {
+        if (bc->needs_base) {
+            bench_base();
+        } else {
+            memset(ref_px, 0x5A, sizeof(ref_px));
+            memset(out_px, 0xA5, sizeof(out_px));
+        }
+        bench_run(&ref_fb, bc->ref, bands[i]);
+        bench_run(&out_fb, bc->fn, bands[i]);
+        for (int y = 0; y < BENCH_H; ++y) {
+            for (int x = 0; x < BENCH_W; ++x) {
+                if (gfx_fb_get(&ref_fb, x, y) != gfx_fb_get(&out_fb, x, y)) {
+                    printf("%s: mismatch at (%d, %d) in %d-line bands: ref 0x%04x, got 0x%04x\n", bc->name, x, y,
+                           bands[i], (unsigned)gfx_fb_get(&ref_fb, x, y), (unsigned)gfx_fb_get(&out_fb, x, y));
+                    return false;
+                }
+            }
+        }
+    }
+    return true;
+}
+
+static double bench_time(gfx_fb_t *fb, bench_fn fn, int iterations) {
+    double start = bench_now_ns();
+    for (int i = 0; i < iterations; ++i) {
+        bench_run(fb, fn, BENCH_H);
+    }
+    return (bench_now_ns() - start) / ((double)iterations * BENCH_W * BENCH_H);
+}
+
+// Encodes fb in chunks of at most cap bytes, decodes the stream and compares
+// it with the frame read in order from first_row. Returns the stream size, or
+// 0 on a mismatch.
+static uint8_t snap_buf[BENCH_W * BENCH_H * 3];
+
+static size_t snap_check(const gfx_fb_t *fb, size_t cap, int first_row) {
+    gfx_snap_t snap;
+    gfx_snap_begin(&snap, fb, first_row);
+    size_t len = 0, n;
+    while ((n = gfx_snap_read(&snap, &snap_buf[len], cap)) > 0) {
+        if (n > cap) {
+            printf("snapshot: chunk of %zu bytes exceeds %zu\n", n, cap);
+            return 0;
+        }
+        len += n;
+    }
+    if (snap.bytes != len || snap.crc != gfx_crc32(0, snap_buf, len)) {
+        printf("snapshot: byte count or CRC out of step with the stream\n");
+        return 0;
+    }
+    static uint8_t want[BENCH_W * 2];
+    size_t pos = 0;
+    for (int r = 0; r < fb->height; ++r) {
+        int y = (first_row + r) % fb->height;
+        gfx_fb_expand_wire(fb, 0, y, (size_t)fb->width, want);
+        for (int x = 0; x < fb->width;) {
+            if (pos >= len) {
+                printf("snapshot: stream ends at row %d\n", r);
+                return 0;
+            }
+            uint8_t token = snap_buf[pos++];
+            int count = (token & 0x7F) + 1;
+            for (int i = 0; i < count; ++i, ++x) {
+                const uint8_t *px = &snap_buf[(token & 0x80) ? pos : pos + 2 * (size_t)i];
+                if (x >= fb->width || px[0] != want[2 * x] || px[1] != want[2 * x + 1]) {
+                    printf("snapshot: mismatch at (%d, %d), %zu-byte chunks from row %d\n", x, y, cap, first_row);
+                    return 0;
+                }
+            }
+            pos += (token & 0x80) ? 2 : 2 * (size_t)count;
+        }
+    }
+    return pos == len ? len : 0;
+}
+
+static bool snap_bench(const char *name, const gfx_fb_t *fb, int iterations) {
+    static const size_t caps[] = { 3, 4, 48, sizeof(snap_buf) };
+    static const int rows[] = { 0, 37 };
+    size_t len = 0;
+    for (size_t c = 0; c < sizeof(caps) / sizeof(caps[0]); ++c) {
+        for (size_t r = 0; r < sizeof(rows) / sizeof(rows[0]); ++r) {
+            if (!(len = snap_check(fb, caps[c], rows[r]))) {
+                return false;
+            }
+        }
+    }
+    double start = bench_now_ns();
+    for (int i = 0; i < iterations; ++i) {
+        gfx_snap_t snap;
+        gfx_snap_begin(&snap, fb, 0);
+        while (gfx_snap_read(&snap, snap_buf, 48)) {
+        }
+    }
+    double ns = (bench_now_ns() - start) / ((double)iterations * BENCH_W * BENCH_H);
+    printf("%-26s %10zu %7.1f%% %8.2f  round-trip ok\n", name, len, 100.0 * len / (BENCH_W * BENCH_H * 2), ns);
+    return true;
+}
+
+int main(int argc, char **argv) {
+    int iterations = argc > 1 ? atoi(argv[1]) : 200;
+    if (iterations < 1) {
+        iterations = 1;
+    }
+    gfx_fb_init(&ref_fb, ref_px, BENCH_W, BENCH_H);
+    gfx_fb_init(&out_fb, out_px, BENCH_W, BENCH_H);
+
+    static const bench_case_t cases[] = {
+        { "gradient", bench_ref_gradient, new_gradient, false },
+        { "corners", bench_ref_corners, new_corners, false },
+        { "blend", bench_ref_blend, new_blend, true },
+        { "sans16", ref_label16, new_label16, true },
+        { "sans11", ref_label11, new_label11, true },
+    };
+    printf("%dx%d, %d bpp, %d iterations\n", BENCH_W, BENCH_H, GFX_FB_BPP, iterations);
+    printf("%-10s %12s %12s %8s\n", "kernel", "ref ns/px", "new ns/px", "speedup");
+    int failed = 0;
+    for (size_t i = 0; i < sizeof(cases) / sizeof(cases[0]); ++i) {
+        const bench_case_t *bc = &cases[i];
+        if (!bench_check(bc)) {
+            failed = 1;
+            continue;
+        }
+        double ref = bench_time(&ref_fb, bc->ref, iterations);
+        double fn = bench_time(&out_fb, bc->fn, iterations);
+        printf("%-10s %12.2f %12.2f %7.1fx  bit-exact\n", bc->name, ref, fn, ref / fn);
+    }
+
+    // Fill rates in Mpx/s; rects are placed at random, partly off the edges.
+    static const fill_case_t fills[] = {
+        { "full-screen clear", 0, 0 },
+        { "rects 4x4", 4, 4 },
+        { "rects 12x12", 12, 12 },
+        { "rects 40x24", 40, 24 },
+    };
+    printf("\n%-18s %12s %12s %8s\n", "fill", "ref Mpx/s", "new Mpx/s", "speedup");
+    for (size_t i = 0; i < sizeof(fills) / sizeof(fills[0]); ++i) {
+        if (!fill_bench(&fills[i], iterations)) {
+            failed = 1;
+        }
+    }
+
+    // Glyph blits, per character of a screen full of text.
+    printf("\n%-18s %12s %12s %8s\n", "glyph blit", "ref ns/char", "new ns/char", "speedup");
+    for (int scale = 1; scale <= 2; ++scale) {
+        if (!text_bench(scale, iterations)) {
+            failed = 1;
+        }
+    }
+
+    // Text throughput, per character drawn (the line box is included in the
+    // solid-background timings).
+    static const char line[] = "The quick brown fox jumps over the lazy dog";
+    size_t chars = sizeof(line) - 1;
+    uint16_t fg = rgb565(255, 255, 255), bg = rgb565(0, 0, 64);
+    fb_bind(&out_fb);
+    printf("\n%-26s %10s\n", "text", "ns/char");
+    double start = bench_now_ns();
+    for (int i = 0; i < iterations * 10; ++i) {
+        fb_draw_text_scaled(0, 40, line, fg, bg, 2);
+    }
+    printf("%-26s %10.1f\n", "5x7 at 2x, on bg", (bench_now_ns() - start) / ((double)iterations * 10 * chars));
+    const gfx_font_t *fonts[] = { &sans16, &sans11 };
+    const char *names[] = { "sans16", "sans11" };
+    for (int f = 0; f < 2; ++f) {
+        char label[32];
+        start = bench_now_ns();
+        for (int i = 0; i < iterations * 10; ++i) {
+            fb_draw_string_bg(fonts[f], 0, 40, line, fg, bg);
+        }
+        snprintf(label, sizeof(label), "%s, on bg", names[f]);
+        printf("%-26s %10.1f\n", label, (bench_now_ns() - start) / ((double)iterations * 10 * chars));
+        start = bench_now_ns();
+        for (int i = 0; i < iterations * 10; ++i) {
+            fb_draw_string(fonts[f], 0, 40, line, fg);
+        }
+        snprintf(label, sizeof(label), "%s, blended", names[f]);
+        printf("%-26s %10.1f\n", label, (bench_now_ns() - start) / ((double)iterations * 10 * chars));
+        int w, h;
+        start = bench_now_ns();
+        for (int i = 0; i < iterations * 10; ++i) {
+            gfx_text_measure(fonts[f], line, &w, &h);
+        }
+        snprintf(label, sizeof(label), "%s, measure only", names[f]);
+        printf("%-26s %10.1f  (%dx%d)\n", label, (bench_now_ns() - start) / ((double)iterations * 10 * chars), w, h);
+    }
+
+    // Snapshot size and encode time, for a page-like frame (flat fill, text
+    // and a frame) and for the gradient, where few neighbours match.
+    printf("\n%-26s %10s %8s %8s\n", "snapshot", "bytes", "of raw", "ns/px");
+    fb_bind(&out_fb);
+    fb_clear(rgb565(8, 16, 32));
+    fb_draw_text_scaled(8, 10, "RP2350-GEEK", rgb565(255, 215, 64), rgb565(8, 16, 32), 2);
+    fb_draw_string(&sans16, 8, 34, line, fg);
+    fb_draw_string(&sans11, 8, 104, line, rgb565(140, 160, 190));
+    fb_draw_rect(4, 4, BENCH_W - 8, BENCH_H - 8, rgb565(64, 96, 160));
+    if (!snap_bench("text page", &out_fb, iterations)) {
+        failed = 1;
+    }
+    fb_bind(&ref_fb);
+    bench_ref_gradient(0, 0);
+    if (!snap_bench("gradient", &ref_fb, iterations)) {
+        failed = 1;
+    }
+    return failed;
+}
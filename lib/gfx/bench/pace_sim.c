@@ -0,0 +1,307 @@
+// Host simulation of frame pacing (gfx/pace.h).
+//
+// Drives a gfx_pacer_t the way the double-buffered demo does: the render side
+// starts the next frame as soon as the previous one is handed to the flush
+// engine, and every vsync tick asks the pacer whether to flush. Time is
+// simulated, so each scenario (render costs, flush length, tick period and
+// jitter) runs ten seconds in no time. Each one is checked for:
+//  - frames flushed only on slot ticks, never between them;
+//  - every slot accounted for, as a presented frame or a drop;
+//  - without jitter, exactly the drops that the render and flush times force
+//    (a frame needs max(render, flush) rounded up to whole slots);
+//  - latency from starting a frame to its flush staying bounded, so late
+//    frames are dropped rather than the timeline drifting.
+// A last scenario runs the two-buffer handoff itself (gfx/swap.h) on small
+// frames: before the first slot, quick frames supersede each other, and
+// every flush must leave the simulated panel identical to the front frame,
+// superseded damage included.
+// Exits non-zero if a check fails.
+//
+// Built with the host library (-DRP2350_GEEK_HOST_BUILD=ON); run gfx_pace_sim.
+#include <stdio.h>
+#include <string.h>
+
+#include "gfx/pace.h"
+#include "gfx/swap.h"
+
+#define SIM_US (10u * 1000u * 1000u)
+
+typedef struct {
+    const char *name;
+    uint32_t tick_us;   // vsync period
+    uint32_t jitter_us; // +/- on each tick (TE from a free-running panel)
+    uint16_t ticks_per_frame;
+    uint32_t flush_us;
+    uint32_t (*render_us)(uint32_t frame);
+} sim_case_t;
+
+static uint32_t render_light(uint32_t frame) {
+    (void)frame;
+    return 8000;
+}
+
+static uint32_t render_heavy(uint32_t frame) {
+    (void)frame;
+    return 40000;
+}
+
+static uint32_t render_spikes(uint32_t frame) {
+    return frame % 10 == 9 ? 70000 : 10000;
+}
+
+static uint32_t render_quick(uint32_t frame) {
+    (void)frame;
+    return 5000;
+}
+
+static uint32_t render_mid(uint32_t frame) {
+    (void)frame;
+    return 20000;
+}
+
+static uint32_t sim_rand(uint32_t *state) {
+    *state = *state * 1664525u + 1013904223u;
+    return *state >> 8;
+}
+
+static uint32_t render_random(uint32_t frame) {
+    uint32_t s = frame * 2654435761u;
+    return 5000 + sim_rand(&s) % 20000;
+}
+
+static uint32_t div_ceil(uint32_t a, uint32_t b) {
+    return (a + b - 1) / b;
+}
+
+static bool sim_run(const sim_case_t *sc) {
+    gfx_pacer_t pacer;
+    gfx_pacer_init(&pacer, sc->ticks_per_frame);
+    uint32_t slot_us = sc->tick_us * sc->ticks_per_frame;
+
+    uint32_t frame = 0, cost = sc->render_us(0);
+    uint64_t begin_us = 0, ready_us = cost, busy_until = 0;
+    bool submitted = false;
+    uint32_t expected_dropped = 0, bad_slot = 0, last_slot = 0;
+    uint32_t latency_bound = 0;
+    gfx_pacer_begin(&pacer, 0);
+
+    uint32_t seed = 1;
+    for (uint32_t k = 1;; ++k) {
+        uint64_t t = (uint64_t)k * sc->tick_us;
+        if (sc->jitter_us) {
+            t = t + sim_rand(&seed) % (2 * sc->jitter_us + 1) - sc->jitter_us;
+        }
+        if (t > SIM_US) {
+            break;
+        }
+        if (!submitted && ready_us <= t) {
+            gfx_pacer_submit(&pacer, ready_us);
+            submitted = true;
+        }
+        if (!gfx_pacer_tick(&pacer, t, busy_until <= t)) {
+            continue;
+        }
+        // Presented: check it landed on a slot and predict the slots the
+        // frame needed from its render and the previous flush.
+        if (k % sc->ticks_per_frame) {
+            bad_slot++;
+        }
+        uint32_t needed = 1;
+        if (!sc->jitter_us) {
+            needed = div_ceil(cost, slot_us);
+            needed = needed > 1 ? needed : 1;
+            uint32_t flush_slots = frame ? div_ceil(sc->flush_us, slot_us) : 1;
+            needed = needed > flush_slots ? needed : flush_slots;
+            expected_dropped += needed - 1;
+        }
+        uint32_t bound = (cost > sc->flush_us ? cost : sc->flush_us) + slot_us + 2 * sc->jitter_us;
+        latency_bound = latency_bound > bound ? latency_bound : bound;
+        last_slot = pacer.slot;
+
+        // The flush starts now and frees the other buffer: start the next frame.
+        busy_until = t + sc->flush_us;
+        frame++;
+        cost = sc->render_us(frame);
+        begin_us = t;
+        ready_us = begin_us + cost;
+        submitted = false;
+        gfx_pacer_begin(&pacer, begin_us);
+    }
+
+    gfx_pace_stats_t st;
+    gfx_pacer_take_stats(&pacer, &st);
+    bool ok = !bad_slot && st.frames + st.dropped == last_slot && st.latency_max_us <= latency_bound;
+    if (!sc->jitter_us && st.dropped != expected_dropped) {
+        ok = false;
+    }
+    double fps = st.frames * 1e6 / SIM_US;
+    double mean_ms = st.latency_count ? (double)st.latency_sum_us / st.latency_count / 1000.0 : 0.0;
+    printf("%-20s %6.1f %7lu %7lu %8.1f %8.1f %8.1f  %s\n", sc->name, fps, (unsigned long)st.frames,
+           (unsigned long)st.dropped, mean_ms, st.latency_max_us / 1000.0, st.render_max_us / 1000.0,
+           ok ? "ok" : "FAIL");
+    if (!ok) {
+        printf("  off-slot %lu, slots %lu, expected drops %lu, latency bound %.1f ms\n", (unsigned long)bad_slot,
+               (unsigned long)last_slot, (unsigned long)expected_dropped, latency_bound / 1000.0);
+    }
+    return ok;
+}
+
+// --- Supersede ---
+// Mirrors the demo's double buffering: the render side presents a frame by
+// remembering its damage, handing its index over and continuing in a freed
+// buffer once it has copied that damage in; the flush side takes the pending
+// frame at a slot, and a flush copies the frame's dirty rects to the panel.
+// The first slot comes after a random panel start-up delay, so each round
+// begins with a run of superseded frames.
+#define SS_W 48
+#define SS_H 30
+#define SS_ROUNDS 200
+#define SS_ROUND_US 300000u
+
+typedef struct {
+    gfx_fb_t frames[2];
+    gfx_pixel_t pixels[2][GFX_FB_LEN(SS_W, SS_H)];
+    gfx_pixel_t panel[GFX_FB_LEN(SS_W, SS_H)];
+    gfx_swap_t swap;
+    int free_idx[2], free_count;
+    uint32_t superseded, overflowed, stale, flushes;
+} ss_state_t;
+
+static void ss_draw(ss_state_t *st, uint32_t *seed, bool first) {
+    if (first || sim_rand(seed) % 20 == 0) {
+        fb_clear((uint16_t)sim_rand(seed));
+        return;
+    }
+    int n = 1 + (int)(sim_rand(seed) % 10);
+    for (int i = 0; i < n; ++i) {
+        int x = (int)(sim_rand(seed) % SS_W), y = (int)(sim_rand(seed) % SS_H);
+        int w = 1 + (int)(sim_rand(seed) % 12), h = 1 + (int)(sim_rand(seed) % 8);
+        fb_draw_rect(x, y, w, h, (uint16_t)sim_rand(seed));
+    }
+    (void)st;
+}
+
+static void ss_free(ss_state_t *st, int idx) {
+    if (idx >= 0) {
+        st->free_idx[st->free_count++] = idx;
+    }
+}
+
+static void ss_round(ss_state_t *st, uint32_t round) {
+    memset(st, 0, sizeof(*st));
+    for (int i = 0; i < 2; ++i) {
+        gfx_fb_init(&st->frames[i], st->pixels[i], SS_W, SS_H);
+    }
+    memset(st->panel, 0xA5, sizeof(st->panel));
+    gfx_swap_init(&st->swap, st->frames);
+    gfx_pacer_t pacer;
+    gfx_pacer_init(&pacer, 2);
+
+    uint32_t seed = 0x9E3779B9u ^ round;
+    const uint32_t tick_us = 16667;
+    uint64_t busy_until = sim_rand(&seed) % 120000; // panel start-up
+    st->free_idx[0] = 1;
+    st->free_count = 1;
+
+    // Render side: drawing frame `cur` until ready_us, or waiting (cur < 0).
+    int cur = 0;
+    gfx_rect_t carry[GFX_DIRTY_MAX];
+    uint8_t carry_count = 0;
+    const gfx_fb_t *done = NULL;
+    fb_bind(&st->frames[0]);
+    ss_draw(st, &seed, true);
+    uint64_t now = 0, ready_us = 1000 + sim_rand(&seed) % 4000;
+    gfx_pacer_begin(&pacer, 0);
+
+    for (uint32_t k = 1; (uint64_t)k * tick_us <= SS_ROUND_US; ++k) {
+        uint64_t t = (uint64_t)k * tick_us;
+        for (;;) {
+            if (cur >= 0 && ready_us <= t) {
+                gfx_fb_t *fb = &st->frames[cur];
+                carry_count = fb->dirty_count;
+                memcpy(carry, fb->dirty, carry_count * sizeof(gfx_rect_t));
+                done = fb;
+                gfx_fb_t *pending = st->swap.pending >= 0 ? &st->frames[st->swap.pending] : NULL;
+                if (pending) {
+                    st->superseded++;
+                    if (pending->dirty_count + fb->dirty_count > GFX_DIRTY_MAX) {
+                        st->overflowed++;
+                    }
+                }
+                ss_free(st, gfx_swap_ready(&st->swap, cur));
+                gfx_pacer_submit(&pacer, ready_us);
+                now = ready_us;
+                cur = -1;
+            }
+            if (cur < 0 && st->free_count) {
+                cur = st->free_idx[0];
+                st->free_idx[0] = st->free_idx[1];
+                st->free_count--;
+                fb_bind(&st->frames[cur]);
+                gfx_fb_copy_rects(fb_target, done, carry, carry_count);
+                gfx_pacer_begin(&pacer, now);
+                ss_draw(st, &seed, false);
+                ready_us = now + 1000 + sim_rand(&seed) % 4000;
+                continue;
+            }
+            break;
+        }
+
+        int prev;
+        if (!gfx_pacer_tick(&pacer, t, busy_until <= t) || !gfx_swap_flip(&st->swap, &prev)) {
+            continue;
+        }
+        gfx_fb_t *front = &st->frames[st->swap.front];
+        gfx_fb_t panel;
+        gfx_fb_init(&panel, st->panel, SS_W, SS_H);
+        gfx_fb_copy_rects(&panel, front, front->dirty, front->dirty_count);
+        front->dirty_count = 0;
+        st->flushes++;
+        if (memcmp(st->panel, front->pixels, sizeof(st->panel)) != 0) {
+            st->stale++;
+        }
+        busy_until = t + 8000;
+        now = t;
+        ss_free(st, prev);
+    }
+}
+
+static bool sim_supersede(void) {
+    static ss_state_t st;
+    uint32_t superseded = 0, overflowed = 0, stale = 0, flushes = 0;
+    for (uint32_t r = 0; r < SS_ROUNDS; ++r) {
+        ss_round(&st, r);
+        superseded += st.superseded;
+        overflowed += st.overflowed;
+        stale += st.stale;
+        flushes += st.flushes;
+    }
+    bool ok = superseded && overflowed && !stale;
+    printf("%-20s %lu flushes, %lu superseded (%lu past %d rects), %lu stale  %s\n", "supersede",
+           (unsigned long)flushes, (unsigned long)superseded, (unsigned long)overflowed, GFX_DIRTY_MAX,
+           (unsigned long)stale, ok ? "ok" : "FAIL");
+    return ok;
+}
+
+int main(void) {
+    static const sim_case_t cases[] = {
+        { "30 fps, 8 ms render", 16667, 0, 2, 13000, render_light },
+        { "30 fps, 40 ms render", 16667, 0, 2, 13000, render_heavy },
+        { "30 fps, 70 ms spikes", 16667, 0, 2, 13000, render_spikes },
+        { "30 fps, 38 ms flush", 16667, 0, 2, 38000, render_quick },
+        { "30 fps, TE 59 Hz", 16950, 300, 2, 13000, render_mid },
+        { "60 fps, 5-25 ms", 16667, 0, 1, 13000, render_random },
+    };
+    printf("%-20s %6s %7s %7s %8s %8s %8s\n", "scenario", "fps", "frames", "dropped", "lat ms", "lat max",
+           "rnd max");
+    int failed = 0;
+    for (size_t i = 0; i < sizeof(cases) / sizeof(cases[0]); ++i) {
+        if (!sim_run(&cases[i])) {
+            failed = 1;
+        }
+    }
+    if (!sim_supersede()) {
+        failed = 1;
+    }
+    return failed;
+}
@@ -0,0 +1,182 @@
+// Host test of the indexed-framebuffer palette (gfx/palette.h).
+//
+//  - gfx_palette_default() holds the RGB332 cube (8bpp) or the VGA colours
+//    (4bpp) before anything has initialised it, and gfx_palette_init_default()
+//    copies the same entries;
+//  - gfx_palette_index() returns the RGB332 cell at 8bpp and the closest
+//    entry at 4bpp, with or without a memo, for random colours;
+//  - two framebuffers sharing a palette keep separate memos that never answer
+//    for each other, and a memo is dropped when the palette changes or the
+//    frame is pointed at another palette.
+// Exits non-zero if a check fails.
+//
+// Built with the host library in an indexed configuration
+// (-DRP2350_GEEK_GFX_BPP=8 or 4); run gfx_palette_test.
+#include <stdio.h>
+
+#include "gfx/fb.h"
+
+#define TEST_W 16
+#define TEST_H 4
+
+#include "test_util.h"
+
+static gfx_pixel_t a_px[GFX_FB_LEN(TEST_W, TEST_H)];
+static gfx_pixel_t b_px[GFX_FB_LEN(TEST_W, TEST_H)];
+static gfx_fb_t a_fb, b_fb;
+
+#if GFX_FB_BPP == 4
+static int32_t color_distance(uint16_t x, uint16_t y) {
+    x = RGB565_LOAD(x);
+    y = RGB565_LOAD(y);
+    int dr = ((x >> 11) - (y >> 11)) * 2, dg = ((x >> 5) & 0x3F) - ((y >> 5) & 0x3F);
+    int db = ((x & 0x1F) - (y & 0x1F)) * 2;
+    return dr * dr + dg * dg + db * db;
+}
+#endif
+
+// The index color should be drawn with, worked out the long way.
+static uint8_t ref_index(const gfx_palette_t *pal, uint16_t color) {
+#if GFX_FB_BPP == 8
+    (void)pal;
+    uint16_t c = RGB565_LOAD(color);
+    return (uint8_t)((c >> 13) << 5 | ((c >> 8) & 0x07) << 2 | ((c >> 3) & 0x03));
+#else
+    uint8_t best = 0;
+    for (unsigned i = 1; i < GFX_PALETTE_SIZE; ++i) {
+        if (color_distance(pal->color[i], color) < color_distance(pal->color[best], color)) {
+            best = (uint8_t)i;
+        }
+    }
+    return best;
+#endif
+}
+
+static bool test_default(void) {
+    const gfx_palette_t *pal = gfx_palette_default();
+#if GFX_FB_BPP == 8
+    for (unsigned i = 0; i < GFX_PALETTE_SIZE; ++i) {
+        uint16_t want = rgb565((uint8_t)((i >> 5) * 255 / 7), (uint8_t)(((i >> 2) & 7) * 255 / 7),
+                               (uint8_t)((i & 3) * 255 / 3));
+        if (pal->color[i] != want) {
+            printf("default: entry %u is 0x%04x, want 0x%04x\n", i, pal->color[i], want);
+            return false;
+        }
+    }
+#else
+    static const struct {
+        uint8_t index, r, g, b;
+    } want[] = {
+        { 0, 0x00, 0x00, 0x00 }, { 1, 0x00, 0x00, 0xAA }, { 6, 0xAA, 0x55, 0x00 },
+        { 8, 0x55, 0x55, 0x55 }, { 12, 0xFF, 0x55, 0x55 }, { 15, 0xFF, 0xFF, 0xFF },
+    };
+    for (size_t i = 0; i < sizeof(want) / sizeof(want[0]); ++i) {
+        uint16_t c = rgb565(want[i].r, want[i].g, want[i].b);
+        if (pal->color[want[i].index] != c) {
+            printf("default: entry %u is 0x%04x, want 0x%04x\n", want[i].index, pal->color[want[i].index], c);
+            return false;
+        }
+    }
+#endif
+    gfx_palette_t copy = { 0 };
+    gfx_palette_init_default(&copy);
+    for (unsigned i = 0; i < GFX_PALETTE_SIZE; ++i) {
+        if (copy.color[i] != pal->color[i]) {
+            printf("default: init_default entry %u is 0x%04x, default 0x%04x\n", i, copy.color[i], pal->color[i]);
+            return false;
+        }
+    }
+    return true;
+}
+
+static bool test_index(void) {
+    const gfx_palette_t *pal = gfx_palette_default();
+    gfx_palette_memo_t memo = { 0 };
+    uint32_t seed = 11;
+    for (int i = 0; i < 5000; ++i) {
+        // Repeat colours now and then so the memo answers some of them.
+        uint16_t color = (uint16_t)test_rand(&seed);
+        if (i % 3 == 0) {
+            color = (uint16_t)(color & 0xF81F);
+        }
+        uint8_t want = ref_index(pal, color);
+        uint8_t plain = gfx_palette_index(pal, NULL, color);
+        uint8_t memoised = gfx_palette_index(pal, &memo, color);
+        uint8_t again = gfx_palette_index(pal, &memo, color);
+        if (plain != want || memoised != want || again != want) {
+            printf("index: 0x%04x gives %u, %u with a memo, %u again; want %u\n", color, plain, memoised, again,
+                   want);
+            return false;
+        }
+    }
+    return true;
+}
+
+static bool frame_holds(const char *what, gfx_fb_t *fb, uint8_t want) {
+    gfx_pixel_t v = gfx_fb_get(fb, TEST_W - 1, TEST_H - 1);
+    if (v != want) {
+        printf("memo: %s: frame holds %u, want %u\n", what, (unsigned)v, want);
+        return false;
+    }
+    return true;
+}
+
+static bool test_memo(void) {
+    gfx_palette_t pal, other;
+    gfx_palette_init_default(&pal);
+    gfx_palette_init_default(&other);
+    gfx_fb_init(&a_fb, a_px, TEST_W, TEST_H);
+    gfx_fb_init(&b_fb, b_px, TEST_W, TEST_H);
+    a_fb.palette = &pal;
+    b_fb.palette = &pal;
+
+    // Alternate two colours between the frames: each frame's memo holds its
+    // own colour, so neither one's answer leaks into the other.
+    uint16_t red = rgb565(250, 20, 20), blue = rgb565(20, 20, 250);
+    for (int i = 0; i < 4; ++i) {
+        fb_bind(&a_fb);
+        fb_clear(red);
+        fb_bind(&b_fb);
+        fb_clear(blue);
+        if (!frame_holds("red frame", &a_fb, ref_index(&pal, red)) ||
+            !frame_holds("blue frame", &b_fb, ref_index(&pal, blue))) {
+            return false;
+        }
+    }
+
+    // Move the memoised colour's entry away: at 4bpp the same colour now maps
+    // elsewhere, so the memo must not answer. At 8bpp the cell stays put.
+    uint8_t was = ref_index(&pal, red);
+    gfx_palette_set(&pal, was, rgb565(0, 255, 0));
+    fb_bind(&a_fb);
+    fb_clear(red);
+    if (!frame_holds("after set", &a_fb, ref_index(&pal, red))) {
+        return false;
+    }
+#if GFX_FB_BPP == 4
+    if (ref_index(&pal, red) == was) {
+        printf("memo: re-colouring entry %u left red on it\n", was);
+        return false;
+    }
+#endif
+
+    // Same colour, same generation, different palette.
+    other.gen = pal.gen;
+    a_fb.palette = &other;
+    fb_clear(red);
+    if (!frame_holds("other palette", &a_fb, ref_index(&other, red))) {
+        return false;
+    }
+    a_fb.palette = &pal;
+    fb_clear(red);
+    return frame_holds("palette back", &a_fb, ref_index(&pal, red));
+}
+
+int main(void) {
+    static const test_case_t tests[] = {
+        { "default", test_default },
+        { "index", test_index },
+        { "memo", test_memo },
+    };
+    return test_run_all(tests, sizeof(tests) / sizeof(tests[0]));
+}
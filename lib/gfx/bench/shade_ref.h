@@ -0,0 +1,95 @@
+#pragma once
+
+#include <stdint.h>
+
+#include "gfx/fb.h"
+#include "gfx/shade.h"
+
+// Per-pixel references for the shading kernels (gfx/shade.h), shared by
+// gfx_bench and gfx_shade_test. Each works a pixel out on its own with
+// divisions rounded down, and writes it with fb_set_pixel() to fb_target,
+// over the part of the rect inside the frame.
+
+static inline int32_t ref_floor_div(int64_t n, int64_t d) {
+    int64_t q = n / d;
+    return (int32_t)(q * d > n ? q - 1 : q);
+}
+
+static inline int32_t ref_ramp_at(const gfx_ramp_t *r, int x, int y) {
+    return r->c0 + ref_floor_div((int64_t)r->dx * x + (int64_t)r->dy * y, r->den);
+}
+
+// The rect clipped to fb_target.
+typedef struct {
+    int x0, y0, x1, y1;
+} ref_clip_t;
+
+static inline ref_clip_t ref_clip(int x, int y, int w, int h) {
+    ref_clip_t c = { x > 0 ? x : 0, y > 0 ? y : 0, x + w, y + h };
+    c.x1 = c.x1 < fb_target->width ? c.x1 : fb_target->width;
+    c.y1 = c.y1 < fb_target->height ? c.y1 : fb_target->height;
+    return c;
+}
+
+static inline void ref_gradient(int x, int y, int w, int h, const gfx_gradient_t *g) {
+    ref_clip_t k = ref_clip(x, y, w, h);
+    for (int py = k.y0; py < k.y1; ++py) {
+        for (int px = k.x0; px < k.x1; ++px) {
+            int gx = px - g->x0, gy = py - g->y0;
+            fb_set_pixel(px, py, rgb565((uint8_t)ref_ramp_at(&g->r, gx, gy), (uint8_t)ref_ramp_at(&g->g, gx, gy),
+                                        (uint8_t)ref_ramp_at(&g->b, gx, gy)));
+        }
+    }
+}
+
+// Channel c (0 red, 1 green, 2 blue) of an RGB565 colour widened to 8 bits.
+static inline int32_t ref_channel(uint16_t color, int c) {
+    uint16_t v = RGB565_LOAD(color);
+    int32_t r = v >> 11, g = (v >> 5) & 0x3F, b = v & 0x1F;
+    return c == 0 ? (r << 3) | (r >> 2) : c == 1 ? (g << 2) | (g >> 4) : (b << 3) | (b >> 2);
+}
+
+// c: top left, top right, bottom left, bottom right. Down the left and right
+// edges, then across.
+static inline void ref_corners(int x, int y, int w, int h, const uint16_t c[4]) {
+    int dw = w > 1 ? w - 1 : 1, dh = h > 1 ? h - 1 : 1;
+    ref_clip_t k = ref_clip(x, y, w, h);
+    for (int py = k.y0; py < k.y1; ++py) {
+        for (int px = k.x0; px < k.x1; ++px) {
+            int32_t v[3];
+            for (int ch = 0; ch < 3; ++ch) {
+                int32_t tl = ref_channel(c[0], ch), tr = ref_channel(c[1], ch);
+                int32_t bl = ref_channel(c[2], ch), br = ref_channel(c[3], ch);
+                int32_t l = tl + ref_floor_div((int64_t)(bl - tl) * (py - y), dh);
+                int32_t r = tr + ref_floor_div((int64_t)(br - tr) * (py - y), dh);
+                v[ch] = l + ref_floor_div((int64_t)(r - l) * (px - x), dw);
+            }
+            fb_set_pixel(px, py, rgb565((uint8_t)v[0], (uint8_t)v[1], (uint8_t)v[2]));
+        }
+    }
+}
+
+// Blends per channel at its own width, with alpha rounded to 1/32 steps.
+static inline uint16_t ref_blend565(uint16_t a, uint16_t b, uint8_t alpha) {
+    uint32_t w = ((uint32_t)alpha + 4) >> 3;
+    uint16_t na = RGB565_LOAD(a), nb = RGB565_LOAD(b);
+    uint32_t r = (((na >> 11) * (32 - w) + (nb >> 11) * w) >> 5) & 0x1F;
+    uint32_t g = ((((na >> 5) & 0x3F) * (32 - w) + ((nb >> 5) & 0x3F) * w) >> 5) & 0x3F;
+    uint32_t bl = (((na & 0x1F) * (32 - w) + (nb & 0x1F) * w) >> 5) & 0x1F;
+    return RGB565_STORE((uint16_t)(r << 11 | g << 5 | bl));
+}
+
+static inline void ref_blend(int x, int y, int w, int h, uint16_t color, uint8_t alpha) {
+    gfx_fb_t *fb = fb_target;
+    ref_clip_t k = ref_clip(x, y, w, h);
+    for (int py = k.y0; py < k.y1; ++py) {
+        for (int px = k.x0; px < k.x1; ++px) {
+#if GFX_FB_INDEXED
+            uint16_t under = fb->palette->color[gfx_fb_get(fb, px, py)];
+#else
+            uint16_t under = gfx_fb_get(fb, px, py);
+#endif
+            fb_set_pixel(px, py, ref_blend565(under, color, alpha));
+        }
+    }
+}
@@ -0,0 +1,262 @@
+// Host test of the colour interpolation kernels (gfx/shade.h).
+//
+//  - fb_fill_gradient() over random ramps (rising, falling, flat, along x,
+//    y or both, denominators up to GFX_RAMP_DEN_MAX, origins off the rect)
+//    and random rects, clipped ones included, matches a per-pixel reference
+//    that divides with floor();
+//  - fb_fill_corners() matches a bilinear reference and gives the corner
+//    pixels their colours exactly;
+//  - gfx_blend565() matches a per-channel blend for every alpha, and
+//    fb_blend_rect() blends every pixel of its rect the same way.
+// The references are in shade_ref.h, shared with gfx_bench.
+// Each fill runs on the full frame and on views starting at odd pixels, so
+// the paired 32-bit stores start misaligned; pixels outside the rect must be
+// left alone and no damage recorded. Exits non-zero if a check fails.
+//
+// Built with the host library (-DRP2350_GEEK_HOST_BUILD=ON); run
+// gfx_shade_test.
+#include <stdio.h>
+#include <string.h>
+
+#include "gfx/fb.h"
+#include "gfx/shade.h"
+#include "shade_ref.h"
+
+#define TEST_W 67
+#define TEST_H 41
+#define TEST_FRAMES
+
+#include "test_util.h"
+
+// Views the kernels are run on: the full frame, and ones starting at odd
+// and even columns (at 4bpp views start on a byte).
+static const gfx_rect_t views[] = {
+    { 0, 0, TEST_W, TEST_H }, { 1, 2, TEST_W, TEST_H - 1 }, { 3, 0, TEST_W - 2, 30 }, { 10, 5, 50, 40 },
+};
+
+// Runs draw on out_fb and ref on ref_fb through view v of both; both start
+// out holding the same background.
+static bool run_both(size_t v, void (*draw)(void *), void (*ref)(void *), void *arg, const char *what) {
+    memset(ref_px, 0x6B, sizeof(ref_px));
+    memset(out_px, 0x6B, sizeof(out_px));
+    gfx_rect_t r = views[v];
+#if GFX_FB_BPP == 4
+    r.x0 &= ~1;
+#endif
+    gfx_fb_t ref_view, out_view;
+    gfx_fb_view(&ref_view, &ref_fb, &r);
+    gfx_fb_view(&out_view, &out_fb, &r);
+    fb_bind(&ref_view);
+    ref(arg);
+    fb_bind(&out_view);
+    draw(arg);
+    if (out_view.dirty_count != 0) {
+        printf("%s: recorded %u dirty rects\n", what, out_view.dirty_count);
+        return false;
+    }
+    return frames_equal(what, &ref_fb, &out_fb);
+}
+
+// --- Gradients ---
+typedef struct {
+    int x, y, w, h;
+    gfx_gradient_t g;
+} gradient_case_t;
+
+static void test_ref_gradient(void *arg) {
+    const gradient_case_t *t = arg;
+    ref_gradient(t->x, t->y, t->w, t->h, &t->g);
+}
+
+static void new_gradient(void *arg) {
+    const gradient_case_t *t = arg;
+    fb_fill_gradient(t->x, t->y, t->w, t->h, &t->g);
+}
+
+// A random ramp that stays within 0..255 over the rect (an affine value is
+// extreme at the corners).
+static gfx_ramp_t random_ramp(const gradient_case_t *t, uint32_t *seed) {
+    for (;;) {
+        gfx_ramp_t r;
+        static const int32_t dens[] = { 1, 2, 3, 7, 66, 255, 1000, GFX_RAMP_DEN_MAX };
+        r.den = dens[test_rand(seed) % 8];
+        r.dx = test_rand(seed) % 4 == 0 ? 0 : (int32_t)(test_rand(seed) % 1025) - 512;
+        r.dy = test_rand(seed) % 4 == 0 ? 0 : (int32_t)(test_rand(seed) % 1025) - 512;
+        if (r.den > 255) {
+            r.dx *= r.den / 255;
+            r.dy *= r.den / 255;
+        }
+        r.c0 = (int32_t)(test_rand(seed) % 256);
+        int lo = 255, hi = 0;
+        for (int c = 0; c < 4; ++c) {
+            int v = ref_ramp_at(&r, t->x + (c & 1 ? t->w - 1 : 0) - t->g.x0, t->y + (c & 2 ? t->h - 1 : 0) - t->g.y0);
+            lo = v < lo ? v : lo;
+            hi = v > hi ? v : hi;
+        }
+        if (lo >= 0 && hi <= 255) {
+            return r;
+        }
+    }
+}
+
+static bool test_gradient(void) {
+    uint32_t seed = 21;
+    char what[96];
+    for (int round = 0; round < 400; ++round) {
+        gradient_case_t t;
+        t.x = (int)(test_rand(&seed) % (TEST_W + 10)) - 5;
+        t.y = (int)(test_rand(&seed) % (TEST_H + 10)) - 5;
+        t.w = 1 + (int)(test_rand(&seed) % 60);
+        t.h = 1 + (int)(test_rand(&seed) % 30);
+        // The origin is often the rect's corner, sometimes up to 20 pixels
+        // away from it on either side.
+        bool corner = round % 3 != 0;
+        t.g.x0 = (int16_t)(corner ? t.x : t.x + (int)(test_rand(&seed) % 41) - 20);
+        t.g.y0 = (int16_t)(corner ? t.y : t.y + (int)(test_rand(&seed) % 41) - 20);
+        if (round < 40) {
+            // The constructor's own ramps, spanning the rect.
+            int span = 1 + (int)(test_rand(&seed) % 300);
+            t.g.x0 = (int16_t)t.x;
+            t.g.y0 = (int16_t)t.y;
+            t.w = span < t.w ? span : t.w;
+            t.h = span < t.h ? span : t.h;
+            t.g.r = gfx_ramp((uint8_t)test_rand(&seed), (uint8_t)test_rand(&seed), 1, 0, span);
+            t.g.g = gfx_ramp((uint8_t)test_rand(&seed), (uint8_t)test_rand(&seed), 0, 1, span);
+            t.g.b = gfx_ramp((uint8_t)test_rand(&seed), (uint8_t)test_rand(&seed), 1, 1, 2 * span);
+        } else {
+            t.g.r = random_ramp(&t, &seed);
+            t.g.g = random_ramp(&t, &seed);
+            t.g.b = random_ramp(&t, &seed);
+        }
+        size_t v = (size_t)round % (sizeof(views) / sizeof(views[0]));
+        snprintf(what, sizeof(what), "gradient, round %d: %dx%d at (%d, %d), view %zu", round, t.w, t.h, t.x, t.y, v);
+        if (!run_both(v, new_gradient, test_ref_gradient, &t, what)) {
+            return false;
+        }
+    }
+    return true;
+}
+
+// --- Corners ---
+typedef struct {
+    int x, y, w, h;
+    uint16_t c[4]; // tl, tr, bl, br
+} corners_case_t;
+
+static void test_ref_corners(void *arg) {
+    const corners_case_t *t = arg;
+    ref_corners(t->x, t->y, t->w, t->h, t->c);
+}
+
+static void new_corners(void *arg) {
+    const corners_case_t *t = arg;
+    fb_fill_corners(t->x, t->y, t->w, t->h, t->c[0], t->c[1], t->c[2], t->c[3]);
+}
+
+static bool test_corners(void) {
+    uint32_t seed = 23;
+    char what[96];
+    for (int round = 0; round < 300; ++round) {
+        corners_case_t t;
+        t.x = (int)(test_rand(&seed) % (TEST_W + 10)) - 5;
+        t.y = (int)(test_rand(&seed) % (TEST_H + 10)) - 5;
+        t.w = 1 + (int)(test_rand(&seed) % 70);
+        t.h = 1 + (int)(test_rand(&seed) % 45);
+        for (int c = 0; c < 4; ++c) {
+            t.c[c] = (uint16_t)test_rand(&seed);
+        }
+        size_t v = (size_t)round % (sizeof(views) / sizeof(views[0]));
+        snprintf(what, sizeof(what), "corners, round %d: %dx%d at (%d, %d), view %zu", round, t.w, t.h, t.x, t.y, v);
+        if (!run_both(v, new_corners, test_ref_corners, &t, what)) {
+            return false;
+        }
+    }
+
+    // Unclipped, the corner pixels are the corner colours.
+    static const uint16_t c[4] = {
+        RGB565_CONST(255, 0, 0), RGB565_CONST(0, 255, 0), RGB565_CONST(0, 0, 255), RGB565_CONST(255, 255, 255),
+    };
+    fb_bind(&out_fb);
+    fb_fill_corners(2, 3, 60, 35, c[0], c[1], c[2], c[3]);
+    static const int at[4][2] = { { 2, 3 }, { 61, 3 }, { 2, 37 }, { 61, 37 } };
+    for (int i = 0; i < 4; ++i) {
+        if (gfx_fb_get(&out_fb, at[i][0], at[i][1]) != gfx_fb_value(&out_fb, c[i])) {
+            printf("corners: corner %d is 0x%x, want 0x%x\n", i, (unsigned)gfx_fb_get(&out_fb, at[i][0], at[i][1]),
+                   (unsigned)gfx_fb_value(&out_fb, c[i]));
+            return false;
+        }
+    }
+    return true;
+}
+
+// --- Blending ---
+typedef struct {
+    int x, y, w, h;
+    uint16_t color;
+    uint8_t alpha;
+} blend_case_t;
+
+// Something to blend over: every pixel a different colour.
+static void fill_pattern(void) {
+    gfx_fb_t *fb = fb_target;
+    for (int y = 0; y < fb->height; ++y) {
+        for (int x = 0; x < fb->width; ++x) {
+            fb_set_pixel(x, y, rgb565((uint8_t)(x * 37), (uint8_t)(y * 59), (uint8_t)((x ^ y) * 11)));
+        }
+    }
+}
+
+static void test_ref_blend(void *arg) {
+    const blend_case_t *t = arg;
+    fill_pattern();
+    ref_blend(t->x, t->y, t->w, t->h, t->color, t->alpha);
+}
+
+static void new_blend(void *arg) {
+    const blend_case_t *t = arg;
+    fill_pattern();
+    fb_blend_rect(t->x, t->y, t->w, t->h, t->color, t->alpha);
+}
+
+static bool test_blend(void) {
+    uint32_t seed = 29;
+    for (int alpha = 0; alpha < 256; ++alpha) {
+        for (int i = 0; i < 300; ++i) {
+            uint16_t a = (uint16_t)test_rand(&seed), b = (uint16_t)test_rand(&seed);
+            uint16_t got = gfx_blend565(a, b, (uint8_t)alpha), want = ref_blend565(a, b, (uint8_t)alpha);
+            if (got != want || (alpha == 0 && got != a) || (alpha == 255 && got != b)) {
+                printf("blend565: 0x%04x over 0x%04x at alpha %d gives 0x%04x, want 0x%04x\n", b, a, alpha, got,
+                       alpha == 0 ? a : alpha == 255 ? b : want);
+                return false;
+            }
+        }
+    }
+
+    char what[96];
+    for (int round = 0; round < 200; ++round) {
+        blend_case_t t;
+        t.x = (int)(test_rand(&seed) % (TEST_W + 10)) - 5;
+        t.y = (int)(test_rand(&seed) % (TEST_H + 10)) - 5;
+        t.w = 1 + (int)(test_rand(&seed) % 60);
+        t.h = 1 + (int)(test_rand(&seed) % 30);
+        t.color = (uint16_t)test_rand(&seed);
+        t.alpha = (uint8_t)test_rand(&seed);
+        size_t v = (size_t)round % (sizeof(views) / sizeof(views[0]));
+        snprintf(what, sizeof(what), "blend rect, round %d: %dx%d at (%d, %d), alpha %u", round, t.w, t.h, t.x, t.y,
+                 t.alpha);
+        if (!run_both(v, new_blend, test_ref_blend, &t, what)) {
+            return false;
+        }
+    }
+    return true;
+}
+
+int main(void) {
+    test_frames_init();
+    static const test_case_t tests[] = {
+        { "gradient", test_gradient },
+        { "corners", test_corners },
+        { "blend", test_blend },
+    };
+    return test_run_all(tests, sizeof(tests) / sizeof(tests[0]));
+}
@@ -0,0 +1,131 @@
+// Host test of the ping-pong flush staging (gfx/stream.h).
+//
+// A frame of random pixels is flushed window by window into the memory panel
+// (gfx/panel_mem.h) the way the demo's DMA interrupt drives it: each chunk is
+// handed to the wire, gfx_stream_refill() stages the next one, and only then
+// does the wire read the chunk it holds, as a DMA transfer would while the
+// CPU converts. Staging into the buffer on the wire would show up as
+// corrupted pixels, and gfx_stream_next() must hand the staged chunk over
+// without converting anything (the conversion belongs after the hand-off, so
+// it overlaps the transfer). Windows cover single pixels, odd widths,
+// partial rows, full-width bands and the whole frame, with chunks from 1
+// pixel to larger than the window. Checks that no chunk exceeds chunk_px,
+// that the byte stream is the window in row-major wire order, and that the
+// panel ends up identical to the frame. Exits non-zero if a check fails.
+//
+// Built with the host library (-DRP2350_GEEK_HOST_BUILD=ON); run
+// gfx_stream_test.
+#include <stdio.h>
+#include <string.h>
+
+#include "gfx/fb.h"
+#include "gfx/panel_mem.h"
+#include "gfx/st7789.h"
+#include "gfx/stream.h"
+
+#define TEST_W 240
+#define TEST_H 135
+#define TEST_CHUNK_MAX 4096
+
+#include "test_util.h"
+
+static gfx_pixel_t frame_px[GFX_FB_LEN(TEST_W, TEST_H)];
+static uint16_t panel_px[TEST_W * TEST_H];
+static uint8_t staging[2][TEST_CHUNK_MAX * 2];
+static uint8_t want[TEST_W * TEST_H * 2];
+static uint8_t held[2][TEST_CHUNK_MAX * 2];
+
+// Streams r of fb through s onto the panel; returns false on a check failing.
+static bool stream_window(gfx_stream_t *s, const gfx_fb_t *fb, const gfx_bus_t *bus, const st7789_config_t *cfg,
+                          const gfx_rect_t *r) {
+    size_t w = (size_t)(r->x1 - r->x0), h = (size_t)(r->y1 - r->y0);
+    for (size_t y = 0; y < h; ++y) {
+        gfx_fb_expand_wire(fb, r->x0, r->y0 + (int)y, w, &want[2 * y * w]);
+    }
+    st7789_set_window(bus, cfg, (uint16_t)r->x0, (uint16_t)r->y0, (uint16_t)w, (uint16_t)h);
+
+    size_t sent = 0;
+    for (size_t px = gfx_stream_begin(s, fb, r); px;) {
+        // Hand the chunk to the wire, which reads it only once the refill
+        // has run, as a transfer drains while the CPU stages.
+        const uint8_t *chunk = gfx_stream_chunk(s);
+        if (px > s->chunk_px) {
+            printf("stream: %zu-pixel chunk from %zu-pixel buffers\n", px, s->chunk_px);
+            return false;
+        }
+        gfx_stream_refill(s);
+        if (sent + px > w * h || memcmp(chunk, &want[2 * sent], px * 2) != 0) {
+            printf("stream: window (%d, %d) %zux%zu, %zu-pixel chunks: bytes %zu.. differ on the wire\n", r->x0,
+                   r->y0, w, h, s->chunk_px, 2 * sent);
+            return false;
+        }
+        bus->write_data(bus->ctx, chunk, px * 2);
+        sent += px;
+
+        // The drained chunk's successor must already be staged: next() only
+        // swaps buffers.
+        memcpy(held[0], s->buf[0], s->chunk_px * 2);
+        memcpy(held[1], s->buf[1], s->chunk_px * 2);
+        px = gfx_stream_next(s);
+        if (memcmp(held[0], s->buf[0], s->chunk_px * 2) != 0 || memcmp(held[1], s->buf[1], s->chunk_px * 2) != 0) {
+            printf("stream: window (%d, %d) %zux%zu, %zu-pixel chunks: next() staged pixels\n", r->x0, r->y0, w, h,
+                   s->chunk_px);
+            return false;
+        }
+    }
+    if (sent != w * h) {
+        printf("stream: window (%d, %d) %zux%zu sent %zu pixels\n", r->x0, r->y0, w, h, sent);
+        return false;
+    }
+    return true;
+}
+
+int main(void) {
+    gfx_fb_t fb;
+    gfx_fb_init(&fb, frame_px, TEST_W, TEST_H);
+    gfx_panel_mem_t panel;
+    gfx_panel_mem_init(&panel, panel_px, TEST_W, TEST_H);
+    gfx_bus_t bus = gfx_panel_mem_bus(&panel);
+    st7789_config_t cfg = { .width = TEST_W, .height = TEST_H };
+
+    uint32_t seed = 5;
+    for (size_t i = 0; i < sizeof(frame_px) / sizeof(frame_px[0]); ++i) {
+        frame_px[i] = (gfx_pixel_t)test_rand(&seed);
+    }
+
+    static const size_t chunks[] = { 1, 7, 240, 512, TEST_CHUNK_MAX };
+    int failed = 0;
+    for (size_t c = 0; c < sizeof(chunks) / sizeof(chunks[0]); ++c) {
+        gfx_stream_t s;
+        gfx_stream_init(&s, staging[0], staging[1], chunks[c]);
+        memset(panel_px, 0, sizeof(panel_px));
+
+        // Fixed shapes, then random windows, then the whole frame so every
+        // panel pixel has been written once more.
+        gfx_rect_t fixed[] = {
+            { 0, 0, 1, 1 },         { 239, 134, 240, 135 }, { 3, 5, 20, 6 },   { 17, 9, 18, 60 },
+            { 0, 40, TEST_W, 41 },  { 0, 50, TEST_W, 77 },  { 1, 0, TEST_W, TEST_H },
+        };
+        bool ok = true;
+        for (size_t i = 0; ok && i < sizeof(fixed) / sizeof(fixed[0]); ++i) {
+            ok = stream_window(&s, &fb, &bus, &cfg, &fixed[i]);
+        }
+        for (int i = 0; ok && i < 200; ++i) {
+            gfx_rect_t r;
+            r.x0 = (int16_t)(test_rand(&seed) % TEST_W);
+            r.y0 = (int16_t)(test_rand(&seed) % TEST_H);
+            r.x1 = (int16_t)(r.x0 + 1 + test_rand(&seed) % (TEST_W - r.x0));
+            r.y1 = (int16_t)(r.y0 + 1 + test_rand(&seed) % (TEST_H - r.y0));
+            if (i % 5 == 0) {
+                r.x0 = 0;
+                r.x1 = TEST_W;
+            }
+            ok = stream_window(&s, &fb, &bus, &cfg, &r);
+        }
+        gfx_rect_t all = { 0, 0, TEST_W, TEST_H };
+        ok = ok && stream_window(&s, &fb, &bus, &cfg, &all) && panel_matches("stream", &fb, &panel);
+        printf("%4zu-pixel chunks  %s\n", chunks[c], ok ? "ok" : "FAIL");
+        failed |= !ok;
+    }
+    return failed;
+}
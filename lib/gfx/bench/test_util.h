@@ -0,0 +1,83 @@
+#pragma once
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+#include <stdio.h>
+
+#include "gfx/fb.h"
+#include "gfx/panel_mem.h"
+
+// Shared by the host regression tests (bench/*_test.c).
+//
+// A test that draws into a reference frame and an output frame defines
+// TEST_W and TEST_H, and TEST_FRAMES, before including this. It gets
+// ref_px/ref_fb and out_px/out_fb of that size, set up by test_frames_init().
+// main() lists its cases in a test_case_t table and returns test_run_all().
+
+// Linear congruential generator; the same sequence on every host, so a
+// failing round can be replayed.
+static inline uint32_t test_rand(uint32_t *state) {
+    *state = *state * 1664525u + 1013904223u;
+    return *state >> 8;
+}
+
+// Whether got holds want's stored values over want's size; prints the first
+// pixel that differs.
+static inline bool frames_equal(const char *what, const gfx_fb_t *want, const gfx_fb_t *got) {
+    for (int y = 0; y < want->height; ++y) {
+        for (int x = 0; x < want->width; ++x) {
+            if (gfx_fb_get(want, x, y) != gfx_fb_get(got, x, y)) {
+                printf("%s: mismatch at (%d, %d): want 0x%x, got 0x%x\n", what, x, y, (unsigned)gfx_fb_get(want, x, y),
+                       (unsigned)gfx_fb_get(got, x, y));
+                return false;
+            }
+        }
+    }
+    return true;
+}
+
+// Whether the memory panel shows fb, pixel for pixel in wire order.
+static inline bool panel_matches(const char *what, const gfx_fb_t *fb, const gfx_panel_mem_t *panel) {
+    uint8_t wire[2];
+    for (int y = 0; y < fb->height; ++y) {
+        for (int x = 0; x < fb->width; ++x) {
+            gfx_fb_expand_wire(fb, x, y, 1, wire);
+            uint16_t c = (uint16_t)(wire[0] << 8 | wire[1]);
+            if (gfx_panel_mem_get(panel, (uint16_t)x, (uint16_t)y) != c) {
+                printf("%s: panel (%d, %d) is 0x%04x, frame 0x%04x\n", what, x, y,
+                       gfx_panel_mem_get(panel, (uint16_t)x, (uint16_t)y), c);
+                return false;
+            }
+        }
+    }
+    return true;
+}
+
+typedef struct {
+    const char *name;
+    bool (*run)(void);
+} test_case_t;
+
+// Runs every case, printing an ok or FAIL line for each; returns the exit
+// status, non-zero if any failed.
+static inline int test_run_all(const test_case_t *tests, size_t count) {
+    int failed = 0;
+    for (size_t i = 0; i < count; ++i) {
+        bool ok = tests[i].run();
+        printf("%-14s %s\n", tests[i].name, ok ? "ok" : "FAIL");
+        failed |= !ok;
+    }
+    return failed;
+}
+
+#ifdef TEST_FRAMES
+static gfx_pixel_t ref_px[GFX_FB_LEN(TEST_W, TEST_H)];
+static gfx_pixel_t out_px[GFX_FB_LEN(TEST_W, TEST_H)];
+static gfx_fb_t ref_fb, out_fb;
+
+static inline void test_frames_init(void) {
+    gfx_fb_init(&ref_fb, ref_px, TEST_W, TEST_H);
+    gfx_fb_init(&out_fb, out_px, TEST_W, TEST_H);
+}
+#endif
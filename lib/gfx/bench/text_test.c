@@ -0,0 +1,385 @@
+// Host regression test for text drawing (gfx/font.h, gfx/text.h).
+//
+// 5x7 text at every scale, at aligned, odd and clipped positions, on the
+// full frame and on views cut through it, and in lines of 70 characters, is
+// compared pixel for pixel with a reference that reads font5x7 column by
+// column, and its damage with the box the text covers. Anti-aliased sans16 (4-bit) and sans11 (2-bit) text,
+// blended over a pattern and drawn on a solid background, is compared with
+// a reference that places glyphs from the font's own tables (advances and
+// kerning pairs) and blends each coverage level with gfx_blend565(); its
+// damage must be exactly the measured box, clipped. Exits non-zero if a
+// check fails.
+//
+// Built with the host library (-DRP2350_GEEK_HOST_BUILD=ON); run
+// gfx_text_test.
+#include <stdio.h>
+#include <string.h>
+
+#include "gfx/assets.h"
+#include "gfx/fb.h"
+#include "gfx/font.h"
+#include "gfx/shade.h"
+#include "gfx/text.h"
+
+#define TEST_W 160
+#define TEST_H 72
+#define TEST_FRAMES
+
+#include "test_util.h"
+
+// One character cell per pixel test, straight from the column-major table.
+static void ref_text(int x, int y, const char *text, uint16_t fg, uint16_t bg, int scale) {
+    int cx = x;
+    for (; *text; ++text) {
+        if (*text == '\n') {
+            cx = x;
+            y += (FB_GLYPH_H + 1) * scale;
+            continue;
+        }
+        unsigned char c = (unsigned char)*text;
+        if (c < 32 || c > 127) {
+            c = '?';
+        }
+        for (int py = 0; py < FB_GLYPH_H * scale; ++py) {
+            for (int px = 0; px < FB_GLYPH_W * scale; ++px) {
+                int col = px / scale, row = py / scale;
+                bool on = col < 5 && ((font5x7[c - 32][col] >> row) & 1);
+                fb_set_pixel(cx + px, y + py, on ? fg : bg);
+            }
+        }
+        cx += FB_GLYPH_W * scale;
+    }
+}
+
+// Whether fb's damage covers the cells text fills at (x, y), clipped, and
+// stays inside their bounding box (lines may merge across the gap between
+// them).
+static bool damage_matches(const gfx_fb_t *fb, int x, int y, const char *text, int scale, const char *what) {
+    static uint8_t cells[TEST_H][TEST_W];
+    memset(cells, 0, sizeof(cells));
+    gfx_rect_t box = { TEST_W, TEST_H, 0, 0 };
+    int cx = x;
+    for (; *text; ++text) {
+        if (*text == '\n') {
+            cx = x;
+            y += (FB_GLYPH_H + 1) * scale;
+            continue;
+        }
+        for (int py = y; py < y + FB_GLYPH_H * scale; ++py) {
+            for (int px = cx; px < cx + FB_GLYPH_W * scale; ++px) {
+                if (px >= 0 && py >= 0 && px < TEST_W && py < TEST_H) {
+                    cells[py][px] = 1;
+                    box.x0 = px < box.x0 ? (int16_t)px : box.x0;
+                    box.y0 = py < box.y0 ? (int16_t)py : box.y0;
+                    box.x1 = px >= box.x1 ? (int16_t)(px + 1) : box.x1;
+                    box.y1 = py >= box.y1 ? (int16_t)(py + 1) : box.y1;
+                }
+            }
+        }
+        cx += FB_GLYPH_W * scale;
+    }
+    for (int py = 0; py < TEST_H; ++py) {
+        for (int px = 0; px < TEST_W; ++px) {
+            bool dirty = false;
+            for (uint8_t i = 0; i < fb->dirty_count; ++i) {
+                const gfx_rect_t *r = &fb->dirty[i];
+                dirty |= px >= r->x0 && px < r->x1 && py >= r->y0 && py < r->y1;
+            }
+            if (cells[py][px] && !dirty) {
+                printf("%s: (%d, %d) drawn but not marked dirty\n", what, px, py);
+                return false;
+            }
+            if (dirty && (px < box.x0 || py < box.y0 || px >= box.x1 || py >= box.y1)) {
+                printf("%s: (%d, %d) marked dirty away from the text\n", what, px, py);
+                return false;
+            }
+        }
+    }
+    return true;
+}
+
+static bool test_5x7(void) {
+    static const char *const texts[] = { "Hello, 5x7!", "{|}~ \x7f\x01", "two\nlines" };
+    static const int xs[] = { 0, 1, 7, -5, 130 };
+    static const int ys[] = { 0, 3, -4, 60 };
+    char what[96];
+    for (int scale = 1; scale <= FB_GLYPH_MAX_SCALE; ++scale) {
+        for (size_t t = 0; t < sizeof(texts) / sizeof(texts[0]); ++t) {
+            for (size_t xi = 0; xi < sizeof(xs) / sizeof(xs[0]); ++xi) {
+                for (size_t yi = 0; yi < sizeof(ys) / sizeof(ys[0]); ++yi) {
+                    int x = xs[xi], y = ys[yi];
+                    uint16_t fg = rgb565(255, 200, (uint8_t)(40 * scale)), bg = rgb565(0, 20, (uint8_t)(60 * t));
+                    memset(ref_px, 0x33, sizeof(ref_px));
+                    memset(out_px, 0x33, sizeof(out_px));
+                    fb_bind(&ref_fb);
+                    ref_text(x, y, texts[t], fg, bg, scale);
+                    fb_bind(&out_fb);
+                    out_fb.dirty_count = 0;
+                    fb_draw_text_scaled(x, y, texts[t], fg, bg, scale);
+                    snprintf(what, sizeof(what), "5x7 \"%s\" at (%d, %d) x%d", texts[t], x, y, scale);
+                    if (!frames_equal(what, &ref_fb, &out_fb)) {
+                        return false;
+                    }
+                    if (!damage_matches(&out_fb, x, y, texts[t], scale, what)) {
+                        return false;
+                    }
+                }
+            }
+        }
+    }
+
+    // A view cut through a line of text, as a render strip sees it.
+    for (int y0 = 0; y0 < 24; y0 += 5) {
+        gfx_rect_t r = { 0, (int16_t)y0, TEST_W, (int16_t)(y0 + 5) };
+        memset(ref_px, 0x33, sizeof(ref_px));
+        memset(out_px, 0x33, sizeof(out_px));
+        gfx_fb_t ref_view, out_view;
+        gfx_fb_view(&ref_view, &ref_fb, &r);
+        gfx_fb_view(&out_view, &out_fb, &r);
+        fb_bind(&ref_view);
+        ref_text(6, 3 - y0, "strip text", 0xFFFF, 0x0000, 2);
+        fb_bind(&out_view);
+        fb_draw_text_scaled(6, 3 - y0, "strip text", 0xFFFF, 0x0000, 2);
+        snprintf(what, sizeof(what), "5x7 in a view from row %d", y0);
+        if (!frames_equal(what, &ref_fb, &out_fb)) {
+            return false;
+        }
+    }
+
+    // Lines longer than the renderer looks up at once, on a frame wide
+    // enough to hold them (the same storage, reshaped).
+    static const int wide_ys[] = { 0, -3, 22 };
+    char line[71];
+    for (int i = 0; i < 70; ++i) {
+        line[i] = (char)(' ' + (i * 7) % 96);
+    }
+    line[70] = '\0';
+    gfx_fb_init(&ref_fb, ref_px, 70 * FB_GLYPH_W, 26);
+    gfx_fb_init(&out_fb, out_px, 70 * FB_GLYPH_W, 26);
+    bool ok = true;
+    for (int scale = 1; scale <= 2 && ok; ++scale) {
+        for (size_t yi = 0; yi < sizeof(wide_ys) / sizeof(wide_ys[0]) && ok; ++yi) {
+            const char *text = &line[scale == 1 ? 0 : 35];
+            memset(ref_px, 0x33, sizeof(ref_px));
+            memset(out_px, 0x33, sizeof(out_px));
+            fb_bind(&ref_fb);
+            ref_text(0, wide_ys[yi], text, 0xFFE0, 0x0010, scale);
+            fb_bind(&out_fb);
+            fb_draw_text_scaled(0, wide_ys[yi], text, 0xFFE0, 0x0010, scale);
+            snprintf(what, sizeof(what), "5x7 %zu-char line at y %d x%d", strlen(text), wide_ys[yi], scale);
+            ok = frames_equal(what, &ref_fb, &out_fb);
+        }
+    }
+    test_frames_init();
+    return ok;
+}
+
+// --- Anti-aliased text ---
+// Glyph for c, looked up without gfx_font_glyph().
+static const gfx_glyph_t *ref_glyph(const gfx_font_t *font, unsigned char c) {
+    if (c < font->first || c >= font->first + font->count) {
+        c = '?';
+    }
+    return &font->glyphs[c - font->first];
+}
+
+static int ref_kern(const gfx_font_t *font, unsigned char a, unsigned char b) {
+    for (size_t i = 0; i < font->kern_count; ++i) {
+        if (font->kerns[i].first == a && font->kerns[i].second == b) {
+            return font->kerns[i].adjust;
+        }
+    }
+    return 0;
+}
+
+static unsigned ref_coverage(const gfx_font_t *font, const gfx_glyph_t *g, int col, int row) {
+    int row_bytes = (g->w * font->bpp + 7) / 8, bit = col * font->bpp;
+    uint8_t byte = font->bitmaps[g->offset + row * row_bytes + (bit >> 3)];
+    return (byte >> (8 - font->bpp - (bit & 7))) & ((1u << font->bpp) - 1);
+}
+
+// Coverage levels the reference has drawn, to make sure the texts exercise
+// both the blended and the fully covered path.
+static bool saw_partial, saw_full;
+
+// Draws text the long way into fb_target: on bg if solid (the measured box
+// filled first, edges mixed with bg), else blended over what is there.
+// Returns the measured box in *w, *h.
+static void ref_string(const gfx_font_t *font, int x, int y, const char *text, uint16_t fg, bool solid,
+                       uint16_t bg, int *w, int *h) {
+    gfx_fb_t *fb = fb_target;
+    int pen = x, line_y = y, width = 0;
+    unsigned char prev = 0;
+    for (const char *p = text;; ++p) {
+        if (!*p || *p == '\n') {
+            width = pen - x > width ? pen - x : width;
+            if (!*p) {
+                break;
+            }
+            pen = x;
+            line_y += font->line_height;
+            prev = 0;
+            continue;
+        }
+        pen += prev ? ref_kern(font, prev, (unsigned char)*p) : 0;
+        prev = (unsigned char)*p;
+        pen += ref_glyph(font, prev)->advance;
+    }
+    *w = width;
+    *h = line_y - y + font->line_height;
+    if (solid) {
+        for (int py = y < 0 ? 0 : y; py < y + *h && py < fb->height; ++py) {
+            for (int px = x < 0 ? 0 : x; px < x + *w && px < fb->width; ++px) {
+                fb_set_pixel(px, py, bg);
+            }
+        }
+    }
+
+    unsigned max = (1u << font->bpp) - 1;
+    pen = x;
+    line_y = y;
+    prev = 0;
+    for (const char *p = text; *p; ++p) {
+        if (*p == '\n') {
+            pen = x;
+            line_y += font->line_height;
+            prev = 0;
+            continue;
+        }
+        pen += prev ? ref_kern(font, prev, (unsigned char)*p) : 0;
+        prev = (unsigned char)*p;
+        const gfx_glyph_t *g = ref_glyph(font, prev);
+        int gx = pen + g->left, gy = line_y + font->ascent - g->top;
+        pen += g->advance;
+        for (int row = 0; row < g->h; ++row) {
+            for (int col = 0; col < g->w; ++col) {
+                int px = gx + col, py = gy + row;
+                unsigned lvl = ref_coverage(font, g, col, row);
+                if (!lvl || px < 0 || py < 0 || px >= fb->width || py >= fb->height) {
+                    continue;
+                }
+                saw_full |= lvl == max;
+                saw_partial |= lvl != max;
+                uint8_t alpha = (uint8_t)((lvl * 255 + max / 2) / max);
+#if GFX_FB_INDEXED
+                uint16_t under = solid ? bg : fb->palette->color[gfx_fb_get(fb, px, py)];
+#else
+                uint16_t under = solid ? bg : gfx_fb_get(fb, px, py);
+#endif
+                fb_set_pixel(px, py, lvl == max ? fg : gfx_blend565(under, fg, alpha));
+            }
+        }
+    }
+}
+
+// Something to blend over: every pixel a different colour.
+static void fill_pattern(void) {
+    gfx_fb_t *fb = fb_target;
+    for (int y = 0; y < fb->height; ++y) {
+        for (int x = 0; x < fb->width; ++x) {
+            fb_set_pixel(x, y, rgb565((uint8_t)(x * 13), (uint8_t)(y * 29), (uint8_t)((x + y) * 7)));
+        }
+    }
+}
+
+// Whether fb's damage is exactly the w x h box at (x, y), clipped.
+static bool damage_is_box(const gfx_fb_t *fb, int x, int y, int w, int h, const char *what) {
+    int x0 = x < 0 ? 0 : x, y0 = y < 0 ? 0 : y;
+    int x1 = x + w < TEST_W ? x + w : TEST_W, y1 = y + h < TEST_H ? y + h : TEST_H;
+    if (x0 >= x1 || y0 >= y1) {
+        if (fb->dirty_count == 0) {
+            return true;
+        }
+    } else if (fb->dirty_count == 1 && fb->dirty[0].x0 == x0 && fb->dirty[0].y0 == y0 && fb->dirty[0].x1 == x1 &&
+               fb->dirty[0].y1 == y1) {
+        return true;
+    }
+    printf("%s: %u dirty rects, first (%d, %d)-(%d, %d); want (%d, %d)-(%d, %d)\n", what, fb->dirty_count,
+           fb->dirty[0].x0, fb->dirty[0].y0, fb->dirty[0].x1, fb->dirty[0].y1, x0, y0, x1, y1);
+    return false;
+}
+
+static bool test_aa(void) {
+    static const gfx_font_t *const fonts[] = { &sans16, &sans11 };
+    static const char *const texts[] = { "AVATAR To, Wy.", "fjord gap\nTypo  Qq|", "\x01?\x7f", "" };
+    static const int xs[] = { 0, 3, -7, 120 };
+    static const int ys[] = { 0, 5, -9, 60 };
+    char what[96];
+    saw_partial = saw_full = false;
+    for (size_t f = 0; f < sizeof(fonts) / sizeof(fonts[0]); ++f) {
+        const gfx_font_t *font = fonts[f];
+        for (size_t t = 0; t < sizeof(texts) / sizeof(texts[0]); ++t) {
+            for (size_t xi = 0; xi < sizeof(xs) / sizeof(xs[0]); ++xi) {
+                for (size_t yi = 0; yi < sizeof(ys) / sizeof(ys[0]); ++yi) {
+                    int x = xs[xi], y = ys[yi], w, h, mw, mh;
+                    uint16_t fg = rgb565(250, (uint8_t)(90 * t), 30), bg = rgb565(10, 40, (uint8_t)(70 * xi));
+                    for (int solid = 0; solid < 2; ++solid) {
+                        fb_bind(&ref_fb);
+                        fill_pattern();
+                        ref_string(font, x, y, texts[t], fg, solid, bg, &w, &h);
+                        fb_bind(&out_fb);
+                        fill_pattern();
+                        out_fb.dirty_count = 0;
+                        if (solid) {
+                            fb_draw_string_bg(font, x, y, texts[t], fg, bg);
+                        } else {
+                            fb_draw_string(font, x, y, texts[t], fg);
+                        }
+                        snprintf(what, sizeof(what), "%s %s\"%s\" at (%d, %d)", f ? "sans11" : "sans16",
+                                 solid ? "on bg " : "", texts[t], x, y);
+                        gfx_text_measure(font, texts[t], &mw, &mh);
+                        if (mw != w || mh != h) {
+                            printf("%s: measured %dx%d, want %dx%d\n", what, mw, mh, w, h);
+                            return false;
+                        }
+                        if (!frames_equal(what, &ref_fb, &out_fb) || !damage_is_box(&out_fb, x, y, w, h, what)) {
+                            return false;
+                        }
+                    }
+                }
+            }
+        }
+    }
+    if (!saw_partial || !saw_full) {
+        printf("aa: the texts drew no %s pixels\n", saw_full ? "partly covered" : "fully covered");
+        return false;
+    }
+
+    // A laid-out run drawn through views cut across it, as render strips
+    // see it.
+    gfx_glyph_pos_t run[32];
+    for (int y0 = 0; y0 < 30; y0 += 4) {
+        gfx_rect_t r = { (int16_t)(y0 & 8), (int16_t)y0, TEST_W, (int16_t)(y0 + 4) };
+        fb_bind(&ref_fb);
+        fill_pattern();
+        fb_bind(&out_fb);
+        fill_pattern();
+        gfx_fb_t ref_view, out_view;
+        gfx_fb_view(&ref_view, &ref_fb, &r);
+        gfx_fb_view(&out_view, &out_fb, &r);
+        int w, h;
+        fb_bind(&ref_view);
+        ref_string(&sans16, 5 - r.x0, 2 - y0, "Strip\nWAVE", 0xFFFF, false, 0, &w, &h);
+        fb_bind(&out_view);
+        size_t n = gfx_text_layout(&sans16, 5 - r.x0, 2 - y0, "Strip\nWAVE", run, 32);
+        fb_draw_glyphs(&sans16, run, n, 0xFFFF);
+        snprintf(what, sizeof(what), "sans16 in a view from (%d, %d)", r.x0, y0);
+        if (!frames_equal(what, &ref_fb, &out_fb)) {
+            return false;
+        }
+        if (out_view.dirty_count != 0) {
+            printf("%s: fb_draw_glyphs() recorded damage\n", what);
+            return false;
+        }
+    }
+    return true;
+}
+
+int main(void) {
+    test_frames_init();
+    static const test_case_t tests[] = {
+        { "5x7 text", test_5x7 },
+        { "aa text", test_aa },
+    };
+    return test_run_all(tests, sizeof(tests) / sizeof(tests[0]));
+}
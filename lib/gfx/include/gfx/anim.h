@@ -0,0 +1,67 @@
+#pragma once
+
+#include <stdbool.h>
+#include <stdint.h>
+
+// Sprite sheets and frame timelines.
+//
+// A sheet holds equally sized frames of 2-bit palette indices (up to four
+// colours), stored one of two ways:
+//  - GFX_SHEET_PACKED2: four pixels per byte, leftmost in the top bits, each
+//    row padded to a whole byte; frame f starts at f * h * ((w + 3) / 4).
+//  - GFX_SHEET_RLE: one byte per run, the index in bits 1:0 and the run
+//    length minus one in bits 7:2; runs continue across rows, and offsets[f]
+//    is where frame f starts in data.
+typedef enum {
+    GFX_SHEET_PACKED2,
+    GFX_SHEET_RLE,
+} gfx_sheet_format_t;
+
+#define GFX_SHEET_OPAQUE (-1) // key for frames drawn without transparency
+
+typedef struct {
+    uint8_t format;
+    uint8_t w, h;
+    uint8_t frame_count;
+    const uint8_t *data;
+    const uint16_t *offsets; // GFX_SHEET_RLE only
+    const uint16_t *palette;
+} gfx_sheet_t;
+
+// Draws one frame with its top-left at (x, y), clipped to fb_target, and marks
+// it dirty. Pixels with index key are skipped (GFX_SHEET_OPAQUE draws all);
+// opaque RLE runs are written as span fills.
+void fb_draw_sheet(int x, int y, const gfx_sheet_t *sheet, unsigned frame, int key);
+
+// One timeline step: show sheet frame `frame` for `ms` milliseconds.
+typedef struct {
+    uint8_t frame;
+    uint16_t ms;
+} gfx_anim_step_t;
+
+// Playback state of a timeline. It holds no clock: the caller passes the time
+// elapsed since the last call to gfx_anim_advance(), so the same timeline runs
+// from a hardware alarm, an RTOS timer or a host test loop.
+typedef struct {
+    const gfx_anim_step_t *steps;
+    uint8_t step_count;
+    uint8_t step;     // current step
+    bool loop;
+    bool done;        // a non-looping timeline has played its last step
+    uint32_t step_ms; // time spent in the current step
+} gfx_anim_t;
+
+void gfx_anim_start(gfx_anim_t *anim, const gfx_anim_step_t *steps, uint8_t count, bool loop);
+
+// Advances by elapsed_ms, skipping any steps that fit entirely in it (a late
+// caller drops frames instead of drifting). Returns true if the frame to show
+// changed.
+bool gfx_anim_advance(gfx_anim_t *anim, uint32_t elapsed_ms);
+
+// Milliseconds until the frame next changes; UINT32_MAX once a non-looping
+// timeline has finished.
+uint32_t gfx_anim_next_ms(const gfx_anim_t *anim);
+
+static inline uint8_t gfx_anim_frame(const gfx_anim_t *anim) {
+    return anim->steps[anim->step].frame;
+}
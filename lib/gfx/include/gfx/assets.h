@@ -0,0 +1,11 @@
+#pragma once
+
+// Built-in font and images. The tables and their size macros are generated
+// from lib/gfx/assets by tools/gfx_assets.py:
+//  - font5x7[96][5]: ASCII 32..127, columns LSB->MSB for rows;
+//  - heart_sheet / heart_palette: 16x16 heart, index 0 is its background;
+//  - gif_sheet / gif_palette / gif_timeline: the three-frame 12x12 pulse and
+//    its looping timeline (GIF_W, GIF_H, GIF_TIMELINE_STEPS);
+//  - sans16 / sans11: anti-aliased proportional fonts for gfx/text.h, 16 px
+//    at 4-bit and 11 px at 2-bit coverage (SANS16_LINE_HEIGHT, ...).
+#include "gfx/assets_data.h"
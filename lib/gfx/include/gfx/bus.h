@@ -0,0 +1,15 @@
+#pragma once
+
+#include <stddef.h>
+#include <stdint.h>
+
+// Byte-level link to a panel controller. Each call is one chip-select frame:
+// write_cmd sends a single byte with DC low, write_data sends bytes with DC
+// high. Firmware builds implement this on SPI (or bit-banged GPIO); host builds
+// use the memory-backed panel in gfx/panel_mem.h.
+typedef struct {
+    void *ctx;
+    void (*write_cmd)(void *ctx, uint8_t cmd);
+    void (*write_data)(void *ctx, const uint8_t *data, size_t len);
+    void (*delay_ms)(void *ctx, uint32_t ms);
+} gfx_bus_t;
@@ -0,0 +1,38 @@
+#pragma once
+
+#include <stdint.h>
+
+// Framebuffers hold RGB565 in panel wire order (big-endian) by default so they
+// can be streamed to the ST7789 without a byte swap. Build with
+// GFX_FB_WIRE_ORDER=0 (RP2350_GEEK_GFX_WIRE_ORDER=OFF) for native-order pixels.
+#ifndef GFX_FB_WIRE_ORDER
+#define GFX_FB_WIRE_ORDER 1
+#endif
+
+// Framebuffer depth. 16 stores RGB565 pixels; 8 and 4 store palette indices
+// (gfx/palette.h) that are looked up when the frame is flushed. Set with
+// RP2350_GEEK_GFX_BPP; the fb_* primitives take RGB565 colours in every mode.
+#ifndef GFX_FB_BPP
+#define GFX_FB_BPP 16
+#endif
+#if GFX_FB_BPP != 16 && GFX_FB_BPP != 8 && GFX_FB_BPP != 4
+#error "GFX_FB_BPP must be 16, 8 or 4"
+#endif
+#define GFX_FB_INDEXED (GFX_FB_BPP < 16)
+
+// Colours are produced directly in framebuffer storage order, so the fb_*
+// primitives never need to know which order is in use.
+#if GFX_FB_WIRE_ORDER
+#define RGB565_STORE(c) (uint16_t)((((c) & 0xFFu) << 8) | (((c) >> 8) & 0xFFu))
+#else
+#define RGB565_STORE(c) (uint16_t)(c)
+#endif
+
+// Storage order is its own inverse; LOAD reads a stored pixel back as native RGB565.
+#define RGB565_LOAD(c) RGB565_STORE(c)
+
+#define RGB565_CONST(r, g, b) RGB565_STORE((((r) & 0xF8u) << 8) | (((g) & 0xFCu) << 3) | ((b) >> 3))
+
+static inline uint16_t rgb565(uint8_t r, uint8_t g, uint8_t b) {
+    return RGB565_CONST(r, g, b);
+}
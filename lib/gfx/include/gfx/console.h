@@ -0,0 +1,41 @@
+#pragma once
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+#include "gfx/fb.h"
+#include "gfx/font.h"
+
+// Scrolling text console in the 5x7 font, meant for log output on a panel
+// with hardware scrolling (st7789_scroll_to()).
+//
+// The framebuffer is a ring of text lines in panel memory order: line k
+// always occupies rows k * GFX_CONSOLE_LINE_H and down, and the panel's
+// scroll offset (gfx_console_scroll_row()) decides which of them appears at
+// the top. Starting a new line once the screen is full only clears that line
+// and advances the offset, so the dirty list holds just the rows that changed
+// and a scroll costs one line of pixels plus a register write, not a frame.
+// The panel's scroll area must be the lines' rows, lines * GFX_CONSOLE_LINE_H.
+#define GFX_CONSOLE_LINE_H (FB_GLYPH_H + 1)
+
+typedef struct {
+    gfx_fb_t *fb;
+    uint16_t fg, bg;
+    uint8_t cols, lines; // text grid: fb->width / FB_GLYPH_W by fb->height / GFX_CONSOLE_LINE_H
+    uint8_t line, col;   // cursor; line is a ring index
+    uint8_t top;         // ring line shown at the top of the screen
+} gfx_console_t;
+
+// Clears fb to bg and marks it dirty; the cursor starts at the top-left.
+void gfx_console_init(gfx_console_t *con, gfx_fb_t *fb, uint16_t fg, uint16_t bg);
+
+// Appends len characters: '\n' starts a new line, '\r' returns to its start,
+// and lines longer than the grid wrap. Draws into the console's framebuffer
+// (fb_target is restored afterwards) and marks what changed dirty.
+void gfx_console_write(gfx_console_t *con, const char *text, size_t len);
+
+// Framebuffer row to show at the top of the panel.
+static inline uint16_t gfx_console_scroll_row(const gfx_console_t *con) {
+    return (uint16_t)(con->top * GFX_CONSOLE_LINE_H);
+}
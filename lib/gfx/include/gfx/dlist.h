@@ -0,0 +1,135 @@
+#pragma once
+
+#include <stdbool.h>
+#include <stdint.h>
+
+#include "gfx/anim.h"
+#include "gfx/fb.h"
+#include "gfx/text.h"
+
+// Display lists: a page recorded as drawing ops so it can be replayed into
+// any part of the frame. Replaying into a full framebuffer gives the same
+// pixels as calling the fb_* primitives directly; replaying into a small
+// strip buffer renders the frame a band at a time, so a page can be shown
+// without a full-frame framebuffer. Ops keep pointers to their text and
+// pixel data, which must outlive the list.
+//
+// A list is also a retained scene: the gfx_dl_set_*() calls change an op in
+// place and record its old and new bounds as damage, and
+// gfx_dl_render_damage() then replays only the damaged areas, which redraws
+// just the ops overlapping them (background included).
+#ifndef GFX_DL_MAX_OPS
+#define GFX_DL_MAX_OPS 24
+#endif
+
+typedef enum {
+    GFX_DL_CLEAR,
+    GFX_DL_RECT,
+    GFX_DL_TEXT,   // 5x7 text, or a gfx_font_t label when font is set
+    GFX_DL_ICON,
+    GFX_DL_SPRITE, // icon whose key index is transparent
+    GFX_DL_SHEET,  // one frame of a gfx_sheet_t
+    GFX_DL_CUSTOM,
+} gfx_dl_kind_t;
+
+// Custom ops draw into fb_target, a view of the part of their bounds being
+// replayed: its pixel (0, 0) is frame pixel (ox, oy) and width/height give
+// the area to cover. At 4bpp the view may start one pixel left of the bounds.
+typedef void (*gfx_dl_draw_fn)(int ox, int oy, void *user);
+
+#define GFX_DL_HIDDEN 0x01
+
+typedef struct {
+    uint8_t kind;
+    uint8_t flags;
+    uint8_t scale;
+    uint16_t fg, bg;
+    gfx_rect_t bounds; // frame area the op touches; ops outside a replay area are skipped
+    union {
+        struct {
+            const char *text;
+            const gfx_font_t *font;
+        };
+        struct {
+            const uint8_t *pixels;
+            const uint16_t *palette;
+            uint8_t key;
+        } icon;
+        struct {
+            const gfx_sheet_t *sheet;
+            uint8_t frame;
+            int8_t key; // GFX_SHEET_OPAQUE or the transparent index
+        } sheet;
+        struct {
+            gfx_dl_draw_fn fn;
+            void *user;
+        } custom;
+    };
+} gfx_dl_op_t;
+
+typedef struct {
+    gfx_dl_op_t ops[GFX_DL_MAX_OPS];
+    uint8_t count;
+    gfx_rect_t damage[GFX_DIRTY_MAX]; // frame areas changed since the last render
+    uint8_t damage_count;
+} gfx_dlist_t;
+
+static inline void gfx_dl_reset(gfx_dlist_t *dl) {
+    dl->count = 0;
+    dl->damage_count = 0;
+}
+
+// Appenders mirror the fb_* primitives and return the op so its fields can be
+// changed before the next replay (e.g. an animation frame), or NULL when the
+// list is full.
+gfx_dl_op_t *gfx_dl_clear(gfx_dlist_t *dl, uint16_t color);
+gfx_dl_op_t *gfx_dl_rect(gfx_dlist_t *dl, int x, int y, int w, int h, uint16_t color);
+gfx_dl_op_t *gfx_dl_text(gfx_dlist_t *dl, int x, int y, const char *text, uint16_t fg, uint16_t bg, int scale);
+// Anti-aliased text in font, blended over whatever the ops before it drew.
+gfx_dl_op_t *gfx_dl_label(gfx_dlist_t *dl, int x, int y, const gfx_font_t *font, const char *text, uint16_t fg);
+gfx_dl_op_t *gfx_dl_icon(gfx_dlist_t *dl, int x, int y, int w, int h, const uint8_t *pixels, const uint16_t *palette);
+gfx_dl_op_t *gfx_dl_sprite(gfx_dlist_t *dl, int x, int y, int w, int h, const uint8_t *pixels, const uint16_t *palette,
+                           uint8_t key);
+gfx_dl_op_t *gfx_dl_sheet(gfx_dlist_t *dl, int x, int y, const gfx_sheet_t *sheet, unsigned frame, int key);
+gfx_dl_op_t *gfx_dl_custom(gfx_dlist_t *dl, int x, int y, int w, int h, gfx_dl_draw_fn fn, void *user);
+
+// Property updates; each damages the op's bounds before and after the change.
+// gfx_dl_set_text() takes the new string (it may be the same buffer, rewritten).
+void gfx_dl_invalidate(gfx_dlist_t *dl, const gfx_rect_t *r);
+void gfx_dl_set_text(gfx_dlist_t *dl, gfx_dl_op_t *op, const char *text);
+void gfx_dl_set_color(gfx_dlist_t *dl, gfx_dl_op_t *op, uint16_t fg, uint16_t bg);
+void gfx_dl_set_pixels(gfx_dlist_t *dl, gfx_dl_op_t *op, const uint8_t *pixels);
+void gfx_dl_set_frame(gfx_dlist_t *dl, gfx_dl_op_t *op, unsigned frame);
+void gfx_dl_set_rect(gfx_dlist_t *dl, gfx_dl_op_t *op, int x, int y, int w, int h);
+void gfx_dl_move(gfx_dlist_t *dl, gfx_dl_op_t *op, int x, int y);
+void gfx_dl_set_visible(gfx_dlist_t *dl, gfx_dl_op_t *op, bool visible);
+
+// Replays the list into fb_target, limited to area (NULL for the whole
+// frame), and marks that area dirty. Pixels outside it are left untouched.
+void gfx_dl_render_area(const gfx_dlist_t *dl, const gfx_rect_t *area);
+
+static inline void gfx_dl_render(const gfx_dlist_t *dl) {
+    gfx_dl_render_area(dl, NULL);
+}
+
+// Replays the damaged areas into fb_target (marking them dirty) and clears
+// the damage.
+void gfx_dl_render_damage(gfx_dlist_t *dl);
+
+// Where finished strips go. send() starts transmitting strip's dirty rect to
+// frame rows y.. (strip row 0 is frame row y) and may return before it is
+// done; wait() blocks until the last send no longer needs its strip.
+typedef struct {
+    void (*send)(void *ctx, gfx_fb_t *strip, int y, bool last);
+    void (*wait)(void *ctx);
+    void *ctx;
+} gfx_strip_sink_t;
+
+// Renders area (NULL for the whole frame_h-line frame) in bands of
+// strips[0].height lines, alternating between the two strip buffers so band
+// k + 1 is drawn while band k is being sent. The strips are frame-wide.
+void gfx_dl_render_strips(const gfx_dlist_t *dl, gfx_fb_t strips[2], int frame_h, const gfx_rect_t *area,
+                          const gfx_strip_sink_t *sink);
+
+// gfx_dl_render_strips() over each damaged area; clears the damage.
+void gfx_dl_render_damage_strips(gfx_dlist_t *dl, gfx_fb_t strips[2], int frame_h, const gfx_strip_sink_t *sink);
@@ -0,0 +1,134 @@
+#pragma once
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+#include "gfx/color.h"
+#include "gfx/palette.h"
+
+#define GFX_DIRTY_MAX 8
+
+// Framebuffer storage unit: an RGB565 pixel at 16bpp, a palette index at
+// 8bpp, and two indices at 4bpp (left pixel in the high nibble).
+#if GFX_FB_BPP == 16
+typedef uint16_t gfx_pixel_t;
+#else
+typedef uint8_t gfx_pixel_t;
+#endif
+
+// Storage units covering n pixels, and the array length of a w x h framebuffer.
+#define GFX_FB_UNITS(n) (GFX_FB_BPP == 4 ? ((n) + 1) / 2 : (n))
+#define GFX_FB_LEN(w, h) ((size_t)GFX_FB_UNITS(w) * (h))
+
+// Damaged region, half-open [x0, x1) x [y0, y1) in framebuffer coordinates.
+typedef struct {
+    int16_t x0, y0, x1, y1;
+} gfx_rect_t;
+
+// A framebuffer together with the damage drawn into it since its last flush.
+typedef struct {
+    gfx_pixel_t *pixels;
+    int16_t width;
+    int16_t height;
+    int16_t stride; // storage units per row
+#if GFX_FB_INDEXED
+    gfx_palette_t *palette;
+    gfx_palette_memo_t memo; // this frame's last colour lookup in palette
+#endif
+    gfx_rect_t dirty[GFX_DIRTY_MAX];
+    uint8_t dirty_count;
+} gfx_fb_t;
+
+// Render target of the fb_* primitives (see fb_bind()).
+extern gfx_fb_t *fb_target;
+
+// Indexed framebuffers start on gfx_palette_default(); point fb->palette
+// elsewhere to give a frame its own colours.
+void gfx_fb_init(gfx_fb_t *fb, gfx_pixel_t *pixels, int width, int height);
+
+// Makes view a framebuffer over the r part of fb's pixels (clipped to fb),
+// sharing its storage and palette; view's (0, 0) is fb's (r->x0, r->y0). At
+// 4bpp r->x0 must be even. The view starts with no damage.
+void gfx_fb_view(gfx_fb_t *view, const gfx_fb_t *fb, const gfx_rect_t *r);
+
+// Selects the framebuffer that the fb_* primitives draw into.
+static inline void fb_bind(gfx_fb_t *fb) {
+    fb_target = fb;
+}
+
+static inline int32_t gfx_rect_area(const gfx_rect_t *r) {
+    return (int32_t)(r->x1 - r->x0) * (r->y1 - r->y0);
+}
+
+// Value stored for an RGB565 colour: the colour itself, or its palette index.
+static inline gfx_pixel_t gfx_fb_value(gfx_fb_t *fb, uint16_t color) {
+#if GFX_FB_INDEXED
+    return gfx_palette_index(fb->palette, &fb->memo, color);
+#else
+    (void)fb;
+    return color;
+#endif
+}
+
+// Unclipped access to the stored value at (x, y).
+static inline void gfx_fb_put(gfx_fb_t *fb, int x, int y, gfx_pixel_t v) {
+#if GFX_FB_BPP == 4
+    gfx_pixel_t *p = &fb->pixels[y * fb->stride + (x >> 1)];
+    *p = (x & 1) ? (gfx_pixel_t)((*p & 0xF0) | v) : (gfx_pixel_t)((*p & 0x0F) | (v << 4));
+#else
+    fb->pixels[y * fb->stride + x] = v;
+#endif
+}
+
+static inline gfx_pixel_t gfx_fb_get(const gfx_fb_t *fb, int x, int y) {
+#if GFX_FB_BPP == 4
+    gfx_pixel_t b = fb->pixels[y * fb->stride + (x >> 1)];
+    return (x & 1) ? (gfx_pixel_t)(b & 0x0F) : (gfx_pixel_t)(b >> 4);
+#else
+    return fb->pixels[y * fb->stride + x];
+#endif
+}
+
+// fb_set_pixel() does not record damage; callers that poke pixels directly
+// mark the covering rect themselves.
+static inline void fb_set_pixel(int x, int y, uint16_t color) {
+    gfx_fb_t *fb = fb_target;
+    if ((unsigned)x < (unsigned)fb->width && (unsigned)y < (unsigned)fb->height) {
+        gfx_fb_put(fb, x, y, gfx_fb_value(fb, color));
+    }
+}
+
+// Writes n storage units of one value using word-wide stores (at 4bpp a unit
+// is a pixel pair, so value carries the index in both nibbles).
+void fb_fill_span(gfx_pixel_t *dst, size_t n, gfx_pixel_t value);
+
+// Adds r to a damage list of up to GFX_DIRTY_MAX rects, merging it with
+// nearby entries (fb_mark_dirty() uses this on fb_target's list).
+void gfx_damage_add(gfx_rect_t rects[GFX_DIRTY_MAX], uint8_t *count, gfx_rect_t r);
+
+void fb_mark_dirty(int x, int y, int w, int h);
+void fb_mark_all_dirty(void);
+
+void fb_clear(uint16_t color);
+// Fills without recording damage; used inside primitives that mark their own bounds.
+void fb_fill_rect(int x, int y, int w, int h, uint16_t color);
+void fb_draw_rect(int x, int y, int w, int h, uint16_t color);
+// Blits a w x h block of palette indices.
+void fb_draw_icon(int x, int y, int w, int h, const uint8_t *pixels, const uint16_t *palette);
+
+// Like fb_draw_icon() but pixels with index key are left as they are, so the
+// sprite shows whatever was drawn under it.
+void fb_draw_sprite(int x, int y, int w, int h, const uint8_t *pixels, const uint16_t *palette, uint8_t key);
+
+static inline void fb_draw_icon16(int x, int y, const uint8_t *pixels, const uint16_t *palette) {
+    fb_draw_icon(x, y, 16, 16, pixels, palette);
+}
+
+// Copies the given rects from src into dst (same dimensions); no damage is recorded.
+void gfx_fb_copy_rects(gfx_fb_t *dst, const gfx_fb_t *src, const gfx_rect_t *rects, size_t count);
+
+// Writes n pixels starting at (x, y) to out as panel wire-order RGB565 (2 bytes
+// per pixel), looking indexed pixels up in fb->palette. Runs past the end of
+// a row continue at the start of the next one.
+void gfx_fb_expand_wire(const gfx_fb_t *fb, int x, int y, size_t n, uint8_t *out);
@@ -0,0 +1,28 @@
+#pragma once
+
+#include <stdint.h>
+
+#define FB_GLYPH_W 6 // 5 font columns + 1 spacing column
+#define FB_GLYPH_H 7
+#define FB_GLYPH_MAX_SCALE 4
+
+// 5x7 text in the built-in font5x7; scale is clamped to 1..FB_GLYPH_MAX_SCALE
+// and '\n' starts a new line 8 * scale pixels down.
+void fb_draw_char_scaled(int x, int y, char c, uint16_t fg, uint16_t bg, int scale);
+void fb_draw_text_scaled(int x, int y, const char *text, uint16_t fg, uint16_t bg, int scale);
+
+static inline void fb_draw_char(int x, int y, char c, uint16_t fg, uint16_t bg) {
+    fb_draw_char_scaled(x, y, c, fg, bg, 1);
+}
+
+static inline void fb_draw_text(int x, int y, const char *text, uint16_t fg, uint16_t bg) {
+    fb_draw_text_scaled(x, y, text, fg, bg, 1);
+}
+
+static inline void fb_draw_char_2x(int x, int y, char c, uint16_t fg, uint16_t bg) {
+    fb_draw_char_scaled(x, y, c, fg, bg, 2);
+}
+
+static inline void fb_draw_text_2x(int x, int y, const char *text, uint16_t fg, uint16_t bg) {
+    fb_draw_text_scaled(x, y, text, fg, bg, 2);
+}
@@ -0,0 +1,62 @@
+#pragma once
+
+#include <stdbool.h>
+#include <stdint.h>
+
+// Frame pacing.
+//
+// Frames are presented on a fixed grid of vsync ticks: the panel's TE pulses
+// where that pin is wired, otherwise a repeating timer at the panel's refresh
+// rate. Every ticks_per_frame-th tick is a frame slot. A finished frame is
+// only flushed at a slot, right as the panel starts a refresh, so the frame
+// rate is fixed and, with TE, the flush runs ahead of the panel's scan. A
+// frame that misses its slot (still rendering, or the previous flush still
+// running) waits for the next one, and the slots it missed are counted as
+// dropped. The grid itself never moves, so a slow frame costs frames instead
+// of pushing every later frame back. Like gfx_anim_t it holds no clock: the
+// caller passes the time.
+//
+// The render side calls gfx_pacer_begin() when it starts a frame and
+// gfx_pacer_submit() when the frame is ready to flush; the tick side calls
+// gfx_pacer_tick() on every tick and starts the flush when it returns true.
+// The two sides may run on different cores or in an interrupt; the caller
+// orders the frame's pixels before gfx_pacer_submit().
+
+typedef struct {
+    uint32_t frames;  // presented
+    uint32_t dropped; // slots missed by late frames
+    // Since the last gfx_pacer_take_stats():
+    uint32_t render_max_us;  // gfx_pacer_begin() to gfx_pacer_submit()
+    uint32_t latency_max_us; // gfx_pacer_begin() to the frame's slot
+    uint64_t latency_sum_us;
+    uint32_t latency_count;
+} gfx_pace_stats_t;
+
+typedef struct {
+    uint16_t ticks_per_frame;
+    uint16_t tick;          // ticks into the current slot
+    volatile uint32_t slot; // slots since gfx_pacer_init()
+    uint32_t target;        // slot the frame being rendered is meant for
+    volatile bool ready;    // a submitted frame waits for a slot
+    uint64_t begin_us;
+    gfx_pace_stats_t stats;
+} gfx_pacer_t;
+
+void gfx_pacer_init(gfx_pacer_t *p, uint16_t ticks_per_frame);
+
+// Render side: a frame is started now, aimed at the next slot.
+void gfx_pacer_begin(gfx_pacer_t *p, uint64_t now_us);
+
+// Render side: the frame is ready; it goes out at the first slot where the
+// flush engine is idle.
+void gfx_pacer_submit(gfx_pacer_t *p, uint64_t now_us);
+
+// Tick side: call on every tick with whether the flush engine could start a
+// frame now. Returns true if this tick is a slot and the submitted frame is
+// to be flushed; it then counts as presented.
+bool gfx_pacer_tick(gfx_pacer_t *p, uint64_t now_us, bool idle);
+
+// Copies the statistics to out and restarts the windowed ones (frames and
+// dropped keep counting). Not safe against a concurrent gfx_pacer_tick();
+// mask the tick's interrupt around it.
+void gfx_pacer_take_stats(gfx_pacer_t *p, gfx_pace_stats_t *out);
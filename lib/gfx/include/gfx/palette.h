@@ -0,0 +1,71 @@
+#pragma once
+
+#include <stdbool.h>
+#include <stdint.h>
+
+#include "gfx/color.h"
+
+#if GFX_FB_INDEXED
+
+#define GFX_PALETTE_SIZE (1u << GFX_FB_BPP)
+
+// Entry colours of an indexed framebuffer, in storage order like every other
+// colour. Drawing maps a colour to an index once per primitive (per pixel for
+// fb_set_pixel()); the flush looks the indices back up.
+typedef struct {
+    uint16_t color[GFX_PALETTE_SIZE];
+    uint32_t gen; // bumped on every change, so memos know to search again
+} gfx_palette_t;
+
+// The last colour -> index search (4bpp). Palettes are shared between
+// framebuffers, and so between the cores rendering into them, so the memo
+// belongs to the caller instead: each gfx_fb_t keeps one for its palette.
+// Zeroed, it holds nothing.
+typedef struct {
+    const gfx_palette_t *pal;
+    uint32_t gen;
+    uint16_t color;
+    uint8_t index;
+} gfx_palette_memo_t;
+
+// Palette that gfx_fb_init() gives every framebuffer: an RGB332 cube at 8bpp,
+// the 16 VGA colours at 4bpp. Initialised statically, so it is ready on
+// either core without a lock.
+gfx_palette_t *gfx_palette_default(void);
+
+void gfx_palette_init_default(gfx_palette_t *pal);
+
+// Re-colours one entry: every pixel holding that index changes on the next
+// flush without being redrawn (mark the area dirty to send it).
+static inline void gfx_palette_set(gfx_palette_t *pal, uint8_t index, uint16_t color) {
+    pal->color[index % GFX_PALETTE_SIZE] = color;
+    pal->gen++;
+}
+
+// Closest entry to color by RGB distance.
+uint8_t gfx_palette_nearest(const gfx_palette_t *pal, uint16_t color);
+
+// Index that color is drawn with. At 8bpp this is the colour's RGB332 cell,
+// independent of the entries, so an animated entry keeps its pixels; at 4bpp
+// it is the nearest current entry, remembered in memo (which may be NULL).
+static inline uint8_t gfx_palette_index(const gfx_palette_t *pal, gfx_palette_memo_t *memo, uint16_t color) {
+#if GFX_FB_BPP == 8
+    (void)pal;
+    (void)memo;
+    uint16_t c = RGB565_LOAD(color);
+    return (uint8_t)(((c >> 13) << 5) | (((c >> 8) & 0x07) << 2) | ((c >> 3) & 0x03));
+#else
+    if (!memo) {
+        return gfx_palette_nearest(pal, color);
+    }
+    if (memo->pal != pal || memo->gen != pal->gen || memo->color != color) {
+        memo->index = gfx_palette_nearest(pal, color);
+        memo->pal = pal;
+        memo->gen = pal->gen;
+        memo->color = color;
+    }
+    return memo->index;
+#endif
+}
+
+#endif // GFX_FB_INDEXED
@@ -0,0 +1,49 @@
+#pragma once
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+#include "gfx/bus.h"
+
+// Memory-backed stand-in for an ST7789 controller. It decodes CASET, RASET,
+// RAMWR, MADCTL, COLMOD, the scroll commands and the on/off commands from the
+// byte stream and writes RAMWR data into a native-order RGB565 pixel array, so
+// rendering and flush code can be run and checked off-target. Addresses are
+// applied as sent; MADCTL and the scroll settings are recorded but not used to
+// rotate or scroll the memory.
+typedef struct {
+    uint16_t *pixels; // width * height, native RGB565
+    uint16_t width;
+    uint16_t height;
+
+    uint8_t cmd;
+    uint8_t params[6];
+    size_t param_len;
+    uint16_t x0, x1, y0, y1;
+    uint16_t cx, cy;
+    uint8_t hi_byte;
+    bool have_hi;
+
+    uint8_t madctl;
+    uint8_t colmod;
+    bool inverted;
+    bool awake;
+    bool display_on;
+    uint16_t scroll_top, scroll_lines, scroll_bottom; // VSCRDEF
+    uint16_t scroll_start;                            // VSCRSADD
+    bool scrolling;                                   // since VSCRSADD, until NORON
+
+    // Traffic counters, reset with gfx_panel_mem_reset_stats().
+    uint32_t cmd_count;
+    uint32_t data_bytes;
+    uint32_t pixels_written;
+} gfx_panel_mem_t;
+
+void gfx_panel_mem_init(gfx_panel_mem_t *panel, uint16_t *pixels, uint16_t width, uint16_t height);
+void gfx_panel_mem_reset_stats(gfx_panel_mem_t *panel);
+gfx_bus_t gfx_panel_mem_bus(gfx_panel_mem_t *panel);
+
+static inline uint16_t gfx_panel_mem_get(const gfx_panel_mem_t *panel, uint16_t x, uint16_t y) {
+    return panel->pixels[(size_t)y * panel->width + x];
+}
@@ -0,0 +1,87 @@
+#pragma once
+
+#include <stdint.h>
+
+// Stage timing for render and flush instrumentation.
+//
+// gfx_perf_now() reads a free-running 32-bit counter: the DWT cycle counter on
+// Cortex-M33, mcycle on Hazard3, and a monotonic nanosecond clock elsewhere,
+// so the same instrumentation builds for both RP2350 cores and the host.
+// GFX_PERF_CLOCK overrides the choice; GFX_PERF_CLOCK_EXTERN leaves
+// gfx_perf_clock_ns() to the application (Zephyr's native_sim, whose
+// simulated clock stands still while code runs). Durations are differences
+// of two readings, so a stage must take less than one counter wrap (about
+// 28 s at 150 MHz, 4 s in nanoseconds).
+//
+// A gfx_perf_stage_t aggregates durations into count, min, max, sum and a
+// histogram with four buckets per power of two, from which percentiles are
+// read to within a quarter of their value. Recording is a handful of
+// instructions and takes no lock; a stage fed from more than one context
+// (another core, an interrupt) needs the caller's exclusion around both
+// gfx_perf_record() and gfx_perf_take().
+
+#define GFX_PERF_CLOCK_DWT 1
+#define GFX_PERF_CLOCK_MCYCLE 2
+#define GFX_PERF_CLOCK_POSIX 3
+#define GFX_PERF_CLOCK_EXTERN 4
+
+#ifndef GFX_PERF_CLOCK
+#if defined(__ARM_ARCH_8M_MAIN__)
+#define GFX_PERF_CLOCK GFX_PERF_CLOCK_DWT
+#elif defined(__riscv) && !defined(__linux__)
+#define GFX_PERF_CLOCK GFX_PERF_CLOCK_MCYCLE
+#else
+#define GFX_PERF_CLOCK GFX_PERF_CLOCK_POSIX
+#endif
+#endif
+
+#define GFX_PERF_BUCKETS 124
+
+typedef struct {
+    uint32_t count;
+    uint32_t min, max; // counter ticks
+    uint64_t sum;
+    uint64_t units;    // what the stage moved (e.g. bytes), for a rate
+    uint32_t hist[GFX_PERF_BUCKETS];
+} gfx_perf_stage_t;
+
+typedef struct {
+    uint32_t count;
+    uint32_t min_us, avg_us, p99_us, max_us;
+    uint32_t units_per_s; // 0 if no units were recorded
+} gfx_perf_summary_t;
+
+#if GFX_PERF_CLOCK == GFX_PERF_CLOCK_POSIX || GFX_PERF_CLOCK == GFX_PERF_CLOCK_EXTERN
+uint64_t gfx_perf_clock_ns(void);
+#endif
+
+// Starts the counter on the calling core (each core has its own) and sets
+// the rate used to turn ticks into time; the nanosecond clocks ignore hz.
+void gfx_perf_init(uint32_t cpu_hz);
+
+static inline uint32_t gfx_perf_now(void) {
+#if GFX_PERF_CLOCK == GFX_PERF_CLOCK_DWT
+    return *(volatile uint32_t *)0xE0001004u; // DWT_CYCCNT
+#elif GFX_PERF_CLOCK == GFX_PERF_CLOCK_MCYCLE
+    uint32_t cycles;
+    __asm volatile("csrr %0, mcycle" : "=r"(cycles));
+    return cycles;
+#else
+    return (uint32_t)gfx_perf_clock_ns();
+#endif
+}
+
+// Ticks (a gfx_perf_now() difference or sum) in microseconds.
+uint32_t gfx_perf_us(uint64_t ticks);
+
+void gfx_perf_reset(gfx_perf_stage_t *s);
+
+// Adds one duration (gfx_perf_now() difference) and the units it moved.
+void gfx_perf_record(gfx_perf_stage_t *s, uint32_t ticks, uint32_t units);
+
+// Copies the stage to out and starts a new window.
+void gfx_perf_take(gfx_perf_stage_t *s, gfx_perf_stage_t *out);
+
+// Times in microseconds; p99 is the upper edge of its histogram bucket,
+// clamped to max.
+void gfx_perf_summarize(const gfx_perf_stage_t *s, gfx_perf_summary_t *out);
@@ -0,0 +1,63 @@
+#pragma once
+
+#include <stdint.h>
+
+#include "gfx/fb.h"
+
+// Colour interpolation kernels.
+//
+// Colours are stepped incrementally (DDA style) instead of being divided out
+// per pixel: each channel is carried in 32.32 fixed point with a step scaled
+// by a reciprocal worked out once per fill, so a pixel costs one add per
+// channel and the result is still exactly the floor of the interpolated
+// value. At 16bpp rows are written two pixels per 32-bit store. Like
+// fb_fill_rect(), these clip to fb_target and record no damage.
+
+// Largest ramp denominator (and fb_fill_corners() width or height) for which
+// the fixed-point stepping is exact.
+#define GFX_RAMP_DEN_MAX 4096
+
+// One 8-bit channel as an affine function of the position (x, y) relative to
+// the gradient origin: c0 + floor((dx * x + dy * y) / den), with
+// 0 < den <= GFX_RAMP_DEN_MAX. The value must stay within 0..255 over the
+// filled area.
+typedef struct {
+    int32_t c0, dx, dy, den;
+} gfx_ramp_t;
+
+// Channel going from `from` to `to` over `span` steps of (wx, wy): (1, 0)
+// runs left to right, (0, 1) top to bottom, (1, 1) along the diagonal
+// (x + y). The value at step `span` would be `to`.
+static inline gfx_ramp_t gfx_ramp(uint8_t from, uint8_t to, int wx, int wy, int span) {
+    int32_t d = (int32_t)to - from;
+    return (gfx_ramp_t){ from, d * wx, d * wy, span };
+}
+
+typedef struct {
+    gfx_ramp_t r, g, b;
+    int16_t x0, y0; // framebuffer position of the ramps' (0, 0)
+} gfx_gradient_t;
+
+// Fills the rect with rgb565(r(x, y), g(x, y), b(x, y)).
+void fb_fill_gradient(int x, int y, int w, int h, const gfx_gradient_t *g);
+
+// Fills the rect with a bilinear blend of four RGB565 corner colours (top
+// left, top right, bottom left, bottom right), interpolated per 8-bit
+// channel; the corner pixels get the corner colours exactly. w and h are
+// at most GFX_RAMP_DEN_MAX + 1.
+void fb_fill_corners(int x, int y, int w, int h, uint16_t tl, uint16_t tr, uint16_t bl, uint16_t br);
+
+// Mixes two RGB565 colours: alpha 0 gives a, 255 gives b. Channels are
+// weighted in 1/32 steps, all three in one 32-bit multiply-add.
+static inline uint16_t gfx_blend565(uint16_t a, uint16_t b, uint8_t alpha) {
+    uint32_t w = ((uint32_t)alpha + 4) >> 3;
+    uint32_t na = RGB565_LOAD(a), nb = RGB565_LOAD(b);
+    uint32_t sa = (na | (na << 16)) & 0x07E0F81Fu;
+    uint32_t sb = (nb | (nb << 16)) & 0x07E0F81Fu;
+    uint32_t s = ((sa * (32 - w) + sb * w) >> 5) & 0x07E0F81Fu;
+    return RGB565_STORE((uint16_t)(s | (s >> 16)));
+}
+
+// Blends color over the pixels already in the rect (gfx_blend565() with the
+// existing pixel as a); indexed pixels are looked up and re-mapped.
+void fb_blend_rect(int x, int y, int w, int h, uint16_t color, uint8_t alpha);
@@ -0,0 +1,41 @@
+#pragma once
+
+#include <stddef.h>
+#include <stdint.h>
+
+#include "gfx/fb.h"
+
+// Framebuffer snapshots, compressed a few bytes at a time so they can be
+// streamed over a slow link without holding up the caller.
+//
+// The stream is the frame's pixels in raster order as wire-order RGB565
+// (indexed frames are looked up in their palette), run-length coded per row:
+//
+//   0x00-0x7F  literal: (byte + 1) pixels follow, 2 bytes each
+//   0x80-0xFF  run: the next pixel repeats (byte - 0x7F) times
+//
+// Tokens never cross a row. UI frames are mostly flat fills and text, so the
+// stream is typically a tenth of the raw frame; noise costs 1 byte per 128
+// pixels. first_row is the row output first, wrapping at the bottom, for a
+// ring such as a scrolled console (gfx_console_scroll_row()).
+//
+// The encoder only reads the framebuffer; whoever draws into it must hold
+// off until the snapshot is done, or the stream shows a mix of frames.
+
+typedef struct {
+    const gfx_fb_t *fb;
+    int16_t first_row;
+    int16_t row, x;  // next pixel, rows counted from first_row
+    uint32_t bytes;  // output so far
+    uint32_t crc;    // gfx_crc32() of the output so far
+} gfx_snap_t;
+
+void gfx_snap_begin(gfx_snap_t *s, const gfx_fb_t *fb, int first_row);
+
+// Writes the next tokens to out, at most cap bytes (cap >= 3); returns the
+// count, 0 once the whole frame has been output.
+size_t gfx_snap_read(gfx_snap_t *s, uint8_t *out, size_t cap);
+
+// CRC-32 (IEEE 802.3, as zlib.crc32()): pass 0 to start, or the previous
+// result to continue.
+uint32_t gfx_crc32(uint32_t crc, const uint8_t *data, size_t len);
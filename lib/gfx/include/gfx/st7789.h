@@ -0,0 +1,64 @@
+#pragma once
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+#include "gfx/bus.h"
+#include "gfx/fb.h"
+
+#define ST7789_CASET 0x2A
+#define ST7789_RASET 0x2B
+#define ST7789_RAMWR 0x2C
+#define ST7789_MADCTL 0x36
+#define ST7789_COLMOD 0x3A
+#define ST7789_INVOFF 0x20
+#define ST7789_INVON 0x21
+#define ST7789_SLPOUT 0x11
+#define ST7789_DISPON 0x29
+#define ST7789_NORON 0x13
+#define ST7789_VSCRDEF 0x33
+#define ST7789_VSCRSADD 0x37
+#define ST7789_TEON 0x35
+
+#define ST7789_MADCTL_MY 0x80
+#define ST7789_MADCTL_MV 0x20
+#define ST7789_RAM_LINES 320 // frame memory lines, the axis hardware scrolling runs along
+
+typedef struct {
+    uint16_t width;
+    uint16_t height;
+    uint16_t x_offset; // visible area position inside the controller's memory
+    uint16_t y_offset;
+    uint8_t madctl;
+    bool invert;
+    bool tear_sync; // drive the TE pin: a pulse as each refresh enters vertical blanking
+} st7789_config_t;
+
+// Minimal init sequence for 16-bit colour; the caller handles the reset pin and backlight.
+void st7789_init(const gfx_bus_t *bus, const st7789_config_t *cfg);
+
+// Sets the CASET/RASET window (panel coordinates) and issues RAMWR.
+void st7789_set_window(const gfx_bus_t *bus, const st7789_config_t *cfg, uint16_t x, uint16_t y, uint16_t w, uint16_t h);
+
+// Streams framebuffer pixels after st7789_set_window(). Wire-order pixels go
+// out as-is; native-order pixels are byte-swapped through a small stack buffer.
+void st7789_write_pixels(const gfx_bus_t *bus, const uint16_t *pixels, size_t count);
+
+// Hardware vertical scrolling. The controller scrolls its frame memory lines,
+// which are panel rows only while MADCTL leaves MV clear, so cfg describes the
+// panel in that (portrait) orientation; cfg->height rows starting at
+// cfg->y_offset become the scrolling area. st7789_scroll_begin() switches to
+// cfg's MADCTL and defines the area; st7789_scroll_to() then shows cfg row
+// `row` at the top of the panel, the rows after it wrapping round, as a
+// one-command update; st7789_scroll_end() returns to normal display mode with
+// restore's MADCTL. With MY set the memory rows are mirrored, which
+// st7789_scroll_to() accounts for.
+void st7789_scroll_begin(const gfx_bus_t *bus, const st7789_config_t *cfg);
+void st7789_scroll_to(const gfx_bus_t *bus, const st7789_config_t *cfg, uint16_t row);
+void st7789_scroll_end(const gfx_bus_t *bus, const st7789_config_t *restore);
+
+// Blocking flush of the framebuffer's dirty rects; consumes the dirty list and
+// returns the number of pixels sent. Indexed framebuffers are looked up in
+// their palette on the way out.
+size_t st7789_flush_dirty(const gfx_bus_t *bus, const st7789_config_t *cfg, gfx_fb_t *fb);
@@ -0,0 +1,42 @@
+#pragma once
+
+#include <stddef.h>
+#include <stdint.h>
+
+#include "gfx/fb.h"
+
+// Ping-pong staging of a flush window for a transport that cannot read the
+// framebuffer as it is (native-order or indexed pixels): the window is
+// expanded to wire-order RGB565 into two chunk buffers of chunk_px pixels
+// each. One is on the wire while the other is filled, so the transport never
+// waits for the expansion and the framebuffer is read only as far as the
+// wire has got. A window the width of the frame is one run of w * h pixels,
+// so its chunks stay full across row ends.
+//
+// gfx_stream_begin() fills the first buffer and gfx_stream_next() is called
+// each time the chunk on the wire has drained; both return the pixels of the
+// chunk to send next, at gfx_stream_chunk(), without converting anything.
+// Once that chunk is on the wire, gfx_stream_refill() fills the other
+// buffer, so the conversion overlaps the transfer. The window is done when
+// gfx_stream_next() returns 0.
+
+typedef struct {
+    uint8_t *buf[2]; // chunk_px * 2 bytes each
+    size_t chunk_px;
+    const gfx_fb_t *frame;
+    int16_t x, y;    // start of the current row
+    size_t col;      // pixels of it staged
+    size_t row_px, rows_left;
+    size_t staged_px[2];
+    uint8_t active;  // buffer on the wire
+} gfx_stream_t;
+
+void gfx_stream_init(gfx_stream_t *s, uint8_t *buf0, uint8_t *buf1, size_t chunk_px);
+
+size_t gfx_stream_begin(gfx_stream_t *s, const gfx_fb_t *frame, const gfx_rect_t *r);
+size_t gfx_stream_next(gfx_stream_t *s);
+void gfx_stream_refill(gfx_stream_t *s);
+
+static inline const uint8_t *gfx_stream_chunk(const gfx_stream_t *s) {
+    return s->buf[s->active];
+}
@@ -0,0 +1,41 @@
+#pragma once
+
+#include <stdbool.h>
+#include <stdint.h>
+
+#include "gfx/fb.h"
+
+// Flush-side bookkeeping of a multi-buffered display.
+//
+// The render side hands finished frames over by index (gfx_swap_ready());
+// at each frame slot with the flush engine idle, the flush side makes the
+// newest of them the front frame (gfx_swap_flip()) and flushes it. A ready
+// frame replaced before its slot came was never shown, but the frame that
+// replaces it was drawn on top of its pixels: its damage moves into the
+// replacing frame, falling back to the whole frame when the two lists do not
+// fit in one. The indices these return are free again and go back to the
+// render side; moving them is up to the caller (bus channels in the demo).
+//
+// Both functions belong to the flush side; the caller orders a frame's pixels
+// and dirty list before handing its index over.
+
+typedef struct {
+    gfx_fb_t *frames;
+    volatile int8_t front;   // being flushed or last shown, -1 before the first
+    volatile int8_t pending; // ready and waiting for a slot, or -1
+} gfx_swap_t;
+
+void gfx_swap_init(gfx_swap_t *s, gfx_fb_t *frames);
+
+// Frame idx is ready. Returns the index of the frame it supersedes, whose
+// buffer is free again, or -1.
+int gfx_swap_ready(gfx_swap_t *s, int idx);
+
+// At a slot: makes the pending frame the front one; the caller starts its
+// flush. Returns false with nothing pending; otherwise *freed gets the
+// previous front frame, free once the new one is flushing, or -1.
+bool gfx_swap_flip(gfx_swap_t *s, int *freed);
+
+// Moves from's damage into into's list, or marks all of into when the merged
+// list would not fit in GFX_DIRTY_MAX rects; from is left with none.
+void gfx_damage_move(gfx_fb_t *into, gfx_fb_t *from);
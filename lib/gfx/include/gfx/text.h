@@ -0,0 +1,70 @@
+#pragma once
+
+#include <stddef.h>
+#include <stdint.h>
+
+#include "gfx/fb.h"
+
+// Proportional anti-aliased fonts.
+//
+// A font is a flash-resident atlas that tools/gfx_assets.py renders from a
+// TrueType source: per character a glyph record and a bitmap of 2- or 4-bit
+// coverage values (row-major, first pixel in the high bits, rows padded to a
+// whole byte), plus the kerning pairs that survive rounding to pixels. Glyph
+// rows are drawn as spans into fb_target: empty pixels are skipped, fully
+// covered ones stored outright and only the edges are blended.
+
+typedef struct {
+    uint16_t offset;  // into the font's bitmaps
+    uint8_t w, h;     // bitmap size
+    int8_t left;      // bitmap column 0 relative to the pen
+    int8_t top;       // bitmap rows above the baseline
+    uint8_t advance;  // pen advance, before kerning
+} gfx_glyph_t;
+
+typedef struct {
+    uint8_t first, second; // character codes
+    int8_t adjust;         // added to first's advance when second follows
+} gfx_kern_t;
+
+typedef struct {
+    uint8_t bpp;           // coverage bits per pixel: 2 or 4
+    uint8_t first, count;  // character codes first..first + count - 1
+    uint8_t ascent;        // baseline, in rows below the top of a line
+    uint8_t line_height;
+    uint16_t kern_count;   // 0 takes the kerning-free path
+    const gfx_glyph_t *glyphs;
+    const uint8_t *bitmaps;
+    const gfx_kern_t *kerns; // sorted by first, then second
+} gfx_font_t;
+
+// A glyph placed by gfx_text_layout(): where its bitmap's top-left lands.
+typedef struct {
+    const gfx_glyph_t *glyph;
+    int16_t x, y;
+} gfx_glyph_pos_t;
+
+// Glyph for c; characters the font lacks use its '?' (NULL if it has none).
+const gfx_glyph_t *gfx_font_glyph(const gfx_font_t *font, char c);
+
+// Lays text out with its first line's top-left at (x, y); '\n' starts a new
+// line. Writes up to max placed glyphs to run (blank ones such as spaces are
+// left out) and returns how many were written. Nothing is drawn.
+size_t gfx_text_layout(const gfx_font_t *font, int x, int y, const char *text, gfx_glyph_pos_t *run, size_t max);
+
+// Box that text occupies when laid out: the longest line's advance and the
+// height of all its lines. Nothing is drawn.
+void gfx_text_measure(const gfx_font_t *font, const char *text, int *w, int *h);
+
+// Draws a laid-out run in fg, blending edge pixels with what is already in
+// the framebuffer. Records no damage.
+void fb_draw_glyphs(const gfx_font_t *font, const gfx_glyph_pos_t *run, size_t n, uint16_t fg);
+
+// Lays out and draws text with its top-left at (x, y), blended over the
+// existing pixels, and marks the measured box dirty.
+void fb_draw_string(const gfx_font_t *font, int x, int y, const char *text, uint16_t fg);
+
+// Like fb_draw_string() on a solid background: the measured box is filled
+// with bg first, and edge pixels take their colour from a table of fg/bg
+// mixes built once per call instead of being read back and blended.
+void fb_draw_string_bg(const gfx_font_t *font, int x, int y, const char *text, uint16_t fg, uint16_t bg);
@@ -0,0 +1,96 @@
+#include "gfx/anim.h"
+
+#include "gfx/fb.h"
+#include "gfx_util.h"
+
+// --- Sheet blits ---
+static void fb_draw_sheet_packed(int x, int y, const gfx_sheet_t *sheet, unsigned frame, int key) {
+    int row_bytes = (sheet->w + 3) / 4;
+    const uint8_t *src = &sheet->data[(size_t)frame * sheet->h * row_bytes];
+    for (int iy = 0; iy < sheet->h; ++iy, src += row_bytes) {
+        for (int ix = 0; ix < sheet->w; ++ix) {
+            int idx = (src[ix >> 2] >> (6 - 2 * (ix & 3))) & 0x03;
+            if (idx != key) {
+                fb_set_pixel(x + ix, y + iy, sheet->palette[idx]);
+            }
+        }
+    }
+}
+
+static void fb_draw_sheet_rle(int x, int y, const gfx_sheet_t *sheet, unsigned frame, int key) {
+    const uint8_t *src = &sheet->data[sheet->offsets[frame]];
+    int total = sheet->w * sheet->h;
+    int col = 0, row = 0;
+    for (int pos = 0; pos < total; ++src) {
+        int idx = *src & 0x03;
+        int run = GFX_MIN((*src >> 2) + 1, total - pos);
+        pos += run;
+        // Split the run at row ends; each piece is one span fill.
+        while (run) {
+            int n = GFX_MIN(run, sheet->w - col);
+            if (idx != key) {
+                fb_fill_rect(x + col, y + row, n, 1, sheet->palette[idx]);
+            }
+            run -= n;
+            col += n;
+            if (col == sheet->w) {
+                col = 0;
+                row++;
+            }
+        }
+    }
+}
+
+void fb_draw_sheet(int x, int y, const gfx_sheet_t *sheet, unsigned frame, int key) {
+    if (frame >= sheet->frame_count) {
+        return;
+    }
+    if (sheet->format == GFX_SHEET_RLE) {
+        fb_draw_sheet_rle(x, y, sheet, frame, key);
+    } else {
+        fb_draw_sheet_packed(x, y, sheet, frame, key);
+    }
+    fb_mark_dirty(x, y, sheet->w, sheet->h);
+}
+
+// --- Timelines ---
+void gfx_anim_start(gfx_anim_t *anim, const gfx_anim_step_t *steps, uint8_t count, bool loop) {
+    uint32_t period = 0;
+    for (uint8_t i = 0; i < count; ++i) {
+        period += steps[i].ms;
+    }
+    anim->steps = steps;
+    anim->step_count = count;
+    anim->step = 0;
+    anim->loop = loop && period; // a zero-length loop would never yield
+    anim->done = !count;
+    anim->step_ms = 0;
+}
+
+bool gfx_anim_advance(gfx_anim_t *anim, uint32_t elapsed_ms) {
+    if (anim->done) {
+        return false;
+    }
+    uint8_t frame = gfx_anim_frame(anim);
+    anim->step_ms += elapsed_ms;
+    while (anim->step_ms >= anim->steps[anim->step].ms) {
+        anim->step_ms -= anim->steps[anim->step].ms;
+        if (anim->step + 1 < anim->step_count) {
+            anim->step++;
+        } else if (anim->loop) {
+            anim->step = 0;
+        } else {
+            anim->done = true;
+            anim->step_ms = 0;
+            break;
+        }
+    }
+    return gfx_anim_frame(anim) != frame;
+}
+
+uint32_t gfx_anim_next_ms(const gfx_anim_t *anim) {
+    if (anim->done) {
+        return UINT32_MAX;
+    }
+    return anim->steps[anim->step].ms - anim->step_ms;
+}
@@ -0,0 +1,66 @@
+#include "gfx/console.h"
+
+#include "gfx_util.h"
+
+void gfx_console_init(gfx_console_t *con, gfx_fb_t *fb, uint16_t fg, uint16_t bg) {
+    *con = (gfx_console_t){
+        .fb = fb,
+        .fg = fg,
+        .bg = bg,
+        .cols = (uint8_t)GFX_MIN(fb->width / FB_GLYPH_W, UINT8_MAX),
+        .lines = (uint8_t)GFX_MIN(fb->height / GFX_CONSOLE_LINE_H, UINT8_MAX),
+    };
+    gfx_fb_t *prev = fb_target;
+    fb_bind(fb);
+    fb_clear(bg);
+    fb_bind(prev);
+}
+
+// Moves the cursor to the start of the next ring line, scrolling once the
+// screen is full, and clears that line (it held the oldest text).
+static void console_newline(gfx_console_t *con) {
+    con->col = 0;
+    con->line = (uint8_t)((con->line + 1) % con->lines);
+    if (con->line == con->top) {
+        con->top = (uint8_t)((con->top + 1) % con->lines);
+    }
+    fb_draw_rect(0, con->line * GFX_CONSOLE_LINE_H, con->fb->width, GFX_CONSOLE_LINE_H, con->bg);
+}
+
+void gfx_console_write(gfx_console_t *con, const char *text, size_t len) {
+    if (!con->lines || !con->cols) {
+        return;
+    }
+    gfx_fb_t *prev = fb_target;
+    fb_bind(con->fb);
+    // Printable characters are collected into runs so each run is one text
+    // draw (and one dirty rect).
+    char run[UINT8_MAX + 1];
+    size_t n = 0;
+    for (size_t i = 0; i <= len; ++i) {
+        char c = i < len ? text[i] : '\0';
+        bool printable = i < len && c != '\n' && c != '\r';
+        if (printable && con->col + n < con->cols) {
+            run[n++] = c == '\t' ? ' ' : c;
+            continue;
+        }
+        if (n) {
+            run[n] = '\0';
+            fb_draw_text(con->col * FB_GLYPH_W, con->line * GFX_CONSOLE_LINE_H, run, con->fg, con->bg);
+            con->col = (uint8_t)(con->col + n);
+            n = 0;
+        }
+        if (i == len) {
+            break;
+        }
+        if (c == '\r') {
+            con->col = 0;
+        } else {
+            console_newline(con);
+            if (printable) {
+                run[n++] = c == '\t' ? ' ' : c; // wrapped onto the new line
+            }
+        }
+    }
+    fb_bind(prev);
+}
@@ -0,0 +1,300 @@
+#include "gfx/dlist.h"
+
+#include <string.h>
+
+#include "gfx/font.h"
+#include "gfx_util.h"
+
+static gfx_dl_op_t *gfx_dl_push(gfx_dlist_t *dl, gfx_dl_kind_t kind, int x, int y, int w, int h) {
+    if (dl->count >= GFX_DL_MAX_OPS) {
+        return NULL;
+    }
+    gfx_dl_op_t *op = &dl->ops[dl->count++];
+    op->kind = (uint8_t)kind;
+    op->flags = 0;
+    op->bounds = (gfx_rect_t){ (int16_t)x, (int16_t)y, (int16_t)(x + w), (int16_t)(y + h) };
+    return op;
+}
+
+gfx_dl_op_t *gfx_dl_clear(gfx_dlist_t *dl, uint16_t color) {
+    gfx_dl_op_t *op = gfx_dl_push(dl, GFX_DL_CLEAR, INT16_MIN / 2, INT16_MIN / 2, INT16_MAX, INT16_MAX);
+    if (op) {
+        op->fg = color;
+    }
+    return op;
+}
+
+gfx_dl_op_t *gfx_dl_rect(gfx_dlist_t *dl, int x, int y, int w, int h, uint16_t color) {
+    gfx_dl_op_t *op = gfx_dl_push(dl, GFX_DL_RECT, x, y, w, h);
+    if (op) {
+        op->fg = color;
+    }
+    return op;
+}
+
+// Sets op->bounds to the block text covers at (x0, y0) in op->font, or in
+// the 5x7 font at op->scale.
+static void gfx_dl_text_bounds(gfx_dl_op_t *op, const char *text) {
+    if (op->font) {
+        int w, h;
+        gfx_text_measure(op->font, text, &w, &h);
+        op->bounds.x1 = (int16_t)(op->bounds.x0 + w);
+        op->bounds.y1 = (int16_t)(op->bounds.y0 + h);
+        return;
+    }
+    int scale = op->scale;
+    int lines = 1, cols = 0, longest = 0;
+    for (const char *c = text; *c; ++c) {
+        if (*c == '\n') {
+            lines++;
+            cols = 0;
+        } else {
+            cols++;
+            longest = GFX_MAX(longest, cols);
+        }
+    }
+    int h = ((lines - 1) * (FB_GLYPH_H + 1) + FB_GLYPH_H) * scale;
+    op->bounds.x1 = (int16_t)(op->bounds.x0 + longest * FB_GLYPH_W * scale);
+    op->bounds.y1 = (int16_t)(op->bounds.y0 + h);
+}
+
+gfx_dl_op_t *gfx_dl_text(gfx_dlist_t *dl, int x, int y, const char *text, uint16_t fg, uint16_t bg, int scale) {
+    gfx_dl_op_t *op = gfx_dl_push(dl, GFX_DL_TEXT, x, y, 0, 0);
+    if (op) {
+        op->text = text;
+        op->font = NULL;
+        op->fg = fg;
+        op->bg = bg;
+        op->scale = (uint8_t)GFX_MIN(GFX_MAX(scale, 1), FB_GLYPH_MAX_SCALE);
+        gfx_dl_text_bounds(op, text);
+    }
+    return op;
+}
+
+gfx_dl_op_t *gfx_dl_label(gfx_dlist_t *dl, int x, int y, const gfx_font_t *font, const char *text, uint16_t fg) {
+    gfx_dl_op_t *op = gfx_dl_push(dl, GFX_DL_TEXT, x, y, 0, 0);
+    if (op) {
+        op->text = text;
+        op->font = font;
+        op->fg = fg;
+        op->bg = 0; // unused: labels blend over what is beneath
+        gfx_dl_text_bounds(op, text);
+    }
+    return op;
+}
+
+gfx_dl_op_t *gfx_dl_icon(gfx_dlist_t *dl, int x, int y, int w, int h, const uint8_t *pixels, const uint16_t *palette) {
+    gfx_dl_op_t *op = gfx_dl_push(dl, GFX_DL_ICON, x, y, w, h);
+    if (op) {
+        op->icon.pixels = pixels;
+        op->icon.palette = palette;
+    }
+    return op;
+}
+
+gfx_dl_op_t *gfx_dl_sprite(gfx_dlist_t *dl, int x, int y, int w, int h, const uint8_t *pixels, const uint16_t *palette,
+                           uint8_t key) {
+    gfx_dl_op_t *op = gfx_dl_icon(dl, x, y, w, h, pixels, palette);
+    if (op) {
+        op->kind = GFX_DL_SPRITE;
+        op->icon.key = key;
+    }
+    return op;
+}
+
+gfx_dl_op_t *gfx_dl_sheet(gfx_dlist_t *dl, int x, int y, const gfx_sheet_t *sheet, unsigned frame, int key) {
+    gfx_dl_op_t *op = gfx_dl_push(dl, GFX_DL_SHEET, x, y, sheet->w, sheet->h);
+    if (op) {
+        op->sheet.sheet = sheet;
+        op->sheet.frame = (uint8_t)frame;
+        op->sheet.key = (int8_t)key;
+    }
+    return op;
+}
+
+gfx_dl_op_t *gfx_dl_custom(gfx_dlist_t *dl, int x, int y, int w, int h, gfx_dl_draw_fn fn, void *user) {
+    gfx_dl_op_t *op = gfx_dl_push(dl, GFX_DL_CUSTOM, x, y, w, h);
+    if (op) {
+        op->custom.fn = fn;
+        op->custom.user = user;
+    }
+    return op;
+}
+
+// --- Retained updates ---
+void gfx_dl_invalidate(gfx_dlist_t *dl, const gfx_rect_t *r) {
+    gfx_damage_add(dl->damage, &dl->damage_count, *r);
+}
+
+void gfx_dl_set_text(gfx_dlist_t *dl, gfx_dl_op_t *op, const char *text) {
+    gfx_dl_invalidate(dl, &op->bounds);
+    op->text = text;
+    gfx_dl_text_bounds(op, text);
+    gfx_dl_invalidate(dl, &op->bounds);
+}
+
+void gfx_dl_set_color(gfx_dlist_t *dl, gfx_dl_op_t *op, uint16_t fg, uint16_t bg) {
+    if (op->fg != fg || op->bg != bg) {
+        op->fg = fg;
+        op->bg = bg;
+        gfx_dl_invalidate(dl, &op->bounds);
+    }
+}
+
+void gfx_dl_set_pixels(gfx_dlist_t *dl, gfx_dl_op_t *op, const uint8_t *pixels) {
+    if (op->icon.pixels != pixels) {
+        op->icon.pixels = pixels;
+        gfx_dl_invalidate(dl, &op->bounds);
+    }
+}
+
+void gfx_dl_set_frame(gfx_dlist_t *dl, gfx_dl_op_t *op, unsigned frame) {
+    if (op->sheet.frame != frame) {
+        op->sheet.frame = (uint8_t)frame;
+        gfx_dl_invalidate(dl, &op->bounds);
+    }
+}
+
+void gfx_dl_set_rect(gfx_dlist_t *dl, gfx_dl_op_t *op, int x, int y, int w, int h) {
+    gfx_rect_t r = { (int16_t)x, (int16_t)y, (int16_t)(x + w), (int16_t)(y + h) };
+    if (memcmp(&r, &op->bounds, sizeof(r)) != 0) {
+        gfx_dl_invalidate(dl, &op->bounds);
+        op->bounds = r;
+        gfx_dl_invalidate(dl, &op->bounds);
+    }
+}
+
+void gfx_dl_move(gfx_dlist_t *dl, gfx_dl_op_t *op, int x, int y) {
+    gfx_dl_set_rect(dl, op, x, y, op->bounds.x1 - op->bounds.x0, op->bounds.y1 - op->bounds.y0);
+}
+
+void gfx_dl_set_visible(gfx_dlist_t *dl, gfx_dl_op_t *op, bool visible) {
+    uint8_t flags = visible ? (uint8_t)(op->flags & ~GFX_DL_HIDDEN) : (uint8_t)(op->flags | GFX_DL_HIDDEN);
+    if (flags != op->flags) {
+        op->flags = flags;
+        gfx_dl_invalidate(dl, &op->bounds);
+    }
+}
+
+// --- Replay ---
+static inline bool gfx_rect_overlaps(const gfx_rect_t *a, const gfx_rect_t *b) {
+    return a->x0 < b->x1 && b->x0 < a->x1 && a->y0 < b->y1 && b->y0 < a->y1;
+}
+
+// Replays the ops that touch the r part of fb, where r's top-left corner is
+// frame pixel (ox, oy). The ops draw through a view of r, which clips them.
+static void gfx_dl_replay(const gfx_dlist_t *dl, gfx_fb_t *fb, const gfx_rect_t *r, int ox, int oy) {
+    gfx_fb_t view;
+    gfx_fb_view(&view, fb, r);
+    gfx_rect_t frame = { (int16_t)ox, (int16_t)oy, (int16_t)(ox + view.width), (int16_t)(oy + view.height) };
+
+    gfx_fb_t *prev = fb_target;
+    fb_bind(&view);
+    for (uint8_t i = 0; i < dl->count; ++i) {
+        const gfx_dl_op_t *op = &dl->ops[i];
+        if ((op->flags & GFX_DL_HIDDEN) || !gfx_rect_overlaps(&op->bounds, &frame)) {
+            continue;
+        }
+        int x = op->bounds.x0 - ox, y = op->bounds.y0 - oy;
+        int w = op->bounds.x1 - op->bounds.x0, h = op->bounds.y1 - op->bounds.y0;
+        switch (op->kind) {
+            case GFX_DL_CLEAR:
+                fb_clear(op->fg);
+                break;
+            case GFX_DL_RECT:
+                fb_fill_rect(x, y, w, h, op->fg);
+                break;
+            case GFX_DL_TEXT:
+                if (op->font) {
+                    fb_draw_string(op->font, x, y, op->text, op->fg);
+                } else {
+                    fb_draw_text_scaled(x, y, op->text, op->fg, op->bg, op->scale);
+                }
+                break;
+            case GFX_DL_ICON:
+                fb_draw_icon(x, y, w, h, op->icon.pixels, op->icon.palette);
+                break;
+            case GFX_DL_SPRITE:
+                fb_draw_sprite(x, y, w, h, op->icon.pixels, op->icon.palette, op->icon.key);
+                break;
+            case GFX_DL_SHEET:
+                fb_draw_sheet(x, y, op->sheet.sheet, op->sheet.frame, op->sheet.key);
+                break;
+            case GFX_DL_CUSTOM: {
+                // Clip the callback to its bounds with a nested view.
+                gfx_rect_t r = { (int16_t)GFX_MAX(x, 0), (int16_t)GFX_MAX(y, 0), (int16_t)(x + w), (int16_t)(y + h) };
+#if GFX_FB_BPP == 4
+                r.x0 &= ~1;
+#endif
+                gfx_fb_t sub;
+                gfx_fb_view(&sub, &view, &r);
+                fb_bind(&sub);
+                op->custom.fn(ox + r.x0, oy + r.y0, op->custom.user);
+                fb_bind(&view);
+                break;
+            }
+        }
+    }
+    fb_bind(prev);
+}
+
+// Clips area (NULL = everything) to a w x h frame; at 4bpp x0 is rounded down
+// to a byte boundary so the area can be viewed.
+static gfx_rect_t gfx_dl_area(const gfx_rect_t *area, int w, int h) {
+    gfx_rect_t a = area ? *area : (gfx_rect_t){ 0, 0, (int16_t)w, (int16_t)h };
+    a.x0 = (int16_t)GFX_MAX(a.x0, 0);
+    a.y0 = (int16_t)GFX_MAX(a.y0, 0);
+    a.x1 = (int16_t)GFX_MIN(a.x1, w);
+    a.y1 = (int16_t)GFX_MIN(a.y1, h);
+#if GFX_FB_BPP == 4
+    a.x0 &= ~1;
+#endif
+    return a;
+}
+
+void gfx_dl_render_area(const gfx_dlist_t *dl, const gfx_rect_t *area) {
+    gfx_fb_t *fb = fb_target;
+    gfx_rect_t a = gfx_dl_area(area, fb->width, fb->height);
+    if (a.x0 >= a.x1 || a.y0 >= a.y1) {
+        return;
+    }
+    gfx_dl_replay(dl, fb, &a, a.x0, a.y0);
+    fb_mark_dirty(a.x0, a.y0, a.x1 - a.x0, a.y1 - a.y0);
+}
+
+void gfx_dl_render_damage(gfx_dlist_t *dl) {
+    for (uint8_t i = 0; i < dl->damage_count; ++i) {
+        gfx_dl_render_area(dl, &dl->damage[i]);
+    }
+    dl->damage_count = 0;
+}
+
+void gfx_dl_render_strips(const gfx_dlist_t *dl, gfx_fb_t strips[2], int frame_h, const gfx_rect_t *area,
+                          const gfx_strip_sink_t *sink) {
+    gfx_rect_t a = gfx_dl_area(area, strips[0].width, frame_h);
+    if (a.x0 >= a.x1 || a.y0 >= a.y1) {
+        return;
+    }
+    int lines = strips[0].height;
+    int k = 0;
+    sink->wait(sink->ctx); // an earlier call's last strip may still be on its way out
+    for (int y = a.y0; y < a.y1; y += lines, k ^= 1) {
+        gfx_fb_t *strip = &strips[k];
+        int h = GFX_MIN(lines, a.y1 - y);
+        gfx_rect_t r = { a.x0, 0, a.x1, (int16_t)h };
+        // strips[k] was last sent two bands ago; the wait before the
+        // previous band's send already covered it.
+        gfx_dl_replay(dl, strip, &r, a.x0, y);
+        strip->dirty[0] = r;
+        strip->dirty_count = 1;
+        sink->wait(sink->ctx);
+        sink->send(sink->ctx, strip, y, y + lines >= a.y1);
+    }
+}
+
+void gfx_dl_render_damage_strips(gfx_dlist_t *dl, gfx_fb_t strips[2], int frame_h, const gfx_strip_sink_t *sink) {
+    for (uint8_t i = 0; i < dl->damage_count; ++i) {
+        gfx_dl_render_strips(dl, strips, frame_h, &dl->damage[i], sink);
+    }
+    dl->damage_count = 0;
+}
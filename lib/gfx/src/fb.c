@@ -0,0 +1,316 @@
+#include "gfx/fb.h"
+
+#include <string.h>
+
+#include "gfx_util.h"
+
+gfx_fb_t *fb_target;
+
+void gfx_fb_init(gfx_fb_t *fb, gfx_pixel_t *pixels, int width, int height) {
+    fb->pixels = pixels;
+    fb->width = (int16_t)width;
+    fb->height = (int16_t)height;
+    fb->stride = (int16_t)GFX_FB_UNITS(width);
+#if GFX_FB_INDEXED
+    fb->palette = gfx_palette_default();
+    fb->memo = (gfx_palette_memo_t){ 0 };
+#endif
+    fb->dirty_count = 0;
+}
+
+void gfx_fb_view(gfx_fb_t *view, const gfx_fb_t *fb, const gfx_rect_t *r) {
+    int x0 = GFX_MAX(r->x0, 0), y0 = GFX_MAX(r->y0, 0);
+    int x1 = GFX_MIN(r->x1, fb->width), y1 = GFX_MIN(r->y1, fb->height);
+#if GFX_FB_BPP == 4
+    view->pixels = &fb->pixels[y0 * fb->stride + (x0 >> 1)];
+#else
+    view->pixels = &fb->pixels[y0 * fb->stride + x0];
+#endif
+    view->width = (int16_t)GFX_MAX(x1 - x0, 0);
+    view->height = (int16_t)GFX_MAX(y1 - y0, 0);
+    view->stride = fb->stride;
+#if GFX_FB_INDEXED
+    view->palette = fb->palette;
+    view->memo = (gfx_palette_memo_t){ 0 };
+#endif
+    view->dirty_count = 0;
+}
+
+// --- Damage tracking ---
+// The fb_* primitives record the regions they touch in the render target's
+// rect list so a flush can push only the changed windows. Nearby rects are
+// merged when the union wastes fewer pixels than a separate window's command
+// overhead; once the list is full, the new rect is folded into whichever
+// entry grows the least.
+#define GFX_DIRTY_MERGE_SLACK_PX 64
+
+static inline gfx_rect_t gfx_rect_union(const gfx_rect_t *a, const gfx_rect_t *b) {
+    gfx_rect_t u = {
+        GFX_MIN(a->x0, b->x0), GFX_MIN(a->y0, b->y0),
+        GFX_MAX(a->x1, b->x1), GFX_MAX(a->y1, b->y1)
+    };
+    return u;
+}
+
+// Pixels the union of a and b would send that neither rect needs.
+static inline int32_t gfx_rect_merge_cost(const gfx_rect_t *a, const gfx_rect_t *b) {
+    gfx_rect_t u = gfx_rect_union(a, b);
+    return gfx_rect_area(&u) - gfx_rect_area(a) - gfx_rect_area(b);
+}
+
+void gfx_damage_add(gfx_rect_t rects[GFX_DIRTY_MAX], uint8_t *count, gfx_rect_t r) {
+    if (r.x0 >= r.x1 || r.y0 >= r.y1) {
+        return;
+    }
+
+    // Absorb every existing rect that is cheap to merge; the grown rect may
+    // now reach others, so rescan until nothing changes.
+    bool merged = true;
+    while (merged) {
+        merged = false;
+        for (uint8_t i = 0; i < *count; ++i) {
+            if (gfx_rect_merge_cost(&r, &rects[i]) <= GFX_DIRTY_MERGE_SLACK_PX) {
+                r = gfx_rect_union(&r, &rects[i]);
+                rects[i] = rects[--*count];
+                merged = true;
+                break;
+            }
+        }
+    }
+
+    if (*count < GFX_DIRTY_MAX) {
+        rects[(*count)++] = r;
+        return;
+    }
+
+    uint8_t best = 0;
+    int32_t best_cost = INT32_MAX;
+    for (uint8_t i = 0; i < *count; ++i) {
+        int32_t cost = gfx_rect_merge_cost(&r, &rects[i]);
+        if (cost < best_cost) {
+            best_cost = cost;
+            best = i;
+        }
+    }
+    rects[best] = gfx_rect_union(&r, &rects[best]);
+}
+
+void fb_mark_dirty(int x, int y, int w, int h) {
+    gfx_fb_t *fb = fb_target;
+    gfx_rect_t r = {
+        (int16_t)GFX_MAX(x, 0), (int16_t)GFX_MAX(y, 0),
+        (int16_t)GFX_MIN(x + w, fb->width), (int16_t)GFX_MIN(y + h, fb->height)
+    };
+    gfx_damage_add(fb->dirty, &fb->dirty_count, r);
+}
+
+void fb_mark_all_dirty(void) {
+    gfx_fb_t *fb = fb_target;
+    fb->dirty[0] = (gfx_rect_t){0, 0, fb->width, fb->height};
+    fb->dirty_count = 1;
+}
+
+// --- Span fill engine ---
+// Fills are clipped once and then written a machine word at a time: a
+// replicated value pattern covers a word's worth of storage units per store
+// (two 16bpp pixels on the RP2350), with single-unit head/tail stores to reach
+// word alignment.
+#if UINTPTR_MAX > 0xFFFFFFFFu
+typedef uint64_t __attribute__((may_alias)) fb_word_t;
+#else
+typedef uint32_t __attribute__((may_alias)) fb_word_t;
+#endif
+#define FB_UNITS_PER_WORD (sizeof(fb_word_t) / sizeof(gfx_pixel_t))
+
+void fb_fill_span(gfx_pixel_t *dst, size_t n, gfx_pixel_t value) {
+    // Runs shorter than a few words (small rects, sprite rows) cost more in
+    // alignment and pattern setup than they save.
+    if (n < 4 * FB_UNITS_PER_WORD) {
+        while (n--) {
+            *dst++ = value;
+        }
+        return;
+    }
+    while (n &&((uintptr_t)dst & (sizeof(fb_word_t) - 1))) {
+        *dst++ = value;
+        n--;
+    }
+
+    fb_word_t pattern = value;
+    for (size_t i = 1; i < FB_UNITS_PER_WORD; ++i) {
+        pattern = (pattern << (8 * sizeof(gfx_pixel_t))) | value;
+    }
+    fb_word_t *w = (fb_word_t *)dst;
+    size_t words = n / FB_UNITS_PER_WORD;
+    while (words >= 4) {
+        w[0] = pattern;
+        w[1] = pattern;
+        w[2] = pattern;
+        w[3] = pattern;
+        w += 4;
+        words -= 4;
+    }
+    while (words--) {
+        *w++ = pattern;
+    }
+
+    dst = (gfx_pixel_t *)w;
+    for (n %= FB_UNITS_PER_WORD; n; --n) {
+        *dst++ = value;
+    }
+}
+
+// Span fill value for one stored pixel value.
+static inline gfx_pixel_t fb_span_value(gfx_pixel_t v) {
+#if GFX_FB_BPP == 4
+    return (gfx_pixel_t)((v << 4) | v);
+#else
+    return v;
+#endif
+}
+
+// Fills pixels [x0, x1) of row y; at 4bpp odd ends are written as nibbles.
+static void fb_fill_row(gfx_fb_t *fb, int x0, int x1, int y, gfx_pixel_t v) {
+#if GFX_FB_BPP == 4
+    if (x0 & 1) {
+        gfx_fb_put(fb, x0++, y, v);
+    }
+    if ((x1 & 1) && x1 > x0) {
+        gfx_fb_put(fb, --x1, y, v);
+    }
+    if (x0 < x1) {
+        fb_fill_span(&fb->pixels[y * fb->stride + (x0 >> 1)], (size_t)(x1 - x0) / 2, fb_span_value(v));
+    }
+#else
+    fb_fill_span(&fb->pixels[y * fb->stride + x0], (size_t)(x1 - x0), v);
+#endif
+}
+
+void fb_clear(uint16_t color) {
+    gfx_fb_t *fb = fb_target;
+    gfx_pixel_t v = gfx_fb_value(fb, color);
+    if (fb->stride == GFX_FB_UNITS(fb->width)) {
+        fb_fill_span(fb->pixels, (size_t)fb->stride * fb->height, fb_span_value(v));
+    } else {
+        // A view: rows are not contiguous.
+        for (int y = 0; y < fb->height; ++y) {
+            fb_fill_row(fb, 0, fb->width, y, v);
+        }
+    }
+    fb_mark_all_dirty();
+}
+
+void fb_fill_rect(int x, int y, int w, int h, uint16_t color) {
+    gfx_fb_t *fb = fb_target;
+    int x0 = GFX_MAX(x, 0), y0 = GFX_MAX(y, 0);
+    int x1 = GFX_MIN(x + w, fb->width), y1 = GFX_MIN(y + h, fb->height);
+    if (x0 >= x1 || y0 >= y1) {
+        return;
+    }
+    gfx_pixel_t v = gfx_fb_value(fb, color);
+    for (int yy = y0; yy < y1; ++yy) {
+        fb_fill_row(fb, x0, x1, yy, v);
+    }
+}
+
+void fb_draw_rect(int x, int y, int w, int h, uint16_t color) {
+    fb_fill_rect(x, y, w, h, color);
+    fb_mark_dirty(x, y, w, h);
+}
+
+void fb_draw_icon(int x, int y, int w, int h, const uint8_t *pixels, const uint16_t *palette) {
+    for (int iy = 0; iy < h; ++iy) {
+        for (int ix = 0; ix < w; ++ix) {
+            uint8_t idx = pixels[iy * w + ix];
+            fb_set_pixel(x + ix, y + iy, palette[idx]);
+        }
+    }
+    fb_mark_dirty(x, y, w, h);
+}
+
+void fb_draw_sprite(int x, int y, int w, int h, const uint8_t *pixels, const uint16_t *palette, uint8_t key) {
+    for (int iy = 0; iy < h; ++iy) {
+        for (int ix = 0; ix < w; ++ix) {
+            uint8_t idx = pixels[iy * w + ix];
+            if (idx != key) {
+                fb_set_pixel(x + ix, y + iy, palette[idx]);
+            }
+        }
+    }
+    fb_mark_dirty(x, y, w, h);
+}
+
+void gfx_fb_copy_rects(gfx_fb_t *dst, const gfx_fb_t *src, const gfx_rect_t *rects, size_t count) {
+    for (size_t i = 0; i < count; ++i) {
+        const gfx_rect_t *r = &rects[i];
+        int x0 = r->x0, x1 = r->x1;
+        for (int y = r->y0; y < r->y1; ++y) {
+#if GFX_FB_BPP == 4
+            // Shared bytes at the rect's edges are merged a nibble at a time.
+            int bx0 = x0, bx1 = x1;
+            if (bx0 & 1) {
+                gfx_fb_put(dst, bx0, y, gfx_fb_get(src, bx0, y));
+                bx0++;
+            }
+            if ((bx1 & 1) && bx1 > bx0) {
+                bx1--;
+                gfx_fb_put(dst, bx1, y, gfx_fb_get(src, bx1, y));
+            }
+            size_t off = (size_t)y * src->stride + (size_t)(bx0 >> 1);
+            if (bx0 < bx1) {
+                memcpy(&dst->pixels[off], &src->pixels[off], (size_t)(bx1 - bx0) / 2);
+            }
+#else
+            size_t off = (size_t)y * src->stride + (size_t)x0;
+            memcpy(&dst->pixels[off], &src->pixels[off], (size_t)(x1 - x0) * sizeof(gfx_pixel_t));
+#endif
+        }
+    }
+}
+
+// --- Flush-time expansion ---
+// Indexed pixels become RGB565 only on their way to the panel, one palette
+// load per pixel; 16bpp pixels are just put in wire order.
+static inline void fb_put_wire(uint8_t *out, uint16_t stored) {
+    uint16_t c = RGB565_LOAD(stored);
+    out[0] = (uint8_t)(c >> 8);
+    out[1] = (uint8_t)(c & 0xFF);
+}
+
+void gfx_fb_expand_wire(const gfx_fb_t *fb, int x, int y, size_t n, uint8_t *out) {
+#if GFX_FB_INDEXED
+    const uint16_t *pal = fb->palette->color;
+#endif
+    while (n) {
+        size_t take = GFX_MIN(n, (size_t)(fb->width - x));
+        n -= take;
+#if GFX_FB_BPP == 4
+        const gfx_pixel_t *src = &fb->pixels[y * fb->stride + (x >> 1)];
+        if (x & 1) {
+            fb_put_wire(out, pal[*src++ & 0x0F]);
+            out += 2;
+            take--;
+        }
+        for (; take >= 2; take -= 2, out += 4) {
+            gfx_pixel_t b = *src++;
+            fb_put_wire(out, pal[b >> 4]);
+            fb_put_wire(out + 2, pal[b & 0x0F]);
+        }
+        if (take) {
+            fb_put_wire(out, pal[*src >> 4]);
+            out += 2;
+        }
+#else
+        const gfx_pixel_t *src = &fb->pixels[y * fb->stride + x];
+        for (size_t i = 0; i < take; ++i, out += 2) {
+#if GFX_FB_INDEXED
+            fb_put_wire(out, pal[src[i]]);
+#else
+            fb_put_wire(out, src[i]);
+#endif
+        }
+#endif
+        x = 0;
+        y++;
+    }
+}
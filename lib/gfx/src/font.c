@@ -0,0 +1,255 @@
+#include "gfx/font.h"
+
+#include <stdbool.h>
+#include <string.h>
+
+#include "gfx/assets.h"
+#include "gfx/fb.h"
+#include "gfx_util.h"
+
+// --- Glyph cache ---
+// font5x7 is column-major, which makes every text pixel a shift-and-test.
+// The first text draw expands it once into row-major masks (bit 4 is the
+// leftmost column), with a row for every byte value so out-of-range
+// characters need no test (they get '?'). A mask then indexes a table of
+// pre-coloured, pre-scaled pixel rows that is rebuilt only when
+// fg/bg/scale change, so each glyph row is a single copy and vertical
+// scaling copies whole output rows. Rows hold stored values, so indexed
+// framebuffers copy indices (packed at 4bpp, where the fast path needs an
+// even x).
+//
+// Text often changes colour every line, and rebuilding 32 rows then costs
+// as much as drawing a few dozen glyphs. At 1x and 2x, 16bpp therefore
+// splits a row in two, indexed by the high and the low mask bits: 18 or 12
+// entries to rebuild, and two fixed-size copies per glyph row.
+static uint8_t font_rows[256][FB_GLYPH_H];
+static bool font_rows_ready;
+
+static struct {
+    uint16_t fg, bg; // colours as passed in
+    gfx_pixel_t fv, bv; // their stored values
+    int scale; // 0 until first use
+    gfx_pixel_t px[32][GFX_FB_UNITS(FB_GLYPH_W * FB_GLYPH_MAX_SCALE)];
+#if GFX_FB_BPP == 16
+    gfx_pixel_t quad[16][4]; // 1x: mask bits 4-1
+    gfx_pixel_t last[2][2]; // 1x: mask bit 0, then the spacing column
+    gfx_pixel_t half[2][8][6]; // 2x: mask bits 4-2; bits 1-0 and the spacing column
+#endif
+} glyph_lut;
+
+static void font_build_rows(void) {
+    for (int c = 0; c < 256; ++c) {
+        int g = (c < 32 || c > 127 ? '?' : c) - 32;
+        for (int row = 0; row < FB_GLYPH_H; ++row) {
+            uint8_t mask = 0;
+            for (int col = 0; col < 5; ++col) {
+                if ((font5x7[g][col] >> row) & 0x01) {
+                    mask |= (uint8_t)(1u << (4 - col));
+                }
+            }
+            font_rows[c][row] = mask;
+        }
+    }
+    font_rows_ready = true;
+}
+
+#if GFX_FB_BPP == 16
+// Fills p with `cols` columns of `bits` (first column in the top bit), each
+// `scale` pixels wide, then `pad` bg pixels.
+static void glyph_lut_cols(gfx_pixel_t *p, unsigned bits, int cols, int scale, int pad) {
+    for (int col = cols - 1; col >= 0; --col) {
+        gfx_pixel_t v = ((bits >> col) & 0x01) ? glyph_lut.fv : glyph_lut.bv;
+        for (int s = 0; s < scale; ++s) {
+            *p++ = v;
+        }
+    }
+    for (int i = 0; i < pad; ++i) {
+        *p++ = glyph_lut.bv;
+    }
+}
+#endif
+
+static void glyph_lut_prepare(uint16_t fg, uint16_t bg, int scale) {
+    if (!font_rows_ready) {
+        font_build_rows();
+    }
+    gfx_pixel_t fv = gfx_fb_value(fb_target, fg);
+    gfx_pixel_t bv = gfx_fb_value(fb_target, bg);
+    glyph_lut.fg = fg;
+    glyph_lut.bg = bg;
+    if (glyph_lut.scale == scale && glyph_lut.fv == fv && glyph_lut.bv == bv) {
+        return;
+    }
+    glyph_lut.fv = fv;
+    glyph_lut.bv = bv;
+    glyph_lut.scale = scale;
+#if GFX_FB_BPP == 16
+    if (scale == 1) {
+        for (unsigned q = 0; q < 16; ++q) {
+            glyph_lut_cols(glyph_lut.quad[q], q, 4, 1, 0);
+        }
+        glyph_lut_cols(glyph_lut.last[0], 0, 1, 1, 1);
+        glyph_lut_cols(glyph_lut.last[1], 1, 1, 1, 1);
+        return;
+    }
+    if (scale == 2) {
+        for (unsigned h = 0; h < 8; ++h) {
+            glyph_lut_cols(glyph_lut.half[0][h], h, 3, 2, 0);
+        }
+        for (unsigned h = 0; h < 4; ++h) {
+            glyph_lut_cols(glyph_lut.half[1][h], h, 2, 2, 2);
+        }
+        return;
+    }
+#endif
+    for (int mask = 0; mask < 32; ++mask) {
+        gfx_pixel_t *p = glyph_lut.px[mask];
+        int n = 0;
+        for (int col = 4; col >= -1; --col) {
+            gfx_pixel_t v = (col >= 0 && ((mask >> col) & 0x01)) ? fv : bv;
+            for (int s = 0; s < scale; ++s, ++n) {
+#if GFX_FB_BPP == 4
+                p[n >> 1] = (n & 1) ? (gfx_pixel_t)(p[n >> 1] | v) : (gfx_pixel_t)(v << 4);
+#else
+                p[n] = v;
+#endif
+            }
+        }
+    }
+}
+
+static inline const uint8_t *font_glyph_rows(char c) {
+    return font_rows[(unsigned char)c];
+}
+
+// Writes one glyph row with mask m at dst. Called with a constant scale, so
+// each copy compiles to a few stores rather than a memcpy call (which cost
+// most of the time at 1x).
+static inline void glyph_row(gfx_pixel_t *dst, uint8_t m, int scale) {
+#if GFX_FB_BPP == 16
+    if (scale == 1) {
+        memcpy(dst, glyph_lut.quad[m >> 1], sizeof(glyph_lut.quad[0]));
+        memcpy(dst + 4, glyph_lut.last[m & 1], sizeof(glyph_lut.last[0]));
+        return;
+    }
+    if (scale == 2) {
+        memcpy(dst, glyph_lut.half[0][m >> 2], sizeof(glyph_lut.half[0][0]));
+        memcpy(dst + 6, glyph_lut.half[1][m & 3], sizeof(glyph_lut.half[1][0]));
+        return;
+    }
+#endif
+    memcpy(dst, glyph_lut.px[m], GFX_FB_UNITS(FB_GLYPH_W * scale) * sizeof(gfx_pixel_t));
+}
+
+// Writes glyph row `row` of n characters from dst on.
+static inline void glyph_row_run(gfx_pixel_t *dst, const uint8_t *const *glyphs, size_t n, int row, int scale) {
+    for (size_t i = 0; i < n; ++i) {
+        glyph_row(dst, glyphs[i][row], scale);
+        dst += GFX_FB_UNITS(FB_GLYPH_W * scale);
+    }
+}
+
+// Characters whose rows fb_draw_run looks up at once when it builds output
+// rows; longer runs go in chunks.
+#define GLYPH_CHUNK 64
+
+// Draws n characters on one line using the prepared glyph_lut; returns the x after them.
+static int fb_draw_run(int x, int y, const char *text, size_t n) {
+    gfx_fb_t *fb = fb_target;
+    int scale = glyph_lut.scale;
+    int cw = FB_GLYPH_W * scale;
+    int w = cw * (int)n;
+    int h = FB_GLYPH_H * scale;
+    fb_mark_dirty(x, y, w, h);
+
+    if (x < 0 || x + w > fb->width || (GFX_FB_BPP == 4 && (x & 1))) {
+        // Clipped at the sides (or nibble-aligned): fall back to clipped per-pixel writes.
+        for (size_t i = 0; i < n; ++i) {
+            const uint8_t *rows = font_glyph_rows(text[i]);
+            for (int py = 0; py < h; ++py) {
+                uint8_t mask = rows[py / scale];
+                for (int px = 0; px < cw; ++px) {
+                    int col = px / scale;
+                    bool on = col < 5 && ((mask >> (4 - col)) & 0x01);
+                    fb_set_pixel(x + (int)i * cw + px, y + py, on ? glyph_lut.fg : glyph_lut.bg);
+                }
+            }
+        }
+        return x + w;
+    }
+
+    int py0 = GFX_MAX(0, -y), py1 = GFX_MIN(h, fb->height - y);
+    if (scale == 1 && py0 == 0 && py1 == FB_GLYPH_H) {
+        // Whole 1x glyphs: one glyph at a time, its seven rows unrolled.
+        size_t stride = (size_t)fb->stride;
+        gfx_pixel_t *dst = &fb->pixels[y * fb->stride + GFX_FB_UNITS(x)];
+        for (size_t i = 0; i < n; ++i, dst += GFX_FB_UNITS(FB_GLYPH_W)) {
+            const uint8_t *rows = font_glyph_rows(text[i]);
+            glyph_row(dst, rows[0], 1);
+            glyph_row(dst + stride, rows[1], 1);
+            glyph_row(dst + 2 * stride, rows[2], 1);
+            glyph_row(dst + 3 * stride, rows[3], 1);
+            glyph_row(dst + 4 * stride, rows[4], 1);
+            glyph_row(dst + 5 * stride, rows[5], 1);
+            glyph_row(dst + 6 * stride, rows[6], 1);
+        }
+        return x + w;
+    }
+
+    // Vertically only the visible output rows are built, so text cut by the
+    // top or bottom edge (e.g. of a render strip) stays on the copy path.
+    const uint8_t *glyphs[GLYPH_CHUNK];
+    for (size_t i0 = 0; i0 < n; i0 += GLYPH_CHUNK) {
+        size_t cn = GFX_MIN(n - i0, (size_t)GLYPH_CHUNK);
+        for (size_t i = 0; i < cn; ++i) {
+            glyphs[i] = font_glyph_rows(text[i0 + i]);
+        }
+        int cx = x + (int)i0 * cw;
+        size_t wu = GFX_FB_UNITS(cw * (int)cn);
+        const gfx_pixel_t *prev = NULL;
+        for (int py = py0; py < py1; ++py) {
+            gfx_pixel_t *dst = &fb->pixels[(y + py) * fb->stride + GFX_FB_UNITS(cx)];
+            if (prev && py % scale) {
+                memcpy(dst, prev, wu * sizeof(gfx_pixel_t));
+            } else {
+                switch (scale) {
+                    case 1:
+                        glyph_row_run(dst, glyphs, cn, py, 1);
+                        break;
+                    case 2:
+                        glyph_row_run(dst, glyphs, cn, py / 2, 2);
+                        break;
+                    case 3:
+                        glyph_row_run(dst, glyphs, cn, py / 3, 3);
+                        break;
+                    default:
+                        glyph_row_run(dst, glyphs, cn, py / 4, 4);
+                        break;
+                }
+            }
+            prev = dst;
+        }
+    }
+    return x + w;
+}
+
+void fb_draw_char_scaled(int x, int y, char c, uint16_t fg, uint16_t bg, int scale) {
+    glyph_lut_prepare(fg, bg, GFX_MIN(GFX_MAX(scale, 1), FB_GLYPH_MAX_SCALE));
+    fb_draw_run(x, y, &c, 1);
+}
+
+void fb_draw_text_scaled(int x, int y, const char *text, uint16_t fg, uint16_t bg, int scale) {
+    scale = GFX_MIN(GFX_MAX(scale, 1), FB_GLYPH_MAX_SCALE);
+    glyph_lut_prepare(fg, bg, scale);
+    while (*text) {
+        size_t n = strcspn(text, "\n");
+        if (n) {
+            fb_draw_run(x, y, text, n);
+            text += n;
+        }
+        if (*text == '\n') {
+            y += (FB_GLYPH_H + 1) * scale;
+            text++;
+        }
+    }
+}
@@ -0,0 +1,5 @@
+#pragma once
+
+// Private helpers shared by the library sources.
+#define GFX_MIN(a, b) ((a) < (b) ? (a) : (b))
+#define GFX_MAX(a, b) ((a) > (b) ? (a) : (b))
@@ -0,0 +1,51 @@
+#include "gfx/pace.h"
+
+#include "gfx_util.h"
+
+void gfx_pacer_init(gfx_pacer_t *p, uint16_t ticks_per_frame) {
+    *p = (gfx_pacer_t){ .ticks_per_frame = GFX_MAX(ticks_per_frame, 1) };
+}
+
+void gfx_pacer_begin(gfx_pacer_t *p, uint64_t now_us) {
+    p->begin_us = now_us;
+    p->target = p->slot + 1;
+}
+
+void gfx_pacer_submit(gfx_pacer_t *p, uint64_t now_us) {
+    uint32_t render_us = (uint32_t)(now_us - p->begin_us);
+    p->stats.render_max_us = GFX_MAX(p->stats.render_max_us, render_us);
+    p->ready = true;
+}
+
+bool gfx_pacer_tick(gfx_pacer_t *p, uint64_t now_us, bool idle) {
+    if (++p->tick < p->ticks_per_frame) {
+        return false;
+    }
+    p->tick = 0;
+    uint32_t slot = p->slot + 1;
+    p->slot = slot;
+    if (!p->ready || !idle) {
+        return false;
+    }
+    p->ready = false;
+    // A frame begun mid-slot cannot make the slot that was already open, so
+    // only slots after its target count as dropped.
+    int32_t late = (int32_t)(slot - p->target);
+    if (late > 0) {
+        p->stats.dropped += (uint32_t)late;
+    }
+    uint32_t latency_us = (uint32_t)(now_us - p->begin_us);
+    p->stats.frames++;
+    p->stats.latency_max_us = GFX_MAX(p->stats.latency_max_us, latency_us);
+    p->stats.latency_sum_us += latency_us;
+    p->stats.latency_count++;
+    return true;
+}
+
+void gfx_pacer_take_stats(gfx_pacer_t *p, gfx_pace_stats_t *out) {
+    *out = p->stats;
+    p->stats.render_max_us = 0;
+    p->stats.latency_max_us = 0;
+    p->stats.latency_sum_us = 0;
+    p->stats.latency_count = 0;
+}
@@ -0,0 +1,52 @@
+#include "gfx/palette.h"
+
+#include <string.h>
+
+#if GFX_FB_INDEXED
+
+#if GFX_FB_BPP == 8
+// RGB332 cube: index bits rrrgggbb.
+#define P332(i) RGB565_CONST(((i) >> 5) * 255 / 7, (((i) >> 2) & 0x07) * 255 / 7, ((i) & 0x03) * 255 / 3)
+#define P4(i) P332(i), P332((i) + 1), P332((i) + 2), P332((i) + 3)
+#define P16(i) P4(i), P4((i) + 4), P4((i) + 8), P4((i) + 12)
+#define P64(i) P16(i), P16((i) + 16), P16((i) + 32), P16((i) + 48)
+#define DEFAULT_COLORS P64(0), P64(64), P64(128), P64(192)
+#else
+#define DEFAULT_COLORS \
+    RGB565_CONST(0x00, 0x00, 0x00), RGB565_CONST(0x00, 0x00, 0xAA), RGB565_CONST(0x00, 0xAA, 0x00), RGB565_CONST(0x00, 0xAA, 0xAA), \
+    RGB565_CONST(0xAA, 0x00, 0x00), RGB565_CONST(0xAA, 0x00, 0xAA), RGB565_CONST(0xAA, 0x55, 0x00), RGB565_CONST(0xAA, 0xAA, 0xAA), \
+    RGB565_CONST(0x55, 0x55, 0x55), RGB565_CONST(0x55, 0x55, 0xFF), RGB565_CONST(0x55, 0xFF, 0x55), RGB565_CONST(0x55, 0xFF, 0xFF), \
+    RGB565_CONST(0xFF, 0x55, 0x55), RGB565_CONST(0xFF, 0x55, 0xFF), RGB565_CONST(0xFF, 0xFF, 0x55), RGB565_CONST(0xFF, 0xFF, 0xFF)
+#endif
+
+static const uint16_t default_colors[GFX_PALETTE_SIZE] = { DEFAULT_COLORS };
+static gfx_palette_t default_palette = { .color = { DEFAULT_COLORS } };
+
+gfx_palette_t *gfx_palette_default(void) {
+    return &default_palette;
+}
+
+void gfx_palette_init_default(gfx_palette_t *pal) {
+    memcpy(pal->color, default_colors, sizeof(pal->color));
+    pal->gen++;
+}
+
+uint8_t gfx_palette_nearest(const gfx_palette_t *pal, uint16_t color) {
+    uint16_t c = RGB565_LOAD(color);
+    // Red and blue are doubled so all three channels count in 6-bit steps.
+    int r = (c >> 11) * 2, g = (c >> 5) & 0x3F, b = (c & 0x1F) * 2;
+    uint8_t best = 0;
+    int32_t best_d = INT32_MAX;
+    for (unsigned i = 0; i < GFX_PALETTE_SIZE; ++i) {
+        uint16_t e = RGB565_LOAD(pal->color[i]);
+        int dr = (e >> 11) * 2 - r, dg = ((e >> 5) & 0x3F) - g, db = (e & 0x1F) * 2 - b;
+        int32_t d = dr * dr + dg * dg + db * db;
+        if (d < best_d) {
+            best_d = d;
+            best = (uint8_t)i;
+        }
+    }
+    return best;
+}
+
+#endif // GFX_FB_INDEXED
@@ -0,0 +1,153 @@
+#include "gfx/panel_mem.h"
+
+#include <string.h>
+
+#include "gfx/st7789.h"
+
+#define ST7789_DISPOFF 0x28
+#define ST7789_SLPIN 0x10
+
+void gfx_panel_mem_init(gfx_panel_mem_t *panel, uint16_t *pixels, uint16_t width, uint16_t height) {
+    memset(panel, 0, sizeof(*panel));
+    panel->pixels = pixels;
+    panel->width = width;
+    panel->height = height;
+    panel->x1 = width - 1;
+    panel->y1 = height - 1;
+    memset(pixels, 0, (size_t)width * height * sizeof(uint16_t));
+}
+
+void gfx_panel_mem_reset_stats(gfx_panel_mem_t *panel) {
+    panel->cmd_count = 0;
+    panel->data_bytes = 0;
+    panel->pixels_written = 0;
+}
+
+static void panel_mem_store(gfx_panel_mem_t *p, uint16_t color) {
+    if (p->cx < p->width && p->cy < p->height) {
+        p->pixels[(size_t)p->cy * p->width + p->cx] = color;
+    }
+    p->pixels_written++;
+    // Like the controller, wrap within the window: next column, then next row,
+    // then back to the top.
+    if (p->cx++ >= p->x1) {
+        p->cx = p->x0;
+        if (p->cy++ >= p->y1) {
+            p->cy = p->y0;
+        }
+    }
+}
+
+static void panel_mem_param(gfx_panel_mem_t *p, uint8_t byte) {
+    if (p->param_len < sizeof(p->params)) {
+        p->params[p->param_len++] = byte;
+    }
+    switch (p->cmd) {
+        case ST7789_CASET:
+            if (p->param_len == 4) {
+                p->x0 = (uint16_t)((p->params[0] << 8) | p->params[1]);
+                p->x1 = (uint16_t)((p->params[2] << 8) | p->params[3]);
+            }
+            break;
+        case ST7789_RASET:
+            if (p->param_len == 4) {
+                p->y0 = (uint16_t)((p->params[0] << 8) | p->params[1]);
+                p->y1 = (uint16_t)((p->params[2] << 8) | p->params[3]);
+            }
+            break;
+        case ST7789_MADCTL:
+            p->madctl = byte;
+            break;
+        case ST7789_VSCRDEF:
+            if (p->param_len == 6) {
+                p->scroll_top = (uint16_t)((p->params[0] << 8) | p->params[1]);
+                p->scroll_lines = (uint16_t)((p->params[2] << 8) | p->params[3]);
+                p->scroll_bottom = (uint16_t)((p->params[4] << 8) | p->params[5]);
+            }
+            break;
+        case ST7789_VSCRSADD:
+            if (p->param_len == 2) {
+                p->scroll_start = (uint16_t)((p->params[0] << 8) | p->params[1]);
+                p->scrolling = true;
+            }
+            break;
+        case ST7789_COLMOD:
+            p->colmod = byte;
+            break;
+        default:
+            break;
+    }
+}
+
+static void panel_mem_write_cmd(void *ctx, uint8_t cmd) {
+    gfx_panel_mem_t *p = ctx;
+    p->cmd = cmd;
+    p->param_len = 0;
+    p->have_hi = false;
+    p->cmd_count++;
+    switch (cmd) {
+        case ST7789_RAMWR:
+            p->cx = p->x0;
+            p->cy = p->y0;
+            break;
+        case ST7789_INVON:
+            p->inverted = true;
+            break;
+        case ST7789_INVOFF:
+            p->inverted = false;
+            break;
+        case ST7789_SLPOUT:
+            p->awake = true;
+            break;
+        case ST7789_SLPIN:
+            p->awake = false;
+            break;
+        case ST7789_DISPON:
+            p->display_on = true;
+            break;
+        case ST7789_NORON:
+            p->scrolling = false;
+            break;
+        case ST7789_DISPOFF:
+            p->display_on = false;
+            break;
+        default:
+            break;
+    }
+}
+
+static void panel_mem_write_data(void *ctx, const uint8_t *data, size_t len) {
+    gfx_panel_mem_t *p = ctx;
+    p->data_bytes += (uint32_t)len;
+    if (p->cmd != ST7789_RAMWR) {
+        for (size_t i = 0; i < len; ++i) {
+            panel_mem_param(p, data[i]);
+        }
+        return;
+    }
+    // RAMWR data arrives big-endian and may be split across data frames.
+    for (size_t i = 0; i < len; ++i) {
+        if (!p->have_hi) {
+            p->hi_byte = data[i];
+            p->have_hi = true;
+        } else {
+            panel_mem_store(p, (uint16_t)((p->hi_byte << 8) | data[i]));
+            p->have_hi = false;
+        }
+    }
+}
+
+static void panel_mem_delay_ms(void *ctx, uint32_t ms) {
+    (void)ctx;
+    (void)ms;
+}
+
+gfx_bus_t gfx_panel_mem_bus(gfx_panel_mem_t *panel) {
+    gfx_bus_t bus = {
+        .ctx = panel,
+        .write_cmd = panel_mem_write_cmd,
+        .write_data = panel_mem_write_data,
+        .delay_ms = panel_mem_delay_ms,
+    };
+    return bus;
+}
@@ -0,0 +1,107 @@
+#ifndef _POSIX_C_SOURCE
+#define _POSIX_C_SOURCE 199309L // clock_gettime() on the host
+#endif
+
+#include "gfx/perf.h"
+
+#include <string.h>
+
+#if GFX_PERF_CLOCK == GFX_PERF_CLOCK_POSIX
+#include <time.h>
+#endif
+
+#include "gfx_util.h"
+
+#if GFX_PERF_CLOCK == GFX_PERF_CLOCK_POSIX || GFX_PERF_CLOCK == GFX_PERF_CLOCK_EXTERN
+static uint32_t perf_hz = 1000000000u;
+#else
+static uint32_t perf_hz = 150000000u;
+#endif
+
+#if GFX_PERF_CLOCK == GFX_PERF_CLOCK_POSIX
+uint64_t gfx_perf_clock_ns(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint64_t)ts.tv_sec * 1000000000u + (uint64_t)ts.tv_nsec;
+}
+#endif
+
+void gfx_perf_init(uint32_t cpu_hz) {
+#if GFX_PERF_CLOCK == GFX_PERF_CLOCK_DWT
+    *(volatile uint32_t *)0xE000EDFCu |= 1u << 24; // DEMCR.TRCENA: powers the DWT
+    *(volatile uint32_t *)0xE0001004u = 0;         // DWT_CYCCNT
+    *(volatile uint32_t *)0xE0001000u |= 1u;       // DWT_CTRL.CYCCNTENA
+    perf_hz = cpu_hz;
+#elif GFX_PERF_CLOCK == GFX_PERF_CLOCK_MCYCLE
+    // Hazard3 comes out of reset with the cycle counter inhibited.
+    __asm volatile("csrci 0x320, 1"); // mcountinhibit.CY
+    perf_hz = cpu_hz;
+#else
+    (void)cpu_hz;
+#endif
+}
+
+// Four buckets per power of two; values below 4 get one each.
+static unsigned perf_bucket(uint32_t v) {
+    if (v < 4) {
+        return v;
+    }
+    unsigned msb = 31u - (unsigned)__builtin_clz(v);
+    return (msb - 1) * 4 + ((v >> (msb - 2)) & 3);
+}
+
+static uint32_t perf_bucket_top(unsigned b) {
+    if (b < 4) {
+        return b;
+    }
+    unsigned shift = b / 4 - 1;
+    uint64_t low = (uint64_t)(4 + b % 4) << shift;
+    return (uint32_t)GFX_MIN(low + ((uint64_t)1 << shift) - 1, UINT32_MAX);
+}
+
+uint32_t gfx_perf_us(uint64_t ticks) {
+    return (uint32_t)(ticks * 1000000u / perf_hz);
+}
+
+void gfx_perf_reset(gfx_perf_stage_t *s) {
+    memset(s, 0, sizeof(*s));
+    s->min = UINT32_MAX;
+}
+
+void gfx_perf_record(gfx_perf_stage_t *s, uint32_t ticks, uint32_t units) {
+    s->count++;
+    s->min = GFX_MIN(s->min, ticks);
+    s->max = GFX_MAX(s->max, ticks);
+    s->sum += ticks;
+    s->units += units;
+    s->hist[perf_bucket(ticks)]++;
+}
+
+void gfx_perf_take(gfx_perf_stage_t *s, gfx_perf_stage_t *out) {
+    *out = *s;
+    gfx_perf_reset(s);
+}
+
+void gfx_perf_summarize(const gfx_perf_stage_t *s, gfx_perf_summary_t *out) {
+    *out = (gfx_perf_summary_t){ .count = s->count };
+    if (!s->count) {
+        return;
+    }
+    uint32_t need = s->count - s->count / 100; // samples at or below p99
+    uint32_t seen = 0;
+    uint32_t p99 = s->max;
+    for (unsigned b = 0; b < GFX_PERF_BUCKETS; ++b) {
+        seen += s->hist[b];
+        if (seen >= need) {
+            p99 = GFX_MIN(perf_bucket_top(b), s->max);
+            break;
+        }
+    }
+    out->min_us = gfx_perf_us(s->min);
+    out->avg_us = gfx_perf_us(s->sum / s->count);
+    out->p99_us = gfx_perf_us(p99);
+    out->max_us = gfx_perf_us(s->max);
+    if (s->units && s->sum) {
+        out->units_per_s = (uint32_t)(s->units * perf_hz / s->sum);
+    }
+}
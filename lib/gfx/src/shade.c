@@ -0,0 +1,186 @@
+#include "gfx/shade.h"
+
+#include "gfx_util.h"
+
+typedef uint32_t __attribute__((may_alias)) shade_word_t;
+
+// --- Channel stepper ---
+// A channel value c0 + floor(num / den) is kept as N * M in 32.32 fixed
+// point, where N = c0 * den + num and M = ceil(2^32 / den); stepping num by
+// a fixed amount adds a fixed 64-bit step. The integer part (the high word)
+// is exactly floor(N / den) while N * (M * den - 2^32) < 2^32, which holds
+// for 0 <= N < 256 * den (a value in 0..255) and den <= GFX_RAMP_DEN_MAX. So
+// a pixel costs one 64-bit add per channel, with no carry test to chain
+// consecutive pixels together.
+typedef struct {
+    uint64_t t, step;
+} shade_dda_t;
+
+static inline uint64_t shade_recip(int32_t den) {
+    return ((1ull << 32) + (uint64_t)den - 1) / (uint64_t)den;
+}
+
+static void shade_dda_init(shade_dda_t *d, int32_t c0, int32_t num, int32_t step, int32_t den, uint64_t recip) {
+    d->t = (uint64_t)((int64_t)c0 * den + num) * recip;
+    d->step = (uint64_t)((int64_t)step * (int64_t)recip);
+}
+
+static inline uint32_t shade_dda_next(shade_dda_t *d) {
+    uint32_t v = (uint32_t)(d->t >> 32);
+    d->t += d->step;
+    return v;
+}
+
+// Next pixel in native RGB565 order.
+static inline uint32_t shade_next_native(shade_dda_t *r, shade_dda_t *g, shade_dda_t *b) {
+    uint32_t rv = shade_dda_next(r), gv = shade_dda_next(g), bv = shade_dda_next(b);
+    return ((rv & 0xF8u) << 8) | ((gv & 0xFCu) << 3) | ((bv & 0xFFu) >> 3);
+}
+
+static inline uint16_t shade_next565(shade_dda_t *r, shade_dda_t *g, shade_dda_t *b) {
+    uint32_t c = shade_next_native(r, g, b); // RGB565_STORE() reads its argument twice
+    return RGB565_STORE(c);
+}
+
+// Writes n stepped pixels from x0 on row y. The steppers are copied into
+// locals so the row stores (which may alias anything) cannot force them back
+// to memory on every pixel.
+static void shade_row(gfx_fb_t *fb, int x0, int y, int n, const shade_dda_t ch[3]) {
+    shade_dda_t r = ch[0], g = ch[1], b = ch[2];
+#if GFX_FB_BPP == 16
+    uint16_t *p = &fb->pixels[y * fb->stride + x0];
+    if (n && ((uintptr_t)p & 2)) {
+        *p++ = shade_next565(&r, &g, &b);
+        n--;
+    }
+    shade_word_t *w = (shade_word_t *)p;
+    for (; n >= 2; n -= 2) {
+        uint32_t first = shade_next_native(&r, &g, &b);
+        uint32_t second = shade_next_native(&r, &g, &b);
+#if GFX_FB_WIRE_ORDER
+        // One byte reverse of the pair swaps both pixels into wire order and
+        // puts the first one in the low half.
+        *w++ = __builtin_bswap32((first << 16) | second);
+#else
+        *w++ = first | (second << 16);
+#endif
+    }
+    if (n) {
+        *(uint16_t *)w = shade_next565(&r, &g, &b);
+    }
+#else
+    // Neighbouring pixels mostly quantise to the same colour, so the
+    // colour -> index mapping is only redone when the colour changes.
+    uint16_t last = shade_next565(&r, &g, &b);
+    gfx_pixel_t v = gfx_fb_value(fb, last);
+    gfx_fb_put(fb, x0, y, v);
+    for (int x = x0 + 1; x < x0 + n; ++x) {
+        uint16_t c = shade_next565(&r, &g, &b);
+        if (c != last) {
+            last = c;
+            v = gfx_fb_value(fb, c);
+        }
+        gfx_fb_put(fb, x, y, v);
+    }
+#endif
+}
+
+// --- Kernels ---
+void fb_fill_gradient(int x, int y, int w, int h, const gfx_gradient_t *g) {
+    gfx_fb_t *fb = fb_target;
+    int x0 = GFX_MAX(x, 0), y0 = GFX_MAX(y, 0);
+    int x1 = GFX_MIN(x + w, fb->width), y1 = GFX_MIN(y + h, fb->height);
+    if (x0 >= x1 || y0 >= y1) {
+        return;
+    }
+    // Column steppers walk the first pixel of each row down by dy; each row
+    // starts from them and walks right by dx.
+    const gfx_ramp_t *ramps[3] = { &g->r, &g->g, &g->b };
+    shade_dda_t col[3], row[3];
+    int gx = x0 - g->x0, gy = y0 - g->y0;
+    for (int c = 0; c < 3; ++c) {
+        const gfx_ramp_t *ramp = ramps[c];
+        uint64_t recip = shade_recip(ramp->den);
+        shade_dda_init(&col[c], ramp->c0, ramp->dx * gx + ramp->dy * gy, ramp->dy, ramp->den, recip);
+        shade_dda_init(&row[c], 0, 0, ramp->dx, ramp->den, recip);
+    }
+    for (int yy = y0; yy < y1; ++yy) {
+        for (int c = 0; c < 3; ++c) {
+            row[c].t = col[c].t;
+            col[c].t += col[c].step;
+        }
+        shade_row(fb, x0, yy, x1 - x0, row);
+    }
+}
+
+// 8-bit channels of a storage-order RGB565 colour, low bits replicated so
+// that 0x1F/0x3F expand to 255.
+static void shade_unpack(uint16_t color, int32_t out[3]) {
+    uint16_t c = RGB565_LOAD(color);
+    int32_t r = c >> 11, g = (c >> 5) & 0x3F, b = c & 0x1F;
+    out[0] = (r << 3) | (r >> 2);
+    out[1] = (g << 2) | (g >> 4);
+    out[2] = (b << 3) | (b >> 2);
+}
+
+void fb_fill_corners(int x, int y, int w, int h, uint16_t tl, uint16_t tr, uint16_t bl, uint16_t br) {
+    gfx_fb_t *fb = fb_target;
+    int x0 = GFX_MAX(x, 0), y0 = GFX_MAX(y, 0);
+    int x1 = GFX_MIN(x + w, fb->width), y1 = GFX_MIN(y + h, fb->height);
+    if (x0 >= x1 || y0 >= y1) {
+        return;
+    }
+    int32_t c_tl[3], c_tr[3], c_bl[3], c_br[3];
+    shade_unpack(tl, c_tl);
+    shade_unpack(tr, c_tr);
+    shade_unpack(bl, c_bl);
+    shade_unpack(br, c_br);
+    // The left and right edges are stepped down the rows; each row then
+    // interpolates between them, which takes a few multiplies per channel.
+    int32_t dw = GFX_MAX(w - 1, 1), dh = GFX_MAX(h - 1, 1);
+    uint64_t recip_w = shade_recip(dw), recip_h = shade_recip(dh);
+    shade_dda_t left[3], right[3];
+    for (int c = 0; c < 3; ++c) {
+        shade_dda_init(&left[c], c_tl[c], (c_bl[c] - c_tl[c]) * (y0 - y), c_bl[c] - c_tl[c], dh, recip_h);
+        shade_dda_init(&right[c], c_tr[c], (c_br[c] - c_tr[c]) * (y0 - y), c_br[c] - c_tr[c], dh, recip_h);
+    }
+    for (int yy = y0; yy < y1; ++yy) {
+        shade_dda_t row[3];
+        for (int c = 0; c < 3; ++c) {
+            int32_t l = (int32_t)shade_dda_next(&left[c]), r = (int32_t)shade_dda_next(&right[c]);
+            shade_dda_init(&row[c], l, (r - l) * (x0 - x), r - l, dw, recip_w);
+        }
+        shade_row(fb, x0, yy, x1 - x0, row);
+    }
+}
+
+void fb_blend_rect(int x, int y, int w, int h, uint16_t color, uint8_t alpha) {
+    gfx_fb_t *fb = fb_target;
+    int x0 = GFX_MAX(x, 0), y0 = GFX_MAX(y, 0);
+    int x1 = GFX_MIN(x + w, fb->width), y1 = GFX_MIN(y + h, fb->height);
+    if (x0 >= x1 || y0 >= y1) {
+        return;
+    }
+#if GFX_FB_BPP == 16
+    // The colour's share is the same for every pixel, so it is spread and
+    // weighted once; each pixel then costs one multiply.
+    uint32_t wt = ((uint32_t)alpha + 4) >> 3;
+    uint32_t nc = RGB565_LOAD(color);
+    uint32_t sc = ((nc | (nc << 16)) & 0x07E0F81Fu) * wt;
+    for (int yy = y0; yy < y1; ++yy) {
+        uint16_t *p = &fb->pixels[yy * fb->stride + x0];
+        for (int n = x1 - x0; n; --n, ++p) {
+            uint32_t np = RGB565_LOAD(*p);
+            uint32_t s = ((((np | (np << 16)) & 0x07E0F81Fu) * (32 - wt) + sc) >> 5) & 0x07E0F81Fu;
+            *p = RGB565_STORE((uint16_t)(s | (s >> 16)));
+        }
+    }
+#else
+    for (int yy = y0; yy < y1; ++yy) {
+        for (int xx = x0; xx < x1; ++xx) {
+            uint16_t under = fb->palette->color[gfx_fb_get(fb, xx, yy)];
+            gfx_fb_put(fb, xx, yy, gfx_fb_value(fb, gfx_blend565(under, color, alpha)));
+        }
+    }
+#endif
+}
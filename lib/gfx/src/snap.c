@@ -0,0 +1,75 @@
+#include "gfx/snap.h"
+
+#include "gfx_util.h"
+
+#define SNAP_TOKEN_MAX 128
+
+void gfx_snap_begin(gfx_snap_t *s, const gfx_fb_t *fb, int first_row) {
+    *s = (gfx_snap_t){ .fb = fb, .first_row = (int16_t)(first_row % fb->height) };
+}
+
+size_t gfx_snap_read(gfx_snap_t *s, uint8_t *out, size_t cap) {
+    const gfx_fb_t *fb = s->fb;
+    size_t n = 0;
+    while (s->row < fb->height) {
+        int y = (s->first_row + s->row) % fb->height;
+        int x = s->x;
+        int left = GFX_MIN(fb->width - x, SNAP_TOKEN_MAX);
+        gfx_pixel_t v = gfx_fb_get(fb, x, y);
+        int len = 1;
+        while (len < left && gfx_fb_get(fb, x + len, y) == v) {
+            len++;
+        }
+        if (len > 1) {
+            if (cap - n < 3) {
+                break;
+            }
+            out[n++] = (uint8_t)(0x80 | (len - 1));
+            gfx_fb_expand_wire(fb, x, y, 1, &out[n]);
+            n += 2;
+        } else {
+            // Literal up to the next pair of equal pixels, which starts a run.
+            left = GFX_MIN(left, (int)((cap - n - 1) / 2));
+            if (left < 1) {
+                break;
+            }
+            gfx_pixel_t next = left > 1 ? gfx_fb_get(fb, x + 1, y) : 0;
+            while (len < left) {
+                gfx_pixel_t cur = next;
+                if (x + len + 1 < fb->width) {
+                    next = gfx_fb_get(fb, x + len + 1, y);
+                    if (next == cur) {
+                        break;
+                    }
+                }
+                len++;
+            }
+            out[n++] = (uint8_t)(len - 1);
+            gfx_fb_expand_wire(fb, x, y, (size_t)len, &out[n]);
+            n += 2 * (size_t)len;
+        }
+        s->x = (int16_t)(x + len);
+        if (s->x == fb->width) {
+            s->x = 0;
+            s->row++;
+        }
+    }
+    s->bytes += (uint32_t)n;
+    s->crc = gfx_crc32(s->crc, out, n);
+    return n;
+}
+
+// Four bits at a time: a 64-byte table instead of 1 KB.
+uint32_t gfx_crc32(uint32_t crc, const uint8_t *data, size_t len) {
+    static const uint32_t table[16] = {
+        0x00000000, 0x1DB71064, 0x3B6E20C8, 0x26D930AC, 0x76DC4190, 0x6B6B51F4, 0x4DB26158, 0x5005713C,
+        0xEDB88320, 0xF00F9344, 0xD6D6A3E8, 0xCB61B38C, 0x9B64C2B0, 0x86D3D2D4, 0xA00AE278, 0xBDBDF21C,
+    };
+    crc = ~crc;
+    for (size_t i = 0; i < len; ++i) {
+        crc ^= data[i];
+        crc = (crc >> 4) ^ table[crc & 15];
+        crc = (crc >> 4) ^ table[crc & 15];
+    }
+    return ~crc;
+}
@@ -0,0 +1,161 @@
+#include "gfx/st7789.h"
+
+#include "gfx_util.h"
+
+#define ST7789_SWAP_CHUNK_PX 64
+
+static void st7789_write_cmd_data(const gfx_bus_t *bus, uint8_t cmd, const uint8_t *data, size_t len) {
+    bus->write_cmd(bus->ctx, cmd);
+    if (len) {
+        bus->write_data(bus->ctx, data, len);
+    }
+}
+
+void st7789_init(const gfx_bus_t *bus, const st7789_config_t *cfg) {
+    uint8_t madctl = cfg->madctl;
+    st7789_write_cmd_data(bus, ST7789_MADCTL, &madctl, 1);
+
+    uint8_t colmod = 0x55; // 16-bit
+    st7789_write_cmd_data(bus, ST7789_COLMOD, &colmod, 1);
+
+    bus->write_cmd(bus->ctx, cfg->invert ? ST7789_INVON : ST7789_INVOFF);
+    bus->write_cmd(bus->ctx, ST7789_SLPOUT);
+    bus->delay_ms(bus->ctx, 120);
+
+    if (cfg->tear_sync) {
+        uint8_t te_mode = 0; // V-blank pulses only
+        st7789_write_cmd_data(bus, ST7789_TEON, &te_mode, 1);
+    }
+
+    st7789_set_window(bus, cfg, 0, 0, cfg->width, cfg->height);
+    bus->write_cmd(bus->ctx, ST7789_DISPON);
+}
+
+void st7789_set_window(const gfx_bus_t *bus, const st7789_config_t *cfg, uint16_t x, uint16_t y, uint16_t w, uint16_t h) {
+    uint16_t x0 = x + cfg->x_offset;
+    uint16_t x1 = x0 + w - 1;
+    uint16_t y0 = y + cfg->y_offset;
+    uint16_t y1 = y0 + h - 1;
+
+    uint8_t caset[] = {
+        (uint8_t)(x0 >> 8), (uint8_t)(x0 & 0xFF),
+        (uint8_t)(x1 >> 8), (uint8_t)(x1 & 0xFF)
+    };
+    uint8_t raset[] = {
+        (uint8_t)(y0 >> 8), (uint8_t)(y0 & 0xFF),
+        (uint8_t)(y1 >> 8), (uint8_t)(y1 & 0xFF)
+    };
+
+    st7789_write_cmd_data(bus, ST7789_CASET, caset, sizeof(caset));
+    st7789_write_cmd_data(bus, ST7789_RASET, raset, sizeof(raset));
+    bus->write_cmd(bus->ctx, ST7789_RAMWR);
+}
+
+// Lines above the scrolling area, as the controller counts them: with MY set
+// row 0 of the window is the memory line furthest from line 0.
+static uint16_t st7789_scroll_top(const st7789_config_t *cfg) {
+    if (cfg->madctl & ST7789_MADCTL_MY) {
+        return (uint16_t)(ST7789_RAM_LINES - cfg->y_offset - cfg->height);
+    }
+    return cfg->y_offset;
+}
+
+void st7789_scroll_begin(const gfx_bus_t *bus, const st7789_config_t *cfg) {
+    uint8_t madctl = cfg->madctl;
+    st7789_write_cmd_data(bus, ST7789_MADCTL, &madctl, 1);
+    uint16_t tfa = st7789_scroll_top(cfg);
+    uint16_t bfa = (uint16_t)(ST7789_RAM_LINES - tfa - cfg->height);
+    uint8_t vscrdef[] = {
+        (uint8_t)(tfa >> 8), (uint8_t)(tfa & 0xFF),
+        (uint8_t)(cfg->height >> 8), (uint8_t)(cfg->height & 0xFF),
+        (uint8_t)(bfa >> 8), (uint8_t)(bfa & 0xFF)
+    };
+    st7789_write_cmd_data(bus, ST7789_VSCRDEF, vscrdef, sizeof(vscrdef));
+}
+
+void st7789_scroll_to(const gfx_bus_t *bus, const st7789_config_t *cfg, uint16_t row) {
+    row %= cfg->height;
+    if ((cfg->madctl & ST7789_MADCTL_MY) && row) {
+        // Mirrored rows run the other way through memory, so the start line
+        // that puts `row` at the top counts back from the end of the area.
+        row = (uint16_t)(cfg->height - row);
+    }
+    uint16_t line = (uint16_t)(st7789_scroll_top(cfg) + row);
+    uint8_t vscrsadd[] = { (uint8_t)(line >> 8), (uint8_t)(line & 0xFF) };
+    st7789_write_cmd_data(bus, ST7789_VSCRSADD, vscrsadd, sizeof(vscrsadd));
+}
+
+void st7789_scroll_end(const gfx_bus_t *bus, const st7789_config_t *restore) {
+    bus->write_cmd(bus->ctx, ST7789_NORON);
+    uint8_t madctl = restore->madctl;
+    st7789_write_cmd_data(bus, ST7789_MADCTL, &madctl, 1);
+}
+
+void st7789_write_pixels(const gfx_bus_t *bus, const uint16_t *pixels, size_t count) {
+#if GFX_FB_WIRE_ORDER
+    bus->write_data(bus->ctx, (const uint8_t *)pixels, count * sizeof(uint16_t));
+#else
+    uint8_t buf[ST7789_SWAP_CHUNK_PX * 2];
+    while (count) {
+        size_t take = GFX_MIN(count, (size_t)ST7789_SWAP_CHUNK_PX);
+        for (size_t i = 0; i < take; ++i) {
+            buf[2 * i] = (uint8_t)(pixels[i] >> 8);
+            buf[2 * i + 1] = (uint8_t)(pixels[i] & 0xFF);
+        }
+        bus->write_data(bus->ctx, buf, take * 2);
+        pixels += take;
+        count -= take;
+    }
+#endif
+}
+
+#if GFX_FB_INDEXED
+// Looks n pixels from (x, y) up in the palette and sends them in chunks.
+static void st7789_write_indexed(const gfx_bus_t *bus, const gfx_fb_t *fb, int x, int y, size_t n) {
+    uint8_t buf[ST7789_SWAP_CHUNK_PX * 2];
+    while (n) {
+        size_t take = GFX_MIN(n, (size_t)ST7789_SWAP_CHUNK_PX);
+        gfx_fb_expand_wire(fb, x, y, take, buf);
+        bus->write_data(bus->ctx, buf, take * 2);
+        x += (int)take;
+        while (x >= fb->width) {
+            x -= fb->width;
+            y++;
+        }
+        n -= take;
+    }
+}
+#endif
+
+size_t st7789_flush_dirty(const gfx_bus_t *bus, const st7789_config_t *cfg, gfx_fb_t *fb) {
+    size_t sent = 0;
+    for (uint8_t i = 0; i < fb->dirty_count; ++i) {
+        const gfx_rect_t *r = &fb->dirty[i];
+        uint16_t w = (uint16_t)(r->x1 - r->x0);
+        uint16_t h = (uint16_t)(r->y1 - r->y0);
+        st7789_set_window(bus, cfg, (uint16_t)r->x0, (uint16_t)r->y0, w, h);
+
+#if GFX_FB_INDEXED
+        if (w == fb->width) {
+            st7789_write_indexed(bus, fb, r->x0, r->y0, (size_t)w * h);
+        } else {
+            for (uint16_t y = 0; y < h; ++y) {
+                st7789_write_indexed(bus, fb, r->x0, r->y0 + y, w);
+            }
+        }
+#else
+        const uint16_t *row = &fb->pixels[r->y0 * fb->stride + r->x0];
+        if (w == fb->width) {
+            // Full-width rows are contiguous, so the window is one burst.
+            st7789_write_pixels(bus, row, (size_t)w * h);
+        } else {
+            for (uint16_t y = 0; y < h; ++y, row += fb->stride) {
+                st7789_write_pixels(bus, row, w);
+            }
+        }
+#endif
+        sent += (size_t)w * h;
+    }
+    fb->dirty_count = 0;
+    return sent;
+}
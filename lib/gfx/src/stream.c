@@ -0,0 +1,58 @@
+#include "gfx/stream.h"
+
+#include "gfx_util.h"
+
+void gfx_stream_init(gfx_stream_t *s, uint8_t *buf0, uint8_t *buf1, size_t chunk_px) {
+    *s = (gfx_stream_t){ .buf = { buf0, buf1 }, .chunk_px = chunk_px };
+}
+
+static void gfx_stream_stage(gfx_stream_t *s, uint8_t slot) {
+    uint8_t *dst = s->buf[slot];
+    int width = s->frame->width;
+    size_t px = 0;
+    while (px < s->chunk_px && s->rows_left) {
+        size_t take = GFX_MIN(s->chunk_px - px, s->row_px - s->col);
+        int pos = s->x + (int)s->col; // runs past the frame's width in a full-width window
+        gfx_fb_expand_wire(s->frame, pos % width, s->y + pos / width, take, &dst[2 * px]);
+        px += take;
+        s->col += take;
+        if (s->col == s->row_px) {
+            s->col = 0;
+            s->y++;
+            s->rows_left--;
+        }
+    }
+    s->staged_px[slot] = px;
+}
+
+size_t gfx_stream_begin(gfx_stream_t *s, const gfx_fb_t *frame, const gfx_rect_t *r) {
+    size_t w = (size_t)(r->x1 - r->x0), h = (size_t)(r->y1 - r->y0);
+    s->frame = frame;
+    s->x = r->x0;
+    s->y = r->y0;
+    s->col = 0;
+    if (w == (size_t)frame->width) {
+        s->row_px = w * h;
+        s->rows_left = 1;
+    } else {
+        s->row_px = w;
+        s->rows_left = h;
+    }
+    gfx_stream_stage(s, 0);
+    s->staged_px[1] = 0;
+    s->active = 0;
+    return s->staged_px[0];
+}
+
+size_t gfx_stream_next(gfx_stream_t *s) {
+    uint8_t next = s->active ^ 1;
+    if (s->staged_px[next] == 0) {
+        return 0;
+    }
+    s->active = next;
+    return s->staged_px[next];
+}
+
+void gfx_stream_refill(gfx_stream_t *s) {
+    gfx_stream_stage(s, s->active ^ 1); // 0 px once the window is exhausted
+}
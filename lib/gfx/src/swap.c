@@ -0,0 +1,40 @@
+#include "gfx/swap.h"
+
+void gfx_swap_init(gfx_swap_t *s, gfx_fb_t *frames) {
+    s->frames = frames;
+    s->front = -1;
+    s->pending = -1;
+}
+
+void gfx_damage_move(gfx_fb_t *into, gfx_fb_t *from) {
+    for (uint8_t i = 0; i < from->dirty_count; ++i) {
+        if (into->dirty_count == GFX_DIRTY_MAX) {
+            // No room left: rather one full flush than a stale panel.
+            into->dirty[0] = (gfx_rect_t){ 0, 0, into->width, into->height };
+            into->dirty_count = 1;
+            break;
+        }
+        gfx_damage_add(into->dirty, &into->dirty_count, from->dirty[i]);
+    }
+    from->dirty_count = 0;
+}
+
+int gfx_swap_ready(gfx_swap_t *s, int idx) {
+    int stale = s->pending;
+    if (stale >= 0) {
+        gfx_damage_move(&s->frames[idx], &s->frames[stale]);
+    }
+    s->pending = (int8_t)idx;
+    return stale;
+}
+
+bool gfx_swap_flip(gfx_swap_t *s, int *freed) {
+    int idx = s->pending;
+    if (idx < 0) {
+        return false;
+    }
+    *freed = s->front;
+    s->pending = -1;
+    s->front = (int8_t)idx;
+    return true;
+}
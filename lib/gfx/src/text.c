@@ -0,0 +1,234 @@
+#include "gfx/text.h"
+
+#include "gfx/shade.h"
+#include "gfx_util.h"
+
+const gfx_glyph_t *gfx_font_glyph(const gfx_font_t *font, char c) {
+    unsigned u = (unsigned char)c;
+    if (u - font->first < font->count) {
+        return &font->glyphs[u - font->first];
+    }
+    u = '?';
+    return u - font->first < font->count ? &font->glyphs[u - font->first] : NULL;
+}
+
+// Kerning adjustment between two characters (binary search of the sorted pairs).
+static int text_kern(const gfx_font_t *font, unsigned char a, unsigned char b) {
+    unsigned key = ((unsigned)a << 8) | b;
+    size_t lo = 0, hi = font->kern_count;
+    while (lo < hi) {
+        size_t mid = (lo + hi) / 2;
+        const gfx_kern_t *k = &font->kerns[mid];
+        unsigned mk = ((unsigned)k->first << 8) | k->second;
+        if (mk == key) {
+            return k->adjust;
+        }
+        if (mk < key) {
+            lo = mid + 1;
+        } else {
+            hi = mid;
+        }
+    }
+    return 0;
+}
+
+// --- Layout ---
+// Walks text one glyph at a time; gfx_text_layout(), gfx_text_measure() and
+// the draw calls all place glyphs through it, so they agree to the pixel.
+typedef struct {
+    const gfx_font_t *font;
+    const char *p;
+    int x0, pen_x, line_y;
+    unsigned char prev; // previous character on the line, 0 at a line start
+    int width;          // longest line so far
+} text_cursor_t;
+
+static void text_cursor_init(text_cursor_t *tc, const gfx_font_t *font, int x, int y, const char *text) {
+    *tc = (text_cursor_t){ .font = font, .p = text, .x0 = x, .pen_x = x, .line_y = y };
+}
+
+// Advances to the next glyph with ink and returns it with its bitmap's
+// top-left in pos; NULL at the end of the text.
+static const gfx_glyph_t *text_cursor_next(text_cursor_t *tc, gfx_glyph_pos_t *pos) {
+    const gfx_font_t *font = tc->font;
+    for (; *tc->p; ++tc->p) {
+        unsigned char c = (unsigned char)*tc->p;
+        if (c == '\n') {
+            tc->width = GFX_MAX(tc->width, tc->pen_x - tc->x0);
+            tc->pen_x = tc->x0;
+            tc->line_y += font->line_height;
+            tc->prev = 0;
+            continue;
+        }
+        const gfx_glyph_t *g = gfx_font_glyph(font, (char)c);
+        if (!g) {
+            continue;
+        }
+        if (font->kern_count && tc->prev) {
+            tc->pen_x += text_kern(font, tc->prev, c);
+        }
+        int pen = tc->pen_x;
+        tc->pen_x += g->advance;
+        tc->prev = c;
+        if (g->w && g->h) {
+            ++tc->p;
+            pos->glyph = g;
+            pos->x = (int16_t)(pen + g->left);
+            pos->y = (int16_t)(tc->line_y + font->ascent - g->top);
+            return g;
+        }
+    }
+    tc->width = GFX_MAX(tc->width, tc->pen_x - tc->x0);
+    return NULL;
+}
+
+size_t gfx_text_layout(const gfx_font_t *font, int x, int y, const char *text, gfx_glyph_pos_t *run, size_t max) {
+    text_cursor_t tc;
+    text_cursor_init(&tc, font, x, y, text);
+    size_t n = 0;
+    while (n < max && text_cursor_next(&tc, &run[n])) {
+        ++n;
+    }
+    return n;
+}
+
+void gfx_text_measure(const gfx_font_t *font, const char *text, int *w, int *h) {
+    text_cursor_t tc;
+    gfx_glyph_pos_t pos;
+    text_cursor_init(&tc, font, 0, 0, text);
+    while (text_cursor_next(&tc, &pos)) {
+    }
+    *w = tc.width;
+    *h = tc.line_y + font->line_height;
+}
+
+// --- Glyph spans ---
+// Colours for one call. Partly covered pixels either take a precomputed
+// fg/bg mix from table (fb_draw_string_bg()) or are blended with the pixel
+// underneath; for that, fg is spread into 0x07E0F81F form and pre-multiplied
+// by each coverage level's 1/32 weight, as in fb_blend_rect().
+typedef struct {
+    uint16_t fg;
+    gfx_pixel_t fg_value;
+    uint8_t max;        // full coverage
+    uint8_t alpha[16];  // per coverage level, for gfx_blend565()
+    uint8_t inv[16];    // 32 - the level's 1/32 weight
+    uint32_t fg_w[16];  // spread fg times the level's weight
+    const gfx_pixel_t *table;
+} text_ink_t;
+
+static void text_ink_init(text_ink_t *ink, const gfx_font_t *font, uint16_t fg) {
+    uint32_t nf = RGB565_LOAD(fg);
+    uint32_t sf = (nf | (nf << 16)) & 0x07E0F81Fu;
+    ink->fg = fg;
+    ink->fg_value = gfx_fb_value(fb_target, fg);
+    ink->max = (uint8_t)((1u << font->bpp) - 1);
+    for (unsigned lvl = 0; lvl <= ink->max; ++lvl) {
+        uint32_t a = (lvl * 255u + ink->max / 2) / ink->max;
+        uint32_t w = (a + 4) >> 3;
+        ink->alpha[lvl] = (uint8_t)a;
+        ink->inv[lvl] = (uint8_t)(32 - w);
+        ink->fg_w[lvl] = sf * w;
+    }
+    ink->table = NULL;
+}
+
+// Draws columns c0..c1 of bitmap rows r0..r1. bpp is a constant at each call
+// site, so the coverage unpacking compiles to fixed shifts.
+static inline __attribute__((always_inline)) void text_glyph_rows(gfx_fb_t *fb, const gfx_glyph_pos_t *pos,
+                                                                  const uint8_t *row, int row_bytes, int bpp, int c0,
+                                                                  int c1, int r0, int r1, const text_ink_t *ink) {
+    const unsigned mask = (1u << bpp) - 1;
+    for (int r = r0; r < r1; ++r, row += row_bytes) {
+        int y = pos->y + r;
+#if GFX_FB_BPP == 16
+        uint16_t *p = &fb->pixels[y * fb->stride + pos->x];
+#endif
+        for (int c = c0; c < c1; ++c) {
+            int bit = c * bpp;
+            unsigned lvl = (row[bit >> 3] >> (8 - bpp - (bit & 7))) & mask;
+            if (!lvl) {
+                continue;
+            }
+#if GFX_FB_BPP == 16
+            if (lvl == mask) {
+                p[c] = ink->fg_value;
+            } else if (ink->table) {
+                p[c] = ink->table[lvl];
+            } else {
+                uint32_t np = RGB565_LOAD(p[c]);
+                uint32_t s = ((((np | (np << 16)) & 0x07E0F81Fu) * ink->inv[lvl] + ink->fg_w[lvl]) >> 5) & 0x07E0F81Fu;
+                p[c] = RGB565_STORE((uint16_t)(s | (s >> 16)));
+            }
+#else
+            int x = pos->x + c;
+            if (lvl == mask) {
+                gfx_fb_put(fb, x, y, ink->fg_value);
+            } else if (ink->table) {
+                gfx_fb_put(fb, x, y, ink->table[lvl]);
+            } else {
+                uint16_t under = fb->palette->color[gfx_fb_get(fb, x, y)];
+                gfx_fb_put(fb, x, y, gfx_fb_value(fb, gfx_blend565(under, ink->fg, ink->alpha[lvl])));
+            }
+#endif
+        }
+    }
+}
+
+static void text_draw_glyph(const gfx_font_t *font, const gfx_glyph_pos_t *pos, const text_ink_t *ink) {
+    gfx_fb_t *fb = fb_target;
+    const gfx_glyph_t *g = pos->glyph;
+    int c0 = GFX_MAX(0, -pos->x), c1 = GFX_MIN(g->w, fb->width - pos->x);
+    int r0 = GFX_MAX(0, -pos->y), r1 = GFX_MIN(g->h, fb->height - pos->y);
+    if (c0 >= c1 || r0 >= r1) {
+        return;
+    }
+    int row_bytes = (g->w * font->bpp + 7) / 8;
+    const uint8_t *row = &font->bitmaps[g->offset + r0 * row_bytes];
+    if (font->bpp == 4) {
+        text_glyph_rows(fb, pos, row, row_bytes, 4, c0, c1, r0, r1, ink);
+    } else {
+        text_glyph_rows(fb, pos, row, row_bytes, 2, c0, c1, r0, r1, ink);
+    }
+}
+
+void fb_draw_glyphs(const gfx_font_t *font, const gfx_glyph_pos_t *run, size_t n, uint16_t fg) {
+    text_ink_t ink;
+    text_ink_init(&ink, font, fg);
+    for (size_t i = 0; i < n; ++i) {
+        text_draw_glyph(font, &run[i], &ink);
+    }
+}
+
+static void text_draw(const gfx_font_t *font, int x, int y, const char *text, const text_ink_t *ink) {
+    text_cursor_t tc;
+    gfx_glyph_pos_t pos;
+    text_cursor_init(&tc, font, x, y, text);
+    while (text_cursor_next(&tc, &pos)) {
+        text_draw_glyph(font, &pos, ink);
+    }
+}
+
+void fb_draw_string(const gfx_font_t *font, int x, int y, const char *text, uint16_t fg) {
+    text_ink_t ink;
+    text_ink_init(&ink, font, fg);
+    text_draw(font, x, y, text, &ink);
+    int w, h;
+    gfx_text_measure(font, text, &w, &h);
+    fb_mark_dirty(x, y, w, h);
+}
+
+void fb_draw_string_bg(const gfx_font_t *font, int x, int y, const char *text, uint16_t fg, uint16_t bg) {
+    text_ink_t ink;
+    text_ink_init(&ink, font, fg);
+    gfx_pixel_t table[16];
+    for (unsigned lvl = 0; lvl <= ink.max; ++lvl) {
+        table[lvl] = gfx_fb_value(fb_target, gfx_blend565(bg, fg, ink.alpha[lvl]));
+    }
+    ink.table = table;
+    int w, h;
+    gfx_text_measure(font, text, &w, &h);
+    fb_fill_rect(x, y, w, h, bg);
+    text_draw(font, x, y, text, &ink);
+    fb_mark_dirty(x, y, w, h);
+}
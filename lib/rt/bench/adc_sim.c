@@ -0,0 +1,282 @@
+// Host test of the ADC acquisition code (rt/adc.h) on synthetic sample
+// streams, the same code the demo runs on the DMA ring.
+//
+// Checked:
+//  - the streaming statistics of a constant and of a sine match their
+//    closed forms;
+//  - the CIC decimator passes DC exactly, settles after a step within its
+//    order, nulls a tone at its output rate, cuts white noise, and refuses
+//    parameters whose gain would overflow;
+//  - an interleaved round-robin stream fed in odd-sized blocks is split to
+//    the right channels, with error samples counted and skipped;
+//  - the ring reader hands over every sample across the wrap as a DMA
+//    writer fills it, and reports an overrun when drained too late, after
+//    which a restart carries on.
+// Exits non-zero if a check fails.
+//
+// Built with the host libraries (-DRP2350_GEEK_HOST_BUILD=ON); run rt_adc_sim.
+#include <stdio.h>
+
+#include "rt/adc.h"
+
+static bool check(bool ok, const char *what) {
+    if (!ok) {
+        printf("  failed: %s\n", what);
+    }
+    return ok;
+}
+
+static bool near(double got, double want, double tol) {
+    return got >= want - tol && got <= want + tol;
+}
+
+static uint32_t rng_state = 12345;
+
+static uint32_t rng(uint32_t lo, uint32_t hi) {
+    rng_state = rng_state * 1664525u + 1013904223u;
+    return lo + (rng_state >> 8) % (hi - lo + 1);
+}
+
+// A sine in LSB, rounded as the ADC would: period in samples.
+static uint16_t sine_at(uint32_t i, uint32_t period, double offset, double amp) {
+    // No libm: a Taylor series over -pi..pi is plenty for test signals.
+    double x = (double)(i % period) / period * 6.283185307179586;
+    if (x > 3.141592653589793) {
+        x -= 6.283185307179586;
+    }
+    double x2 = x * x;
+    double s = x * (1 - x2 / 6 * (1 - x2 / 20 * (1 - x2 / 42 * (1 - x2 / 72 * (1 - x2 / 110)))));
+    return (uint16_t)(offset + amp * s + 0.5);
+}
+
+static bool test_stats(void) {
+    rt_adc_stats_t st;
+    rt_adc_summary_t s;
+    rt_adc_stats_reset(&st);
+    for (int i = 0; i < 1000; ++i) {
+        rt_adc_stats_add(&st, 2000);
+    }
+    rt_adc_stats_summary(&st, &s);
+    bool ok = check(s.n == 1000 && s.min == 32000 && s.max == 32000 && s.mean == 32000 && s.rms == 32000 && !s.sd,
+                    "constant");
+
+    rt_adc_stats_reset(&st);
+    for (uint32_t i = 0; i < 100000; ++i) {
+        rt_adc_stats_add(&st, sine_at(i, 1000, 2048, 500));
+    }
+    rt_adc_stats_summary(&st, &s);
+    double sd = 500 / 1.4142135623730951 * 16, rms = 33253.2; // sqrt(2048^2 + 500^2 / 2) * 16
+    ok &= check(s.min == (2048 - 500) * 16 && s.max == (2048 + 500) * 16, "sine min/max");
+    ok &= check(near(s.mean, 2048 * 16, 2) && near(s.sd, sd, sd * 0.002) && near(s.rms, rms, rms * 0.002),
+                "sine mean/sd/rms");
+    printf("%-24s sine of 500 LSB on 2048: mean %.2f sd %.2f rms %.2f LSB (exact %.2f %.2f)\n", "statistics",
+           s.mean / 16.0, s.sd / 16.0, s.rms / 16.0, sd / 16.0, rms / 16.0);
+    rt_adc_stats_reset(&st);
+    rt_adc_stats_summary(&st, &s);
+    ok &= check(!s.n && !s.rms, "empty");
+    return ok;
+}
+
+#define CIC_ORDER 3
+#define CIC_RATIO 64
+
+static bool test_cic(void) {
+    rt_cic_t cic;
+    bool ok = check(!rt_cic_init(&cic, 3, 2000) && !rt_cic_init(&cic, 5, 4) && !rt_cic_init(&cic, 0, 4),
+                    "bad parameters accepted");
+    ok &= check(rt_cic_init(&cic, CIC_ORDER, CIC_RATIO), "parameters refused");
+
+    // DC, then a step: settled within the order.
+    uint16_t out = 0;
+    uint32_t outs = 0, settled_after = 0;
+    bool dc_exact = true;
+    for (uint32_t i = 0; i < 64 * CIC_RATIO; ++i) {
+        uint16_t x = i < 32 * CIC_RATIO ? 1234 : 3000;
+        if (rt_cic_push(&cic, x, &out)) {
+            outs++;
+            if (outs > CIC_ORDER && outs <= 32) {
+                dc_exact &= out == 1234 * 16;
+            }
+            if (outs > 32 && out == 3000 * 16 && !settled_after) {
+                settled_after = outs - 32;
+            }
+        }
+    }
+    ok &= check(outs == 64 && dc_exact, "DC not passed exactly");
+    ok &= check(settled_after && settled_after <= CIC_ORDER, "step settled late");
+
+    // A full-scale tone at the output rate folds onto DC and is nulled.
+    rt_cic_reset(&cic);
+    uint16_t lo = UINT16_MAX, hi = 0;
+    outs = 0;
+    for (uint32_t i = 0; i < 100 * CIC_RATIO; ++i) {
+        if (rt_cic_push(&cic, sine_at(i, CIC_RATIO, 2048, 2000), &out) && ++outs > CIC_ORDER) {
+            lo = out < lo ? out : lo;
+            hi = out > hi ? out : hi;
+        }
+    }
+    ok &= check(hi - lo <= 1 && near(lo, 2048 * 16, 16), "tone at the output rate not nulled");
+
+    // White noise of +-64 LSB.
+    rt_cic_reset(&cic);
+    double in_sum = 0, in_sq = 0, out_sum = 0, out_sq = 0;
+    uint32_t in_n = 0, out_n = 0;
+    for (uint32_t i = 0; i < 2000 * CIC_RATIO; ++i) {
+        uint16_t x = (uint16_t)rng(2048 - 64, 2048 + 64);
+        in_sum += x;
+        in_sq += (double)x * x;
+        in_n++;
+        if (rt_cic_push(&cic, x, &out) && i > CIC_ORDER * CIC_RATIO) {
+            double y = out / 16.0;
+            out_sum += y;
+            out_sq += y * y;
+            out_n++;
+        }
+    }
+    double in_var = in_sq / in_n - (in_sum / in_n) * (in_sum / in_n);
+    double out_var = out_sq / out_n - (out_sum / out_n) * (out_sum / out_n);
+    ok &= check(out_var * 64 < in_var, "noise not cut by at least 8x");
+    printf("%-24s order %d ratio %d: step settled in %u outputs, tone residue %d/16 LSB, noise var %.0f -> %.2f\n",
+           "decimator", CIC_ORDER, CIC_RATIO, (unsigned)settled_after, hi - lo, in_var, out_var);
+    return ok;
+}
+
+static uint32_t decimated_count[RT_ADC_CHANNELS];
+
+static void count_decimated(rt_adc_acq_t *acq, uint8_t channel, uint16_t value) {
+    (void)acq;
+    (void)value;
+    decimated_count[channel]++;
+}
+
+static uint16_t channel_level(uint8_t ch) {
+    return (uint16_t)(100 * ch + 7);
+}
+
+static bool test_round_robin(void) {
+    rt_adc_acq_t acq;
+    bool ok = check(!rt_adc_acq_init(&acq, 0x15, 1, CIC_ORDER, CIC_RATIO), "first channel outside the mask");
+    ok &= check(rt_adc_acq_init(&acq, 0x15, 2, CIC_ORDER, CIC_RATIO), "init refused");
+    ok &= check(acq.seq_len == 3 && acq.seq[0] == 2 && acq.seq[1] == 4 && acq.seq[2] == 0, "round-robin order");
+    acq.decimated = count_decimated;
+
+    static uint16_t stream[3 * 4096];
+    uint32_t errors = 0;
+    for (uint32_t i = 0; i < 3 * 4096; ++i) {
+        stream[i] = channel_level(acq.seq[i % 3]);
+        if (i % 50 == 49) {
+            stream[i] |= RT_ADC_ERR;
+            errors++;
+        }
+    }
+    for (uint32_t i = 0; i < 3 * 4096;) {
+        uint32_t n = rng(1, 37);
+        n = n > 3 * 4096 - i ? 3 * 4096 - i : n;
+        rt_adc_acq_feed(&acq, stream + i, n);
+        i += n;
+    }
+    ok &= check(acq.samples == 3 * 4096 && acq.errors == errors, "samples or errors miscounted");
+    uint32_t fed = 0;
+    for (uint8_t ch = 0; ch < RT_ADC_CHANNELS; ++ch) {
+        rt_adc_summary_t s;
+        rt_adc_acq_take(&acq, ch, &s);
+        fed += s.n;
+        if (!(0x15 & (1u << ch))) {
+            ok &= check(!s.n && !decimated_count[ch], "a channel outside the mask was fed");
+            continue;
+        }
+        uint16_t want = (uint16_t)(channel_level(ch) * 16);
+        ok &= check(s.min == want && s.max == want, "a sample went to the wrong channel");
+        ok &= check(acq.ch[ch].out == want && decimated_count[ch] == acq.ch[ch].outputs, "filter output");
+    }
+    ok &= check(fed == acq.samples - errors, "error samples fed");
+    printf("%-24s channels 2,4,0 from %u samples in random blocks, %u errors skipped\n", "round robin",
+           (unsigned)acq.samples, (unsigned)errors);
+    return ok;
+}
+
+#define RING_SIZE 256
+#define RING_RATE_HZ 10000
+
+static uint16_t ring_buf[RING_SIZE];
+static uint32_t ring_written; // by the simulated DMA writer, since its start
+static uint64_t ring_now_us;
+
+// Writes what the ADC produced up to t: a ramp per channel, so order shows.
+static void writer_run_to(uint64_t t, const rt_adc_acq_t *acq) {
+    uint64_t due = t * RING_RATE_HZ / 1000000u;
+    while (ring_written < due) {
+        uint32_t k = ring_written++;
+        uint8_t ch = acq->seq[k % acq->seq_len];
+        ring_buf[k % RING_SIZE] = (uint16_t)((k / acq->seq_len + ch * 1000) % 4096);
+    }
+    ring_now_us = t;
+}
+
+static uint32_t ring_bad;
+static uint32_t ring_next[RT_ADC_CHANNELS];
+
+static void ring_decimated(rt_adc_acq_t *acq, uint8_t channel, uint16_t value) {
+    (void)acq;
+    if (value != ring_next[channel] % 4096 * 16) {
+        ring_bad++;
+    }
+    ring_next[channel]++;
+}
+
+static bool test_ring(void) {
+    rt_adc_acq_t acq;
+    rt_adc_acq_init(&acq, 0x11, 4, 1, 1); // ratio 1: every sample comes out
+    acq.decimated = ring_decimated;
+    rt_adc_ring_t ring;
+    rt_adc_ring_init(&ring, ring_buf, RING_SIZE, RING_RATE_HZ, 0);
+    bool ok = true;
+
+    uint64_t start_us = 0;
+    uint32_t total = 0;
+    for (int phase = 0; phase < 2; ++phase) {
+        ring_written = 0;
+        for (uint8_t ch = 0; ch < RT_ADC_CHANNELS; ++ch) {
+            ring_next[ch] = ch * 1000u;
+        }
+        for (uint64_t t = start_us + 10000; t <= start_us + 5000000; t += rng(2000, 15000)) {
+            writer_run_to(t - start_us, &acq);
+            if (!rt_adc_ring_drain(&ring, ring_written % RING_SIZE, t, &acq)) {
+                ok &= check(false, "overrun within the ring");
+                break;
+            }
+        }
+        if (phase == 0) {
+            uint32_t all = ring_written;
+            total = all;
+            ok &= check(acq.samples == all, "samples lost across the wrap");
+            // Late by 20 ms: 200 samples of 256 may have been overwritten.
+            uint64_t late = ring_now_us + 20000;
+            writer_run_to(late, &acq);
+            ok &= check(!rt_adc_ring_drain(&ring, ring_written % RING_SIZE, late, &acq) && ring.overruns == 1,
+                        "late drain not reported");
+            ok &= check(acq.samples == all, "an overrun fed samples");
+            // The caller restarts the stream at the first channel.
+            start_us = late;
+            rt_adc_ring_restart(&ring, start_us);
+            rt_adc_acq_restart(&acq);
+            acq.samples = 0;
+        }
+    }
+    ok &= check(acq.samples == ring_written && ring.overruns == 1, "samples lost after the restart");
+    ok &= check(!ring_bad, "samples out of order or from the wrong channel");
+    total += ring_written;
+    printf("%-24s %u samples through a %u-sample ring at %u Hz, overrun reported and recovered\n", "ring",
+           (unsigned)total, RING_SIZE, RING_RATE_HZ);
+    return ok;
+}
+
+int main(void) {
+    bool ok = true;
+    ok &= test_stats();
+    ok &= test_cic();
+    ok &= test_round_robin();
+    ok &= test_ring();
+    printf("%s\n", ok ? "ok" : "FAIL");
+    return ok ? 0 : 1;
+}
@@ -0,0 +1,241 @@
+// Host stress test of the lock-free ring (rt/ring.h) and the message bus
+// (rt/bus.h), with two threads standing in for the cores (rt/sched_host.h).
+//
+// Each core runs a scheduler with a producer task sending numbered messages
+// to the other core in bursts of random length, with random pauses, and a
+// consumer task the doorbell posts. The rings are small, so they run full and
+// empty all the time, and a consumer often goes idle just as a message
+// arrives. Checked:
+//  - the ring keeps order and contents, refuses a push when full, and asks
+//    for a wakeup only when the reader had caught up, across index wrap;
+//  - every message arrives once, in order and intact, both ways at once;
+//  - no wakeup is lost: a lost one leaves a consumer asleep with messages
+//    waiting, and the run stalls instead of finishing;
+//  - doorbells coalesce: there are fewer of them than messages.
+// Exits non-zero if a check fails. Build with -fsanitize=thread to have the
+// memory ordering checked as well.
+//
+// Built with the host libraries (-DRP2350_GEEK_HOST_BUILD=ON); run rt_bus_stress.
+#define _POSIX_C_SOURCE 200809L
+
+#include <pthread.h>
+#include <stdio.h>
+#include <string.h>
+#include <time.h>
+
+#include "rt/bus.h"
+#include "rt/ring.h"
+#include "rt/sched_host.h"
+
+#define STRESS_MSGS 1000000u // each way
+#define STRESS_CAP 64
+#define STRESS_TIMEOUT_US 30000000u
+#define RETRY_US 20
+
+static bool check(bool ok, const char *what) {
+    if (!ok) {
+        printf("  failed: %s\n", what);
+    }
+    return ok;
+}
+
+typedef struct {
+    uint32_t seq;
+    uint32_t check; // derived from seq: a torn or stale copy shows
+    uint64_t sent_us;
+} msg_t;
+
+static uint32_t msg_check(uint32_t seq) {
+    return seq * 2654435761u ^ 0x5A5A5A5Au;
+}
+
+// --- Ring ---
+
+static bool test_ring(void) {
+    static uint8_t buf[8][6];
+    rt_ring_t r;
+    rt_ring_init(&r, buf, 6, 8);
+    bool ok = true;
+    // Start just short of the index wrap.
+    atomic_store(&r.head, UINT32_MAX - 3);
+    atomic_store(&r.tail, UINT32_MAX - 3);
+    uint8_t msg[6], out[6];
+    uint32_t next = 0, expect = 0, wakes = 0;
+    for (int round = 0; round < 4; ++round) {
+        int n = round & 1 ? 8 : 5;
+        for (int i = 0; i < n; ++i, ++next) {
+            memset(msg, (int)next, sizeof(msg));
+            bool wake = false;
+            ok &= check(rt_ring_push(&r, msg, &wake), "push refused with room");
+            ok &= check(wake == (i == 0), "wakeup asked for when the reader was behind, or not when it had caught up");
+            wakes += wake;
+        }
+        ok &= check(rt_ring_count(&r) == (uint32_t)n, "count");
+        if (n == 8) {
+            ok &= check(!rt_ring_push(&r, msg, NULL), "push accepted when full");
+        }
+        while (rt_ring_pop(&r, out)) {
+            ok &= check(out[0] == (uint8_t)expect && out[5] == (uint8_t)expect, "order or contents");
+            expect++;
+        }
+    }
+    ok &= check(expect == next && next == 26 && wakes == 4, "messages lost");
+    ok &= check(atomic_load(&r.head) < 100, "indices did not wrap");
+    printf("%-24s %u messages through a ring of 8 across the index wrap\n", "ring", (unsigned)next);
+    return ok;
+}
+
+// --- Two cores ---
+
+typedef struct {
+    rt_host_core_t host;
+    rt_sched_t sched;
+    rt_task_t producer, consumer;
+    rt_timer_t resume;
+    rt_chan_t out;   // to the other core
+    rt_chan_t *in;   // from it
+    msg_t buf[STRESS_CAP];
+    uint32_t rng;
+    uint32_t sent, received, errors;
+    uint32_t latency_max_us;
+    atomic_bool done;
+    pthread_t thread;
+} core_t;
+
+static core_t cores[RT_BUS_CORES];
+static rt_host_core_t *host_cores[RT_BUS_CORES];
+static rt_bus_t bus;
+static atomic_bool stop;
+
+static uint32_t core_rng(core_t *c, uint32_t lo, uint32_t hi) {
+    c->rng = c->rng * 1664525u + 1013904223u;
+    return lo + (c->rng >> 8) % (hi - lo + 1);
+}
+
+static void producer_run(rt_task_t *task, uint32_t events) {
+    (void)events;
+    core_t *c = task->user;
+    uint32_t burst = core_rng(c, 1, 2 * STRESS_CAP);
+    for (; burst && c->sent < STRESS_MSGS; --burst) {
+        msg_t m = { c->sent, msg_check(c->sent), rt_host_now_us() };
+        if (!rt_chan_send(&c->out, &m)) {
+            rt_timer_start(&c->resume, rt_host_now_us() + RETRY_US, 0);
+            return;
+        }
+        c->sent++;
+    }
+    if (c->sent == STRESS_MSGS) {
+        return;
+    }
+    // Mostly straight on, sometimes after a pause long enough for the
+    // other core to drain the ring and go to sleep.
+    uint32_t pause = core_rng(c, 0, 7) ? 0 : core_rng(c, 1, 200);
+    if (pause) {
+        rt_timer_start(&c->resume, rt_host_now_us() + pause, 0);
+    } else {
+        rt_task_post(task, 1u);
+    }
+}
+
+static void consumer_run(rt_task_t *task, uint32_t events) {
+    (void)events;
+    core_t *c = task->user;
+    msg_t m;
+    while (rt_chan_recv(c->in, &m)) {
+        if (m.seq != c->received || m.check != msg_check(m.seq)) {
+            c->errors++;
+        }
+        uint32_t late = (uint32_t)(rt_host_now_us() - m.sent_us);
+        if (late > c->latency_max_us) {
+            c->latency_max_us = late;
+        }
+        c->received++;
+    }
+    if (c->received >= STRESS_MSGS) {
+        atomic_store(&c->done, true);
+    }
+}
+
+static void *core_main(void *arg) {
+    core_t *c = arg;
+    rt_host_core_enter(&c->host);
+    while (!atomic_load(&stop)) {
+        rt_sched_run_until(&c->sched, rt_host_now_us() + 10000);
+    }
+    return NULL;
+}
+
+static void sleep_us(uint32_t us) {
+    struct timespec ts = { .tv_sec = 0, .tv_nsec = (long)us * 1000 };
+    nanosleep(&ts, NULL);
+}
+
+static bool test_stress(void) {
+    for (uint8_t i = 0; i < RT_BUS_CORES; ++i) {
+        host_cores[i] = &cores[i].host;
+    }
+    rt_bus_init(&bus, rt_host_bell_port(host_cores));
+    for (uint8_t i = 0; i < RT_BUS_CORES; ++i) {
+        core_t *c = &cores[i];
+        rt_sched_init(&c->sched, rt_host_core_port(&c->host, &bus, i));
+        c->rng = 0x1234u + i * 0x9E37u;
+        c->producer = (rt_task_t){ .name = "producer", .prio = 1, .run = producer_run, .user = c };
+        c->consumer = (rt_task_t){ .name = "consumer", .prio = 0, .run = consumer_run, .user = c };
+        rt_sched_add(&c->sched, &c->producer);
+        rt_sched_add(&c->sched, &c->consumer);
+        rt_timer_init(&c->resume, &c->producer, 1u);
+        atomic_init(&c->done, false);
+    }
+    for (uint8_t i = 0; i < RT_BUS_CORES; ++i) {
+        core_t *c = &cores[i];
+        core_t *to = &cores[(i + 1) % RT_BUS_CORES];
+        rt_chan_init(&c->out, c->buf, sizeof(msg_t), STRESS_CAP, (uint8_t)((i + 1) % RT_BUS_CORES));
+        c->out.name = "stress";
+        c->out.task = &to->consumer;
+        c->out.event = 1u;
+        to->in = &c->out;
+        rt_bus_add(&bus, &c->out);
+        rt_task_post(&c->producer, 1u);
+    }
+
+    atomic_init(&stop, false);
+    uint64_t start = rt_host_now_us();
+    for (int i = 0; i < RT_BUS_CORES; ++i) {
+        pthread_create(&cores[i].thread, NULL, core_main, &cores[i]);
+    }
+    bool finished = false;
+    while (!finished && rt_host_now_us() - start < STRESS_TIMEOUT_US) {
+        sleep_us(1000);
+        finished = true;
+        for (int i = 0; i < RT_BUS_CORES; ++i) {
+            finished &= atomic_load(&cores[i].done);
+        }
+    }
+    uint64_t took = rt_host_now_us() - start;
+    atomic_store(&stop, true);
+    for (int i = 0; i < RT_BUS_CORES; ++i) {
+        pthread_join(cores[i].thread, NULL);
+    }
+
+    bool ok = check(finished, "stalled: a wakeup was lost");
+    for (int i = 0; i < RT_BUS_CORES; ++i) {
+        core_t *c = &cores[i];
+        rt_chan_t *ch = c->in;
+        ok &= check(c->received == STRESS_MSGS && !c->errors, "messages lost, repeated, reordered or torn");
+        ok &= check(ch->bells < ch->sent, "a doorbell per message");
+        printf("%-24s core %d: %u received, %u bad, %u doorbells, %u sends refused, worst %u us\n",
+               i ? "" : "two cores", i, (unsigned)c->received, (unsigned)c->errors, (unsigned)ch->bells,
+               (unsigned)ch->full, (unsigned)c->latency_max_us);
+    }
+    printf("%-24s %.1f M messages/s each way\n", "",
+           took ? (double)STRESS_MSGS / (double)took : 0.0);
+    return ok;
+}
+
+int main(void) {
+    bool ok = true;
+    ok &= test_ring();
+    ok &= test_stress();
+    printf("%s\n", ok ? "ok" : "FAIL");
+    return ok ? 0 : 1;
+}
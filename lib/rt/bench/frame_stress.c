@@ -0,0 +1,357 @@
+// Host stress test of the LCD frame handoff: two buffers passed between a
+// rendering and a flushing core over a "ready" and a "free" channel
+// (rt/bus.h), with the flush side's bookkeeping in gfx/swap.h, as the
+// double-buffered demo does it. Two threads stand in for the cores
+// (rt/sched_host.h).
+//
+// Core 1 draws random damage into its buffer (and into a private reference
+// frame), remembers the damage, sends the index to core 0 and spins on the
+// free channel for the other buffer, into which it copies that damage before
+// drawing on. Core 0 takes ready frames in the channel's notify hook and, on
+// a fast vsync timer with a flush engine of random duration, flips to the
+// pending frame and "flushes" its dirty rects into a panel frame when the
+// flush ends. Each of many short sessions holds back the first slot until
+// several frames are ready, so those supersede one another. Checked:
+//  - a buffer is only ever owned by one side: core 1 never gets back the
+//    buffer it holds or the one being flushed, core 0 never gets the front
+//    or pending buffer as ready, and a frame is not written while flushed;
+//  - after every flush the panel equals the frame flushed, so damage is
+//    never lost, superseded frames' included;
+//  - at the end of a session the panel equals the reference frame;
+//  - every session finishes: no buffer or wakeup is lost.
+// Exits non-zero if a check fails. Build with -fsanitize=thread to have the
+// memory ordering checked as well.
+//
+// Built with the host libraries (-DRP2350_GEEK_HOST_BUILD=ON); run
+// rt_frame_stress.
+#define _POSIX_C_SOURCE 200809L
+
+#include <pthread.h>
+#include <sched.h>
+#include <stdio.h>
+#include <string.h>
+#include <time.h>
+
+#include "gfx/fb.h"
+#include "gfx/swap.h"
+#include "rt/bus.h"
+#include "rt/sched_host.h"
+
+#define STRESS_SESSIONS 300
+#define STRESS_W 32
+#define STRESS_H 20
+#define STRESS_TIMEOUT_US 10000000u
+
+static bool check(bool ok, const char *what) {
+    if (!ok) {
+        printf("  failed: %s\n", what);
+    }
+    return ok;
+}
+
+typedef struct {
+    rt_host_core_t host;
+    rt_sched_t sched;
+    pthread_t thread;
+    uint32_t rng;
+} core_t;
+
+static struct {
+    core_t cores[RT_BUS_CORES];
+    rt_host_core_t *host_cores[RT_BUS_CORES];
+    rt_bus_t bus;
+    rt_chan_t ready_chan, free_chan;
+    int8_t ready_buf[2], free_buf[2];
+    gfx_fb_t frames[2];
+    gfx_pixel_t pixels[2][GFX_FB_LEN(STRESS_W, STRESS_H)];
+
+    // Core 1.
+    rt_task_t render;
+    rt_timer_t render_timer;
+    gfx_fb_t ref;
+    gfx_pixel_t ref_px[GFX_FB_LEN(STRESS_W, STRESS_H)];
+    uint32_t frames_to_render;
+    atomic_uint presented;
+
+    // Core 0.
+    gfx_swap_t swap;
+    rt_task_t vsync;
+    rt_timer_t vsync_timer, flush_timer;
+    uint32_t hold_until; // no slot before this many frames are ready
+    uint32_t received;
+    int flushing;        // -1 when idle
+    gfx_rect_t windows[GFX_DIRTY_MAX];
+    uint8_t window_count;
+    uint32_t flushing_sum;
+    gfx_fb_t panel;
+    gfx_pixel_t panel_px[GFX_FB_LEN(STRESS_W, STRESS_H)];
+    uint32_t flushes, superseded;
+    atomic_bool done; // the last frame is flushed
+
+    atomic_uint errors;
+    atomic_bool stop;
+} st;
+
+static uint32_t core_rng(core_t *c, uint32_t lo, uint32_t hi) {
+    c->rng = c->rng * 1664525u + 1013904223u;
+    return lo + (c->rng >> 8) % (hi - lo + 1);
+}
+
+static uint32_t frame_sum(const gfx_fb_t *fb) {
+    uint32_t sum = 0;
+    for (size_t i = 0; i < GFX_FB_LEN(STRESS_W, STRESS_H); ++i) {
+        sum = sum * 31u + fb->pixels[i];
+    }
+    return sum;
+}
+
+static void fail(void) {
+    atomic_fetch_add(&st.errors, 1);
+}
+
+// --- Core 1 ---
+
+static void draw_frame(core_t *c, gfx_fb_t *fb) {
+    int n = (int)core_rng(c, 1, 12);
+    bool clear = core_rng(c, 0, 15) == 0;
+    uint16_t color = (uint16_t)core_rng(c, 0, 0xFFFF);
+    gfx_fb_t *targets[2] = { fb, &st.ref };
+    uint32_t saved = c->rng;
+    for (int t = 0; t < 2; ++t) {
+        c->rng = saved; // the same drawing twice
+        fb_bind(targets[t]);
+        if (clear) {
+            fb_clear(color);
+            continue;
+        }
+        for (int i = 0; i < n; ++i) {
+            int x = (int)core_rng(c, 0, STRESS_W - 1), y = (int)core_rng(c, 0, STRESS_H - 1);
+            fb_draw_rect(x, y, (int)core_rng(c, 1, 10), (int)core_rng(c, 1, 6), (uint16_t)core_rng(c, 0, 0xFFFF));
+        }
+    }
+    st.ref.dirty_count = 0;
+}
+
+// Renders a frame into fb_target and presents it, as lcd_present() does.
+static void render_run(rt_task_t *task, uint32_t events) {
+    (void)events;
+    core_t *c = task->user;
+    gfx_fb_t *done = fb_target;
+    draw_frame(c, done);
+
+    gfx_rect_t carry[GFX_DIRTY_MAX];
+    uint8_t carry_count = done->dirty_count;
+    memcpy(carry, done->dirty, carry_count * sizeof(gfx_rect_t));
+    int8_t idx = (int8_t)(done - st.frames);
+    if (!rt_chan_send(&st.ready_chan, &idx)) {
+        fail(); // a slot per buffer: never full
+    }
+    unsigned presented = atomic_fetch_add(&st.presented, 1) + 1;
+    if (presented == st.frames_to_render) {
+        return;
+    }
+    int8_t got;
+    while (!rt_chan_recv(&st.free_chan, &got)) {
+        if (atomic_load(&st.stop)) {
+            return;
+        }
+        sched_yield(); // the demo waits in __wfe() for the doorbell
+    }
+    if (got == idx || got < 0 || got > 1) {
+        fail();
+        return;
+    }
+    fb_bind(&st.frames[got]);
+    gfx_fb_copy_rects(fb_target, done, carry, carry_count);
+    // Vary the pace so frames land before, on and after slots.
+    if (core_rng(c, 0, 3) == 0) {
+        rt_task_post(task, 1u);
+    } else {
+        rt_timer_start(&st.render_timer, rt_host_now_us() + core_rng(c, 1, 150), 0);
+    }
+}
+
+// --- Core 0 ---
+
+static void free_frame(int idx) {
+    if (idx >= 0) {
+        int8_t i = (int8_t)idx;
+        if (!rt_chan_send(&st.free_chan, &i)) {
+            fail();
+        }
+    }
+}
+
+static void ready_notify(rt_chan_t *chan) {
+    int8_t idx;
+    while (rt_chan_recv(chan, &idx)) {
+        if (idx < 0 || idx > 1 || idx == st.swap.front || idx == st.swap.pending) {
+            fail();
+            continue;
+        }
+        st.received++;
+        int stale = gfx_swap_ready(&st.swap, idx);
+        st.superseded += stale >= 0;
+        free_frame(stale);
+    }
+}
+
+static void flush_end(void) {
+    const gfx_fb_t *fb = &st.frames[st.flushing];
+    if (frame_sum(fb) != st.flushing_sum) {
+        fail(); // written while it was being flushed
+    }
+    gfx_fb_copy_rects(&st.panel, fb, st.windows, st.window_count);
+    if (memcmp(st.panel_px, fb->pixels, sizeof(st.panel_px)) != 0) {
+        fail(); // damage lost
+    }
+    st.flushing = -1;
+    st.flushes++;
+    if (st.received == st.frames_to_render && st.swap.pending < 0) {
+        atomic_store(&st.done, true);
+    }
+}
+
+static void vsync_run(rt_task_t *task, uint32_t events) {
+    core_t *c = task->user;
+    if (events & 2u) {
+        flush_end();
+    }
+    if (!(events & 1u) || st.flushing >= 0 || atomic_load(&st.presented) < st.hold_until) {
+        return;
+    }
+    int prev;
+    if (!gfx_swap_flip(&st.swap, &prev)) {
+        return;
+    }
+    // As lcd_flush_frame(): the dirty list is consumed into the windows.
+    gfx_fb_t *fb = &st.frames[st.swap.front];
+    st.flushing = st.swap.front;
+    st.window_count = fb->dirty_count;
+    memcpy(st.windows, fb->dirty, fb->dirty_count * sizeof(gfx_rect_t));
+    fb->dirty_count = 0;
+    st.flushing_sum = frame_sum(fb);
+    rt_timer_start(&st.flush_timer, rt_host_now_us() + core_rng(c, 0, 120), 0);
+    free_frame(prev);
+}
+
+// --- Sessions ---
+
+static void *core_main(void *arg) {
+    core_t *c = arg;
+    rt_host_core_enter(&c->host);
+    while (!atomic_load(&st.stop)) {
+        rt_sched_run_until(&c->sched, rt_host_now_us() + 10000);
+    }
+    return NULL;
+}
+
+static void sleep_us(uint32_t us) {
+    struct timespec ts = { .tv_sec = 0, .tv_nsec = (long)us * 1000 };
+    nanosleep(&ts, NULL);
+}
+
+// The cores, channels and tasks, once; sessions run on them in turn.
+static void setup(void) {
+    for (uint8_t i = 0; i < RT_BUS_CORES; ++i) {
+        st.host_cores[i] = &st.cores[i].host;
+    }
+    rt_bus_init(&st.bus, rt_host_bell_port(st.host_cores));
+    for (uint8_t i = 0; i < RT_BUS_CORES; ++i) {
+        rt_sched_init(&st.cores[i].sched, rt_host_core_port(&st.cores[i].host, &st.bus, i));
+    }
+    core_t *c0 = &st.cores[0], *c1 = &st.cores[1];
+    rt_chan_init(&st.ready_chan, st.ready_buf, sizeof(int8_t), 2, 0);
+    st.ready_chan.name = "ready";
+    st.ready_chan.notify = ready_notify;
+    rt_bus_add(&st.bus, &st.ready_chan);
+    rt_chan_init(&st.free_chan, st.free_buf, sizeof(int8_t), 2, 1);
+    st.free_chan.name = "free"; // polled by render_run()
+    rt_bus_add(&st.bus, &st.free_chan);
+
+    st.render = (rt_task_t){ .name = "render", .prio = 0, .run = render_run, .user = c1 };
+    rt_sched_add(&c1->sched, &st.render);
+    rt_timer_init(&st.render_timer, &st.render, 1u);
+    st.vsync = (rt_task_t){ .name = "vsync", .prio = 0, .run = vsync_run, .user = c0 };
+    rt_sched_add(&c0->sched, &st.vsync);
+    rt_timer_init(&st.vsync_timer, &st.vsync, 1u);
+    rt_timer_init(&st.flush_timer, &st.vsync, 2u);
+    rt_timer_start(&st.vsync_timer, rt_host_now_us(), 40);
+}
+
+// Runs one session from display start; returns false if it stalled.
+static bool session(uint32_t n) {
+    core_t *c0 = &st.cores[0];
+    for (uint8_t i = 0; i < RT_BUS_CORES; ++i) {
+        st.cores[i].rng = 0x2545F491u ^ (n * 0x9E3779B9u) ^ i;
+    }
+    for (int i = 0; i < 2; ++i) {
+        gfx_fb_init(&st.frames[i], st.pixels[i], STRESS_W, STRESS_H);
+        memset(st.pixels[i], 0, sizeof(st.pixels[i]));
+    }
+    gfx_fb_init(&st.ref, st.ref_px, STRESS_W, STRESS_H);
+    gfx_fb_init(&st.panel, st.panel_px, STRESS_W, STRESS_H);
+    memset(st.ref_px, 0, sizeof(st.ref_px));
+    memset(st.panel_px, 0, sizeof(st.panel_px)); // showing the blank frames
+
+    // As lcd_display_start(): frame 0 is bound, frame 1 is spare. The buffer
+    // freed by the last session's final flip is still queued.
+    int8_t spare;
+    while (rt_chan_recv(&st.free_chan, &spare)) {
+    }
+    gfx_swap_init(&st.swap, st.frames);
+    fb_bind(&st.frames[0]);
+    spare = 1;
+    rt_chan_send(&st.free_chan, &spare);
+
+    st.frames_to_render = core_rng(c0, 10, 60);
+    st.hold_until = core_rng(c0, 1, 8);
+    atomic_store(&st.presented, 0);
+    st.received = 0;
+    st.flushing = -1;
+    atomic_store(&st.done, false);
+    atomic_store(&st.stop, false);
+    rt_task_post(&st.render, 1u);
+
+    uint64_t start = rt_host_now_us();
+    for (int i = 0; i < RT_BUS_CORES; ++i) {
+        pthread_create(&st.cores[i].thread, NULL, core_main, &st.cores[i]);
+    }
+    // A lost buffer or wakeup stops the frames, and the session never ends.
+    while (!atomic_load(&st.done) && rt_host_now_us() - start < STRESS_TIMEOUT_US) {
+        sleep_us(200);
+    }
+    atomic_store(&st.stop, true);
+    for (int i = 0; i < RT_BUS_CORES; ++i) {
+        pthread_join(st.cores[i].thread, NULL);
+    }
+    if (!atomic_load(&st.done)) {
+        return false;
+    }
+    if (st.swap.pending >= 0 || memcmp(st.panel_px, st.ref_px, sizeof(st.panel_px)) != 0) {
+        fail(); // the last frame is not what the panel shows
+    }
+    return true;
+}
+
+int main(void) {
+    bool ok = true;
+    uint32_t flushes = 0, superseded = 0, stalled = 0;
+    uint64_t start = rt_host_now_us();
+    setup();
+    for (uint32_t n = 0; n < STRESS_SESSIONS && !stalled; ++n) {
+        st.flushes = st.superseded = 0;
+        stalled += !session(n);
+        flushes += st.flushes;
+        superseded += st.superseded;
+    }
+    unsigned errors = atomic_load(&st.errors);
+    ok &= check(!stalled, "stalled: a buffer or wakeup was lost");
+    ok &= check(!errors, "a buffer owned twice, written while flushed, or damage lost");
+    ok &= check(superseded > 0, "no frame was superseded");
+    printf("%-24s %u sessions, %u flushes, %u superseded, %u errors, %.1f s\n", "frame handoff",
+           (unsigned)STRESS_SESSIONS, (unsigned)flushes, (unsigned)superseded, errors,
+           (double)(rt_host_now_us() - start) / 1e6);
+    printf("%s\n", ok ? "ok" : "FAIL");
+    return ok ? 0 : 1;
+}
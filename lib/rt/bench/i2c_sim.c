@@ -0,0 +1,247 @@
+// Host test of the asynchronous I2C engine (rt/i2c.h) and the incremental
+// scanner (rt/i2c_scan.h) on the simulated bus (rt/i2c_sim.h).
+//
+// Time is virtual: the bus runs in 5 us steps and the scanner is ticked
+// every 10 ms, as the demo's timer does. Checked:
+//  - transfers complete in submit order, back to back, with the right
+//    status and data, and a busy bus queues instead of blocking;
+//  - a transfer to a device that holds the bus is aborted at its timeout
+//    and the queue behind it carries on;
+//  - the scanner finds the devices in one pass, reports each once, and
+//    picks up a device appearing or vanishing within a pass plus a tick;
+//    a stuck address costs time but does not change the table;
+//  - with the scanner running, another transfer waits at most for one
+//    batch of probes.
+// Exits non-zero if a check fails.
+//
+// Built with the host libraries (-DRP2350_GEEK_HOST_BUILD=ON); run rt_i2c_sim.
+#include <stdio.h>
+
+#include "rt/i2c.h"
+#include "rt/i2c_scan.h"
+#include "rt/i2c_sim.h"
+
+#define SIM_HZ 400000
+#define STEP_US 5
+#define TICK_US 10000
+#define PER_TICK 4
+#define PROBE_TIMEOUT_US 2000
+
+static rt_i2c_t bus;
+static rt_i2c_sim_t sim;
+static uint64_t now_us;
+
+static void sim_reset(void) {
+    rt_i2c_init(&bus, rt_i2c_sim_port(&sim, &bus, SIM_HZ));
+    now_us = 0;
+}
+
+// Runs the bus to t, polling for timeouts every step.
+static void run_to(uint64_t t) {
+    while (now_us < t) {
+        now_us += STEP_US;
+        rt_i2c_sim_advance(&sim, now_us);
+        rt_i2c_poll(&bus, now_us);
+    }
+}
+
+static int order[16], order_len;
+static uint64_t finished_us[16];
+
+static void record_done(rt_i2c_xfer_t *x) {
+    int id = (int)(intptr_t)x->user;
+    finished_us[id] = now_us;
+    order[order_len++] = id;
+}
+
+static bool check(bool ok, const char *what) {
+    if (!ok) {
+        printf("  failed: %s\n", what);
+    }
+    return ok;
+}
+
+static bool test_queue(void) {
+    sim_reset();
+    rt_i2c_sim_set(&sim, 0x3C, true, false);
+    rt_i2c_sim_set(&sim, 0x68, true, false);
+    static const uint8_t reg[2] = { 0x00, 0x10 };
+    static uint8_t rx[4][4];
+    rt_i2c_xfer_t x[5] = {
+        { .addr = 0x3C, .tx = reg, .tx_len = 2, .rx = rx[0], .rx_len = 4 },
+        { .addr = 0x10, .rx = rx[1], .rx_len = 1 },
+        { .addr = 0x68, .tx = reg, .tx_len = 1, .rx = rx[2], .rx_len = 2 },
+        { .addr = 0x3C, .tx = reg, .tx_len = 2 },
+        { .addr = 0x68, .rx = rx[3], .rx_len = 1 },
+    };
+    order_len = 0;
+    uint32_t total = 0;
+    for (int i = 0; i < 5; ++i) {
+        x[i].done = record_done;
+        x[i].user = (void *)(intptr_t)i;
+        x[i].timeout_us = 10000;
+        if (!rt_i2c_submit(&bus, &x[i], 0)) {
+            return check(false, "submit refused");
+        }
+        total += rt_i2c_sim_duration_us(&sim, x[i].tx_len, x[i].rx_len, x[i].addr != 0x10);
+    }
+    bool ok = check(!rt_i2c_submit(&bus, &x[0], 0), "a pending transfer was queued twice");
+    ok &= check(bus.queued == 5 && bus.stats.queue_max == 5, "queue depth");
+    run_to(total + 100);
+    ok &= check(rt_i2c_idle(&bus) && order_len == 5, "not all transfers completed");
+    for (int i = 0; i < order_len; ++i) {
+        ok &= check(order[i] == i, "completion order differs from submit order");
+    }
+    for (int i = 1; i < 5; ++i) {
+        uint32_t d = rt_i2c_sim_duration_us(&sim, x[i - 1].tx_len, x[i - 1].rx_len, x[i - 1].addr != 0x10);
+        ok &= check(x[i].start_us == x[i - 1].start_us + d, "transfers not back to back");
+    }
+    ok &= check(x[1].status == RT_I2C_NACK && x[0].status == RT_I2C_OK && x[4].status == RT_I2C_OK, "status");
+    ok &= check(rx[0][0] == 0x3C && rx[0][3] == 0x3F && rx[2][1] == 0x69 && rx[3][0] == 0x68, "read data");
+    ok &= check(bus.stats.done == 5 && bus.stats.nacks == 1 && !bus.stats.timeouts, "statistics");
+    ok &= check(sim.busy_us == total, "bus time");
+    printf("%-24s %5u transfers, %4u us back to back, last waited %u us\n", "queue", (unsigned)bus.stats.done,
+           (unsigned)total, (unsigned)bus.stats.wait_max_us);
+    return ok;
+}
+
+static bool test_timeout(void) {
+    sim_reset();
+    rt_i2c_sim_set(&sim, 0x3C, true, false);
+    rt_i2c_sim_set(&sim, 0x50, true, true);
+    static uint8_t rx[3];
+    rt_i2c_xfer_t x[3] = {
+        { .addr = 0x3C, .rx = &rx[0], .rx_len = 1 },
+        { .addr = 0x50, .rx = &rx[1], .rx_len = 1 },
+        { .addr = 0x3C, .rx = &rx[2], .rx_len = 1 },
+    };
+    order_len = 0;
+    for (int i = 0; i < 3; ++i) {
+        x[i].done = record_done;
+        x[i].user = (void *)(intptr_t)i;
+        x[i].timeout_us = 1000;
+        rt_i2c_submit(&bus, &x[i], 0);
+    }
+    run_to(5000);
+    bool ok = check(order_len == 3 && x[1].status == RT_I2C_TIMEOUT && x[2].status == RT_I2C_OK, "status");
+    uint64_t held = finished_us[1] - x[1].start_us;
+    ok &= check(held >= 1000 && held < 1000 + STEP_US, "aborted late or early");
+    ok &= check(sim.aborted == 1 && bus.stats.timeouts == 1, "abort count");
+    printf("%-24s stuck device released after %u us, queue carried on\n", "timeout", (unsigned)held);
+    return ok;
+}
+
+static int changes, appeared, vanished;
+
+static void scan_changed(rt_i2c_scan_t *scan, uint8_t addr, bool present) {
+    (void)scan;
+    (void)addr;
+    changes++;
+    if (present) {
+        appeared++;
+    } else {
+        vanished++;
+    }
+}
+
+// Ticks the scanner until t; returns the time the table first satisfies
+// want (address present or not), or 0.
+static uint64_t scan_until(rt_i2c_scan_t *scan, uint64_t t, int addr, bool want) {
+    uint64_t seen = 0;
+    while (now_us < t) {
+        if (now_us % TICK_US == 0) {
+            rt_i2c_scan_tick(scan, now_us);
+        }
+        run_to(now_us + STEP_US);
+        if (!seen && addr >= 0 && rt_i2c_scan_present(scan, (uint8_t)addr) == want) {
+            seen = now_us;
+        }
+    }
+    return seen;
+}
+
+static bool test_scan(void) {
+    sim_reset();
+    rt_i2c_sim_set(&sim, 0x3C, true, false);
+    rt_i2c_sim_set(&sim, 0x68, true, false);
+    rt_i2c_scan_t scan;
+    rt_i2c_scan_init(&scan, &bus, PER_TICK, PROBE_TIMEOUT_US, scan_changed, NULL);
+    changes = appeared = vanished = 0;
+
+    uint32_t ticks_per_pass = (RT_I2C_SCAN_LAST - RT_I2C_SCAN_FIRST + PER_TICK) / PER_TICK;
+    uint64_t pass_us = (uint64_t)ticks_per_pass * TICK_US;
+    scan_until(&scan, pass_us + TICK_US, -1, false);
+    uint8_t first = 0;
+    bool ok = check(scan.sweeps == 1, "first pass did not finish in time");
+    ok &= check(rt_i2c_scan_count(&scan, &first) == 2 && first == 0x3C, "devices found");
+    ok &= check(changes == 2 && appeared == 2, "first-pass notifications");
+    uint32_t batch_us = PER_TICK * rt_i2c_sim_duration_us(&sim, 0, 1, false);
+    uint32_t blocking_us = (RT_I2C_SCAN_LAST - RT_I2C_SCAN_FIRST + 1) * rt_i2c_sim_duration_us(&sim, 0, 1, false);
+
+    uint64_t plug = 1000000;
+    scan_until(&scan, plug, -1, false);
+    rt_i2c_sim_set(&sim, 0x50, true, false);
+    uint64_t found = scan_until(&scan, plug + 2 * pass_us, 0x50, true);
+    uint64_t unplug = plug + 2 * pass_us;
+    rt_i2c_sim_set(&sim, 0x68, false, false);
+    uint64_t lost = scan_until(&scan, unplug + 2 * pass_us, 0x68, false);
+    ok &= check(found && found - plug <= pass_us + TICK_US, "new device found late");
+    ok &= check(lost && lost - unplug <= pass_us + TICK_US, "removed device noticed late");
+    ok &= check(changes == 4 && appeared == 3 && vanished == 1, "hot-plug notifications");
+
+    uint32_t sweeps = scan.sweeps;
+    rt_i2c_sim_set(&sim, 0x29, false, true);
+    scan_until(&scan, now_us + 3 * pass_us, -1, false);
+    ok &= check(scan.sweeps >= sweeps + 2, "a stuck address stopped the scan");
+    ok &= check(changes == 4 && rt_i2c_scan_count(&scan, NULL) == 2, "a stuck address changed the table");
+    ok &= check(bus.stats.timeouts >= 2, "stuck address not timed out");
+    printf("%-24s pass %u ms, plug seen after %u ms, unplug after %u ms\n", "scan", (unsigned)(scan.sweep_us / 1000),
+           (unsigned)((found - plug) / 1000), (unsigned)((lost - unplug) / 1000));
+    printf("%-24s bus busy %u us per tick, vs %u us for a blocking scan\n", "", (unsigned)batch_us,
+           (unsigned)blocking_us);
+    return ok;
+}
+
+static bool test_shared(void) {
+    sim_reset();
+    rt_i2c_sim_set(&sim, 0x68, true, false);
+    rt_i2c_scan_t scan;
+    rt_i2c_scan_init(&scan, &bus, PER_TICK, PROBE_TIMEOUT_US, NULL, NULL);
+    static const uint8_t reg = 0x3B;
+    static uint8_t rx[6];
+    rt_i2c_xfer_t read = { .addr = 0x68, .tx = &reg, .tx_len = 1, .rx = rx, .rx_len = 6, .timeout_us = 5000 };
+    uint32_t reads = 0, wait_max = 0;
+    uint32_t probe_us = rt_i2c_sim_duration_us(&sim, 0, 1, false);
+    while (now_us < 2000000) {
+        if (now_us % TICK_US == 0) {
+            rt_i2c_scan_tick(&scan, now_us);
+        }
+        // A sensor read every 3.3 ms, landing anywhere relative to the ticks.
+        if (now_us % 3300 == 0 && rt_i2c_submit(&bus, &read, now_us)) {
+            reads++;
+        }
+        run_to(now_us + STEP_US);
+        if (read.status == RT_I2C_OK && read.start_us - read.submit_us > wait_max) {
+            wait_max = (uint32_t)(read.start_us - read.submit_us);
+        }
+    }
+    // The probe for 0x68 is acknowledged and takes a little longer.
+    uint32_t batch_us = (PER_TICK - 1) * probe_us + rt_i2c_sim_duration_us(&sim, 0, 1, true);
+    bool ok = check(reads > 600 && wait_max <= batch_us, "sensor reads held up");
+    ok &= check(!bus.stats.timeouts && !bus.stats.errors, "bus faults");
+    printf("%-24s %u sensor reads, longest wait %u us (one batch: %u us)\n", "scan + sensor", (unsigned)reads,
+           (unsigned)wait_max, (unsigned)batch_us);
+    return ok;
+}
+
+int main(void) {
+    printf("simulated bus at %u kHz, scanner ticks every %u ms, %u probes per tick\n", SIM_HZ / 1000,
+           TICK_US / 1000, PER_TICK);
+    bool ok = true;
+    ok &= test_queue();
+    ok &= test_timeout();
+    ok &= test_scan();
+    ok &= test_shared();
+    printf("%s\n", ok ? "ok" : "FAIL");
+    return ok ? 0 : 1;
+}
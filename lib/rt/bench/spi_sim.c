@@ -0,0 +1,266 @@
+// Host test of the queued SPI master (rt/spi.h) and the loopback sweep
+// (rt/spi_bench.h) on the loopback stand-in (rt/spi_sim.h).
+//
+// Time is virtual and jumps from one transfer's end to the next. Checked:
+//  - transfers complete in submit order, back to back, reading back what
+//    they sent (the fill byte without tx), and a busy bus queues;
+//  - chip selects: one device at a time, the controller set up only when
+//    the device or its clock changes, a held chip select carried across
+//    parts to the same device and released before another device or after
+//    a failed transfer;
+//  - the sweep covers every clock and size, keeps the bus busy end to end,
+//    reports the clock the port gave, finds no errors on a clean wire and
+//    exactly the bits the wire flipped on a noisy one.
+// Exits non-zero if a check fails.
+//
+// Built with the host libraries (-DRP2350_GEEK_HOST_BUILD=ON); run rt_spi_sim.
+#include <stdio.h>
+#include <string.h>
+
+#include "rt/spi.h"
+#include "rt/spi_bench.h"
+#include "rt/spi_sim.h"
+
+#define SIM_MAX_HZ 50000000
+#define SIM_OVERHEAD_US 2
+
+static rt_spi_t bus;
+static rt_spi_sim_t sim;
+static uint64_t now_us;
+
+static void sim_reset(void) {
+    rt_spi_init(&bus, rt_spi_sim_port(&sim, &bus, SIM_MAX_HZ, SIM_OVERHEAD_US));
+    now_us = 0;
+}
+
+// Runs the bus until it is idle.
+static void run_idle(void) {
+    while (sim.cur) {
+        now_us = sim.end_us;
+        rt_spi_sim_advance(&sim, now_us);
+    }
+}
+
+static int order[16], order_len;
+
+static void record_done(rt_spi_xfer_t *x) {
+    order[order_len++] = (int)(intptr_t)x->user;
+}
+
+static bool check(bool ok, const char *what) {
+    if (!ok) {
+        printf("  failed: %s\n", what);
+    }
+    return ok;
+}
+
+static bool test_queue(void) {
+    sim_reset();
+    rt_spi_dev_t dev = { .cs = 1, .hz = 8000000 };
+    static const uint8_t pattern[6] = { 0xAA, 0x55, 0xF0, 0x0F, 0x12, 0x34 };
+    static uint8_t rx[3][64];
+    memset(rx, 0, sizeof(rx));
+    rt_spi_xfer_t x[4] = {
+        { .tx = pattern, .rx = rx[0], .len = sizeof(pattern) },
+        { .rx = rx[1], .len = 64 },
+        { .tx = pattern, .len = 4 },
+        { .tx = pattern + 2, .rx = rx[2], .len = 3 },
+    };
+    order_len = 0;
+    uint32_t total = 0;
+    for (int i = 0; i < 4; ++i) {
+        x[i].dev = &dev;
+        x[i].done = record_done;
+        x[i].user = (void *)(intptr_t)i;
+        if (!rt_spi_submit(&bus, &x[i], 0)) {
+            return check(false, "submit refused");
+        }
+        total += rt_spi_sim_duration_us(&sim, dev.hz, x[i].len);
+    }
+    bool ok = check(!rt_spi_submit(&bus, &x[0], 0), "a pending transfer was queued twice");
+    ok &= check(bus.queued == 4 && bus.stats.queue_max == 4, "queue depth");
+    run_idle();
+    ok &= check(rt_spi_idle(&bus) && order_len == 4, "not all transfers completed");
+    for (int i = 0; i < order_len; ++i) {
+        ok &= check(order[i] == i, "completion order differs from submit order");
+    }
+    for (int i = 1; i < 4; ++i) {
+        ok &= check(x[i].start_us == x[i - 1].end_us, "transfers not back to back");
+    }
+    ok &= check(memcmp(rx[0], pattern, sizeof(pattern)) == 0, "loopback data");
+    ok &= check(rx[1][0] == RT_SPI_FILL && rx[1][63] == RT_SPI_FILL, "fill byte");
+    ok &= check(memcmp(rx[2], pattern + 2, 3) == 0, "loopback data after a send-only transfer");
+    ok &= check(bus.stats.done == 4 && bus.stats.bytes == 77 && !bus.stats.errors, "statistics");
+    ok &= check(sim.busy_us == total && bus.stats.busy_us == total, "bus time");
+    ok &= check(sim.configures == 1 && !sim.cs_faults && !sim.cs_active, "chip select");
+    printf("%-24s %5u transfers, %4u us back to back, last waited %u us\n", "queue", (unsigned)bus.stats.done,
+           (unsigned)total, (unsigned)bus.stats.wait_max_us);
+    return ok;
+}
+
+static bool test_devices(void) {
+    sim_reset();
+    rt_spi_dev_t a = { .cs = 1, .hz = 1000000 };
+    rt_spi_dev_t b = { .cs = 2, .hz = 20000000, .mode = 3 };
+    rt_spi_dev_t fast = { .cs = 3, .hz = 100000000 };
+    static const uint8_t cmd[2] = { 0x03, 0x00 };
+    static uint8_t data[16];
+    // A command and its data to a, two transfers to b, then a again.
+    rt_spi_xfer_t x[5] = {
+        { .dev = &a, .tx = cmd, .len = 2, .hold = true },
+        { .dev = &a, .rx = data, .len = 16 },
+        { .dev = &b, .tx = cmd, .len = 1 },
+        { .dev = &b, .tx = cmd, .len = 1 },
+        { .dev = &a, .tx = cmd, .len = 2 },
+    };
+    for (int i = 0; i < 5; ++i) {
+        rt_spi_submit(&bus, &x[i], 0);
+    }
+    run_idle();
+    bool ok = check(sim.configures == 3 && bus.stats.configures == 3, "set-ups for a change of device");
+    ok &= check(sim.selects == 4, "a held chip select was not carried over");
+    ok &= check(x[1].start_us == x[0].end_us, "held parts not back to back");
+
+    // A hold with nothing behind it keeps the chip select until another
+    // device needs the bus.
+    rt_spi_xfer_t held = { .dev = &a, .tx = cmd, .len = 2, .hold = true };
+    rt_spi_submit(&bus, &held, now_us);
+    run_idle();
+    ok &= check(sim.cs_active == 1u << 1, "held chip select released early");
+    rt_spi_submit(&bus, &x[2], now_us);
+    run_idle();
+    ok &= check(!sim.cs_active, "held chip select not released for another device");
+
+    b.hz = 25000000;
+    rt_spi_submit(&bus, &x[3], now_us);
+    rt_spi_submit(&bus, &x[4], now_us);
+    run_idle();
+    ok &= check(sim.configures == 6 && b.actual_hz == 25000000, "clock change not applied");
+    rt_spi_xfer_t f = { .dev = &fast, .len = 1 };
+    rt_spi_submit(&bus, &f, now_us);
+    run_idle();
+    ok &= check(fast.actual_hz == SIM_MAX_HZ && a.actual_hz == 1000000, "actual clock");
+    ok &= check(!sim.cs_faults, "two chip selects asserted, or a set-up under one");
+    printf("%-24s %u transfers, %u set-ups, %u selects, %u faults\n", "devices", (unsigned)sim.started,
+           (unsigned)sim.configures, (unsigned)sim.selects, (unsigned)sim.cs_faults);
+    return ok;
+}
+
+static bool test_errors(void) {
+    sim_reset();
+    rt_spi_dev_t dev = { .cs = 0, .hz = 4000000 };
+    static const uint8_t cmd[2] = { 0x9F, 0x00 };
+    static uint8_t rx[4];
+    rt_spi_xfer_t x[3] = {
+        { .dev = &dev, .tx = cmd, .len = 2, .hold = true },
+        { .dev = &dev, .rx = rx, .len = 4 },
+        { .dev = &dev, .tx = cmd, .rx = rx, .len = 2 },
+    };
+    sim.fail_next = true;
+    for (int i = 0; i < 3; ++i) {
+        rt_spi_submit(&bus, &x[i], 0);
+    }
+    run_idle();
+    bool ok = check(x[0].status == RT_SPI_ERROR && x[1].status == RT_SPI_OK && x[2].status == RT_SPI_OK, "status");
+    ok &= check(bus.stats.errors == 1 && bus.stats.done == 3, "error count");
+    ok &= check(sim.selects == 3, "a failed transfer kept its chip select");
+    printf("%-24s overrun reported, chip select released, queue carried on\n", "errors");
+    return ok;
+}
+
+static const uint32_t rates[] = { 1000000, 10000000, 40000000, 75000000 };
+static const uint16_t sizes[] = { 16, 256, 4096 };
+#define ROWS (sizeof(rates) / sizeof(rates[0]) * sizeof(sizes) / sizeof(sizes[0]))
+#define MAX_LEN 4096
+#define BYTES_PER_ROW 16384
+
+static uint8_t bench_buf[4 * MAX_LEN];
+static rt_spi_bench_row_t rows[ROWS];
+static int rows_reported;
+
+static void row_done(rt_spi_bench_t *b, uint16_t row) {
+    (void)b;
+    if (row == rows_reported) {
+        rows_reported++;
+    }
+}
+
+static void print_row(const rt_spi_bench_row_t *r) {
+    uint32_t kbps = rt_spi_bench_kbps(r), eff = rt_spi_bench_efficiency(r);
+    printf("%-24s %6u kHz %5u B x%-5u %3u.%03u MB/s %3u.%u%% errors=%u\n", "", (unsigned)(r->hz / 1000),
+           (unsigned)r->len, (unsigned)r->xfers, (unsigned)(kbps / 1000), (unsigned)(kbps % 1000),
+           (unsigned)(eff / 10), (unsigned)(eff % 10), (unsigned)r->bit_errors);
+}
+
+static bool run_sweep(rt_spi_bench_t *b, uint32_t error_hz, uint32_t error_every) {
+    sim_reset();
+    sim.error_hz = error_hz;
+    sim.error_every = error_every;
+    rows_reported = 0;
+    *b = (rt_spi_bench_t){
+        .bus = &bus,
+        .dev = { .cs = 1 },
+        .rates = rates,
+        .rate_count = sizeof(rates) / sizeof(rates[0]),
+        .sizes = sizes,
+        .size_count = sizeof(sizes) / sizeof(sizes[0]),
+        .max_len = MAX_LEN,
+        .bytes_per_row = BYTES_PER_ROW,
+        .buf = bench_buf,
+        .rows = rows,
+        .row_done = row_done,
+    };
+    if (!check(rt_spi_bench_start(b, 0), "sweep refused")) {
+        return false;
+    }
+    bool ok = check(!rt_spi_bench_start(b, 0), "a second sweep started");
+    run_idle();
+    ok &= check(!b->running && b->rows_done == ROWS && rows_reported == (int)ROWS, "sweep did not finish");
+    return ok;
+}
+
+static bool test_bench(void) {
+    static rt_spi_bench_t b;
+    bool ok = run_sweep(&b, 0, 0);
+    uint64_t busy = 0;
+    for (unsigned i = 0; i < ROWS; ++i) {
+        const rt_spi_bench_row_t *r = &rows[i];
+        uint32_t hz = rates[i / 3] < SIM_MAX_HZ ? rates[i / 3] : SIM_MAX_HZ;
+        ok &= check(r->hz == hz && r->len == sizes[i % 3], "row clock or size");
+        ok &= check(r->xfers == BYTES_PER_ROW / r->len && r->bytes == BYTES_PER_ROW, "row transfers");
+        ok &= check(r->us == r->xfers * rt_spi_sim_duration_us(&sim, hz, r->len), "bus idle within a row");
+        ok &= check(!r->bit_errors && !r->failed, "errors on a clean wire");
+        busy += r->us;
+    }
+    ok &= check(sim.busy_us == busy && !sim.cs_faults, "bus time");
+    printf("%-24s %u rows, clean wire:\n", "sweep", (unsigned)ROWS);
+    for (unsigned i = 0; i < ROWS; i += 3) {
+        print_row(&rows[i]);
+        print_row(&rows[i + 2]);
+    }
+
+    // One bit in 10^5 flipped above 20 MHz.
+    ok &= run_sweep(&b, 20000000, 100000);
+    uint64_t errors = 0;
+    for (unsigned i = 0; i < ROWS; ++i) {
+        errors += rows[i].bit_errors;
+        if (rows[i].hz <= 20000000) {
+            ok &= check(!rows[i].bit_errors, "errors below the noisy clock");
+        }
+    }
+    ok &= check(errors == sim.flipped && errors > 0, "bit errors miscounted");
+    printf("%-24s %u of %u bits flipped above 20 MHz, %u counted\n", "sweep, noisy wire", (unsigned)sim.flipped,
+           (unsigned)sim.bits, (unsigned)errors);
+    return ok;
+}
+
+int main(void) {
+    printf("loopback bus up to %u MHz, %u us per transfer set-up\n", SIM_MAX_HZ / 1000000, SIM_OVERHEAD_US);
+    bool ok = true;
+    ok &= test_queue();
+    ok &= test_devices();
+    ok &= test_errors();
+    ok &= test_bench();
+    printf("%s\n", ok ? "ok" : "FAIL");
+    return ok ? 0 : 1;
+}
@@ -0,0 +1,125 @@
+#pragma once
+
+#include <stdbool.h>
+#include <stdint.h>
+
+// Continuous ADC acquisition: the bookkeeping behind a free-running ADC whose
+// FIFO a DMA channel copies into a ring of samples.
+//
+// The ADC converts the channels of a round-robin mask in turn, in ascending
+// order from the one selected when it starts, so the stream is interleaved;
+// rt_adc_acq_feed() splits it by position and runs each channel's sample
+// through streaming statistics (min, max, mean, RMS and standard deviation,
+// accumulated until taken) and a CIC decimation filter. The ring reader
+// (rt_adc_ring_t) hands over what the DMA engine has written since the last
+// drain, across the wrap, and notices when it has fallen a whole ring behind.
+//
+// Everything is integer and incremental: a sample costs a few additions.
+// Filter outputs and summaries are in 1/16 LSB (4095 reads 65520), since
+// averaging adds resolution. Nothing here touches the hardware.
+
+#define RT_ADC_CHANNELS 9       // RP2350B: 8 inputs and the temperature sensor
+#define RT_ADC_ERR 0x8000u      // sample flag: conversion error (the FIFO's ERR bit)
+#define RT_ADC_MASK 0x0FFFu
+#define RT_CIC_MAX_ORDER 4
+
+// Running statistics of raw 12-bit samples.
+typedef struct {
+    uint32_t n;
+    uint16_t min, max;
+    uint64_t sum, sum_sq;
+} rt_adc_stats_t;
+
+typedef struct {
+    uint32_t n;
+    uint16_t min, max, mean, rms, sd; // 1/16 LSB; all 0 if n is 0
+} rt_adc_summary_t;
+
+void rt_adc_stats_reset(rt_adc_stats_t *st);
+
+static inline void rt_adc_stats_add(rt_adc_stats_t *st, uint16_t x) {
+    st->n++;
+    st->min = x < st->min ? x : st->min;
+    st->max = x > st->max ? x : st->max;
+    st->sum += x;
+    st->sum_sq += (uint32_t)x * x;
+}
+
+void rt_adc_stats_summary(const rt_adc_stats_t *st, rt_adc_summary_t *out);
+
+// Cascaded integrator-comb decimator: order integrators at the input rate,
+// order combs at 1/ratio of it, gain ratio^order divided out. Responds to DC
+// exactly and nulls every multiple of the output rate, which is what would
+// alias onto DC. Integrators wrap, which is harmless: the output fits.
+typedef struct {
+    uint8_t order;
+    uint16_t ratio;
+    uint32_t gain;
+    uint16_t phase;
+    uint32_t integ[RT_CIC_MAX_ORDER];
+    uint32_t comb[RT_CIC_MAX_ORDER]; // the previous input of each comb
+} rt_cic_t;
+
+// False if order is not 1..RT_CIC_MAX_ORDER or ratio^order * 4095 does not
+// fit 32 bits (ratio 64 at order 3 does).
+bool rt_cic_init(rt_cic_t *cic, uint8_t order, uint16_t ratio);
+
+void rt_cic_reset(rt_cic_t *cic);
+
+// Takes a 12-bit sample; every ratio-th call stores an output in *out and
+// returns true. The first order outputs after a reset are still settling.
+bool rt_cic_push(rt_cic_t *cic, uint16_t x, uint16_t *out);
+
+typedef struct rt_adc_acq rt_adc_acq_t;
+
+typedef struct {
+    rt_adc_stats_t stats; // since the last rt_adc_acq_take()
+    rt_cic_t cic;
+    volatile uint16_t out; // latest filter output
+    uint32_t outputs;
+} rt_adc_chan_t;
+
+struct rt_adc_acq {
+    uint8_t seq[RT_ADC_CHANNELS]; // channel of each position in the round robin
+    uint8_t seq_len;
+    uint8_t phase; // position of the next sample
+    rt_adc_chan_t ch[RT_ADC_CHANNELS];
+    uint32_t samples, errors; // errors are counted, not fed
+    // Optional: each filter output, from rt_adc_acq_feed().
+    void (*decimated)(rt_adc_acq_t *acq, uint8_t channel, uint16_t value);
+    void *user;
+};
+
+// mask: the round-robin channels; first: the one converted first. False if
+// first is not in mask or the filter parameters are refused.
+bool rt_adc_acq_init(rt_adc_acq_t *acq, uint16_t mask, uint8_t first, uint8_t cic_order, uint16_t cic_ratio);
+
+// After the stream restarts at the first channel; filters start over.
+void rt_adc_acq_restart(rt_adc_acq_t *acq);
+
+void rt_adc_acq_feed(rt_adc_acq_t *acq, const volatile uint16_t *samples, uint32_t n);
+
+// A channel's summary since the last take; its statistics restart.
+void rt_adc_acq_take(rt_adc_acq_t *acq, uint8_t channel, rt_adc_summary_t *out);
+
+// Reader of a DMA ring of size samples (a power of two) written at rate_hz.
+typedef struct {
+    const volatile uint16_t *buf;
+    uint32_t size;
+    uint32_t rate_hz;
+    uint32_t read;    // next sample to read
+    uint64_t last_us; // of the last drain or restart
+    uint32_t overruns;
+} rt_adc_ring_t;
+
+void rt_adc_ring_init(rt_adc_ring_t *ring, const volatile uint16_t *buf, uint32_t size, uint32_t rate_hz,
+                      uint64_t now_us);
+
+// Feeds acq what was written up to write_idx (the writer's next index). If
+// long enough has passed since the last drain that the writer may have come
+// round again (three quarters of the ring, to allow for clock slop), feeds
+// nothing, counts an overrun and returns false: the caller restarts the
+// stream, then calls rt_adc_ring_restart() and rt_adc_acq_restart().
+bool rt_adc_ring_drain(rt_adc_ring_t *ring, uint32_t write_idx, uint64_t now_us, rt_adc_acq_t *acq);
+
+void rt_adc_ring_restart(rt_adc_ring_t *ring, uint64_t now_us);
@@ -0,0 +1,77 @@
+#pragma once
+
+#include <stdbool.h>
+#include <stdint.h>
+
+#include "rt/ring.h"
+#include "rt/sched.h"
+
+// Message bus between cores.
+//
+// A channel is an rt_ring_t with one sending context and a receiving core.
+// Sending never blocks or locks; when the receiver may have stopped reading
+// (see rt/ring.h), the bus rings that core's doorbell through the port. The
+// receiving core's doorbell handler calls rt_bus_doorbell(), which posts each
+// channel's task for it if messages are waiting, or calls its notify hook
+// (from the handler, for work that cannot wait for a task); a channel with
+// neither is polled by its reader, which the doorbell merely wakes. Sending to
+// a channel of the sender's own core skips the doorbell.
+//
+// The port maps doorbells onto the hardware: the SIO FIFO on the RP2350, a
+// condition variable on the host (rt/sched_host.h). Doorbells may coalesce;
+// one handler run serves everything sent before it started.
+
+#define RT_BUS_CORES 2
+#define RT_BUS_CHANNELS 8 // per receiving core
+
+typedef struct rt_bus rt_bus_t;
+typedef struct rt_chan rt_chan_t;
+
+typedef struct {
+    void *ctx;
+    uint8_t (*core)(void *ctx);             // the calling core
+    void (*ring)(void *ctx, uint8_t core); // raise core's doorbell
+} rt_bell_port_t;
+
+struct rt_chan {
+    const char *name;
+    rt_ring_t ring;
+    uint8_t core; // receiving core
+    rt_task_t *task;
+    uint32_t event;
+    void (*notify)(rt_chan_t *chan);
+    void *user;
+
+    // Sender's statistics.
+    rt_bus_t *bus;
+    uint32_t sent;
+    uint32_t full;  // sends refused
+    uint32_t bells; // doorbells rung
+};
+
+struct rt_bus {
+    rt_bell_port_t port;
+    rt_chan_t *chans[RT_BUS_CORES][RT_BUS_CHANNELS];
+    uint8_t chan_count[RT_BUS_CORES];
+};
+
+void rt_bus_init(rt_bus_t *bus, rt_bell_port_t port);
+
+// A channel of cap messages of msg_size bytes in buf (cap a power of two) to
+// core. Set name, and task and event or notify, before rt_bus_add().
+void rt_chan_init(rt_chan_t *chan, void *buf, uint16_t msg_size, uint32_t cap, uint8_t core);
+
+// Before either core uses the channel. False if the core has RT_BUS_CHANNELS.
+bool rt_bus_add(rt_bus_t *bus, rt_chan_t *chan);
+
+// Sender: copies msg in; false (counted in full) if the channel is full.
+bool rt_chan_send(rt_chan_t *chan, const void *msg);
+
+// Receiver: the oldest message; false if there is none.
+static inline bool rt_chan_recv(rt_chan_t *chan, void *msg) {
+    return rt_ring_pop(&chan->ring, msg);
+}
+
+// The doorbell handler of core: hands the channels with messages to their
+// readers.
+void rt_bus_doorbell(rt_bus_t *bus, uint8_t core);
@@ -0,0 +1,85 @@
+#pragma once
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+// Asynchronous I2C master.
+//
+// Transactions are queued and run one at a time by a port: the controller's
+// interrupt handler on the target (see the bare-metal demo), or the simulated
+// bus in rt/i2c_sim.h on the host. A transaction writes tx, then reads rx
+// after a repeated start (either part may be empty), and ends in its
+// completion callback with a status. One still on the bus after its timeout
+// is aborted by rt_i2c_poll(). Like gfx_pacer_t the engine holds no clock:
+// the caller passes the time.
+//
+// The engine takes no locks. rt_i2c_submit(), rt_i2c_poll() and the port's
+// rt_i2c_port_done() must not preempt each other: call them from interrupts
+// of one priority, or mask the port's interrupt around the first two.
+// Callbacks run inside whichever call finished the transaction and may
+// submit more.
+
+#define RT_I2C_PENDING 1 // queued or on the bus
+#define RT_I2C_OK 0
+#define RT_I2C_NACK (-1)    // nobody acknowledged the address (or a byte)
+#define RT_I2C_TIMEOUT (-2) // aborted by rt_i2c_poll()
+#define RT_I2C_ERROR (-3)   // lost arbitration or another bus fault
+
+typedef struct rt_i2c_xfer rt_i2c_xfer_t;
+
+struct rt_i2c_xfer {
+    uint8_t addr; // 7-bit
+    uint16_t tx_len, rx_len;
+    const uint8_t *tx;
+    uint8_t *rx;
+    uint32_t timeout_us; // from the moment it goes on the bus
+    void (*done)(rt_i2c_xfer_t *x);
+    void *user;
+
+    // Engine state.
+    volatile int8_t status;
+    uint64_t submit_us, start_us;
+    rt_i2c_xfer_t *next;
+};
+
+typedef struct {
+    void *ctx;
+    // Puts x on the bus (x->start_us is already set). The port reports the
+    // end later with rt_i2c_port_done(), never from inside start().
+    void (*start)(void *ctx, const rt_i2c_xfer_t *x);
+    // Abandons the transfer on the bus; no rt_i2c_port_done() follows.
+    void (*abort)(void *ctx);
+} rt_i2c_port_t;
+
+typedef struct {
+    uint32_t done; // every completion, whatever its status
+    uint32_t nacks, timeouts, errors;
+    uint16_t queue_max;   // deepest queue, the transfer on the bus included
+    uint32_t wait_max_us; // submit to start on the bus
+} rt_i2c_stats_t;
+
+typedef struct {
+    rt_i2c_port_t port;
+    rt_i2c_xfer_t *head, *tail; // head is on the bus
+    uint16_t queued;
+    rt_i2c_stats_t stats;
+} rt_i2c_t;
+
+void rt_i2c_init(rt_i2c_t *bus, rt_i2c_port_t port);
+
+// Queues x (zero-initialised, or finished); it starts at once if the bus is
+// idle. Returns false, leaving x alone, if it is still pending from an
+// earlier submit.
+bool rt_i2c_submit(rt_i2c_t *bus, rt_i2c_xfer_t *x, uint64_t now_us);
+
+// Aborts the transfer on the bus if it has outlived its timeout.
+void rt_i2c_poll(rt_i2c_t *bus, uint64_t now_us);
+
+// Port side: the transfer on the bus ended with status (RT_I2C_OK, _NACK or
+// _ERROR); its rx bytes are in place. Starts the next one.
+void rt_i2c_port_done(rt_i2c_t *bus, int status, uint64_t now_us);
+
+static inline bool rt_i2c_idle(const rt_i2c_t *bus) {
+    return bus->head == NULL;
+}
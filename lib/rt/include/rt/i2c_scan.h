@@ -0,0 +1,53 @@
+#pragma once
+
+#include <stdbool.h>
+#include <stdint.h>
+
+#include "rt/i2c.h"
+
+// Incremental I2C bus scanner on top of rt/i2c.h.
+//
+// Each rt_i2c_scan_tick() queues one-byte reads to the next few addresses of
+// 0x08-0x77 (fewer if the previous batch is still running) and returns; the
+// results update a table of the addresses that answered, and every change
+// (including each device found on the first pass) is reported through the
+// changed callback, from the context that completed the probe. A probe that
+// times out leaves the address as it was: a wedged bus says nothing about
+// who is on it. The table can be read from any context.
+
+#define RT_I2C_SCAN_FIRST 0x08
+#define RT_I2C_SCAN_LAST 0x77
+#define RT_I2C_SCAN_BATCH 8 // most probes per tick
+
+typedef struct rt_i2c_scan rt_i2c_scan_t;
+
+struct rt_i2c_scan {
+    rt_i2c_t *bus;
+    uint8_t per_tick;
+    uint32_t timeout_us; // per probe
+    void (*changed)(rt_i2c_scan_t *scan, uint8_t addr, bool present);
+    void *user;
+
+    uint8_t next;     // address of the next probe
+    uint8_t inflight; // probes of the current batch not yet finished
+    rt_i2c_xfer_t probes[RT_I2C_SCAN_BATCH];
+    uint8_t rx[RT_I2C_SCAN_BATCH];
+    volatile uint32_t present[4]; // bit addr % 32 of word addr / 32
+    volatile uint32_t sweeps;     // completed passes over the range
+    bool sweeping;                // a pass has been started
+    uint64_t sweep_start_us;
+    volatile uint32_t sweep_us; // duration of the last pass
+};
+
+void rt_i2c_scan_init(rt_i2c_scan_t *scan, rt_i2c_t *bus, uint8_t per_tick, uint32_t timeout_us,
+                      void (*changed)(rt_i2c_scan_t *scan, uint8_t addr, bool present), void *user);
+
+void rt_i2c_scan_tick(rt_i2c_scan_t *scan, uint64_t now_us);
+
+static inline bool rt_i2c_scan_present(const rt_i2c_scan_t *scan, uint8_t addr) {
+    return (scan->present[addr >> 5] >> (addr & 31)) & 1u;
+}
+
+// Devices in the table, and the lowest address among them in *first (left
+// alone if there are none).
+int rt_i2c_scan_count(const rt_i2c_scan_t *scan, uint8_t *first);
@@ -0,0 +1,44 @@
+#pragma once
+
+#include <stdbool.h>
+#include <stdint.h>
+
+#include "rt/i2c.h"
+
+// Simulated I2C bus for host tests, as a port for rt/i2c.h.
+//
+// Devices are addresses that acknowledge every byte and read back
+// addr + n for the n-th byte. A transfer takes its bit count at the bus
+// clock: start and address, then 9 bits per byte with a repeated start and
+// address again before the read, and a stop; an address nobody answers
+// ends after the address byte. A stuck address never finishes, as if the
+// device held SCL low, until the engine aborts it. Time passes only through
+// rt_i2c_sim_advance().
+
+typedef struct {
+    rt_i2c_t *bus;
+    uint32_t hz;
+    uint32_t present[4]; // bit addr % 32 of word addr / 32, like rt_i2c_scan_t
+    uint32_t stuck[4];
+
+    const rt_i2c_xfer_t *cur;
+    uint64_t end_us; // when cur finishes (UINT64_MAX if stuck)
+    int8_t result;
+
+    // Traffic counters.
+    uint32_t started, aborted;
+    uint64_t busy_us; // time with a transfer on the bus
+} rt_i2c_sim_t;
+
+// Makes the simulator bus's port; bus must be initialised with it
+// (rt_i2c_init(bus, rt_i2c_sim_port(sim, bus))).
+rt_i2c_port_t rt_i2c_sim_port(rt_i2c_sim_t *sim, rt_i2c_t *bus, uint32_t hz);
+
+void rt_i2c_sim_set(rt_i2c_sim_t *sim, uint8_t addr, bool present, bool stuck);
+
+// Runs the bus up to now_us, completing whatever finishes by then (the
+// engine starts each next transfer when the previous one ends).
+void rt_i2c_sim_advance(rt_i2c_sim_t *sim, uint64_t now_us);
+
+// Time a transfer of tx_len and rx_len bytes takes, acknowledged or not.
+uint32_t rt_i2c_sim_duration_us(const rt_i2c_sim_t *sim, uint16_t tx_len, uint16_t rx_len, bool acked);
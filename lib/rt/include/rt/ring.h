@@ -0,0 +1,39 @@
+#pragma once
+
+#include <stdatomic.h>
+#include <stdbool.h>
+#include <stdint.h>
+
+// Lock-free single-producer, single-consumer ring of fixed-size messages.
+//
+// One context pushes and one pops; they may be on different cores. Only
+// loads, stores and fences are used (no read-modify-write atomics), so it
+// builds the same for the Cortex-M33, for Hazard3 without the A extension
+// and for the host.
+//
+// The producer learns when the consumer may have stopped looking:
+// rt_ring_push() sets *wake if the consumer had taken everything before this
+// message. A consumer that pops until rt_ring_pop() fails and then sleeps
+// until woken never misses a message, provided the producer wakes it
+// whenever *wake is set; messages pushed while it is still draining cost no
+// wakeup.
+
+typedef struct {
+    uint8_t *buf;
+    uint16_t msg_size;
+    uint32_t cap; // power of two
+    atomic_uint_least32_t head; // next to push; written by the producer
+    atomic_uint_least32_t tail; // next to pop; written by the consumer
+} rt_ring_t;
+
+// buf holds cap messages of msg_size bytes; cap is a power of two.
+void rt_ring_init(rt_ring_t *r, void *buf, uint16_t msg_size, uint32_t cap);
+
+// Producer: copies msg in; false if the ring is full. wake may be NULL.
+bool rt_ring_push(rt_ring_t *r, const void *msg, bool *wake);
+
+// Consumer: copies the oldest message out; false if there is none.
+bool rt_ring_pop(rt_ring_t *r, void *msg);
+
+// Either side: messages waiting (a snapshot).
+uint32_t rt_ring_count(rt_ring_t *r);
@@ -0,0 +1,149 @@
+#pragma once
+
+#include <stdbool.h>
+#include <stdint.h>
+
+// Cooperative run-to-completion scheduler.
+//
+// A task is a function that runs when events have been posted to it and
+// returns; it gets the event bits posted since its last run (posting the same
+// bit twice before it runs delivers it once). Ready tasks run highest
+// priority first (0 is the highest), in posting order within a priority, and
+// a task is never preempted by another: a long one delays everything behind
+// it, so work is cut into short steps. Interrupt handlers post events or push
+// to an rt_queue_t and leave the work to a task.
+//
+// Timers post events to a task at a deadline, once or periodically. They sit
+// in a timer wheel of RT_WHEEL_SLOTS buckets of RT_WHEEL_TICK_US; deadlines
+// are exact, the buckets only bound the search. A periodic timer stays on its
+// grid: a late run does not move the next deadline, and periods missed
+// altogether are skipped. The scheduler is tickless: with nothing ready it
+// asks the port to idle until the earliest deadline, and wakes early when an
+// interrupt posts.
+//
+// The port supplies the clock, the idle wait and the lock that serialises
+// posting from interrupts (rt/sched_sim.h has a virtual-clock port for host
+// tests). Each scheduler runs on one core; other cores post to it.
+
+#define RT_SCHED_PRIOS 4
+#define RT_WHEEL_SLOTS 64 // power of two
+#define RT_WHEEL_TICK_US 1000
+
+typedef struct rt_sched rt_sched_t;
+typedef struct rt_task rt_task_t;
+typedef struct rt_timer rt_timer_t;
+
+typedef struct {
+    void *ctx;
+    uint64_t (*now)(void *ctx);
+    // Waits until deadline_us (UINT64_MAX: no deadline) or until something is
+    // posted, whichever comes first; returning early is harmless.
+    void (*idle)(void *ctx, uint64_t deadline_us);
+    uint32_t (*lock)(void *ctx);
+    void (*unlock)(void *ctx, uint32_t state);
+    // Optional: makes a scheduler idling on another core look again.
+    void (*wake)(void *ctx);
+} rt_sched_port_t;
+
+typedef struct {
+    uint32_t runs;
+    uint32_t latency_max_us; // first event posted to the run starting
+    uint32_t run_max_us;
+    uint64_t run_sum_us;
+} rt_task_stats_t;
+
+struct rt_task {
+    const char *name;
+    uint8_t prio;
+    void (*run)(rt_task_t *task, uint32_t events);
+    void *user;
+
+    // Scheduler state.
+    rt_sched_t *sched;
+    volatile uint32_t events; // posted, not yet delivered
+    bool ready;
+    uint64_t ready_us;
+    rt_task_t *next;     // in the ready list
+    rt_task_t *next_all; // every task of the scheduler
+    rt_task_stats_t stats;
+};
+
+struct rt_timer {
+    rt_task_t *task;
+    uint32_t events;
+
+    // Timer state.
+    uint64_t deadline_us;
+    uint32_t period_us; // 0: one-shot
+    bool armed;
+    rt_timer_t *next;
+};
+
+typedef struct {
+    uint32_t idles;             // waits in port.idle()
+    uint32_t timer_late_max_us; // deadline to expiry
+} rt_sched_stats_t;
+
+struct rt_sched {
+    rt_sched_port_t port;
+    rt_task_t *ready_head[RT_SCHED_PRIOS], *ready_tail[RT_SCHED_PRIOS];
+    rt_timer_t *wheel[RT_WHEEL_SLOTS];
+    uint64_t wheel_tick; // buckets before this tick have been expired
+    rt_task_t *tasks;
+    rt_task_t *current;
+    rt_sched_stats_t stats;
+};
+
+void rt_sched_init(rt_sched_t *s, rt_sched_port_t port);
+
+static inline uint64_t rt_sched_now(const rt_sched_t *s) {
+    return s->port.now(s->port.ctx);
+}
+
+// Attaches a task whose name, prio, run and user are filled in.
+void rt_sched_add(rt_sched_t *s, rt_task_t *task);
+
+// Sets event bits on the task and makes it ready. Safe from interrupts and
+// from other cores.
+void rt_task_post(rt_task_t *task, uint32_t events);
+
+// A timer posting events to task; it starts disarmed.
+void rt_timer_init(rt_timer_t *tm, rt_task_t *task, uint32_t events);
+
+// Arms (or re-arms) the timer for deadline_us, then every period_us if that
+// is not 0. A deadline already past expires at once.
+void rt_timer_start(rt_timer_t *tm, uint64_t deadline_us, uint32_t period_us);
+
+void rt_timer_stop(rt_timer_t *tm);
+
+// Expires due timers and runs the highest priority ready task, if any;
+// returns whether one ran.
+bool rt_sched_run_once(rt_sched_t *s);
+
+// Runs ready tasks until none is left, then idles until the next deadline or
+// until end_us, whichever is first. Returns at end_us (UINT64_MAX: never).
+void rt_sched_run_until(rt_sched_t *s, uint64_t end_us);
+
+// Copies the statistics to out and restarts them; rt_sched_t.tasks lists
+// the tasks. Safe wherever posting is.
+void rt_task_take_stats(rt_task_t *task, rt_task_stats_t *out);
+void rt_sched_take_stats(rt_sched_t *s, rt_sched_stats_t *out);
+
+// Event queue: a ring of 32-bit messages, pushed from interrupts or other
+// tasks and popped by one task, which each push posts event to.
+typedef struct {
+    uint32_t *buf;
+    uint16_t cap; // power of two
+    volatile uint16_t head, tail;
+    rt_task_t *task;
+    uint32_t event;
+    uint32_t dropped;   // pushes refused because the ring was full
+    uint16_t depth_max; // deepest it has been
+} rt_queue_t;
+
+void rt_queue_init(rt_queue_t *q, uint32_t *buf, uint16_t cap, rt_task_t *task, uint32_t event);
+
+// Returns false (and counts a drop) if the ring is full.
+bool rt_queue_push(rt_queue_t *q, uint32_t msg);
+
+bool rt_queue_pop(rt_queue_t *q, uint32_t *msg);
@@ -0,0 +1,38 @@
+#pragma once
+
+#include <pthread.h>
+#include <stdatomic.h>
+#include <stdbool.h>
+#include <stdint.h>
+
+#include "rt/bus.h"
+#include "rt/sched.h"
+
+// Host threads as cores, for stress tests of rt/sched.h and rt/bus.h with
+// real concurrency.
+//
+// Each rt_host_core_t is a port for one scheduler, run by one thread that
+// calls rt_host_core_enter() first. The clock is CLOCK_MONOTONIC, the lock a
+// mutex, and idle() waits on a condition variable that wake() and the
+// doorbell signal. A doorbell is taken when its core next idles, as an
+// interrupt between tasks would be: rt_bus_doorbell() runs on that core's
+// thread.
+
+typedef struct {
+    pthread_mutex_t mutex;
+    pthread_cond_t cond;
+    bool kicked;
+    atomic_bool bell;
+    rt_bus_t *bus;
+    uint8_t id;
+} rt_host_core_t;
+
+rt_sched_port_t rt_host_core_port(rt_host_core_t *hc, rt_bus_t *bus, uint8_t id);
+
+// Marks the calling thread as running hc.
+void rt_host_core_enter(rt_host_core_t *hc);
+
+// Doorbells for a bus whose cores are cores[0..RT_BUS_CORES-1].
+rt_bell_port_t rt_host_bell_port(rt_host_core_t **cores);
+
+uint64_t rt_host_now_us(void);
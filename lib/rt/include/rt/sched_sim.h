@@ -0,0 +1,41 @@
+#pragma once
+
+#include <stdbool.h>
+#include <stdint.h>
+
+#include "rt/sched.h"
+
+// Virtual clock for host tests, as a port for rt/sched.h.
+//
+// Time moves only when the scheduler idles (straight to the deadline, or to
+// the next simulated interrupt if that comes first) or when a task calls
+// rt_vclock_spend() to stand for the work it does. Simulated interrupts are
+// one-shot handlers at a given time; they run when the clock passes it, even
+// in the middle of a task's rt_vclock_spend(), as a real interrupt would
+// preempt it, and may schedule themselves again. The lock does nothing: there
+// is one thread.
+
+#define RT_VCLOCK_IRQS 16
+
+typedef struct rt_vclock rt_vclock_t;
+
+typedef struct {
+    uint64_t at_us;
+    void (*fn)(rt_vclock_t *vc, void *user);
+    void *user;
+} rt_virq_t;
+
+struct rt_vclock {
+    uint64_t now_us;
+    rt_virq_t irqs[RT_VCLOCK_IRQS];
+    int irq_count;
+    uint64_t idle_us; // spent in idle()
+};
+
+rt_sched_port_t rt_vclock_port(rt_vclock_t *vc, uint64_t start_us);
+
+// Schedules fn at at_us; false if RT_VCLOCK_IRQS are already pending.
+bool rt_vclock_irq_at(rt_vclock_t *vc, uint64_t at_us, void (*fn)(rt_vclock_t *vc, void *user), void *user);
+
+// Moves the clock on by us, running the interrupts due meanwhile.
+void rt_vclock_spend(rt_vclock_t *vc, uint32_t us);
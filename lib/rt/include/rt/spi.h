@@ -0,0 +1,101 @@
+#pragma once
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+// Queued SPI master.
+//
+// Transactions are queued and run one at a time, full duplex, by a port:
+// DMA on the target (see the bare-metal demo), or the loopback stand-in in
+// rt/spi_sim.h on the host. Each names a device, which carries its chip
+// select, clock and mode. Before a transaction the engine releases the chip
+// select of any other device, has the port set up the controller if the
+// device or its settings changed since the last transfer, and asserts the
+// device's chip select; after it the chip select is released again, unless
+// the transaction asks to hold it for a following one to the same device
+// (a command, then its data). A held chip select is released before another
+// device's transfer, so parts of one exchange are submitted back to back.
+//
+// The engine takes no locks and holds no clock. rt_spi_submit() and the
+// port's rt_spi_port_done() must not preempt each other: call them from
+// interrupts of one priority, or mask the port's interrupt around the
+// first. Callbacks run inside whichever call finished the transaction and
+// may submit more.
+
+#define RT_SPI_PENDING 1 // queued or on the bus
+#define RT_SPI_OK 0
+#define RT_SPI_ERROR (-1) // the port saw a fault (a receive overrun)
+
+#define RT_SPI_FILL 0xFF // sent by transactions without tx
+
+typedef struct rt_spi_xfer rt_spi_xfer_t;
+
+typedef struct {
+    uint32_t cs;        // chip select, in the port's terms (a GPIO on the demo)
+    uint32_t hz;        // requested clock
+    uint8_t mode;       // CPOL << 1 | CPHA
+    uint32_t actual_hz; // what the port made of hz, once configured
+} rt_spi_dev_t;
+
+struct rt_spi_xfer {
+    rt_spi_dev_t *dev;
+    const uint8_t *tx; // NULL: RT_SPI_FILL is sent
+    uint8_t *rx;       // NULL: what comes back is dropped
+    uint16_t len;      // not 0
+    bool hold;         // keep the chip select asserted afterwards
+    void (*done)(rt_spi_xfer_t *x);
+    void *user;
+
+    // Engine state.
+    volatile int8_t status;
+    uint64_t submit_us, start_us, end_us;
+    rt_spi_xfer_t *next;
+};
+
+typedef struct {
+    void *ctx;
+    // Sets the controller up for dev's clock and mode and returns the clock
+    // it got. Only called with every chip select released.
+    uint32_t (*configure)(void *ctx, const rt_spi_dev_t *dev);
+    void (*select)(void *ctx, const rt_spi_dev_t *dev, bool active);
+    // Clocks x->len bytes out of x->tx and into x->rx. The port reports the
+    // end later with rt_spi_port_done(), never from inside start().
+    void (*start)(void *ctx, const rt_spi_xfer_t *x);
+} rt_spi_port_t;
+
+typedef struct {
+    uint32_t done; // every completion, whatever its status
+    uint32_t errors;
+    uint32_t configures; // controller set-ups for a change of device or clock
+    uint64_t bytes;
+    uint64_t busy_us;     // start to end, summed over transfers
+    uint16_t queue_max;   // deepest queue, the transfer on the bus included
+    uint32_t wait_max_us; // submit to start on the bus
+} rt_spi_stats_t;
+
+typedef struct {
+    rt_spi_port_t port;
+    rt_spi_xfer_t *head, *tail; // head is on the bus
+    uint16_t queued;
+    const rt_spi_dev_t *configured; // controller set for it, at these:
+    uint32_t configured_hz;
+    uint8_t configured_mode;
+    const rt_spi_dev_t *selected; // chip select asserted (NULL: none)
+    rt_spi_stats_t stats;
+} rt_spi_t;
+
+void rt_spi_init(rt_spi_t *bus, rt_spi_port_t port);
+
+// Queues x (zero-initialised, or finished); it starts at once if the bus is
+// idle. Returns false, leaving x alone, if it is still pending from an
+// earlier submit.
+bool rt_spi_submit(rt_spi_t *bus, rt_spi_xfer_t *x, uint64_t now_us);
+
+// Port side: the transfer on the bus ended with status (RT_SPI_OK or
+// _ERROR); its rx bytes are in place. Starts the next one.
+void rt_spi_port_done(rt_spi_t *bus, int status, uint64_t now_us);
+
+static inline bool rt_spi_idle(const rt_spi_t *bus) {
+    return bus->head == NULL;
+}
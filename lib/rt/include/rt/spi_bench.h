@@ -0,0 +1,67 @@
+#pragma once
+
+#include <stdbool.h>
+#include <stdint.h>
+
+#include "rt/spi.h"
+
+// Loopback throughput and integrity sweep on top of rt/spi.h (MOSI wired to
+// MISO).
+//
+// For every clock in rates and every transfer size in sizes (rates outer),
+// the sweep sends about bytes_per_row bytes of pseudo-random data through
+// dev and compares what comes back, bit by bit. Two transfers are kept
+// queued so the bus never waits for the check. Each row of results ends up
+// in rows[] and is announced through row_done, from the context that
+// completed its last transfer; the sweep is over when rows_done reaches
+// rate_count * size_count and running drops.
+//
+// Fill in the fields up to user (buf holds 4 * max_len bytes: tx and rx of
+// two transfers) and call rt_spi_bench_start(). The bench changes dev.hz as
+// it goes; dev is not to be shared with other transfers meanwhile.
+
+typedef struct {
+    uint32_t hz;  // clock the port gave
+    uint16_t len; // bytes per transfer
+    uint32_t xfers;
+    uint32_t bytes;
+    uint32_t bit_errors;
+    uint32_t failed; // transfers the port ended with an error, not compared
+    uint32_t us;     // first transfer starting to the last one ending
+} rt_spi_bench_row_t;
+
+typedef struct rt_spi_bench rt_spi_bench_t;
+
+struct rt_spi_bench {
+    rt_spi_t *bus;
+    rt_spi_dev_t dev;
+    const uint32_t *rates;
+    uint8_t rate_count;
+    const uint16_t *sizes;
+    uint8_t size_count;
+    uint16_t max_len;
+    uint32_t bytes_per_row;
+    uint8_t *buf;
+    rt_spi_bench_row_t *rows; // rate_count * size_count
+    void (*row_done)(rt_spi_bench_t *b, uint16_t row);
+    void *user;
+
+    // Sweep state.
+    rt_spi_xfer_t x[2];
+    uint32_t seed;
+    uint16_t row;
+    uint32_t row_xfers; // transfers in the current row
+    uint32_t submitted, completed;
+    uint64_t row_start_us;
+    volatile uint16_t rows_done;
+    volatile bool running;
+};
+
+// Starts a sweep; returns false if one is running or a size is not in
+// 1..max_len.
+bool rt_spi_bench_start(rt_spi_bench_t *b, uint64_t now_us);
+
+// Throughput of a row in kB/s (1000 bytes), and as a share of the raw bit
+// rate in tenths of a percent.
+uint32_t rt_spi_bench_kbps(const rt_spi_bench_row_t *r);
+uint32_t rt_spi_bench_efficiency(const rt_spi_bench_row_t *r);
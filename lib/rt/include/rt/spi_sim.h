@@ -0,0 +1,47 @@
+#pragma once
+
+#include <stdbool.h>
+#include <stdint.h>
+
+#include "rt/spi.h"
+
+// Loopback SPI bus for host tests, as a port for rt/spi.h: MOSI is wired to
+// MISO, so each transfer reads back what it sent. Clocks are capped at
+// max_hz. A transfer takes overhead_us (the port's set-up and the FIFO
+// draining) plus its bits at the clock. Above error_hz the wire flips one
+// received bit in every error_every, counted in flipped, so an integrity
+// check can be held to an exact figure. Chip selects are tracked as a mask
+// of cs bits; a transfer that starts without exactly its own device selected,
+// or a set-up with any selected, counts as a cs_fault. Time passes only
+// through rt_spi_sim_advance().
+
+typedef struct {
+    rt_spi_t *bus;
+    uint32_t max_hz;
+    uint32_t overhead_us;
+    uint32_t error_hz, error_every; // error_every 0: a clean wire
+    bool fail_next;                 // the next transfer ends with RT_SPI_ERROR
+
+    uint32_t hz; // as configured
+    uint32_t cs_active;
+    const rt_spi_xfer_t *cur;
+    uint64_t end_us; // when cur finishes
+    int8_t result;
+    uint32_t since_flip; // bits received since the last flipped one
+
+    // Traffic counters.
+    uint32_t started, configures, selects, cs_faults;
+    uint64_t bits, flipped;
+    uint64_t busy_us; // time with a transfer on the bus
+} rt_spi_sim_t;
+
+// Makes the simulator bus's port; bus must be initialised with it
+// (rt_spi_init(bus, rt_spi_sim_port(sim, bus, max_hz, overhead_us))).
+rt_spi_port_t rt_spi_sim_port(rt_spi_sim_t *sim, rt_spi_t *bus, uint32_t max_hz, uint32_t overhead_us);
+
+// Runs the bus up to now_us, completing whatever finishes by then (the
+// engine starts each next transfer when the previous one ends).
+void rt_spi_sim_advance(rt_spi_sim_t *sim, uint64_t now_us);
+
+// Time a transfer of len bytes takes at hz (as configured).
+uint32_t rt_spi_sim_duration_us(const rt_spi_sim_t *sim, uint32_t hz, uint16_t len);
@@ -0,0 +1,165 @@
+#include "rt/adc.h"
+
+#include <stddef.h>
+
+void rt_adc_stats_reset(rt_adc_stats_t *st) {
+    *st = (rt_adc_stats_t){ .min = UINT16_MAX };
+}
+
+static uint32_t isqrt64(uint64_t x) {
+    uint64_t r = 0;
+    uint64_t bit = 1ull << 62;
+    while (bit > x) {
+        bit >>= 2;
+    }
+    while (bit) {
+        if (x >= r + bit) {
+            x -= r + bit;
+            r = (r >> 1) + bit;
+        } else {
+            r >>= 1;
+        }
+        bit >>= 2;
+    }
+    return (uint32_t)r;
+}
+
+// Mean square and variance in 1/256 LSB^2, then roots in 1/16 LSB. Doubles
+// keep the variance from cancelling away; this runs once per report.
+void rt_adc_stats_summary(const rt_adc_stats_t *st, rt_adc_summary_t *out) {
+    *out = (rt_adc_summary_t){ .n = st->n };
+    if (!st->n) {
+        return;
+    }
+    double mean = (double)st->sum / st->n;
+    double ms = (double)st->sum_sq / st->n;
+    double var = ms - mean * mean;
+    out->min = (uint16_t)(st->min * 16u);
+    out->max = (uint16_t)(st->max * 16u);
+    out->mean = (uint16_t)(mean * 16.0 + 0.5);
+    out->rms = (uint16_t)isqrt64((uint64_t)(ms * 256.0 + 0.5));
+    out->sd = var > 0.0 ? (uint16_t)isqrt64((uint64_t)(var * 256.0 + 0.5)) : 0;
+}
+
+bool rt_cic_init(rt_cic_t *cic, uint8_t order, uint16_t ratio) {
+    if (order < 1 || order > RT_CIC_MAX_ORDER || ratio < 1) {
+        return false;
+    }
+    uint64_t gain = 1;
+    for (uint8_t i = 0; i < order; ++i) {
+        gain *= ratio;
+        if (gain * RT_ADC_MASK > UINT32_MAX) {
+            return false;
+        }
+    }
+    *cic = (rt_cic_t){ .order = order, .ratio = ratio, .gain = (uint32_t)gain };
+    return true;
+}
+
+void rt_cic_reset(rt_cic_t *cic) {
+    *cic = (rt_cic_t){ .order = cic->order, .ratio = cic->ratio, .gain = cic->gain };
+}
+
+bool rt_cic_push(rt_cic_t *cic, uint16_t x, uint16_t *out) {
+    uint32_t v = x;
+    for (uint8_t i = 0; i < cic->order; ++i) {
+        cic->integ[i] += v;
+        v = cic->integ[i];
+    }
+    if (++cic->phase < cic->ratio) {
+        return false;
+    }
+    cic->phase = 0;
+    for (uint8_t i = 0; i < cic->order; ++i) {
+        uint32_t d = v - cic->comb[i];
+        cic->comb[i] = v;
+        v = d;
+    }
+    *out = (uint16_t)(((uint64_t)v * 16u + cic->gain / 2) / cic->gain);
+    return true;
+}
+
+bool rt_adc_acq_init(rt_adc_acq_t *acq, uint16_t mask, uint8_t first, uint8_t cic_order, uint16_t cic_ratio) {
+    *acq = (rt_adc_acq_t){ 0 };
+    if (first >= RT_ADC_CHANNELS || !(mask & (1u << first))) {
+        return false;
+    }
+    for (uint8_t i = 0; i < RT_ADC_CHANNELS; ++i) {
+        uint8_t ch = (uint8_t)((first + i) % RT_ADC_CHANNELS);
+        if (mask & (1u << ch)) {
+            acq->seq[acq->seq_len++] = ch;
+        }
+    }
+    for (uint8_t ch = 0; ch < RT_ADC_CHANNELS; ++ch) {
+        rt_adc_stats_reset(&acq->ch[ch].stats);
+        if (!rt_cic_init(&acq->ch[ch].cic, cic_order, cic_ratio)) {
+            return false;
+        }
+    }
+    return true;
+}
+
+void rt_adc_acq_restart(rt_adc_acq_t *acq) {
+    acq->phase = 0;
+    for (uint8_t ch = 0; ch < RT_ADC_CHANNELS; ++ch) {
+        rt_cic_reset(&acq->ch[ch].cic);
+    }
+}
+
+void rt_adc_acq_feed(rt_adc_acq_t *acq, const volatile uint16_t *samples, uint32_t n) {
+    for (uint32_t i = 0; i < n; ++i) {
+        uint16_t s = samples[i];
+        uint8_t channel = acq->seq[acq->phase];
+        if (++acq->phase == acq->seq_len) {
+            acq->phase = 0;
+        }
+        acq->samples++;
+        if (s & RT_ADC_ERR) {
+            acq->errors++;
+            continue;
+        }
+        rt_adc_chan_t *ch = &acq->ch[channel];
+        uint16_t x = s & RT_ADC_MASK;
+        rt_adc_stats_add(&ch->stats, x);
+        uint16_t out;
+        if (rt_cic_push(&ch->cic, x, &out)) {
+            ch->out = out;
+            ch->outputs++;
+            if (acq->decimated) {
+                acq->decimated(acq, channel, out);
+            }
+        }
+    }
+}
+
+void rt_adc_acq_take(rt_adc_acq_t *acq, uint8_t channel, rt_adc_summary_t *out) {
+    rt_adc_stats_summary(&acq->ch[channel].stats, out);
+    rt_adc_stats_reset(&acq->ch[channel].stats);
+}
+
+void rt_adc_ring_init(rt_adc_ring_t *ring, const volatile uint16_t *buf, uint32_t size, uint32_t rate_hz,
+                      uint64_t now_us) {
+    *ring = (rt_adc_ring_t){ .buf = buf, .size = size, .rate_hz = rate_hz, .last_us = now_us };
+}
+
+void rt_adc_ring_restart(rt_adc_ring_t *ring, uint64_t now_us) {
+    ring->read = 0;
+    ring->last_us = now_us;
+}
+
+bool rt_adc_ring_drain(rt_adc_ring_t *ring, uint32_t write_idx, uint64_t now_us, rt_adc_acq_t *acq) {
+    uint64_t written = (now_us - ring->last_us) * ring->rate_hz;
+    if (written >= (uint64_t)(ring->size - ring->size / 4) * 1000000u) {
+        ring->overruns++;
+        return false;
+    }
+    ring->last_us = now_us;
+    write_idx &= ring->size - 1;
+    if (write_idx < ring->read) {
+        rt_adc_acq_feed(acq, ring->buf + ring->read, ring->size - ring->read);
+        ring->read = 0;
+    }
+    rt_adc_acq_feed(acq, ring->buf + ring->read, write_idx - ring->read);
+    ring->read = write_idx;
+    return true;
+}
@@ -0,0 +1,58 @@
+#include "rt/bus.h"
+
+#include <stddef.h>
+
+void rt_bus_init(rt_bus_t *bus, rt_bell_port_t port) {
+    *bus = (rt_bus_t){ .port = port };
+}
+
+void rt_chan_init(rt_chan_t *chan, void *buf, uint16_t msg_size, uint32_t cap, uint8_t core) {
+    *chan = (rt_chan_t){ .core = core };
+    rt_ring_init(&chan->ring, buf, msg_size, cap);
+}
+
+bool rt_bus_add(rt_bus_t *bus, rt_chan_t *chan) {
+    if (chan->core >= RT_BUS_CORES || bus->chan_count[chan->core] == RT_BUS_CHANNELS) {
+        return false;
+    }
+    chan->bus = bus;
+    bus->chans[chan->core][bus->chan_count[chan->core]++] = chan;
+    return true;
+}
+
+static void chan_deliver(rt_chan_t *chan) {
+    if (chan->notify) {
+        chan->notify(chan);
+    } else if (chan->task) {
+        rt_task_post(chan->task, chan->event);
+    }
+}
+
+bool rt_chan_send(rt_chan_t *chan, const void *msg) {
+    bool wake = false;
+    if (!rt_ring_push(&chan->ring, msg, &wake)) {
+        chan->full++;
+        return false;
+    }
+    chan->sent++;
+    if (wake) {
+        rt_bell_port_t *port = &chan->bus->port;
+        if (port->core(port->ctx) == chan->core) {
+            chan_deliver(chan);
+        } else {
+            chan->bells++;
+            port->ring(port->ctx, chan->core);
+        }
+    }
+    return true;
+}
+
+void rt_bus_doorbell(rt_bus_t *bus, uint8_t core) {
+    atomic_thread_fence(memory_order_acquire); // after taking the doorbell
+    for (uint8_t i = 0; i < bus->chan_count[core]; ++i) {
+        rt_chan_t *chan = bus->chans[core][i];
+        if (rt_ring_count(&chan->ring)) {
+            chan_deliver(chan);
+        }
+    }
+}
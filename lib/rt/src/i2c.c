@@ -0,0 +1,77 @@
+#include "rt/i2c.h"
+
+void rt_i2c_init(rt_i2c_t *bus, rt_i2c_port_t port) {
+    *bus = (rt_i2c_t){ .port = port };
+}
+
+static void i2c_start_head(rt_i2c_t *bus, uint64_t now_us) {
+    rt_i2c_xfer_t *x = bus->head;
+    x->start_us = now_us;
+    uint32_t wait_us = (uint32_t)(now_us - x->submit_us);
+    if (wait_us > bus->stats.wait_max_us) {
+        bus->stats.wait_max_us = wait_us;
+    }
+    bus->port.start(bus->port.ctx, x);
+}
+
+bool rt_i2c_submit(rt_i2c_t *bus, rt_i2c_xfer_t *x, uint64_t now_us) {
+    if (x->status == RT_I2C_PENDING) {
+        return false;
+    }
+    x->status = RT_I2C_PENDING;
+    x->submit_us = now_us;
+    x->next = NULL;
+    if (bus->tail) {
+        bus->tail->next = x;
+    } else {
+        bus->head = x;
+    }
+    bus->tail = x;
+    if (++bus->queued > bus->stats.queue_max) {
+        bus->stats.queue_max = bus->queued;
+    }
+    if (bus->head == x) {
+        i2c_start_head(bus, now_us);
+    }
+    return true;
+}
+
+// Retires the head with status and starts the next transfer before running
+// the callback, so a callback that submits more only extends the queue.
+static void i2c_finish(rt_i2c_t *bus, int status, uint64_t now_us) {
+    rt_i2c_xfer_t *x = bus->head;
+    bus->head = x->next;
+    if (!bus->head) {
+        bus->tail = NULL;
+    }
+    bus->queued--;
+    bus->stats.done++;
+    if (status == RT_I2C_NACK) {
+        bus->stats.nacks++;
+    } else if (status == RT_I2C_TIMEOUT) {
+        bus->stats.timeouts++;
+    } else if (status < 0) {
+        bus->stats.errors++;
+    }
+    if (bus->head) {
+        i2c_start_head(bus, now_us);
+    }
+    x->status = (int8_t)status;
+    if (x->done) {
+        x->done(x);
+    }
+}
+
+void rt_i2c_poll(rt_i2c_t *bus, uint64_t now_us) {
+    rt_i2c_xfer_t *x = bus->head;
+    if (x && x->timeout_us && now_us - x->start_us >= x->timeout_us) {
+        bus->port.abort(bus->port.ctx);
+        i2c_finish(bus, RT_I2C_TIMEOUT, now_us);
+    }
+}
+
+void rt_i2c_port_done(rt_i2c_t *bus, int status, uint64_t now_us) {
+    if (bus->head) {
+        i2c_finish(bus, status, now_us);
+    }
+}
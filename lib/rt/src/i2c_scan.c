@@ -0,0 +1,77 @@
+#include "rt/i2c_scan.h"
+
+static void scan_probe_done(rt_i2c_xfer_t *x) {
+    rt_i2c_scan_t *scan = x->user;
+    scan->inflight--;
+    if (x->status == RT_I2C_OK || x->status == RT_I2C_NACK) {
+        bool present = x->status == RT_I2C_OK;
+        uint32_t bit = 1u << (x->addr & 31);
+        volatile uint32_t *word = &scan->present[x->addr >> 5];
+        if (present != ((*word & bit) != 0)) {
+            *word ^= bit;
+            if (scan->changed) {
+                scan->changed(scan, x->addr, present);
+            }
+        }
+    }
+    if (x->addr == RT_I2C_SCAN_LAST) {
+        scan->sweeps++;
+    }
+}
+
+void rt_i2c_scan_init(rt_i2c_scan_t *scan, rt_i2c_t *bus, uint8_t per_tick, uint32_t timeout_us,
+                      void (*changed)(rt_i2c_scan_t *scan, uint8_t addr, bool present), void *user) {
+    *scan = (rt_i2c_scan_t){
+        .bus = bus,
+        .per_tick = per_tick < 1 ? 1 : per_tick > RT_I2C_SCAN_BATCH ? RT_I2C_SCAN_BATCH : per_tick,
+        .timeout_us = timeout_us,
+        .changed = changed,
+        .user = user,
+        .next = RT_I2C_SCAN_FIRST,
+    };
+    for (int i = 0; i < RT_I2C_SCAN_BATCH; ++i) {
+        scan->probes[i] = (rt_i2c_xfer_t){
+            .rx = &scan->rx[i],
+            .rx_len = 1,
+            .timeout_us = timeout_us,
+            .done = scan_probe_done,
+            .user = scan,
+        };
+    }
+}
+
+void rt_i2c_scan_tick(rt_i2c_scan_t *scan, uint64_t now_us) {
+    if (scan->inflight) {
+        return; // a slow bus only slows the scan down
+    }
+    for (int i = 0; i < scan->per_tick; ++i) {
+        if (scan->next == RT_I2C_SCAN_FIRST) {
+            if (scan->sweeping) {
+                scan->sweep_us = (uint32_t)(now_us - scan->sweep_start_us);
+            }
+            scan->sweeping = true;
+            scan->sweep_start_us = now_us;
+        }
+        rt_i2c_xfer_t *x = &scan->probes[i];
+        x->addr = scan->next;
+        scan->next = scan->next == RT_I2C_SCAN_LAST ? RT_I2C_SCAN_FIRST : scan->next + 1;
+        scan->inflight++;
+        rt_i2c_submit(scan->bus, x, now_us);
+        if (scan->next == RT_I2C_SCAN_FIRST) {
+            break; // a pass is timed from tick to tick
+        }
+    }
+}
+
+int rt_i2c_scan_count(const rt_i2c_scan_t *scan, uint8_t *first) {
+    int count = 0;
+    for (int addr = RT_I2C_SCAN_LAST; addr >= RT_I2C_SCAN_FIRST; --addr) {
+        if (rt_i2c_scan_present(scan, (uint8_t)addr)) {
+            count++;
+            if (first) {
+                *first = (uint8_t)addr;
+            }
+        }
+    }
+    return count;
+}
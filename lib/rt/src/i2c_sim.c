@@ -0,0 +1,61 @@
+#include "rt/i2c_sim.h"
+
+static bool sim_bit(const uint32_t *set, uint8_t addr) {
+    return (set[addr >> 5] >> (addr & 31)) & 1u;
+}
+
+uint32_t rt_i2c_sim_duration_us(const rt_i2c_sim_t *sim, uint16_t tx_len, uint16_t rx_len, bool acked) {
+    uint32_t bits = 1 + 9 + 1; // start, address + ack, stop
+    if (acked) {
+        bits += 9u * (tx_len + rx_len);
+        if (tx_len && rx_len) {
+            bits += 1 + 9; // repeated start and the address again
+        }
+    }
+    return (uint32_t)(((uint64_t)bits * 1000000u + sim->hz - 1) / sim->hz);
+}
+
+static void sim_start(void *ctx, const rt_i2c_xfer_t *x) {
+    rt_i2c_sim_t *sim = ctx;
+    sim->cur = x;
+    sim->started++;
+    if (sim_bit(sim->stuck, x->addr)) {
+        sim->end_us = UINT64_MAX;
+        return;
+    }
+    bool acked = sim_bit(sim->present, x->addr);
+    sim->result = acked ? RT_I2C_OK : RT_I2C_NACK;
+    sim->end_us = x->start_us + rt_i2c_sim_duration_us(sim, x->tx_len, x->rx_len, acked);
+}
+
+static void sim_abort(void *ctx) {
+    rt_i2c_sim_t *sim = ctx;
+    sim->cur = NULL;
+    sim->aborted++;
+}
+
+rt_i2c_port_t rt_i2c_sim_port(rt_i2c_sim_t *sim, rt_i2c_t *bus, uint32_t hz) {
+    *sim = (rt_i2c_sim_t){ .bus = bus, .hz = hz };
+    return (rt_i2c_port_t){ sim, sim_start, sim_abort };
+}
+
+void rt_i2c_sim_set(rt_i2c_sim_t *sim, uint8_t addr, bool present, bool stuck) {
+    uint32_t bit = 1u << (addr & 31);
+    sim->present[addr >> 5] = present ? sim->present[addr >> 5] | bit : sim->present[addr >> 5] & ~bit;
+    sim->stuck[addr >> 5] = stuck ? sim->stuck[addr >> 5] | bit : sim->stuck[addr >> 5] & ~bit;
+}
+
+void rt_i2c_sim_advance(rt_i2c_sim_t *sim, uint64_t now_us) {
+    while (sim->cur && sim->end_us <= now_us) {
+        const rt_i2c_xfer_t *x = sim->cur;
+        sim->busy_us += sim->end_us - x->start_us;
+        if (sim->result == RT_I2C_OK) {
+            for (uint16_t i = 0; i < x->rx_len; ++i) {
+                x->rx[i] = (uint8_t)(x->addr + i);
+            }
+        }
+        sim->cur = NULL;
+        // The next transfer starts when this one ends, not at now_us.
+        rt_i2c_port_done(sim->bus, sim->result, sim->end_us);
+    }
+}
@@ -0,0 +1,53 @@
+#include "rt/ring.h"
+
+#include <string.h>
+
+void rt_ring_init(rt_ring_t *r, void *buf, uint16_t msg_size, uint32_t cap) {
+    r->buf = buf;
+    r->msg_size = msg_size;
+    r->cap = cap;
+    atomic_init(&r->head, 0);
+    atomic_init(&r->tail, 0);
+}
+
+// The two fences make a store-then-load handshake: the producer publishes
+// head and then reads tail, the consumer publishes tail and then reads head,
+// so at least one of them sees the other's store. Either the producer sees
+// that the consumer has taken everything and wakes it, or the consumer sees
+// the new message before it stops.
+
+bool rt_ring_push(rt_ring_t *r, const void *msg, bool *wake) {
+    uint32_t head = atomic_load_explicit(&r->head, memory_order_relaxed);
+    uint32_t tail = atomic_load_explicit(&r->tail, memory_order_acquire);
+    if (head - tail == r->cap) {
+        return false;
+    }
+    memcpy(r->buf + (size_t)(head & (r->cap - 1)) * r->msg_size, msg, r->msg_size);
+    atomic_store_explicit(&r->head, head + 1, memory_order_release);
+    if (wake) {
+        atomic_thread_fence(memory_order_seq_cst);
+        *wake = atomic_load_explicit(&r->tail, memory_order_relaxed) == head;
+    }
+    return true;
+}
+
+bool rt_ring_pop(rt_ring_t *r, void *msg) {
+    uint32_t tail = atomic_load_explicit(&r->tail, memory_order_relaxed);
+    uint32_t head = atomic_load_explicit(&r->head, memory_order_acquire);
+    if (head == tail) {
+        atomic_thread_fence(memory_order_seq_cst);
+        head = atomic_load_explicit(&r->head, memory_order_acquire);
+        if (head == tail) {
+            return false;
+        }
+    }
+    memcpy(msg, r->buf + (size_t)(tail & (r->cap - 1)) * r->msg_size, r->msg_size);
+    atomic_store_explicit(&r->tail, tail + 1, memory_order_release);
+    return true;
+}
+
+uint32_t rt_ring_count(rt_ring_t *r) {
+    uint32_t tail = atomic_load_explicit(&r->tail, memory_order_acquire);
+    uint32_t head = atomic_load_explicit(&r->head, memory_order_acquire);
+    return head - tail;
+}
@@ -0,0 +1,306 @@
+#include "rt/sched.h"
+
+#include <stddef.h>
+
+#define WHEEL_MASK (RT_WHEEL_SLOTS - 1)
+
+static inline uint64_t wheel_tick_of(uint64_t us) {
+    return us / RT_WHEEL_TICK_US;
+}
+
+void rt_sched_init(rt_sched_t *s, rt_sched_port_t port) {
+    *s = (rt_sched_t){ .port = port };
+    s->wheel_tick = wheel_tick_of(rt_sched_now(s));
+}
+
+void rt_sched_add(rt_sched_t *s, rt_task_t *task) {
+    task->sched = s;
+    task->events = 0;
+    task->ready = false;
+    task->next = NULL;
+    task->stats = (rt_task_stats_t){ 0 };
+    if (task->prio >= RT_SCHED_PRIOS) {
+        task->prio = RT_SCHED_PRIOS - 1;
+    }
+    uint32_t state = s->port.lock(s->port.ctx);
+    task->next_all = s->tasks;
+    s->tasks = task;
+    s->port.unlock(s->port.ctx, state);
+}
+
+// Called with the lock held.
+static void sched_ready(rt_sched_t *s, rt_task_t *task, uint64_t now_us) {
+    if (task->ready) {
+        return;
+    }
+    task->ready = true;
+    task->ready_us = now_us;
+    task->next = NULL;
+    if (s->ready_tail[task->prio]) {
+        s->ready_tail[task->prio]->next = task;
+    } else {
+        s->ready_head[task->prio] = task;
+    }
+    s->ready_tail[task->prio] = task;
+}
+
+void rt_task_post(rt_task_t *task, uint32_t events) {
+    rt_sched_t *s = task->sched;
+    uint64_t now = rt_sched_now(s);
+    uint32_t state = s->port.lock(s->port.ctx);
+    task->events |= events;
+    sched_ready(s, task, now);
+    s->port.unlock(s->port.ctx, state);
+    if (s->port.wake) {
+        s->port.wake(s->port.ctx);
+    }
+}
+
+// --- Timer wheel ---
+// A timer sits in the bucket of its deadline's tick, or of wheel_tick if
+// that is already past, so every bucket from wheel_tick on holds the timers
+// due in it this turn of the wheel plus any due whole turns later.
+
+static void wheel_insert(rt_sched_t *s, rt_timer_t *tm) {
+    uint64_t tick = wheel_tick_of(tm->deadline_us);
+    if (tick < s->wheel_tick) {
+        tick = s->wheel_tick;
+    }
+    rt_timer_t **slot = &s->wheel[tick & WHEEL_MASK];
+    tm->next = *slot;
+    *slot = tm;
+}
+
+static void wheel_remove(rt_sched_t *s, rt_timer_t *tm) {
+    for (int i = 0; i < RT_WHEEL_SLOTS; ++i) {
+        for (rt_timer_t **p = &s->wheel[i]; *p; p = &(*p)->next) {
+            if (*p == tm) {
+                *p = tm->next;
+                return;
+            }
+        }
+    }
+}
+
+void rt_timer_init(rt_timer_t *tm, rt_task_t *task, uint32_t events) {
+    *tm = (rt_timer_t){ .task = task, .events = events };
+}
+
+void rt_timer_start(rt_timer_t *tm, uint64_t deadline_us, uint32_t period_us) {
+    rt_sched_t *s = tm->task->sched;
+    uint32_t state = s->port.lock(s->port.ctx);
+    if (tm->armed) {
+        wheel_remove(s, tm);
+    }
+    tm->deadline_us = deadline_us;
+    tm->period_us = period_us;
+    tm->armed = true;
+    wheel_insert(s, tm);
+    s->port.unlock(s->port.ctx, state);
+    if (s->port.wake) {
+        s->port.wake(s->port.ctx); // the deadline may be earlier than the one idled for
+    }
+}
+
+void rt_timer_stop(rt_timer_t *tm) {
+    rt_sched_t *s = tm->task->sched;
+    uint32_t state = s->port.lock(s->port.ctx);
+    if (tm->armed) {
+        wheel_remove(s, tm);
+        tm->armed = false;
+    }
+    s->port.unlock(s->port.ctx, state);
+}
+
+// Fires the timers due by now_us. Walks the buckets from wheel_tick to now,
+// at most one turn; timers a whole turn or more ahead go back where they were.
+static void wheel_expire(rt_sched_t *s, uint64_t now_us) {
+    uint64_t now_tick = wheel_tick_of(now_us);
+    uint64_t span = now_tick - s->wheel_tick + 1;
+    if (span > RT_WHEEL_SLOTS) {
+        span = RT_WHEEL_SLOTS;
+    }
+    // Reinsertions land at now_tick or later: advance first.
+    uint64_t first = s->wheel_tick;
+    s->wheel_tick = now_tick;
+    for (uint64_t i = 0; i < span; ++i) {
+        rt_timer_t **slot = &s->wheel[(first + i) & WHEEL_MASK];
+        rt_timer_t *list = *slot;
+        *slot = NULL;
+        while (list) {
+            rt_timer_t *tm = list;
+            list = tm->next;
+            if (tm->deadline_us > now_us) {
+                tm->next = *slot;
+                *slot = tm;
+                continue;
+            }
+            uint32_t late = (uint32_t)(now_us - tm->deadline_us);
+            if (late > s->stats.timer_late_max_us) {
+                s->stats.timer_late_max_us = late;
+            }
+            tm->task->events |= tm->events;
+            sched_ready(s, tm->task, tm->deadline_us);
+            if (tm->period_us) {
+                tm->deadline_us += tm->period_us;
+                if (tm->deadline_us <= now_us) {
+                    tm->deadline_us += (now_us - tm->deadline_us) / tm->period_us * tm->period_us + tm->period_us;
+                }
+                wheel_insert(s, tm);
+            } else {
+                tm->armed = false;
+            }
+        }
+    }
+}
+
+// Earliest deadline, or UINT64_MAX. Buckets are searched in wheel order
+// for a timer due within that bucket's tick; failing that every timer is a
+// turn or more away and the smallest deadline wins.
+static uint64_t wheel_next(const rt_sched_t *s) {
+    uint64_t best = UINT64_MAX;
+    for (int i = 0; i < RT_WHEEL_SLOTS; ++i) {
+        uint64_t tick = s->wheel_tick + (uint64_t)i;
+        uint64_t end = (tick + 1) * RT_WHEEL_TICK_US;
+        for (const rt_timer_t *tm = s->wheel[tick & WHEEL_MASK]; tm; tm = tm->next) {
+            if (tm->deadline_us < best) {
+                best = tm->deadline_us;
+            }
+        }
+        if (best < end) {
+            return best;
+        }
+    }
+    return best;
+}
+
+// --- Dispatch ---
+
+bool rt_sched_run_once(rt_sched_t *s) {
+    uint64_t now = rt_sched_now(s);
+    uint32_t state = s->port.lock(s->port.ctx);
+    wheel_expire(s, now);
+    rt_task_t *task = NULL;
+    for (int prio = 0; prio < RT_SCHED_PRIOS && !task; ++prio) {
+        task = s->ready_head[prio];
+        if (task) {
+            s->ready_head[prio] = task->next;
+            if (!task->next) {
+                s->ready_tail[prio] = NULL;
+            }
+        }
+    }
+    uint32_t events = 0;
+    if (task) {
+        events = task->events;
+        task->events = 0;
+        task->ready = false;
+    }
+    s->port.unlock(s->port.ctx, state);
+    if (!task) {
+        return false;
+    }
+
+    uint32_t latency = now > task->ready_us ? (uint32_t)(now - task->ready_us) : 0;
+    s->current = task;
+    task->run(task, events);
+    s->current = NULL;
+    uint32_t took = (uint32_t)(rt_sched_now(s) - now);
+
+    state = s->port.lock(s->port.ctx);
+    task->stats.runs++;
+    task->stats.run_sum_us += took;
+    if (took > task->stats.run_max_us) {
+        task->stats.run_max_us = took;
+    }
+    if (latency > task->stats.latency_max_us) {
+        task->stats.latency_max_us = latency;
+    }
+    s->port.unlock(s->port.ctx, state);
+    return true;
+}
+
+static bool sched_any_ready(const rt_sched_t *s) {
+    for (int prio = 0; prio < RT_SCHED_PRIOS; ++prio) {
+        if (s->ready_head[prio]) {
+            return true;
+        }
+    }
+    return false;
+}
+
+void rt_sched_run_until(rt_sched_t *s, uint64_t end_us) {
+    while (rt_sched_now(s) < end_us) {
+        if (rt_sched_run_once(s)) {
+            continue;
+        }
+        uint32_t state = s->port.lock(s->port.ctx);
+        bool ready = sched_any_ready(s);
+        uint64_t deadline = wheel_next(s);
+        s->port.unlock(s->port.ctx, state);
+        if (ready) {
+            continue; // posted since the check in rt_sched_run_once()
+        }
+        if (deadline > end_us) {
+            deadline = end_us;
+        }
+        if (deadline > rt_sched_now(s)) {
+            s->stats.idles++;
+            s->port.idle(s->port.ctx, deadline);
+        }
+    }
+}
+
+void rt_task_take_stats(rt_task_t *task, rt_task_stats_t *out) {
+    rt_sched_t *s = task->sched;
+    uint32_t state = s->port.lock(s->port.ctx);
+    *out = task->stats;
+    task->stats = (rt_task_stats_t){ 0 };
+    s->port.unlock(s->port.ctx, state);
+}
+
+void rt_sched_take_stats(rt_sched_t *s, rt_sched_stats_t *out) {
+    uint32_t state = s->port.lock(s->port.ctx);
+    *out = s->stats;
+    s->stats = (rt_sched_stats_t){ 0 };
+    s->port.unlock(s->port.ctx, state);
+}
+
+// --- Event queues ---
+
+void rt_queue_init(rt_queue_t *q, uint32_t *buf, uint16_t cap, rt_task_t *task, uint32_t event) {
+    *q = (rt_queue_t){ .buf = buf, .cap = cap, .task = task, .event = event };
+}
+
+bool rt_queue_push(rt_queue_t *q, uint32_t msg) {
+    rt_sched_t *s = q->task->sched;
+    uint32_t state = s->port.lock(s->port.ctx);
+    uint16_t depth = (uint16_t)(q->head - q->tail);
+    bool ok = depth < q->cap;
+    if (ok) {
+        q->buf[q->head & (q->cap - 1)] = msg;
+        q->head++;
+        if (depth + 1 > q->depth_max) {
+            q->depth_max = (uint16_t)(depth + 1);
+        }
+    } else {
+        q->dropped++;
+    }
+    s->port.unlock(s->port.ctx, state);
+    if (ok) {
+        rt_task_post(q->task, q->event);
+    }
+    return ok;
+}
+
+bool rt_queue_pop(rt_queue_t *q, uint32_t *msg) {
+    rt_sched_t *s = q->task->sched;
+    uint32_t state = s->port.lock(s->port.ctx);
+    bool ok = q->head != q->tail;
+    if (ok) {
+        *msg = q->buf[q->tail & (q->cap - 1)];
+        q->tail++;
+    }
+    s->port.unlock(s->port.ctx, state);
+    return ok;
+}
@@ -0,0 +1,97 @@
+#define _POSIX_C_SOURCE 200809L
+
+#include "rt/sched_host.h"
+
+#include <time.h>
+
+static _Thread_local rt_host_core_t *host_current;
+
+uint64_t rt_host_now_us(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint64_t)ts.tv_sec * 1000000u + (uint64_t)ts.tv_nsec / 1000u;
+}
+
+static uint64_t host_now(void *ctx) {
+    (void)ctx;
+    return rt_host_now_us();
+}
+
+static uint32_t host_lock(void *ctx) {
+    pthread_mutex_lock(&((rt_host_core_t *)ctx)->mutex);
+    return 0;
+}
+
+static void host_unlock(void *ctx, uint32_t state) {
+    (void)state;
+    pthread_mutex_unlock(&((rt_host_core_t *)ctx)->mutex);
+}
+
+static void host_wake(void *ctx) {
+    rt_host_core_t *hc = ctx;
+    pthread_mutex_lock(&hc->mutex);
+    hc->kicked = true;
+    pthread_cond_signal(&hc->cond);
+    pthread_mutex_unlock(&hc->mutex);
+}
+
+static void host_idle(void *ctx, uint64_t deadline_us) {
+    rt_host_core_t *hc = ctx;
+    pthread_mutex_lock(&hc->mutex);
+    while (!hc->kicked && !atomic_load(&hc->bell)) {
+        if (deadline_us == UINT64_MAX) {
+            pthread_cond_wait(&hc->cond, &hc->mutex);
+            continue;
+        }
+        if (rt_host_now_us() >= deadline_us) {
+            break;
+        }
+        struct timespec ts = { .tv_sec = (time_t)(deadline_us / 1000000u),
+                               .tv_nsec = (long)(deadline_us % 1000000u) * 1000 };
+        pthread_cond_timedwait(&hc->cond, &hc->mutex, &ts);
+    }
+    hc->kicked = false;
+    pthread_mutex_unlock(&hc->mutex);
+    if (atomic_exchange(&hc->bell, false) && hc->bus) {
+        rt_bus_doorbell(hc->bus, hc->id);
+    }
+}
+
+rt_sched_port_t rt_host_core_port(rt_host_core_t *hc, rt_bus_t *bus, uint8_t id) {
+    hc->kicked = false;
+    atomic_init(&hc->bell, false);
+    hc->bus = bus;
+    hc->id = id;
+    pthread_mutex_init(&hc->mutex, NULL);
+    // Deadlines are CLOCK_MONOTONIC, like the clock.
+    pthread_condattr_t attr;
+    pthread_condattr_init(&attr);
+    pthread_condattr_setclock(&attr, CLOCK_MONOTONIC);
+    pthread_cond_init(&hc->cond, &attr);
+    pthread_condattr_destroy(&attr);
+    return (rt_sched_port_t){ .ctx = hc,
+                              .now = host_now,
+                              .idle = host_idle,
+                              .lock = host_lock,
+                              .unlock = host_unlock,
+                              .wake = host_wake };
+}
+
+void rt_host_core_enter(rt_host_core_t *hc) {
+    host_current = hc;
+}
+
+static uint8_t host_bell_core(void *ctx) {
+    (void)ctx;
+    return host_current ? host_current->id : 0;
+}
+
+static void host_bell_ring(void *ctx, uint8_t core) {
+    rt_host_core_t *hc = ((rt_host_core_t **)ctx)[core];
+    atomic_store(&hc->bell, true);
+    host_wake(hc);
+}
+
+rt_bell_port_t rt_host_bell_port(rt_host_core_t **cores) {
+    return (rt_bell_port_t){ .ctx = cores, .core = host_bell_core, .ring = host_bell_ring };
+}
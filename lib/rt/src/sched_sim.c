@@ -0,0 +1,75 @@
+#include "rt/sched_sim.h"
+
+#include <stddef.h>
+
+static uint64_t vclock_now(void *ctx) {
+    return ((rt_vclock_t *)ctx)->now_us;
+}
+
+static uint32_t vclock_lock(void *ctx) {
+    (void)ctx;
+    return 0;
+}
+
+static void vclock_unlock(void *ctx, uint32_t state) {
+    (void)ctx;
+    (void)state;
+}
+
+// Index of the earliest pending interrupt, or -1.
+static int vclock_next_irq(const rt_vclock_t *vc) {
+    int best = -1;
+    for (int i = 0; i < vc->irq_count; ++i) {
+        if (best < 0 || vc->irqs[i].at_us < vc->irqs[best].at_us) {
+            best = i;
+        }
+    }
+    return best;
+}
+
+// Advances to end_us, stopping at each interrupt due by then to run it.
+// With stop_at_irq it returns after the first one instead.
+static void vclock_advance(rt_vclock_t *vc, uint64_t end_us, bool stop_at_irq) {
+    int i;
+    while ((i = vclock_next_irq(vc)) >= 0 && vc->irqs[i].at_us <= end_us) {
+        rt_virq_t irq = vc->irqs[i];
+        vc->irqs[i] = vc->irqs[--vc->irq_count];
+        if (irq.at_us > vc->now_us) {
+            vc->now_us = irq.at_us;
+        }
+        irq.fn(vc, irq.user);
+        if (stop_at_irq) {
+            return;
+        }
+    }
+    if (end_us > vc->now_us) {
+        vc->now_us = end_us;
+    }
+}
+
+static void vclock_idle(void *ctx, uint64_t deadline_us) {
+    rt_vclock_t *vc = ctx;
+    uint64_t from = vc->now_us;
+    if (deadline_us == UINT64_MAX && vclock_next_irq(vc) < 0) {
+        return; // nothing will ever happen
+    }
+    vclock_advance(vc, deadline_us, true);
+    vc->idle_us += vc->now_us - from;
+}
+
+rt_sched_port_t rt_vclock_port(rt_vclock_t *vc, uint64_t start_us) {
+    *vc = (rt_vclock_t){ .now_us = start_us };
+    return (rt_sched_port_t){ .ctx = vc, .now = vclock_now, .idle = vclock_idle, .lock = vclock_lock, .unlock = vclock_unlock };
+}
+
+bool rt_vclock_irq_at(rt_vclock_t *vc, uint64_t at_us, void (*fn)(rt_vclock_t *vc, void *user), void *user) {
+    if (vc->irq_count == RT_VCLOCK_IRQS) {
+        return false;
+    }
+    vc->irqs[vc->irq_count++] = (rt_virq_t){ at_us, fn, user };
+    return true;
+}
+
+void rt_vclock_spend(rt_vclock_t *vc, uint32_t us) {
+    vclock_advance(vc, vc->now_us + us, false);
+}
@@ -0,0 +1,92 @@
+#include "rt/spi.h"
+
+void rt_spi_init(rt_spi_t *bus, rt_spi_port_t port) {
+    *bus = (rt_spi_t){ .port = port };
+}
+
+static void spi_deselect(rt_spi_t *bus) {
+    if (bus->selected) {
+        bus->port.select(bus->port.ctx, bus->selected, false);
+        bus->selected = NULL;
+    }
+}
+
+static void spi_start_head(rt_spi_t *bus, uint64_t now_us) {
+    rt_spi_xfer_t *x = bus->head;
+    rt_spi_dev_t *dev = x->dev;
+    if (bus->selected != dev) {
+        spi_deselect(bus);
+    }
+    if (bus->configured != dev || bus->configured_hz != dev->hz || bus->configured_mode != dev->mode) {
+        spi_deselect(bus); // a held chip select does not see the clock change
+        dev->actual_hz = bus->port.configure(bus->port.ctx, dev);
+        bus->configured = dev;
+        bus->configured_hz = dev->hz;
+        bus->configured_mode = dev->mode;
+        bus->stats.configures++;
+    }
+    if (!bus->selected) {
+        bus->port.select(bus->port.ctx, dev, true);
+        bus->selected = dev;
+    }
+    x->start_us = now_us;
+    uint32_t wait_us = (uint32_t)(now_us - x->submit_us);
+    if (wait_us > bus->stats.wait_max_us) {
+        bus->stats.wait_max_us = wait_us;
+    }
+    bus->port.start(bus->port.ctx, x);
+}
+
+bool rt_spi_submit(rt_spi_t *bus, rt_spi_xfer_t *x, uint64_t now_us) {
+    if (x->status == RT_SPI_PENDING) {
+        return false;
+    }
+    x->status = RT_SPI_PENDING;
+    x->submit_us = now_us;
+    x->next = NULL;
+    if (bus->tail) {
+        bus->tail->next = x;
+    } else {
+        bus->head = x;
+    }
+    bus->tail = x;
+    if (++bus->queued > bus->stats.queue_max) {
+        bus->stats.queue_max = bus->queued;
+    }
+    if (bus->head == x) {
+        spi_start_head(bus, now_us);
+    }
+    return true;
+}
+
+// Retires the head with status and starts the next transfer before running
+// the callback, so a callback that submits more only extends the queue. A
+// failed transfer releases its chip select even if it asked to hold it.
+void rt_spi_port_done(rt_spi_t *bus, int status, uint64_t now_us) {
+    rt_spi_xfer_t *x = bus->head;
+    if (!x) {
+        return;
+    }
+    bus->head = x->next;
+    if (!bus->head) {
+        bus->tail = NULL;
+    }
+    bus->queued--;
+    bus->stats.done++;
+    bus->stats.bytes += x->len;
+    bus->stats.busy_us += now_us - x->start_us;
+    if (status < 0) {
+        bus->stats.errors++;
+    }
+    if (!x->hold || status < 0) {
+        spi_deselect(bus);
+    }
+    x->end_us = now_us;
+    if (bus->head) {
+        spi_start_head(bus, now_us);
+    }
+    x->status = (int8_t)status;
+    if (x->done) {
+        x->done(x);
+    }
+}
@@ -0,0 +1,117 @@
+#include "rt/spi_bench.h"
+
+// xorshift32: cheap, and no byte pattern repeats within a sweep.
+static void bench_fill(rt_spi_bench_t *b, uint8_t *buf, uint16_t len) {
+    uint32_t s = b->seed;
+    for (uint16_t i = 0; i < len; ++i) {
+        s ^= s << 13;
+        s ^= s >> 17;
+        s ^= s << 5;
+        buf[i] = (uint8_t)s;
+    }
+    b->seed = s;
+}
+
+static uint32_t bench_compare(const uint8_t *tx, const uint8_t *rx, uint16_t len) {
+    uint32_t errors = 0;
+    for (uint16_t i = 0; i < len; ++i) {
+        errors += (uint32_t)__builtin_popcount((unsigned)(tx[i] ^ rx[i]));
+    }
+    return errors;
+}
+
+static void bench_xfer_done(rt_spi_xfer_t *x);
+
+// Queues transfer i of the current row with fresh data.
+static void bench_submit(rt_spi_bench_t *b, int i, uint64_t now_us) {
+    rt_spi_xfer_t *x = &b->x[i];
+    bench_fill(b, b->buf + (size_t)(2 * i) * b->max_len, x->len);
+    b->submitted++;
+    rt_spi_submit(b->bus, x, now_us);
+}
+
+static void bench_row_start(rt_spi_bench_t *b, uint64_t now_us) {
+    uint16_t len = b->sizes[b->row % b->size_count];
+    b->dev.hz = b->rates[b->row / b->size_count];
+    b->row_xfers = b->bytes_per_row / len;
+    if (b->row_xfers == 0) {
+        b->row_xfers = 1;
+    }
+    b->submitted = b->completed = 0;
+    b->rows[b->row] = (rt_spi_bench_row_t){ .len = len };
+    for (int i = 0; i < 2; ++i) {
+        b->x[i] = (rt_spi_xfer_t){
+            .dev = &b->dev,
+            .tx = b->buf + (size_t)(2 * i) * b->max_len,
+            .rx = b->buf + (size_t)(2 * i + 1) * b->max_len,
+            .len = len,
+            .done = bench_xfer_done,
+            .user = b,
+        };
+    }
+    for (int i = 0; i < 2 && b->submitted < b->row_xfers; ++i) {
+        bench_submit(b, i, now_us);
+    }
+}
+
+static void bench_xfer_done(rt_spi_xfer_t *x) {
+    rt_spi_bench_t *b = x->user;
+    rt_spi_bench_row_t *r = &b->rows[b->row];
+    if (b->completed++ == 0) {
+        r->hz = b->dev.actual_hz;
+        b->row_start_us = x->start_us;
+    }
+    r->xfers++;
+    r->bytes += x->len;
+    if (x->status == RT_SPI_OK) {
+        r->bit_errors += bench_compare(x->tx, x->rx, x->len);
+    } else {
+        r->failed++;
+    }
+    if (b->submitted < b->row_xfers) {
+        bench_submit(b, (int)(x - b->x), x->end_us);
+        return;
+    }
+    if (b->completed < b->row_xfers) {
+        return;
+    }
+    r->us = (uint32_t)(x->end_us - b->row_start_us);
+    uint16_t row = b->row;
+    b->rows_done = (uint16_t)(row + 1);
+    bool last = row + 1 == b->rate_count * b->size_count;
+    if (!last) {
+        b->row++;
+        bench_row_start(b, x->end_us);
+    } else {
+        b->running = false;
+    }
+    if (b->row_done) {
+        b->row_done(b, row);
+    }
+}
+
+bool rt_spi_bench_start(rt_spi_bench_t *b, uint64_t now_us) {
+    if (b->running || !b->rate_count || !b->size_count) {
+        return false;
+    }
+    for (int i = 0; i < b->size_count; ++i) {
+        if (b->sizes[i] == 0 || b->sizes[i] > b->max_len) {
+            return false;
+        }
+    }
+    b->running = true;
+    b->rows_done = 0;
+    b->row = 0;
+    b->seed = 0x2545F491u;
+    bench_row_start(b, now_us);
+    return true;
+}
+
+uint32_t rt_spi_bench_kbps(const rt_spi_bench_row_t *r) {
+    return r->us ? (uint32_t)((uint64_t)r->bytes * 1000u / r->us) : 0;
+}
+
+uint32_t rt_spi_bench_efficiency(const rt_spi_bench_row_t *r) {
+    uint64_t raw_us = r->hz ? (uint64_t)r->bytes * 8u * 1000000u / r->hz : 0;
+    return r->us ? (uint32_t)(raw_us * 1000u / r->us) : 0;
+}
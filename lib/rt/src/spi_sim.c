@@ -0,0 +1,76 @@
+#include "rt/spi_sim.h"
+
+uint32_t rt_spi_sim_duration_us(const rt_spi_sim_t *sim, uint32_t hz, uint16_t len) {
+    return sim->overhead_us + (uint32_t)(((uint64_t)len * 8u * 1000000u + hz - 1) / hz);
+}
+
+static uint32_t sim_configure(void *ctx, const rt_spi_dev_t *dev) {
+    rt_spi_sim_t *sim = ctx;
+    sim->configures++;
+    if (sim->cs_active) {
+        sim->cs_faults++;
+    }
+    sim->hz = dev->hz < sim->max_hz ? dev->hz : sim->max_hz;
+    return sim->hz;
+}
+
+static void sim_select(void *ctx, const rt_spi_dev_t *dev, bool active) {
+    rt_spi_sim_t *sim = ctx;
+    uint32_t bit = 1u << (dev->cs & 31);
+    if (active) {
+        sim->selects++;
+        sim->cs_active |= bit;
+    } else {
+        sim->cs_active &= ~bit;
+    }
+}
+
+static void sim_start(void *ctx, const rt_spi_xfer_t *x) {
+    rt_spi_sim_t *sim = ctx;
+    sim->cur = x;
+    sim->started++;
+    if (sim->cs_active != 1u << (x->dev->cs & 31)) {
+        sim->cs_faults++;
+    }
+    sim->result = sim->fail_next ? RT_SPI_ERROR : RT_SPI_OK;
+    sim->fail_next = false;
+    sim->end_us = x->start_us + rt_spi_sim_duration_us(sim, sim->hz, x->len);
+}
+
+rt_spi_port_t rt_spi_sim_port(rt_spi_sim_t *sim, rt_spi_t *bus, uint32_t max_hz, uint32_t overhead_us) {
+    *sim = (rt_spi_sim_t){ .bus = bus, .max_hz = max_hz, .overhead_us = overhead_us };
+    return (rt_spi_port_t){ sim, sim_configure, sim_select, sim_start };
+}
+
+// Loops tx back into rx, flipping a bit every error_every bits when the
+// clock is above error_hz.
+static void sim_loop(rt_spi_sim_t *sim, const rt_spi_xfer_t *x) {
+    bool noisy = sim->error_every && sim->hz > sim->error_hz;
+    for (uint16_t i = 0; i < x->len; ++i) {
+        uint8_t b = x->tx ? x->tx[i] : RT_SPI_FILL;
+        if (noisy) {
+            for (int bit = 7; bit >= 0; --bit) {
+                if (++sim->since_flip == sim->error_every) {
+                    sim->since_flip = 0;
+                    b ^= (uint8_t)(1u << bit);
+                    sim->flipped++;
+                }
+            }
+        }
+        if (x->rx) {
+            x->rx[i] = b;
+        }
+    }
+    sim->bits += 8u * x->len;
+}
+
+void rt_spi_sim_advance(rt_spi_sim_t *sim, uint64_t now_us) {
+    while (sim->cur && sim->end_us <= now_us) {
+        const rt_spi_xfer_t *x = sim->cur;
+        sim->busy_us += sim->end_us - x->start_us;
+        sim_loop(sim, x);
+        sim->cur = NULL;
+        // The next transfer starts when this one ends, not at now_us.
+        rt_spi_port_done(sim->bus, sim->result, sim->end_us);
+    }
+}
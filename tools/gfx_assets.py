@@ -0,0 +1,837 @@
+#!/usr/bin/env python3
+"""Converts the image and font sources in lib/gfx/assets into C tables.
+
+Reads a manifest (lib/gfx/assets/assets.txt) with one asset per line:
+
+  <name> <source> [packed2|rle|auto] [timeline]
+  <name> <source.ttf> size=<px> [bpp=2|4] [chars=<first>-<last>]
+
+  .png / .gif  become a gfx_sheet_t `<name>_sheet` (see gfx/anim.h) with its
+               palette `<name>_palette`. Colours are reduced to RGB565 and,
+               if there are more than four, quantised (median cut) to four.
+               Indexed sources keep their palette order, so index 0 stays the
+               colour key; truecolour sources number colours in raster order.
+               GIF frames are composited, identical frames are stored once,
+               and `timeline` also emits `<name>_timeline` from the frame
+               delays. The format defaults to auto: whichever is smaller.
+  .bdf         becomes `<name>[count][width]` for glyphs up to 8 rows high,
+               column-major with bit 0 the top row (the layout of font5x7).
+  .ttf         becomes a gfx_font_t `<name>` (see gfx/text.h): characters
+               32-126 by default, rendered at `size` pixels per em with 8
+               samples per pixel row and measured exactly along each sample,
+               stored as 4-bit (default) or 2-bit coverage trimmed to the ink.
+               The outlines are not hinted. Kerning comes from the legacy
+               'kern' table; pairs that round to 0 pixels are dropped.
+
+Every table is const, so it stays in flash and is read in place through XIP.
+Identical palettes are emitted once. The per-asset flash cost is printed and
+kept in the generated source.
+
+Usage: tools/gfx_assets.py <manifest> <out.c> <out.h>
+Only the standard library is used (zlib for PNG, LZW decoded here for GIF,
+TrueType outlines rasterised here).
+"""
+
+import math
+import pathlib
+import struct
+import sys
+import zlib
+
+SHEET_COLOURS = 4
+SHEET_STRUCT_BYTES = 16  # gfx_sheet_t on a 32-bit target
+RLE_MAX_RUN = 64
+GLYPH_BYTES = 8  # gfx_glyph_t
+KERN_BYTES = 3  # gfx_kern_t
+FONT_STRUCT_BYTES = 20  # gfx_font_t on a 32-bit target
+
+
+class AssetError(Exception):
+    pass
+
+
+# --- Decoders ---
+
+
+def _png_unfilter(raw, width, height, bpp, row_bytes):
+    rows = []
+    prev = bytearray(row_bytes)
+    pos = 0
+    for _ in range(height):
+        ftype = raw[pos]
+        line = bytearray(raw[pos + 1:pos + 1 + row_bytes])
+        pos += 1 + row_bytes
+        for i in range(row_bytes):
+            a = line[i - bpp] if i >= bpp else 0
+            b = prev[i]
+            c = prev[i - bpp] if i >= bpp else 0
+            if ftype == 1:
+                line[i] = (line[i] + a) & 0xFF
+            elif ftype == 2:
+                line[i] = (line[i] + b) & 0xFF
+            elif ftype == 3:
+                line[i] = (line[i] + ((a + b) >> 1)) & 0xFF
+            elif ftype == 4:
+                p = a + b - c
+                pa, pb, pc = abs(p - a), abs(p - b), abs(p - c)
+                pred = a if pa <= pb and pa <= pc else (b if pb <= pc else c)
+                line[i] = (line[i] + pred) & 0xFF
+            elif ftype != 0:
+                raise AssetError(f"bad PNG filter {ftype}")
+        rows.append(line)
+        prev = line
+    return rows
+
+
+def load_png(path):
+    """Returns (width, height, [frame], palette or None, []) with a frame being
+    a list of palette indices (indexed PNG) or RGB tuples. Alpha is ignored."""
+    data = path.read_bytes()
+    if data[:8] != b"\x89PNG\r\n\x1a\n":
+        raise AssetError(f"{path}: not a PNG")
+    pos, idat, plte = 8, b"", None
+    while pos < len(data):
+        length, ctype = struct.unpack(">I4s", data[pos:pos + 8])
+        body = data[pos + 8:pos + 8 + length]
+        pos += 12 + length
+        if ctype == b"IHDR":
+            width, height, depth, colour, _, _, interlace = struct.unpack(">IIBBBBB", body)
+        elif ctype == b"PLTE":
+            plte = [tuple(body[i:i + 3]) for i in range(0, len(body), 3)]
+        elif ctype == b"IDAT":
+            idat += body
+        elif ctype == b"IEND":
+            break
+    if interlace:
+        raise AssetError(f"{path}: interlaced PNGs are not supported")
+    channels = {0: 1, 2: 3, 3: 1, 4: 2, 6: 4}[colour]
+    if depth != 8 and colour not in (0, 3):
+        raise AssetError(f"{path}: only 8-bit truecolour PNGs are supported")
+    row_bytes = (width * channels * depth + 7) // 8
+    rows = _png_unfilter(zlib.decompress(idat), width, height, max(1, channels * depth // 8), row_bytes)
+    pixels = []
+    for line in rows:
+        for x in range(width):
+            if depth < 8:
+                bit = x * depth
+                v = (line[bit // 8] >> (8 - depth - bit % 8)) & ((1 << depth) - 1)
+            else:
+                v = line[x * channels] if channels < 3 else tuple(line[x * channels:x * channels + 3])
+            if colour == 0:
+                v = (v * 255 // ((1 << depth) - 1),) * 3
+            elif colour == 4:
+                v = (v,) * 3
+            pixels.append(v)
+    return width, height, [pixels], plte if colour == 3 else None, []
+
+
+def _lzw_decode(data, min_size):
+    clear, end = 1 << min_size, (1 << min_size) + 1
+    out = bytearray()
+    table, size, prev = None, min_size + 1, None
+    bits, nbits = 0, 0
+    for byte in data:
+        bits |= byte << nbits
+        nbits += 8
+        while nbits >= size:
+            code = bits & ((1 << size) - 1)
+            bits >>= size
+            nbits -= size
+            if code == clear:
+                table = [bytes([i]) for i in range(clear)] + [b"", b""]
+                size, prev = min_size + 1, None
+                continue
+            if code == end:
+                return out
+            if prev is None:
+                entry = table[code]
+            elif code < len(table):
+                entry = table[code]
+                table.append(prev + entry[:1])
+            else:
+                entry = prev + prev[:1]
+                table.append(entry)
+            out += entry
+            prev = entry
+            if len(table) == (1 << size) and size < 12:
+                size += 1
+    return out
+
+
+def load_gif(path):
+    """Returns (width, height, frames, palette, delays_ms), compositing each
+    frame onto the canvas and honouring transparency and disposal 2."""
+    data = path.read_bytes()
+    if data[:3] != b"GIF":
+        raise AssetError(f"{path}: not a GIF")
+    width, height, flags, bg = struct.unpack("<HHBB", data[6:12])
+    pos = 13
+    palette = None
+    if flags & 0x80:
+        n = 2 << (flags & 7)
+        palette = [tuple(data[pos + 3 * i:pos + 3 * i + 3]) for i in range(n)]
+        pos += 3 * n
+    canvas = [bg] * (width * height)
+    frames, delays = [], []
+    delay, transparent, disposal = 0, None, 0
+    while pos < len(data):
+        block = data[pos]
+        if block == 0x3B:
+            break
+        if block == 0x21:
+            label = data[pos + 1]
+            pos += 2
+            if label == 0xF9:
+                gflags, delay, tidx = struct.unpack("<BHB", data[pos + 1:pos + 5])
+                transparent = tidx if gflags & 1 else None
+                disposal = (gflags >> 2) & 7
+            while data[pos]:
+                pos += data[pos] + 1
+            pos += 1
+            continue
+        if block != 0x2C:
+            raise AssetError(f"{path}: unexpected block 0x{block:02x}")
+        fx, fy, fw, fh, iflags = struct.unpack("<HHHHB", data[pos + 1:pos + 10])
+        pos += 10
+        if iflags & 0x80:
+            raise AssetError(f"{path}: local colour tables are not supported")
+        if iflags & 0x40:
+            raise AssetError(f"{path}: interlaced GIFs are not supported")
+        min_size = data[pos]
+        pos += 1
+        lzw = bytearray()
+        while data[pos]:
+            lzw += data[pos + 1:pos + 1 + data[pos]]
+            pos += data[pos] + 1
+        pos += 1
+        indices = _lzw_decode(lzw, min_size)
+        before = list(canvas)
+        for y in range(fh):
+            for x in range(fw):
+                v = indices[y * fw + x]
+                if v != transparent and fx + x < width and fy + y < height:
+                    canvas[(fy + y) * width + fx + x] = v
+        frames.append(list(canvas))
+        delays.append(delay * 10)
+        if disposal == 2:
+            for y in range(fy, min(fy + fh, height)):
+                for x in range(fx, min(fx + fw, width)):
+                    canvas[y * width + x] = bg
+        elif disposal == 3:
+            canvas = before
+        delay, transparent, disposal = 0, None, 0
+    if not frames:
+        raise AssetError(f"{path}: no frames")
+    return width, height, frames, palette, delays
+
+
+def load_bdf(path):
+    """Returns (width, height, {encoding: [row bitmaps, MSB = left]})."""
+    glyphs, width, height, enc, rows = {}, 0, 0, None, None
+    for line in path.read_text().splitlines():
+        words = line.split()
+        if not words:
+            continue
+        if words[0] == "FONTBOUNDINGBOX":
+            width, height = int(words[1]), int(words[2])
+        elif words[0] == "ENCODING":
+            enc = int(words[1])
+        elif words[0] == "BITMAP":
+            rows = []
+        elif words[0] == "ENDCHAR":
+            glyphs[enc] = rows
+            rows = None
+        elif rows is not None:
+            bits = len(words[0]) * 4
+            rows.append(int(words[0], 16) >> (bits - width) if bits >= width else int(words[0], 16))
+    if not width or height > 8:
+        raise AssetError(f"{path}: need a FONTBOUNDINGBOX at most 8 rows high")
+    return width, height, glyphs
+
+
+class TrueType:
+    """Reads the outline, metric, character map and kerning tables of a .ttf."""
+
+    def __init__(self, path):
+        self.path = path
+        self.data = data = path.read_bytes()
+        if data[:4] not in (b"\x00\x01\x00\x00", b"true"):
+            raise AssetError(f"{path}: not a TrueType font")
+        self.tables = {}
+        for i in range(struct.unpack_from(">H", data, 4)[0]):
+            tag, _, off, length = struct.unpack_from(">4sIII", data, 12 + 16 * i)
+            self.tables[tag.decode("latin-1")] = (off, length)
+        for tag in ("head", "maxp", "hhea", "hmtx", "loca", "glyf", "cmap"):
+            if tag not in self.tables:
+                raise AssetError(f"{path}: no '{tag}' table")
+        head = self.tables["head"][0]
+        self.units_per_em = struct.unpack_from(">H", data, head + 18)[0]
+        long_loca = struct.unpack_from(">h", data, head + 50)[0]
+        count = struct.unpack_from(">H", data, self.tables["maxp"][0] + 4)[0]
+        metrics = struct.unpack_from(">H", data, self.tables["hhea"][0] + 34)[0]
+        hmtx = self.tables["hmtx"][0]
+        self.advances = [struct.unpack_from(">H", data, hmtx + 4 * min(i, metrics - 1))[0] for i in range(count)]
+        loca = self.tables["loca"][0]
+        if long_loca:
+            self.loca = list(struct.unpack_from(f">{count + 1}I", data, loca))
+        else:
+            self.loca = [2 * o for o in struct.unpack_from(f">{count + 1}H", data, loca)]
+        self.cmap = self._read_cmap()
+
+    def _read_cmap(self):
+        """Character -> glyph index from the format 4 (BMP) subtable."""
+        data, base = self.data, self.tables["cmap"][0]
+        sub = None
+        for i in range(struct.unpack_from(">H", data, base + 2)[0]):
+            platform, encoding, off = struct.unpack_from(">HHI", data, base + 4 + 8 * i)
+            if (platform, encoding) in ((3, 1), (0, 3)) and struct.unpack_from(">H", data, base + off)[0] == 4:
+                sub = base + off
+        if sub is None:
+            raise AssetError(f"{self.path}: no Unicode BMP (format 4) character map")
+        segs = struct.unpack_from(">H", data, sub + 6)[0] // 2
+        ends = struct.unpack_from(f">{segs}H", data, sub + 14)
+        starts = struct.unpack_from(f">{segs}H", data, sub + 16 + 2 * segs)
+        deltas = struct.unpack_from(f">{segs}h", data, sub + 16 + 4 * segs)
+        range_at = sub + 16 + 6 * segs
+        cmap = {}
+        for i in range(segs):
+            ro = struct.unpack_from(">H", data, range_at + 2 * i)[0]
+            for c in range(starts[i], min(ends[i], 0xFFFE) + 1):
+                if ro:
+                    g = struct.unpack_from(">H", data, range_at + 2 * i + ro + 2 * (c - starts[i]))[0]
+                    g = (g + deltas[i]) & 0xFFFF if g else 0
+                else:
+                    g = (c + deltas[i]) & 0xFFFF
+                if g:
+                    cmap[c] = g
+        return cmap
+
+    def kerning(self):
+        """{(left glyph, right glyph): units} from the legacy 'kern' table."""
+        pairs = {}
+        if "kern" not in self.tables:
+            return pairs
+        data, pos = self.data, self.tables["kern"][0]
+        version, count = struct.unpack_from(">HH", data, pos)
+        if version != 0:
+            return pairs
+        pos += 4
+        for _ in range(count):
+            _, length, coverage = struct.unpack_from(">HHH", data, pos)
+            if coverage >> 8 == 0 and coverage & 0x7 == 1:  # format 0, horizontal, not minimum/cross-stream
+                n = struct.unpack_from(">H", data, pos + 6)[0]
+                for i in range(n):
+                    left, right, value = struct.unpack_from(">HHh", data, pos + 14 + 6 * i)
+                    pairs[(left, right)] = value
+            pos += length
+        return pairs
+
+    def contours(self, glyph, depth=0):
+        """Outline of a glyph as closed contours of (x, y, on_curve) points."""
+        data = self.data
+        start, end = self.loca[glyph], self.loca[glyph + 1]
+        if start == end:
+            return []
+        pos = self.tables["glyf"][0] + start
+        n = struct.unpack_from(">h", data, pos)[0]
+        pos += 10
+        if n < 0:
+            return self._composite(pos, depth)
+        ends = struct.unpack_from(f">{n}H", data, pos)
+        pos += 2 * n
+        pos += 2 + struct.unpack_from(">H", data, pos)[0]  # skip the hinting instructions
+        count = ends[-1] + 1 if n else 0
+        flags = []
+        while len(flags) < count:
+            f = data[pos]
+            pos += 1
+            repeat = 1
+            if f & 8:
+                repeat += data[pos]
+                pos += 1
+            flags += [f] * repeat
+        coords = []
+        for short, same in ((2, 16), (4, 32)):
+            v, axis = 0, []
+            for f in flags:
+                if f & short:
+                    v += data[pos] if f & same else -data[pos]
+                    pos += 1
+                elif not f & same:
+                    v += struct.unpack_from(">h", data, pos)[0]
+                    pos += 2
+                axis.append(v)
+            coords.append(axis)
+        points = [(x, y, f & 1) for x, y, f in zip(coords[0], coords[1], flags)]
+        out, first = [], 0
+        for last in ends:
+            out.append(points[first:last + 1])
+            first = last + 1
+        return out
+
+    def _composite(self, pos, depth):
+        if depth > 8:
+            raise AssetError(f"{self.path}: composite glyphs nested too deeply")
+        data, out = self.data, []
+        while True:
+            flags, glyph = struct.unpack_from(">HH", data, pos)
+            pos += 4
+            if flags & 1:
+                dx, dy = struct.unpack_from(">hh", data, pos)
+                pos += 4
+            else:
+                dx, dy = struct.unpack_from(">bb", data, pos)
+                pos += 2
+            if not flags & 2:
+                dx = dy = 0  # point-matched placement: not used by the fonts here
+            xx, xy, yx, yy = 1.0, 0.0, 0.0, 1.0
+            if flags & 0x8:
+                xx = yy = struct.unpack_from(">h", data, pos)[0] / 16384
+                pos += 2
+            elif flags & 0x40:
+                xx, yy = (v / 16384 for v in struct.unpack_from(">hh", data, pos))
+                pos += 4
+            elif flags & 0x80:
+                xx, xy, yx, yy = (v / 16384 for v in struct.unpack_from(">hhhh", data, pos))
+                pos += 8
+            for contour in self.contours(glyph, depth + 1):
+                out.append([(x * xx + y * yx + dx, x * xy + y * yy + dy, on) for x, y, on in contour])
+            if not flags & 0x20:
+                return out
+
+
+def _flatten(contour, scale, steps=6):
+    """Quadratic contour in font units -> closed polygon in pixels (y up)."""
+    pts = [(x * scale, y * scale, on) for x, y, on in contour]
+    if not any(on for _, _, on in pts):
+        # All off-curve: start on the implied point between the first two.
+        (x0, y0, _), (x1, y1, _) = pts[0], pts[1]
+        pts.insert(0, ((x0 + x1) / 2, (y0 + y1) / 2, 1))
+    while not pts[0][2]:
+        pts.append(pts.pop(0))
+    poly = [pts[0][:2]]
+    ctrl = None
+    for x, y, on in pts[1:] + pts[:1]:
+        if on:
+            if ctrl is None:
+                poly.append((x, y))
+            else:
+                _quad(poly, ctrl, (x, y), steps)
+                ctrl = None
+        elif ctrl is None:
+            ctrl = (x, y)
+        else:
+            mid = ((ctrl[0] + x) / 2, (ctrl[1] + y) / 2)
+            _quad(poly, ctrl, mid, steps)
+            ctrl = (x, y)
+    return poly
+
+
+def _quad(poly, ctrl, end, steps):
+    x0, y0 = poly[-1]
+    for i in range(1, steps + 1):
+        t = i / steps
+        a, b, c = (1 - t) * (1 - t), 2 * t * (1 - t), t * t
+        poly.append((a * x0 + b * ctrl[0] + c * end[0], a * y0 + b * ctrl[1] + c * end[1]))
+
+
+def _rasterise(polys, x0, y1, w, h, sub=8):
+    """Nonzero-winding coverage (0..1) of the w x h pixel box whose top-left
+    corner is (x0, y1) in y-up pixel space. Each pixel row is sampled on `sub`
+    scanlines; along a scanline, spans are measured exactly."""
+    edges = []
+    for poly in polys:
+        for (ax, ay), (bx, by) in zip(poly, poly[1:] + poly[:1]):
+            if ay != by:
+                edges.append((ax, ay, bx, by, 1 if by > ay else -1))
+    cov = [[0.0] * w for _ in range(h)]
+    for row in range(h):
+        acc = cov[row]
+        for s in range(sub):
+            y = y1 - row - (s + 0.5) / sub
+            hits = []
+            for ax, ay, bx, by, wind in edges:
+                if min(ay, by) <= y < max(ay, by):
+                    hits.append((ax + (y - ay) * (bx - ax) / (by - ay) - x0, wind))
+            hits.sort()
+            winding = 0
+            for i, (x, wind) in enumerate(hits[:-1]):
+                winding += wind
+                if winding:
+                    _span(acc, x, hits[i + 1][0], w, 1 / sub)
+    return cov
+
+
+def _span(acc, a, b, w, weight):
+    a, b = max(a, 0.0), min(b, float(w))
+    while a < b:
+        px = int(a)
+        end = min(b, px + 1.0)
+        acc[px] += (end - a) * weight
+        a = end
+
+
+def load_ttf(path, size, bpp, first, last):
+    """Renders characters first..last at `size` pixels per em. Returns
+    (glyphs, kerns): glyphs[c - first] = (w, h, left, top, advance, levels)
+    with levels a row-major list of 0..2^bpp - 1, trimmed to the inked box;
+    kerns = {(c1, c2): pixels}, nonzero only."""
+    font = TrueType(path)
+    scale = size / font.units_per_em
+    top_level = (1 << bpp) - 1
+    glyphs = []
+    for c in range(first, last + 1):
+        g = font.cmap.get(c, 0)
+        advance = round(font.advances[g] * scale)
+        polys = [_flatten(contour, scale) for contour in font.contours(g)]
+        if not polys:
+            glyphs.append((0, 0, 0, 0, advance, []))
+            continue
+        xs = [x for p in polys for x, _ in p]
+        ys = [y for p in polys for _, y in p]
+        bx0, by1 = math.floor(min(xs)), math.ceil(max(ys))
+        w, h = math.ceil(max(xs)) - bx0, by1 - math.floor(min(ys))
+        cov = _rasterise(polys, bx0, by1, w, h)
+        levels = [[min(top_level, round(v * top_level)) for v in row] for row in cov]
+        rows = [i for i, row in enumerate(levels) if any(row)]
+        cols = [i for i in range(w) if any(row[i] for row in levels)]
+        if not rows:
+            glyphs.append((0, 0, 0, 0, advance, []))
+            continue
+        r0, r1, c0, c1 = rows[0], rows[-1] + 1, cols[0], cols[-1] + 1
+        if c1 - c0 > 255 or r1 - r0 > 255 or advance > 255:
+            raise AssetError(f"{path}: glyph {c} is too large at {size} px")
+        glyphs.append((c1 - c0, r1 - r0, bx0 + c0, by1 - r0, advance, [v for row in levels[r0:r1] for v in row[c0:c1]]))
+    index = {font.cmap[c]: c for c in range(first, last + 1) if c in font.cmap}
+    kerns = {}
+    for (a, b), units in font.kerning().items():
+        px = round(units * scale)
+        if px and a in index and b in index:
+            kerns[(index[a], index[b])] = px
+    return glyphs, kerns
+
+
+# --- Palette reduction ---
+
+
+def rgb565(c):
+    return ((c[0] & 0xF8) << 8) | ((c[1] & 0xFC) << 3) | (c[2] >> 3)
+
+
+def _median_cut(colours, count):
+    """colours: {rgb: weight}. Returns up to count representative colours."""
+    boxes = [list(colours)]
+    while len(boxes) < count:
+        splittable = [b for b in boxes if len(b) > 1]
+        if not splittable:
+            break
+        box = max(splittable, key=lambda b: sum(colours[c] for c in b))
+        ch = max(range(3), key=lambda i: max(c[i] for c in box) - min(c[i] for c in box))
+        box.sort(key=lambda c: c[ch])
+        half, acc = sum(colours[c] for c in box) / 2, 0
+        for cut in range(1, len(box)):
+            acc += colours[box[cut - 1]]
+            if acc >= half:
+                break
+        boxes.remove(box)
+        boxes += [box[:cut], box[cut:]]
+    reps = []
+    for box in boxes:
+        w = sum(colours[c] for c in box)
+        reps.append(tuple(round(sum(c[i] * colours[c] for c in box) / w) for i in range(3)))
+    return reps
+
+
+def quantise(frames, palette, path):
+    """Maps every frame to indices into at most SHEET_COLOURS RGB colours and
+    returns (frames, colours)."""
+    order = []  # candidate colours in preferred order
+    if palette is not None:
+        used = sorted({v for f in frames for v in f})
+        order = [palette[i] for i in used]
+        frames = [[palette[v] for v in f] for f in frames]
+    else:
+        seen = set()
+        for f in frames:
+            for c in f:
+                if c not in seen:
+                    seen.add(c)
+                    order.append(c)
+    # Colours equal in RGB565 are one colour on the panel.
+    merged = []
+    for c in order:
+        if all(rgb565(c) != rgb565(m) for m in merged):
+            merged.append(c)
+    if len(merged) > SHEET_COLOURS:
+        weights = {}
+        for f in frames:
+            for c in f:
+                weights[c] = weights.get(c, 0) + 1
+        reps = _median_cut(weights, SHEET_COLOURS)
+        nearest = lambda c: min(reps, key=lambda r: sum((a - b) ** 2 for a, b in zip(c, r)))
+        merged = []
+        for c in order:
+            r = nearest(c)
+            if r not in merged:
+                merged.append(r)
+        print(f"gfx_assets: {path.name}: quantised {len(order)} colours to {len(merged)}")
+    lookup = {}
+    out = []
+    for f in frames:
+        row = []
+        for c in f:
+            if c not in lookup:
+                lookup[c] = min(range(len(merged)),
+                                key=lambda i: sum((a - b) ** 2 for a, b in zip(c, merged[i])))
+            row.append(lookup[c])
+        out.append(row)
+    return out, merged
+
+
+# --- Encoders ---
+
+
+def encode_packed2(frame, w, h):
+    out = bytearray()
+    for y in range(h):
+        for x in range(0, w, 4):
+            b = 0
+            for i in range(4):
+                v = frame[y * w + x + i] if x + i < w else 0
+                b |= v << (6 - 2 * i)
+            out.append(b)
+    return out
+
+
+def encode_rle(frame):
+    out = bytearray()
+    i = 0
+    while i < len(frame):
+        n = 1
+        while i + n < len(frame) and n < RLE_MAX_RUN and frame[i + n] == frame[i]:
+            n += 1
+        out.append(((n - 1) << 2) | frame[i])
+        i += n
+    return out
+
+
+# --- Output ---
+
+
+def c_bytes(data, indent="    ", per_line=12):
+    lines = []
+    for i in range(0, len(data), per_line):
+        lines.append(indent + ", ".join(f"0x{b:02X}" for b in data[i:i + per_line]) + ",")
+    return lines
+
+
+class Output:
+    def __init__(self):
+        self.c = []
+        self.h = []
+        self.palettes = {}  # RGB565 tuple -> name of the array holding it
+        self.report = []
+
+    def palette(self, name, colours):
+        key = tuple(rgb565(c) for c in colours)
+        shared = self.palettes.get(key)
+        self.h.append(f"#define {name.upper()}_COLOURS {len(colours)}")
+        if shared:
+            self.h.append(f"#define {name}_palette {shared}")
+            return 0, shared
+        self.palettes[key] = f"{name}_palette"
+        self.h.append(f"extern const uint16_t {name}_palette[{len(colours)}];")
+        self.c.append(f"const uint16_t {name}_palette[{len(colours)}] = {{")
+        self.c += [f"    RGB565_CONST({r}, {g}, {b})," for r, g, b in colours]
+        self.c += ["};", ""]
+        return 2 * len(colours), None
+
+    def sheet(self, name, source, fmt, timeline):
+        loader = load_gif if source.suffix.lower() == ".gif" else load_png
+        w, h, frames, palette, delays = loader(source)
+        if w > 255 or h > 255:
+            raise AssetError(f"{source}: sheets are at most 255x255")
+        frames, colours = quantise(frames, palette, source)
+        unique, steps = [], []
+        for f, ms in zip(frames, delays or [0] * len(frames)):
+            if f not in unique:
+                unique.append(f)
+            steps.append((unique.index(f), ms))
+        if len(unique) > 255:
+            raise AssetError(f"{source}: more than 255 distinct frames")
+
+        packed = b"".join(encode_packed2(f, w, h) for f in unique)
+        rle = [encode_rle(f) for f in unique]
+        rle_cost = sum(map(len, rle)) + 2 * len(unique)
+        if fmt == "auto":
+            fmt = "rle" if rle_cost < len(packed) else "packed2"
+
+        up = name.upper()
+        self.h += [f"// {name}: {source.name}, {w}x{h}, {len(unique)} frame(s), {fmt}",
+                   f"#define {up}_W {w}", f"#define {up}_H {h}", f"#define {up}_FRAME_COUNT {len(unique)}"]
+        pal_bytes, shared = self.palette(name, colours)
+        self.h.append(f"extern const gfx_sheet_t {name}_sheet;")
+        if fmt == "rle":
+            data = b"".join(rle)
+            offsets, off = [], 0
+            for r in rle:
+                offsets.append(off)
+                off += len(r)
+            self.c.append(f"// {len(data)} bytes of runs; {len(packed)} packed, "
+                          f"{w * h * len(unique)} as byte indices.")
+            self.c.append(f"static const uint8_t {name}_rle[{len(data)}] = {{")
+            for i, r in enumerate(rle):
+                self.c.append(f"    // frame {i}: {len(r)} runs")
+                self.c += c_bytes(r)
+            self.c += ["};", "",
+                       f"static const uint16_t {name}_rle_offsets[{len(offsets)}] = {{ "
+                       + ", ".join(map(str, offsets)) + " };", ""]
+            data_name, data_bytes = f"{name}_rle", len(data) + 2 * len(offsets)
+        else:
+            self.c.append(f"// 2bpp packed, {(w + 3) // 4} bytes per row.")
+            self.c.append(f"static const uint8_t {name}_packed[{len(packed)}] = {{")
+            self.c += c_bytes(packed, per_line=(w + 3) // 4)
+            self.c += ["};", ""]
+            data_name, data_bytes = f"{name}_packed", len(packed)
+        self.c += [f"const gfx_sheet_t {name}_sheet = {{",
+                   f"    .format = GFX_SHEET_{'RLE' if fmt == 'rle' else 'PACKED2'},",
+                   f"    .w = {w},", f"    .h = {h},", f"    .frame_count = {len(unique)},",
+                   f"    .data = {data_name},"]
+        if fmt == "rle":
+            self.c.append(f"    .offsets = {name}_rle_offsets,")
+        self.c += [f"    .palette = {shared or name + '_palette'},", "};", ""]
+
+        cost = data_bytes + pal_bytes + SHEET_STRUCT_BYTES
+        if timeline:
+            self.h += [f"#define {up}_TIMELINE_STEPS {len(steps)}",
+                       f"extern const gfx_anim_step_t {name}_timeline[{up}_TIMELINE_STEPS];"]
+            self.c += [f"const gfx_anim_step_t {name}_timeline[{up}_TIMELINE_STEPS] = {{",
+                       "    " + ", ".join(f"{{ {f}, {ms} }}" for f, ms in steps) + ",", "};", ""]
+            cost += 4 * len(steps)
+        self.h.append("")
+        note = f"palette shared with {shared.removesuffix('_palette')}" if shared else f"palette {pal_bytes} B"
+        self.report.append((name, f"{w}x{h} x{len(unique)} {fmt}: data {data_bytes} B, {note}", cost))
+
+    def font(self, name, source):
+        width, height, glyphs = load_bdf(source)
+        first, last = min(glyphs), max(glyphs)
+        up = name.upper()
+        self.h += [f"// {name}: {source.name}, {width}x{height} glyphs {first}..{last}, "
+                   "column-major (bit 0 is the top row)",
+                   f"#define {up}_FIRST {first}", f"#define {up}_COUNT {last - first + 1}",
+                   f"#define {up}_W {width}", f"#define {up}_H {height}",
+                   f"extern const uint8_t {name}[{up}_COUNT][{up}_W];", ""]
+        self.c.append(f"const uint8_t {name}[{up}_COUNT][{up}_W] = {{")
+        for enc in range(first, last + 1):
+            rows = glyphs.get(enc, [])
+            cols = []
+            for x in range(width):
+                cols.append(sum(1 << y for y, bits in enumerate(rows) if (bits >> (width - 1 - x)) & 1))
+            label = "space" if enc == 32 else chr(enc) if 32 < enc < 127 and chr(enc) != "\\" else f"\\x{enc:02x}"
+            self.c.append("    { " + ", ".join(f"0x{c:02X}" for c in cols) + f" }}, // {label}")
+        self.c += ["};", ""]
+        size = (last - first + 1) * width
+        self.report.append((name, f"{last - first + 1} glyphs {width}x{height}", size))
+
+    def ttf(self, name, source, size, bpp, first, last):
+        glyphs, kerns = load_ttf(source, size, bpp, first, last)
+        ascent = max(g[3] for g in glyphs if g[1])
+        descent = max(g[1] - g[3] for g in glyphs if g[1])
+        per_byte = 8 // bpp
+        bitmaps, records = bytearray(), []
+        for c, (w, h, left, top, advance, levels) in zip(range(first, last + 1), glyphs):
+            records.append((len(bitmaps), w, h, left, top, advance, c))
+            for r in range(h):
+                row = levels[r * w:(r + 1) * w]
+                for i in range(0, w, per_byte):
+                    b = 0
+                    for j, v in enumerate(row[i:i + per_byte]):
+                        b |= v << (8 - bpp * (j + 1))
+                    bitmaps.append(b)
+        if len(bitmaps) > 0xFFFF:
+            raise AssetError(f"{source}: {len(bitmaps)} bytes of glyph bitmaps at {size} px, at most 65535")
+
+        up, count = name.upper(), last - first + 1
+        self.h += [f"// {name}: {source.name} at {size} px, {bpp}-bit coverage, characters {first}..{last}, "
+                   f"{len(kerns)} kerning pairs",
+                   f"#define {up}_LINE_HEIGHT {ascent + descent}",
+                   f"extern const gfx_font_t {name};", ""]
+        self.c.append(f"// {len(bitmaps)} bytes of {bpp}-bit coverage, rows padded to a byte.")
+        self.c.append(f"static const uint8_t {name}_bitmaps[{len(bitmaps)}] = {{")
+        self.c += c_bytes(bitmaps, per_line=16)
+        self.c += ["};", "", f"static const gfx_glyph_t {name}_glyphs[{count}] = {{"]
+        for off, w, h, left, top, advance, c in records:
+            label = "space" if c == 32 else chr(c) if 32 < c < 127 and chr(c) != "\\" else f"\\x{c:02x}"
+            self.c.append(f"    {{ {off}, {w}, {h}, {left}, {top}, {advance} }}, // {label}")
+        self.c += ["};", ""]
+        if kerns:
+            self.c.append(f"static const gfx_kern_t {name}_kerns[{len(kerns)}] = {{")
+            for i in range(0, len(kerns), 6):
+                chunk = sorted(kerns.items())[i:i + 6]
+                self.c.append("    " + " ".join(f"{{ {a}, {b}, {v} }}," for (a, b), v in chunk))
+            self.c += ["};", ""]
+        self.c += [f"const gfx_font_t {name} = {{",
+                   f"    .bpp = {bpp},", f"    .first = {first},", f"    .count = {count},",
+                   f"    .ascent = {ascent},", f"    .line_height = {ascent + descent},",
+                   f"    .kern_count = {len(kerns)},", f"    .glyphs = {name}_glyphs,",
+                   f"    .bitmaps = {name}_bitmaps,", f"    .kerns = {name + '_kerns' if kerns else 'NULL'},",
+                   "};", ""]
+        cost = len(bitmaps) + GLYPH_BYTES * count + KERN_BYTES * len(kerns) + FONT_STRUCT_BYTES
+        self.report.append((name, f"{count} glyphs {size} px {bpp}bpp: bitmaps {len(bitmaps)} B, "
+                                  f"{len(kerns)} kerning pairs", cost))
+
+
+def main(argv):
+    if len(argv) != 4:
+        print("usage: gfx_assets.py <manifest> <out.c> <out.h>", file=sys.stderr)
+        return 2
+    manifest, out_c, out_h = map(pathlib.Path, argv[1:])
+    out = Output()
+    try:
+        for lineno, line in enumerate(manifest.read_text().splitlines(), 1):
+            words = line.split("#", 1)[0].split()
+            if not words:
+                continue
+            if len(words) < 2:
+                raise AssetError(f"{manifest}:{lineno}: expected <name> <source> [options]")
+            name, source, opts = words[0], manifest.parent / words[1], words[2:]
+            if source.suffix.lower() == ".bdf":
+                out.font(name, source)
+                continue
+            if source.suffix.lower() == ".ttf":
+                kv = dict(o.split("=", 1) for o in opts if "=" in o)
+                unknown = set(kv) - {"size", "bpp", "chars"} | {o for o in opts if "=" not in o}
+                if unknown or "size" not in kv or kv.get("bpp", "4") not in ("2", "4"):
+                    raise AssetError(f"{manifest}:{lineno}: expected size=<px> [bpp=2|4] [chars=<first>-<last>]")
+                first, last = map(int, kv.get("chars", "32-126").split("-"))
+                if not 0 <= first <= last <= 255:
+                    raise AssetError(f"{manifest}:{lineno}: chars must lie within 0-255")
+                out.ttf(name, source, int(kv["size"]), int(kv.get("bpp", "4")), first, last)
+                continue
+            fmt = next((o for o in opts if o in ("packed2", "rle", "auto")), "auto")
+            unknown = set(opts) - {"packed2", "rle", "auto", "timeline"}
+            if unknown:
+                raise AssetError(f"{manifest}:{lineno}: unknown option {' '.join(sorted(unknown))}")
+            out.sheet(name, source, fmt, "timeline" in opts)
+    except (AssetError, OSError, KeyError, ValueError, zlib.error, struct.error) as e:
+        print(f"gfx_assets: {e}", file=sys.stderr)
+        return 1
+
+    total = sum(cost for _, _, cost in out.report)
+    report = [f"{name:<10} {cost:5} B  {what}" for name, what, cost in out.report]
+    report.append(f"{'total':<10} {total:5} B")
+    for line in report:
+        print(f"gfx_assets: {line}")
+
+    banner = f"// Generated by tools/gfx_assets.py from {manifest.name}; do not edit."
+    out_h.parent.mkdir(parents=True, exist_ok=True)
+    out_c.parent.mkdir(parents=True, exist_ok=True)
+    out_h.write_text("\n".join([banner, "#pragma once", "", "#include <stdint.h>", "",
+                                '#include "gfx/anim.h"', '#include "gfx/text.h"', ""] + out.h))
+    out_c.write_text("\n".join([banner, "//", "// Flash cost:"] + [f"//   {line}" for line in report]
+                               + ["", f'#include "gfx/{out_h.name}"', '#include "gfx/color.h"', ""] + out.c))
+    return 0
+
+
+if __name__ == "__main__":
+    sys.exit(main(sys.argv))
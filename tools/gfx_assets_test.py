@@ -0,0 +1,264 @@
+#!/usr/bin/env python3
+"""Round-trip test of tools/gfx_assets.py.
+
+Converts the real manifest (lib/gfx/assets/assets.txt), and a second one
+that forces each sheet format and adds generated PNGs, then reads the
+emitted C back and decodes every table the way the library does:
+
+  sheets   packed2 and RLE frames, through their palettes, give the source
+           pixels in RGB565 exactly when the source has at most four
+           colours; quantised sources get the palette entry nearest each
+           source colour. GIF frames come back in order through the
+           timeline, with the source delays; identical palettes are emitted
+           once and shared by name.
+  bdf      the column-major table gives every glyph row of the source.
+  ttf      glyph records and unpacked coverage match what load_ttf()
+           rendered, and the kerning pairs are all there.
+
+Usage: tools/gfx_assets_test.py
+Exits non-zero if a check fails.
+"""
+
+import pathlib
+import re
+import struct
+import sys
+import tempfile
+import zlib
+
+sys.path.insert(0, str(pathlib.Path(__file__).resolve().parent))
+import gfx_assets as ga
+
+ASSETS = pathlib.Path(__file__).resolve().parent.parent / "lib" / "gfx" / "assets"
+
+
+class Mismatch(Exception):
+    pass
+
+
+# --- Reading the generated C ---
+
+
+def parse_c(text):
+    """Returns {name: (type, body)} for every table and struct defined."""
+    defs = {}
+    for m in re.finditer(r"^(?:static )?const (\w+) (\w+)(?:\[[^\]]*\])* = \{(.*?)\};", text, re.M | re.S):
+        defs[m.group(2)] = (m.group(1), re.sub(r"//[^\n]*", "", m.group(3)))
+    return defs
+
+
+def ints(body):
+    return [int(t, 0) for t in re.findall(r"-?0x[0-9A-Fa-f]+|-?\d+", body)]
+
+
+def fields(body):
+    return {k: v.strip() for k, v in re.findall(r"\.(\w+) = ([^,]+),", body)}
+
+
+def palette(defs, name):
+    _, body = defs[name]
+    return [tuple(map(int, c)) for c in re.findall(r"RGB565_CONST\((\d+), (\d+), (\d+)\)", body)]
+
+
+def sheet_frames(defs, name):
+    """Decodes <name>_sheet into (w, h, [[index]], palette RGB)."""
+    f = fields(defs[f"{name}_sheet"][1])
+    w, h, count = int(f["w"]), int(f["h"]), int(f["frame_count"])
+    data = ints(defs[f["data"]][1])
+    frames = []
+    if f["format"] == "GFX_SHEET_RLE":
+        offsets = ints(defs[f["offsets"]][1])
+        for i in range(count):
+            pos, frame = offsets[i], []
+            while len(frame) < w * h:
+                frame += [data[pos] & 3] * ((data[pos] >> 2) + 1)
+                pos += 1
+            if len(frame) != w * h:
+                raise Mismatch(f"{name}: frame {i} runs overshoot the frame by {len(frame) - w * h}")
+            frames.append(frame)
+    else:
+        row_bytes = (w + 3) // 4
+        if len(data) != count * h * row_bytes:
+            raise Mismatch(f"{name}: {len(data)} packed bytes for {count} frames of {h} x {row_bytes}")
+        for i in range(count):
+            base = i * h * row_bytes
+            frames.append([(data[base + y * row_bytes + x // 4] >> (6 - 2 * (x % 4))) & 3
+                           for y in range(h) for x in range(w)])
+    return w, h, f["format"], frames, palette(defs, f["palette"])
+
+
+# --- Checks ---
+
+
+def source_rgb(path):
+    """Source frames as RGB tuples, with delays."""
+    loader = ga.load_gif if path.suffix.lower() == ".gif" else ga.load_png
+    w, h, frames, pal, delays = loader(path)
+    if pal is not None:
+        frames = [[pal[v] for v in f] for f in frames]
+    return w, h, frames, delays
+
+
+def check_sheet(defs, name, path, fmt=None):
+    sw, sh, src, delays = source_rgb(path)
+    w, h, got_fmt, frames, pal = sheet_frames(defs, name)
+    if (w, h) != (sw, sh):
+        raise Mismatch(f"{name}: {w}x{h}, source {sw}x{sh}")
+    if fmt and got_fmt != fmt:
+        raise Mismatch(f"{name}: stored as {got_fmt}, manifest asks for {fmt}")
+    if len(pal) > ga.SHEET_COLOURS or any(v >= len(pal) for f in frames for v in f):
+        raise Mismatch(f"{name}: {len(pal)} palette entries, indices up to {max(max(f) for f in frames)}")
+
+    # Which stored frame each source frame became.
+    if f"{name}_timeline" in defs:
+        steps = list(zip(*[iter(ints(defs[f"{name}_timeline"][1]))] * 2))
+        if [ms for _, ms in steps] != delays:
+            raise Mismatch(f"{name}: timeline delays {[ms for _, ms in steps]}, source {delays}")
+        shown = [f for f, _ in steps]
+    else:
+        unique = []
+        for f in src:
+            if f not in unique:
+                unique.append(f)
+        shown = [unique.index(f) for f in src]
+    if len(shown) != len(src) or max(shown) >= len(frames):
+        raise Mismatch(f"{name}: {len(frames)} stored frames for {len(src)} source frames")
+
+    exact = len({ga.rgb565(c) for f in src for c in f}) <= ga.SHEET_COLOURS
+    for i, (f, k) in enumerate(zip(src, shown)):
+        for p, (c, v) in enumerate(zip(f, frames[k])):
+            if exact:
+                ok = ga.rgb565(pal[v]) == ga.rgb565(c)
+            else:
+                dist = [sum((a - b) ** 2 for a, b in zip(c, e)) for e in pal]
+                ok = dist[v] == min(dist)
+            if not ok:
+                raise Mismatch(f"{name}: frame {i} pixel ({p % w}, {p // w}) is {pal[v]}, source {c}")
+
+    if len({tuple(f) for f in frames}) != len(frames):
+        raise Mismatch(f"{name}: identical frames stored twice")
+
+
+def check_bdf(defs, name, path):
+    width, height, glyphs = ga.load_bdf(path)
+    table = ints(defs[name][1])
+    first = min(glyphs)
+    for i in range(len(table) // width):
+        cols = table[i * width:(i + 1) * width]
+        rows = [sum(1 << (width - 1 - x) for x in range(width) if (cols[x] >> y) & 1) for y in range(height)]
+        want = (glyphs.get(first + i, []) + [0] * height)[:height]
+        if rows != want:
+            raise Mismatch(f"{name}: glyph {first + i} rows {rows}, source {want}")
+    if len(table) != (max(glyphs) - first + 1) * width:
+        raise Mismatch(f"{name}: {len(table) // width} glyphs, source spans {max(glyphs) - first + 1}")
+
+
+def check_ttf(defs, name, path, size, bpp, first=32, last=126):
+    glyphs, kerns = ga.load_ttf(path, size, bpp, first, last)
+    font = fields(defs[name][1])
+    if (int(font["bpp"]), int(font["first"]), int(font["count"])) != (bpp, first, last - first + 1):
+        raise Mismatch(f"{name}: bpp {font['bpp']}, characters {font['first']} + {font['count']}")
+    records = list(zip(*[iter(ints(defs[font["glyphs"]][1]))] * 6))
+    bitmaps = ints(defs[font["bitmaps"]][1])
+    per_byte = 8 // bpp
+    for c, (rec, (w, h, left, top, advance, levels)) in enumerate(zip(records, glyphs), first):
+        off = rec[0]
+        if rec[1:] != (w, h, left, top, advance):
+            raise Mismatch(f"{name}: glyph {c} record {rec[1:]}, rendered {(w, h, left, top, advance)}")
+        row_bytes = (w + per_byte - 1) // per_byte
+        got = [(bitmaps[off + y * row_bytes + x // per_byte] >> (8 - bpp * (x % per_byte + 1))) & ((1 << bpp) - 1)
+               for y in range(h) for x in range(w)]
+        if got != levels:
+            raise Mismatch(f"{name}: glyph {c} coverage differs from the rendering")
+    table = list(zip(*[iter(ints(defs[font["kerns"]][1]))] * 3)) if font["kerns"] != "NULL" else []
+    got_kerns = {(a, b): v for a, b, v in table}
+    if got_kerns != kerns or int(font["kern_count"]) != len(table):
+        raise Mismatch(f"{name}: {len(table)} kerning pairs, rendered {len(kerns)}")
+    if [(a, b) for a, b, _ in table] != sorted(got_kerns):
+        raise Mismatch(f"{name}: kerning pairs are not sorted for the lookup")
+
+
+# --- Generated sources ---
+
+
+def write_png(path, w, h, pixels):
+    """8-bit RGB PNG, every row with the Sub filter."""
+    raw = bytearray()
+    for y in range(h):
+        row = bytes(c for p in pixels[y * w:(y + 1) * w] for c in p)
+        raw.append(1)
+        raw += bytes((row[i] - (row[i - 3] if i >= 3 else 0)) & 0xFF for i in range(len(row)))
+
+    def chunk(kind, body):
+        return struct.pack(">I", len(body)) + kind + body + struct.pack(">I", zlib.crc32(kind + body))
+
+    path.write_bytes(b"\x89PNG\r\n\x1a\n" + chunk(b"IHDR", struct.pack(">IIBBBBB", w, h, 8, 2, 0, 0, 0))
+                     + chunk(b"IDAT", zlib.compress(bytes(raw))) + chunk(b"IEND", b""))
+
+
+def convert(manifest, tmp):
+    out_c, out_h = tmp / "assets_data.c", tmp / "include" / "gfx" / "assets_data.h"
+    if ga.main(["gfx_assets.py", str(manifest), str(out_c), str(out_h)]) != 0:
+        raise Mismatch(f"{manifest.name}: conversion failed")
+    return parse_c(out_c.read_text()), out_h.read_text()
+
+
+def test_manifest(tmp):
+    defs, header = convert(ASSETS / "assets.txt", tmp)
+    check_bdf(defs, "font5x7", ASSETS / "font5x7.bdf")
+    check_sheet(defs, "heart", ASSETS / "heart.png")
+    check_sheet(defs, "gif", ASSETS / "pulse.gif")
+    check_ttf(defs, "sans16", ASSETS / "Lato-Regular.ttf", 16, 4)
+    check_ttf(defs, "sans11", ASSETS / "Lato-Regular.ttf", 11, 2)
+
+
+def test_forced(tmp):
+    # Stripes: three colours, 13 wide (padded packed rows) and runs longer
+    # than RLE_MAX_RUN that cross rows. Blend: 30 colours, to be quantised.
+    stripes = [(255, 0, 0) if i < 80 else (0, 0, 255) if (i // 7) % 2 else (250, 250, 250) for i in range(13 * 9)]
+    write_png(tmp / "stripes.png", 13, 9, stripes)
+    blend = [(x * 25, y * 40, 255 - x * 20) for y in range(6) for x in range(10)]
+    write_png(tmp / "blend.png", 10, 6, blend)
+    manifest = tmp / "forced.txt"
+    manifest.write_text("\n".join([
+        f"heart_p   {ASSETS / 'heart.png'}  packed2",
+        f"heart_r   {ASSETS / 'heart.png'}  rle",
+        f"gif_r     {ASSETS / 'pulse.gif'}  rle  timeline",
+        f"gif_p     {ASSETS / 'pulse.gif'}  packed2",
+        "stripes_p stripes.png packed2",
+        "stripes_r stripes.png rle",
+        "blend     blend.png",
+    ]) + "\n")
+    defs, header = convert(manifest, tmp)
+    for name, src, fmt in [("heart_p", "heart.png", "PACKED2"), ("heart_r", "heart.png", "RLE"),
+                           ("gif_r", "pulse.gif", "RLE"), ("gif_p", "pulse.gif", "PACKED2")]:
+        check_sheet(defs, name, ASSETS / src, f"GFX_SHEET_{fmt}")
+    check_sheet(defs, "stripes_p", tmp / "stripes.png", "GFX_SHEET_PACKED2")
+    check_sheet(defs, "stripes_r", tmp / "stripes.png", "GFX_SHEET_RLE")
+    check_sheet(defs, "blend", tmp / "blend.png")
+    if any((b >> 2) + 1 > ga.RLE_MAX_RUN for b in ints(defs["stripes_r_rle"][1])) or \
+            max((b >> 2) + 1 for b in ints(defs["stripes_r_rle"][1])) != ga.RLE_MAX_RUN:
+        raise Mismatch("stripes_r: the 80-pixel run is not split at RLE_MAX_RUN")
+    for shared, first in [("heart_r", "heart_p"), ("gif_p", "gif_r"), ("stripes_r", "stripes_p")]:
+        if f"#define {shared}_palette {first}_palette" not in header or f"{shared}_palette" in defs:
+            raise Mismatch(f"{shared}: palette not shared with {first}")
+
+
+def main():
+    tests = [("manifest", test_manifest), ("forced formats", test_forced)]
+    failed = 0
+    for name, run in tests:
+        with tempfile.TemporaryDirectory() as tmp:
+            try:
+                run(pathlib.Path(tmp))
+                ok = True
+            except (Mismatch, ga.AssetError) as e:
+                print(e)
+                ok = False
+        print(f"{name:<14} {'ok' if ok else 'FAIL'}")
+        failed |= not ok
+    return 1 if failed else 0
+
+
+if __name__ == "__main__":
+    sys.exit(main())
@@ -0,0 +1,192 @@
+#!/usr/bin/env python3
+"""Decodes LCD snapshots streamed by the bare-metal demo into PNG files.
+
+Sending `SCREENSHOT` to the demo makes it stream whatever the panel shows as
+lines in its log (see lib/gfx/include/gfx/snap.h for the pixel coding):
+
+  @snap begin <id> <width> <height> <page>
+  @snap <seq> <base64 chunk>
+  @snap end <id> <bytes> <crc32>
+
+Other log lines may be interleaved and are ignored. Chunks are checked for
+gaps by their sequence numbers, the reassembled stream against the byte count
+and CRC-32, and the decoded pixels against the frame size.
+
+Usage: tools/gfx_snapshot.py <log file | - | /dev/ttyACM0> [-o out.png] [--baud N]
+
+A log file (or - for stdin) is scanned for every snapshot in it. A serial
+device is put in raw mode, sent the command, and read until one snapshot has
+arrived. With several snapshots, the output name gets -<id> inserted before
+its suffix. Exits non-zero if no snapshot decodes.
+"""
+
+import argparse
+import base64
+import binascii
+import os
+import pathlib
+import stat
+import struct
+import sys
+import time
+import zlib
+
+
+class SnapError(Exception):
+    pass
+
+
+def rle_decode(data, width, height):
+    """Returns the frame as RGB565 values in raster order."""
+    pixels = []
+    pos = 0
+    for row in range(height):
+        x = 0
+        while x < width:
+            if pos >= len(data):
+                raise SnapError(f"stream ends in row {row}")
+            token = data[pos]
+            count = (token & 0x7F) + 1
+            if x + count > width:
+                raise SnapError(f"token crosses the end of row {row}")
+            if token & 0x80:
+                (value,) = struct.unpack_from(">H", data, pos + 1)
+                pixels.extend([value] * count)
+                pos += 3
+            else:
+                pixels.extend(struct.unpack_from(f">{count}H", data, pos + 1))
+                pos += 1 + 2 * count
+            x += count
+    if pos != len(data):
+        raise SnapError(f"{len(data) - pos} bytes left over after the frame")
+    return pixels
+
+
+def write_png(path, width, height, pixels):
+    raw = bytearray()
+    for y in range(height):
+        raw.append(0)  # filter: none
+        for v in pixels[y * width:(y + 1) * width]:
+            r, g, b = v >> 11, (v >> 5) & 0x3F, v & 0x1F
+            raw += bytes(((r << 3) | (r >> 2), (g << 2) | (g >> 4), (b << 3) | (b >> 2)))
+
+    def chunk(kind, body):
+        return struct.pack(">I", len(body)) + kind + body + struct.pack(">I", zlib.crc32(kind + body))
+
+    header = struct.pack(">IIBBBBB", width, height, 8, 2, 0, 0, 0)
+    path.write_bytes(b"\x89PNG\r\n\x1a\n" + chunk(b"IHDR", header) + chunk(b"IDAT", zlib.compress(bytes(raw), 9))
+                     + chunk(b"IEND", b""))
+
+
+class Collector:
+    """Reassembles snapshots from log lines."""
+
+    def __init__(self):
+        self.current = None
+        self.done = []  # (id, width, height, page, pixels)
+
+    def feed(self, line):
+        words = line.split()
+        if len(words) < 2 or words[0] != "@snap":
+            return
+        try:
+            if words[1] == "begin":
+                ident, width, height = int(words[2]), int(words[3]), int(words[4])
+                page = words[5] if len(words) > 5 else "?"
+                self.current = {"id": ident, "w": width, "h": height, "page": page, "seq": 0, "data": bytearray()}
+            elif words[1] == "end":
+                snap, self.current = self.current, None
+                if snap is None or int(words[2]) != snap["id"]:
+                    raise SnapError(f"end of snapshot {words[2]} without its beginning")
+                size, crc = int(words[3]), int(words[4], 16)
+                data = bytes(snap["data"])
+                if len(data) != size or zlib.crc32(data) != crc:
+                    raise SnapError(f"snapshot {snap['id']}: got {len(data)} bytes with CRC {zlib.crc32(data):08x}, "
+                                    f"expected {size} with {crc:08x}")
+                pixels = rle_decode(data, snap["w"], snap["h"])
+                self.done.append((snap["id"], snap["w"], snap["h"], snap["page"], pixels))
+            elif self.current is not None:
+                seq = int(words[1])
+                if seq != self.current["seq"]:
+                    snap, self.current = self.current, None
+                    raise SnapError(f"snapshot {snap['id']}: chunk {seq} arrived instead of {snap['seq']}")
+                self.current["data"] += base64.b64decode(words[2], validate=True)
+                self.current["seq"] += 1
+        except (IndexError, ValueError, binascii.Error, struct.error) as e:
+            self.current = None
+            raise SnapError(f"malformed line {line.strip()!r}: {e}")
+
+
+def open_serial(path, baud):
+    import termios
+    import tty
+
+    fd = os.open(path, os.O_RDWR | os.O_NOCTTY)
+    tty.setraw(fd)
+    attrs = termios.tcgetattr(fd)
+    speed = getattr(termios, f"B{baud}")
+    attrs[4] = attrs[5] = speed
+    termios.tcsetattr(fd, termios.TCSANOW, attrs)
+    termios.tcflush(fd, termios.TCIFLUSH)
+    return fd
+
+
+def read_serial(path, baud, collector, timeout):
+    fd = open_serial(path, baud)
+    try:
+        os.write(fd, b"SCREENSHOT\r\n")
+        pending = b""
+        deadline = time.monotonic() + timeout
+        while not collector.done:
+            if time.monotonic() > deadline:
+                raise SnapError(f"no snapshot from {path} within {timeout:.0f} s")
+            chunk = os.read(fd, 4096)
+            if not chunk:
+                time.sleep(0.01)
+                continue
+            pending += chunk
+            *lines, pending = pending.split(b"\n")
+            for line in lines:
+                try:
+                    collector.feed(line.decode("ascii", "replace"))
+                except SnapError as e:
+                    print(f"gfx_snapshot: {e}", file=sys.stderr)
+    finally:
+        os.close(fd)
+
+
+def main(argv):
+    parser = argparse.ArgumentParser(description="Decode LCD snapshots from the demo's log into PNG files.")
+    parser.add_argument("source", help="log file, - for stdin, or a serial device to request a snapshot from")
+    parser.add_argument("-o", "--output", default="snapshot.png", type=pathlib.Path)
+    parser.add_argument("--baud", type=int, default=115200, help="serial speed (ignored by USB CDC)")
+    parser.add_argument("--timeout", type=float, default=30.0, help="seconds to wait for a serial snapshot")
+    args = parser.parse_args(argv[1:])
+
+    collector = Collector()
+    try:
+        if args.source != "-" and stat.S_ISCHR(os.stat(args.source).st_mode):
+            read_serial(args.source, args.baud, collector, args.timeout)
+        else:
+            stream = sys.stdin if args.source == "-" else open(args.source, errors="replace")
+            with stream:
+                for line in stream:
+                    try:
+                        collector.feed(line)
+                    except SnapError as e:
+                        print(f"gfx_snapshot: {e}", file=sys.stderr)
+    except (OSError, SnapError) as e:
+        print(f"gfx_snapshot: {e}", file=sys.stderr)
+        return 1
+
+    for ident, width, height, page, pixels in collector.done:
+        out = args.output
+        if len(collector.done) > 1:
+            out = out.with_name(f"{out.stem}-{ident}{out.suffix}")
+        write_png(out, width, height, pixels)
+        print(f"gfx_snapshot: snapshot {ident} ({page}, {width}x{height}) -> {out}")
+    return 0 if collector.done else 1
+
+
+if __name__ == "__main__":
+    sys.exit(main(sys.argv))
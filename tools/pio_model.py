@@ -0,0 +1,437 @@
+#!/usr/bin/env python3
+"""Instruction-level model of the RP2350 PIO, used to check the LCD programs.
+
+Assembles the programs in examples/baremetal/src/lcd_pio.pio (the subset of
+pioasm syntax they use) to real PIO machine code, runs that code cycle by
+cycle with FIFOs, autopull/autopush, side-set and wrap, and checks:
+
+  lcd_tx   the SCK/MOSI/DC/CS waveform decodes to the bytes that were queued
+           (commands, odd-length parameters, 16-bit pixels in both
+           framebuffer byte orders), at 2 PIO cycles per bit;
+  lcd_pal  palette indices become the addresses of their 16-bit entries.
+
+Usage: tools/pio_model.py [path/to/lcd_pio.pio]
+Exits non-zero on the first mismatch.
+"""
+
+import pathlib
+import re
+import sys
+from collections import deque
+
+OPCODES = {"jmp": 0, "wait": 1, "in": 2, "out": 3, "push": 4, "pull": 4, "mov": 5, "irq": 6, "set": 7}
+JMP_COND = {"": 0, "!x": 1, "x--": 2, "!y": 3, "y--": 4, "x!=y": 5, "pin": 6, "!osre": 7}
+IN_SRC = {"pins": 0, "x": 1, "y": 2, "null": 3, "isr": 6, "osr": 7}
+OUT_DST = {"pins": 0, "x": 1, "y": 2, "null": 3, "pindirs": 4, "pc": 5, "isr": 6, "exec": 7}
+MOV_DST = {"pins": 0, "x": 1, "y": 2, "exec": 4, "pc": 5, "isr": 6, "osr": 7}
+MOV_SRC = {"pins": 0, "x": 1, "y": 2, "null": 3, "status": 5, "isr": 6, "osr": 7}
+SET_DST = {"pins": 0, "x": 1, "y": 2, "pindirs": 4}
+
+
+class Program:
+    def __init__(self, name):
+        self.name = name
+        self.code = []
+        self.wrap_target = 0
+        self.wrap = None
+        self.side_bits = 0
+        self.side_opt = False
+
+
+def _num(tok):
+    tok = tok.strip()
+    return int(tok.replace("_", ""), 0)
+
+
+def assemble(text):
+    """Returns {name: Program} for every .program in a .pio source."""
+    programs = {}
+    prog = None
+    pending = []  # (Program, mnemonic, args, side, delay) until labels resolve
+    labels = {}
+    in_block = False
+
+    def finish():
+        if prog is None:
+            return
+        lbl = labels[prog.name]
+        for p, op, args, side, delay in (x for x in pending if x[0] is prog):
+            prog.code.append(encode(p, op, args, side, delay, lbl))
+        if prog.wrap is None:
+            prog.wrap = len(prog.code) - 1
+
+    for raw in text.splitlines():
+        line = raw.split(";")[0].strip()
+        if line.startswith("%"):
+            in_block = not line.startswith("%}") and "{" in line
+            continue
+        if in_block:
+            if raw.strip().startswith("%}"):
+                in_block = False
+            continue
+        if not line:
+            continue
+        if line.startswith(".program"):
+            finish()
+            prog = Program(line.split()[1])
+            programs[prog.name] = prog
+            labels[prog.name] = {}
+            count = 0
+            continue
+        if line.startswith(".side_set"):
+            parts = line.split()
+            prog.side_bits = int(parts[1])
+            prog.side_opt = "opt" in parts[2:]
+            continue
+        if line == ".wrap_target":
+            prog.wrap_target = count
+            continue
+        if line == ".wrap":
+            prog.wrap = count - 1
+            continue
+        if line.startswith("."):
+            continue
+        m = re.match(r"^(public\s+)?([A-Za-z_]\w*):$", line)
+        if m:
+            labels[prog.name][m.group(2)] = count
+            continue
+        side = None
+        delay = 0
+        m = re.search(r"\[(\d+)\]\s*$", line)
+        if m:
+            delay = int(m.group(1))
+            line = line[: m.start()].strip()
+        m = re.search(r"\bside\s+(\S+)\s*$", line)
+        if m:
+            side = _num(m.group(1))
+            line = line[: m.start()].strip()
+        op, _, rest = line.partition(" ")
+        args = [a.strip() for a in rest.split(",")] if rest.strip() else []
+        pending.append((prog, op.lower(), args, side, delay))
+        count += 1
+    finish()
+    return programs
+
+
+def encode(prog, op, args, side, delay, labels):
+    ss_bits = prog.side_bits + (1 if prog.side_opt else 0)
+    delay_bits = 5 - ss_bits
+    if delay >= (1 << delay_bits):
+        raise ValueError(f"delay {delay} too large")
+    field = delay
+    if side is not None:
+        sfield = side
+        if prog.side_opt:
+            sfield |= 1 << prog.side_bits
+        field |= sfield << delay_bits
+    elif prog.side_bits and not prog.side_opt:
+        raise ValueError(f"{op}: side-set required")
+    word = (OPCODES[op] << 13) | (field << 8)
+
+    if op == "jmp":
+        parts = " ".join(args).replace(",", " ").split()
+        cond = parts[0] if len(parts) == 2 else ""
+        target = parts[-1]
+        addr = labels[target] if target in labels else _num(target)
+        word |= (JMP_COND[cond] << 5) | addr
+    elif op == "in":
+        word |= (IN_SRC[args[0]] << 5) | (_num(args[1]) & 31)
+    elif op == "out":
+        word |= (OUT_DST[args[0]] << 5) | (_num(args[1]) & 31)
+    elif op in ("push", "pull"):
+        opts = set(a for arg in args for a in arg.split())
+        word |= (0x80 if op == "pull" else 0)
+        if "iffull" in opts or "ifempty" in opts:
+            word |= 0x40
+        if "noblock" not in opts:
+            word |= 0x20
+    elif op == "mov":
+        src = args[1]
+        mop = 0
+        if src.startswith("!") or src.startswith("~"):
+            mop, src = 1, src[1:]
+        elif src.startswith("::"):
+            mop, src = 2, src[2:]
+        word |= (MOV_DST[args[0]] << 5) | (mop << 3) | MOV_SRC[src.strip()]
+    elif op == "set":
+        word |= (SET_DST[args[0]] << 5) | (_num(args[1]) & 31)
+    else:
+        raise ValueError(f"unsupported instruction {op}")
+    return word
+
+
+class StateMachine:
+    """One PIO state machine executing assembled code, one instruction per cycle."""
+
+    def __init__(self, prog, out_base=0, out_count=1, set_base=0, set_count=1, side_base=0,
+                 out_right=False, autopull=False, pull_thresh=32,
+                 in_right=False, autopush=False, push_thresh=32):
+        self.p = prog
+        self.pc = prog.wrap_target
+        self.x = self.y = 0
+        self.osr, self.osr_count = 0, 32
+        self.isr, self.isr_count = 0, 0
+        self.tx, self.rx = deque(), deque()
+        self.pins = 0
+        self.out_base, self.out_count = out_base, out_count
+        self.set_base, self.set_count = set_base, set_count
+        self.side_base = side_base
+        self.out_right, self.autopull, self.pull_thresh = out_right, autopull, pull_thresh % 32 or 32
+        self.in_right, self.autopush, self.push_thresh = in_right, autopush, push_thresh % 32 or 32
+        self.stalled = False
+
+    def _write_pins(self, base, count, value):
+        mask = ((1 << count) - 1) << base
+        self.pins = (self.pins & ~mask) | ((value << base) & mask)
+
+    def _shift_out(self, n):
+        n = n or 32
+        if self.out_right:
+            data = self.osr & ((1 << n) - 1) if n < 32 else self.osr
+            self.osr = (self.osr >> n) if n < 32 else 0
+        else:
+            data = self.osr >> (32 - n)
+            self.osr = (self.osr << n) & 0xFFFFFFFF if n < 32 else 0
+        self.osr_count = min(32, self.osr_count + n)
+        return data
+
+    def _shift_in(self, data, n):
+        n = n or 32
+        data &= (1 << n) - 1 if n < 32 else 0xFFFFFFFF
+        if self.in_right:
+            self.isr = ((self.isr >> n) | (data << (32 - n))) & 0xFFFFFFFF if n < 32 else data
+        else:
+            self.isr = ((self.isr << n) | data) & 0xFFFFFFFF if n < 32 else data
+        self.isr_count = min(32, self.isr_count + n)
+
+    def _refill(self):
+        if self.autopull and self.osr_count >= self.pull_thresh and self.tx:
+            self.osr, self.osr_count = self.tx.popleft(), 0
+
+    def step(self):
+        """Executes (or stalls on) one instruction; returns False when stalled."""
+        word = self.p.code[self.pc]
+        ss_bits = self.p.side_bits + (1 if self.p.side_opt else 0)
+        field = (word >> 8) & 0x1F
+        if ss_bits:
+            sfield = field >> (5 - ss_bits)
+            enabled = not self.p.side_opt or (sfield >> self.p.side_bits) & 1
+            if enabled:
+                self._write_pins(self.side_base, self.p.side_bits, sfield & ((1 << self.p.side_bits) - 1))
+        op = word >> 13
+        a, b = (word >> 5) & 7, word & 31
+        next_pc = self.pc + 1 if self.pc != self.p.wrap else self.p.wrap_target
+
+        if op == 0:  # JMP
+            take = {0: True, 1: self.x == 0, 2: self.x != 0, 3: self.y == 0,
+                    4: self.y != 0, 5: self.x != self.y, 7: self.osr_count < self.pull_thresh}[a]
+            if a == 2:
+                self.x = (self.x - 1) & 0xFFFFFFFF
+            if a == 4:
+                self.y = (self.y - 1) & 0xFFFFFFFF
+            if take:
+                next_pc = b
+        elif op == 2:  # IN
+            src = {1: self.x, 2: self.y, 3: 0, 6: self.isr, 7: self.osr}[a]
+            if self.autopush and self.isr_count >= self.push_thresh:
+                return self._stall()
+            self._shift_in(src, b)
+            if self.autopush and self.isr_count >= self.push_thresh:
+                self.rx.append(self.isr)
+                self.isr, self.isr_count = 0, 0
+        elif op == 3:  # OUT
+            if self.autopull and self.osr_count >= self.pull_thresh:
+                if not self.tx:
+                    return self._stall()
+                self._refill()
+            data = self._shift_out(b)
+            if a == 0:
+                self._write_pins(self.out_base, self.out_count, data)
+            elif a == 1:
+                self.x = data
+            elif a == 2:
+                self.y = data
+            elif a != 3:
+                raise NotImplementedError(f"out dest {a}")
+            self._refill()
+        elif op == 4:  # PUSH / PULL
+            if word & 0x80:
+                if self.autopull and self.osr_count == 0:
+                    pass  # fence: autopull already refilled the OSR
+                elif word & 0x40 and self.osr_count < self.pull_thresh:
+                    pass
+                elif self.tx:
+                    self.osr, self.osr_count = self.tx.popleft(), 0
+                elif word & 0x20:
+                    return self._stall()
+                else:
+                    self.osr, self.osr_count = self.x, 0
+            else:
+                self.rx.append(self.isr)
+                self.isr, self.isr_count = 0, 0
+        elif op == 5:  # MOV
+            src = {1: self.x, 2: self.y, 3: 0, 6: self.isr, 7: self.osr}[b & 7]
+            mop = (b >> 3) & 3
+            if mop == 1:
+                src = ~src & 0xFFFFFFFF
+            elif mop == 2:
+                src = int(f"{src:032b}"[::-1], 2)
+            if a == 1:
+                self.x = src
+            elif a == 2:
+                self.y = src
+            elif a == 6:
+                self.isr, self.isr_count = src, 0
+            elif a == 7:
+                self.osr, self.osr_count = src, 0
+            else:
+                raise NotImplementedError(f"mov dest {a}")
+        elif op == 7:  # SET
+            if a == 0:
+                self._write_pins(self.set_base, self.set_count, b)
+            elif a == 1:
+                self.x = b
+            elif a == 2:
+                self.y = b
+        else:
+            raise NotImplementedError(f"opcode {op}")
+
+        self.stalled = False
+        self.pc = next_pc
+        return True
+
+    def _stall(self):
+        self.stalled = True
+        return False
+
+
+# Pin numbering inside the model (relative to the real GP8..GP11 wiring).
+DC, CS, SCK, MOSI = 0, 1, 2, 3
+
+
+def lcd_tx_machine(prog):
+    sm = StateMachine(prog, out_base=MOSI, set_base=DC, set_count=2, side_base=SCK,
+                      autopull=True, pull_thresh=16)
+    sm.pins = (1 << DC) | (1 << CS)
+    return sm
+
+
+def run_lcd_tx(sm, max_cycles=10_000_000):
+    """Runs until the TX FIFO is drained and the SM is stalled; decodes the bus."""
+    frames = []  # [(dc, bytearray)]
+    shift, nbits = 0, 0
+    prev_sck = 0
+    cycles = 0
+    busy_cycles = 0
+    while cycles < max_cycles:
+        ran = sm.step()
+        cycles += 1
+        pins = sm.pins
+        sck = (pins >> SCK) & 1
+        cs = (pins >> CS) & 1
+        if ran and not cs:
+            busy_cycles += 1
+        if sck and not prev_sck and not cs:
+            dc = (pins >> DC) & 1
+            if nbits == 0 and (not frames or frames[-1][0] != dc or frames[-1][2]):
+                frames.append([dc, bytearray(), False])
+            shift = (shift << 1) | ((pins >> MOSI) & 1)
+            nbits += 1
+            if nbits == 8:
+                frames[-1][1].append(shift)
+                shift, nbits = 0, 0
+        if cs and frames and not frames[-1][2]:
+            frames[-1][2] = True  # CS released: the next bytes start a new frame
+            if nbits:
+                raise AssertionError(f"CS released mid-byte ({nbits} bits)")
+        prev_sck = sck
+        if not ran and not sm.tx:
+            break
+    return [(dc, bytes(b)) for dc, b, _ in frames], busy_cycles
+
+
+def tx_bytes(sm, dc, data):
+    """Queues a transfer as the firmware's CPU path does: header plus 2 bytes per word."""
+    sm.tx.append(((1 if dc else 0) << 31) | (len(data) * 8 - 1))
+    for i in range(0, len(data), 2):
+        hi = data[i]
+        lo = data[i + 1] if i + 1 < len(data) else 0
+        sm.tx.append((hi << 24) | (lo << 16))
+
+
+def tx_pixels(sm, pixels, wire_order):
+    """Queues pixels as the DMA path does: 16-bit writes replicated across the word,
+    with the DMA byte swap enabled for wire-order framebuffers."""
+    sm.tx.append((1 << 31) | (len(pixels) * 16 - 1))
+    for p in pixels:
+        h = ((p & 0xFF) << 8 | p >> 8) if wire_order else p
+        if wire_order:
+            h = ((h & 0xFF) << 8) | (h >> 8)  # DMA bswap restores the native value
+        sm.tx.append((h << 16) | h)
+
+
+def check(cond, msg):
+    if not cond:
+        print(f"FAIL: {msg}")
+        sys.exit(1)
+
+
+def check_lcd_tx(prog):
+    pixels = [0xF800, 0x07E0, 0x001F, 0x1234, 0xFFFF, 0x0000, 0xA55A]
+    for wire_order in (False, True):
+        sm = lcd_tx_machine(prog)
+        tx_bytes(sm, 0, bytes([0x2A]))
+        tx_bytes(sm, 1, bytes([0x00, 0x28, 0x01, 0x17]))
+        tx_bytes(sm, 0, bytes([0x36]))
+        tx_bytes(sm, 1, bytes([0x60]))  # odd length: the pad byte must not be sent
+        tx_bytes(sm, 0, bytes([0x2C]))
+        tx_pixels(sm, pixels, wire_order)
+        tx_pixels(sm, pixels[:3], wire_order)  # a second row in the same RAMWR
+        frames, busy = run_lcd_tx(sm)
+        expect = [
+            (0, b"\x2A"), (1, b"\x00\x28\x01\x17"), (0, b"\x36"), (1, b"\x60"), (0, b"\x2C"),
+            (1, b"".join(p.to_bytes(2, "big") for p in pixels)),
+            (1, b"".join(p.to_bytes(2, "big") for p in pixels[:3])),
+        ]
+        check(frames == expect, f"lcd_tx (wire_order={wire_order}) decoded {frames}, expected {expect}")
+        check((sm.pins >> CS) & 1 == 1, "CS left asserted")
+
+    # Throughput: a 240-pixel row is 3840 bits.
+    sm = lcd_tx_machine(prog)
+    tx_pixels(sm, [0x5555] * 240, False)
+    _, busy = run_lcd_tx(sm)
+    bits = 240 * 16
+    check(busy <= bits * 2 + 8, f"row took {busy} cycles for {bits} bits")
+    print(f"lcd_tx: ok ({len(prog.code)} instructions, {busy / bits:.3f} PIO cycles/bit on a 240 px row)")
+
+
+def check_lcd_pal(prog):
+    base = 0x20001000  # 512-byte aligned
+    sm = StateMachine(prog, out_right=True, autopull=True, pull_thresh=8,
+                      in_right=False, autopush=True, push_thresh=9)
+    sm.y = base >> 9
+    indices = [0, 1, 2, 3, 255, 7, 128]
+    for i in indices:
+        sm.tx.append(i * 0x01010101)  # 8-bit DMA writes are replicated across the word
+    for _ in range(200):
+        if not sm.step() and not sm.tx:
+            break
+    got = list(sm.rx)
+    expect = [base + 2 * i for i in indices]
+    check(got == expect, f"lcd_pal produced {[hex(a) for a in got]}, expected {[hex(a) for a in expect]}")
+    print(f"lcd_pal: ok ({len(prog.code)} instructions)")
+
+
+def main():
+    path = pathlib.Path(sys.argv[1]) if len(sys.argv) > 1 else \
+        pathlib.Path(__file__).resolve().parent.parent / "examples/baremetal/src/lcd_pio.pio"
+    programs = assemble(path.read_text())
+    for name, prog in programs.items():
+        words = " ".join(f"{w:04x}" for w in prog.code)
+        print(f"{name}: wrap {prog.wrap_target}..{prog.wrap}: {words}")
+    check_lcd_tx(programs["lcd_tx"])
+    check_lcd_pal(programs["lcd_pal"])
+
+
+if __name__ == "__main__":
+    main()
@@ -0,0 +1,12 @@
+/* native_sim only: built against the host C library (see CMakeLists.txt), so
+ * the app can time flushes in real time rather than simulated time. */
+#define _POSIX_C_SOURCE 200809L
+
+#include <stdint.h>
+#include <time.h>
+
+uint64_t lcd_host_time_ns(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint64_t)ts.tv_sec * 1000000000u + (uint64_t)ts.tv_nsec;
+}
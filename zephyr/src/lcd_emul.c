@@ -0,0 +1,86 @@
+/* SPI emulator for the LCD node on native_sim. Bytes sent to the panel are fed
+ * to the gfx library's memory-backed ST7789, with the DC line read back from
+ * the GPIO emulator to split commands from data. */
+#define DT_DRV_COMPAT waveshare_rp2350_geek_lcd
+
+#include <zephyr/device.h>
+#include <zephyr/drivers/emul.h>
+#include <zephyr/drivers/gpio.h>
+#include <zephyr/drivers/gpio/gpio_emul.h>
+#include <zephyr/drivers/spi.h>
+#include <zephyr/drivers/spi_emul.h>
+
+#include "gfx/panel_mem.h"
+
+/* Controller RAM as addressed with the app's MADCTL (landscape). */
+#define LCD_EMUL_MEM_W 320
+#define LCD_EMUL_MEM_H 240
+
+struct lcd_emul_cfg {
+    struct gpio_dt_spec dc;
+};
+
+struct lcd_emul_data {
+    gfx_panel_mem_t panel;
+    gfx_bus_t bus;
+    uint16_t mem[LCD_EMUL_MEM_W * LCD_EMUL_MEM_H];
+};
+
+static int lcd_emul_io(const struct emul *target, const struct spi_config *config,
+                       const struct spi_buf_set *tx_bufs, const struct spi_buf_set *rx_bufs) {
+    ARG_UNUSED(rx_bufs);
+    const struct lcd_emul_cfg *cfg = target->cfg;
+    struct lcd_emul_data *data = target->data;
+
+    if (!tx_bufs) {
+        return 0;
+    }
+
+    bool is_data = gpio_emul_output_get(cfg->dc.port, cfg->dc.pin) > 0;
+    bool wide = SPI_WORD_SIZE_GET(config->operation) == 16;
+    for (size_t i = 0; i < tx_bufs->count; ++i) {
+        const struct spi_buf *b = &tx_bufs->buffers[i];
+        const uint8_t *bytes = b->buf;
+        if (!bytes) {
+            continue;
+        }
+        if (!is_data) {
+            for (size_t j = 0; j < b->len; ++j) {
+                data->bus.write_cmd(data->bus.ctx, bytes[j]);
+            }
+        } else if (!wide) {
+            data->bus.write_data(data->bus.ctx, bytes, b->len);
+        } else {
+            /* 16-bit frames go out MSB first whatever the memory byte order. */
+            const uint16_t *words = b->buf;
+            for (size_t j = 0; j < b->len / 2; ++j) {
+                uint8_t be[2] = { (uint8_t)(words[j] >> 8), (uint8_t)(words[j] & 0xFF) };
+                data->bus.write_data(data->bus.ctx, be, sizeof(be));
+            }
+        }
+    }
+    return 0;
+}
+
+static const struct spi_emul_api lcd_emul_api = {
+    .io = lcd_emul_io,
+};
+
+static int lcd_emul_init(const struct emul *target, const struct device *parent) {
+    ARG_UNUSED(parent);
+    struct lcd_emul_data *data = target->data;
+
+    gfx_panel_mem_init(&data->panel, data->mem, LCD_EMUL_MEM_W, LCD_EMUL_MEM_H);
+    data->bus = gfx_panel_mem_bus(&data->panel);
+    return 0;
+}
+
+#define LCD_EMUL(n)                                                                  \
+    static struct lcd_emul_data lcd_emul_data_##n;                                   \
+    static const struct lcd_emul_cfg lcd_emul_cfg_##n = {                            \
+        .dc = GPIO_DT_SPEC_INST_GET(n, dc_gpios),                                    \
+    };                                                                               \
+    EMUL_DT_INST_DEFINE(n, lcd_emul_init, &lcd_emul_data_##n, &lcd_emul_cfg_##n,     \
+                        &lcd_emul_api, NULL)
+
+DT_INST_FOREACH_STATUS_OKAY(LCD_EMUL)
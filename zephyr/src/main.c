@@ -1,12 +1,31 @@
+#include <errno.h>
 #include <stdbool.h>
 #include <stdint.h>
+#include <stdio.h>
+#include <string.h>
 #include <zephyr/device.h>
 #include <zephyr/devicetree.h>
 #include <zephyr/drivers/gpio.h>
+#include <zephyr/drivers/spi.h>
 #include <zephyr/kernel.h>
 #include <zephyr/logging/log.h>
+#include <zephyr/logging/log_backend.h>
+#include <zephyr/logging/log_output.h>
+#include <zephyr/spinlock.h>
+#include <zephyr/sys/ring_buffer.h>
 #include <zephyr/sys/util.h>
 
+#include "gfx/assets.h"
+#include "gfx/console.h"
+#include "gfx/dlist.h"
+#include "gfx/fb.h"
+#include "gfx/font.h"
+#include "gfx/pace.h"
+#include "gfx/perf.h"
+#include "gfx/shade.h"
+#include "gfx/st7789.h"
+#include "gfx/text.h"
+
 LOG_MODULE_REGISTER(rp2350_geek_demo, LOG_LEVEL_INF);
 
 #define HEARTBEAT_MS 5000
@@ -30,306 +49,632 @@ LOG_MODULE_REGISTER(rp2350_geek_demo, LOG_LEVEL_INF);
 #define LCD_MADCTL LCD_MADCTL_BASE
 #endif
 
-/* GPIO pins for the on-board LCD (SPI1 wiring). */
-#define LCD_PIN_SCK 10
-#define LCD_PIN_MOSI 11
-#define LCD_PIN_CS 9
-#define LCD_PIN_DC 8
-#define LCD_PIN_RST 12
-#define LCD_PIN_BL 13
+/* The LCD node (SPI1, DC/RST/BL pins) comes from the board overlay; on
+ * native_sim it sits on an SPI emulator backed by a memory panel. */
+#define LCD_NODE DT_NODELABEL(lcd)
+#define LCD_SPI_OP (SPI_OP_MODE_MASTER | SPI_WORD_SET(8) | SPI_TRANSFER_MSB)
 
-static const struct device *const gpio_dev = DEVICE_DT_GET(DT_NODELABEL(gpio0));
+static const struct spi_dt_spec lcd_spi = SPI_DT_SPEC_GET(LCD_NODE, LCD_SPI_OP, 0);
+static const struct gpio_dt_spec lcd_dc_pin = GPIO_DT_SPEC_GET(LCD_NODE, dc_gpios);
+static const struct gpio_dt_spec lcd_rst_pin = GPIO_DT_SPEC_GET_OR(LCD_NODE, reset_gpios, {0});
+static const struct gpio_dt_spec lcd_bl_pin = GPIO_DT_SPEC_GET_OR(LCD_NODE, backlight_gpios, {0});
+static const struct gpio_dt_spec lcd_te_pin = GPIO_DT_SPEC_GET_OR(LCD_NODE, te_gpios, {0});
 static const struct gpio_dt_spec led = GPIO_DT_SPEC_GET_OR(DT_ALIAS(led0), gpios, {0});
 
-static uint16_t lcd_fb[LCD_WIDTH * LCD_HEIGHT];
+/* LCD_STRIP_LINES=N renders pages N lines at a time into two frame-wide
+ * strips instead of a full framebuffer; the next strip is drawn while the
+ * previous one's pixels are DMAed. 0 keeps the whole frame. */
+#ifndef LCD_STRIP_LINES
+#define LCD_STRIP_LINES 0
+#endif
+#if LCD_STRIP_LINES
+#define LCD_FB_COUNT 2
+#define LCD_FB_LINES LCD_STRIP_LINES
+#else
+#define LCD_FB_COUNT 1
+#define LCD_FB_LINES LCD_HEIGHT
+#endif
+
+static gfx_pixel_t lcd_fb[LCD_FB_COUNT][GFX_FB_LEN(LCD_WIDTH, LCD_FB_LINES)];
+static gfx_fb_t lcd_frames[LCD_FB_COUNT];
 
-static inline uint16_t rgb565(uint8_t r, uint8_t g, uint8_t b) {
-    return (uint16_t)(((r & 0xF8u) << 8) | ((g & 0xFCu) << 3) | (b >> 3));
-}
+/* Frames are flushed on a fixed grid of panel refreshes (gfx/pace.h): every
+ * LCD_REFRESH_HZ / LCD_FRAME_HZ-th pulse of the panel's TE line when the
+ * devicetree gives te-gpios, otherwise of a k_timer at LCD_REFRESH_HZ. A
+ * frame that misses its slot waits for the next one instead of going out
+ * late. */
+#ifndef LCD_FRAME_HZ
+#define LCD_FRAME_HZ 30
+#endif
+#define LCD_REFRESH_HZ 60 /* the controller's power-on frame rate */
+
+/* Pixel windows go out with 16-bit SPI frames when the framebuffer is in
+ * native order: the controller shifts each frame MSB first, which is exactly
+ * the panel's byte order, so no staging copy is needed in either mode. */
+static struct spi_config lcd_pixel_cfg;
+
+#if !GFX_FB_INDEXED
+/* One buffer per window row; a full-width window is a single buffer. */
+static struct spi_buf lcd_tx_bufs[LCD_HEIGHT];
+#endif
+
+/* Available while no pixel transfer is in flight. */
+static K_SEM_DEFINE(lcd_tx_idle, 1, 1);
+
+static uint32_t lcd_flush_started;
+static uint32_t lcd_flush_px;
+static volatile uint32_t lcd_last_flush_us;
+static volatile uint32_t lcd_last_flush_px;
+static volatile uint32_t lcd_last_render_us;
+
+/* Render and flush durations (gfx/perf.h), in CPU cycles on the target.
+ * Flushes are recorded from the SPI completion callback, so both stages sit
+ * behind a spinlock. LCD_PERF_OVERLAY=1 also draws the last summary into the
+ * top-right corner of every frame. */
+#ifndef LCD_PERF_OVERLAY
+#define LCD_PERF_OVERLAY 0
+#endif
+#if LCD_STRIP_LINES && LCD_PERF_OVERLAY
+#error "LCD_PERF_OVERLAY draws into a whole frame; build it with LCD_STRIP_LINES=0"
+#endif
+
+static struct k_spinlock lcd_perf_lock;
+static gfx_perf_stage_t lcd_perf_render, lcd_perf_flush;
+#if LCD_PERF_OVERLAY
+static char lcd_perf_overlay[2][28]; /* "rnd avg/p99us" */
+#endif
+
+#if defined(CONFIG_BOARD_NATIVE_SIM)
+/* Simulated time stands still while code runs, so native_sim times stages
+ * with the host's monotonic clock (src/host_clock_bottom.c); CMakeLists.txt
+ * builds the library with GFX_PERF_CLOCK_EXTERN for it. */
+extern uint64_t lcd_host_time_ns(void);
 
-static inline void lcd_gpio_set(uint32_t pin, int value) {
-    gpio_pin_set(gpio_dev, pin, value);
+uint64_t gfx_perf_clock_ns(void) {
+    return lcd_host_time_ns();
 }
+#endif
 
-static void lcd_bb_write_byte(uint8_t byte) {
-    for (int i = 7; i >= 0; --i) {
-        lcd_gpio_set(LCD_PIN_MOSI, (byte >> i) & 0x01u);
-        lcd_gpio_set(LCD_PIN_SCK, 1);
-        lcd_gpio_set(LCD_PIN_SCK, 0);
-    }
+static void lcd_perf_add(gfx_perf_stage_t *stage, uint32_t ticks, uint32_t units) {
+    k_spinlock_key_t key = k_spin_lock(&lcd_perf_lock);
+    gfx_perf_record(stage, ticks, units);
+    k_spin_unlock(&lcd_perf_lock, key);
 }
 
-static void lcd_write_bytes(const uint8_t *data, size_t len) {
-    for (size_t i = 0; i < len; ++i) {
-        lcd_bb_write_byte(data[i]);
+static void lcd_flush_done(uint32_t px) {
+    uint32_t ticks = gfx_perf_now() - lcd_flush_started;
+    lcd_last_flush_us = gfx_perf_us(ticks);
+    lcd_last_flush_px = px;
+    if (px) {
+        lcd_perf_add(&lcd_perf_flush, ticks, px * 2);
     }
 }
 
-static inline void lcd_cs(bool level) { lcd_gpio_set(LCD_PIN_CS, level); }
-static inline void lcd_dc(bool level) { lcd_gpio_set(LCD_PIN_DC, level); }
-
 static void lcd_write_cmd(uint8_t cmd) {
-    lcd_cs(0);
-    lcd_dc(0);
-    lcd_write_bytes(&cmd, 1);
-    lcd_cs(1);
+    struct spi_buf buf = { .buf = &cmd, .len = 1 };
+    struct spi_buf_set tx = { .buffers = &buf, .count = 1 };
+    gpio_pin_set_dt(&lcd_dc_pin, 0);
+    spi_write_dt(&lcd_spi, &tx);
 }
 
 static void lcd_write_data(const uint8_t *data, size_t len) {
-    lcd_cs(0);
-    lcd_dc(1);
-    lcd_write_bytes(data, len);
-    lcd_cs(1);
+    struct spi_buf buf = { .buf = (void *)data, .len = len };
+    struct spi_buf_set tx = { .buffers = &buf, .count = 1 };
+    gpio_pin_set_dt(&lcd_dc_pin, 1);
+    spi_write_dt(&lcd_spi, &tx);
 }
 
-static void lcd_set_addr_window(uint16_t x, uint16_t y, uint16_t w, uint16_t h) {
-    uint16_t x0 = x + LCD_X_OFFSET;
-    uint16_t x1 = x0 + w - 1;
-    uint16_t y0 = y + LCD_Y_OFFSET;
-    uint16_t y1 = y0 + h - 1;
+static void lcd_bus_write_cmd(void *ctx, uint8_t cmd) {
+    ARG_UNUSED(ctx);
+    lcd_write_cmd(cmd);
+}
 
-    uint8_t caset[] = {
-        (uint8_t)(x0 >> 8), (uint8_t)(x0 & 0xFF),
-        (uint8_t)(x1 >> 8), (uint8_t)(x1 & 0xFF)
-    };
-    uint8_t raset[] = {
-        (uint8_t)(y0 >> 8), (uint8_t)(y0 & 0xFF),
-        (uint8_t)(y1 >> 8), (uint8_t)(y1 & 0xFF)
-    };
+static void lcd_bus_write_data(void *ctx, const uint8_t *data, size_t len) {
+    ARG_UNUSED(ctx);
+    lcd_write_data(data, len);
+}
 
-    lcd_write_cmd(0x2A);
-    lcd_write_data(caset, sizeof(caset));
-    lcd_write_cmd(0x2B);
-    lcd_write_data(raset, sizeof(raset));
-    lcd_write_cmd(0x2C);
+static void lcd_bus_delay_ms(void *ctx, uint32_t ms) {
+    ARG_UNUSED(ctx);
+    k_msleep(ms);
 }
 
+static const gfx_bus_t lcd_bus = {
+    .write_cmd = lcd_bus_write_cmd,
+    .write_data = lcd_bus_write_data,
+    .delay_ms = lcd_bus_delay_ms,
+};
+
+static const st7789_config_t lcd_panel = {
+    .width = LCD_WIDTH,
+    .height = LCD_HEIGHT,
+    .x_offset = LCD_X_OFFSET,
+    .y_offset = LCD_Y_OFFSET,
+    .madctl = LCD_MADCTL,
+    .invert = true,
+    .tear_sync = DT_NODE_HAS_PROP(LCD_NODE, te_gpios),
+};
+
 static void lcd_reset_panel(void) {
-    lcd_gpio_set(LCD_PIN_RST, 0);
+    if (!lcd_rst_pin.port) {
+        return;
+    }
+    gpio_pin_set_dt(&lcd_rst_pin, 1); /* active-low line: assert reset */
     k_msleep(20);
-    lcd_gpio_set(LCD_PIN_RST, 1);
+    gpio_pin_set_dt(&lcd_rst_pin, 0);
     k_msleep(120);
 }
 
 static void lcd_init_panel(void) {
-    /* Control pins */
-    gpio_pin_configure(gpio_dev, LCD_PIN_CS, GPIO_OUTPUT_HIGH);
-    gpio_pin_configure(gpio_dev, LCD_PIN_DC, GPIO_OUTPUT_HIGH);
-    gpio_pin_configure(gpio_dev, LCD_PIN_RST, GPIO_OUTPUT_HIGH);
-    gpio_pin_configure(gpio_dev, LCD_PIN_BL, GPIO_OUTPUT_LOW);
-
-    /* Bit-bang SPI pins */
-    gpio_pin_configure(gpio_dev, LCD_PIN_SCK, GPIO_OUTPUT_LOW);
-    gpio_pin_configure(gpio_dev, LCD_PIN_MOSI, GPIO_OUTPUT_LOW);
+    for (int i = 0; i < LCD_FB_COUNT; ++i) {
+        gfx_fb_init(&lcd_frames[i], lcd_fb[i], LCD_WIDTH, LCD_FB_LINES);
+    }
+    fb_bind(&lcd_frames[0]);
 
-    lcd_reset_panel();
+    lcd_pixel_cfg = lcd_spi.config;
+#if !GFX_FB_WIRE_ORDER
+    lcd_pixel_cfg.operation = (lcd_pixel_cfg.operation & ~SPI_WORD_SIZE_MASK) | SPI_WORD_SET(16);
+#endif
 
-    lcd_write_cmd(0x36); /* MADCTL */
-    uint8_t madctl = LCD_MADCTL;
-    lcd_write_data(&madctl, 1);
+    gpio_pin_configure_dt(&lcd_dc_pin, GPIO_OUTPUT_ACTIVE);
+    if (lcd_rst_pin.port) {
+        gpio_pin_configure_dt(&lcd_rst_pin, GPIO_OUTPUT_INACTIVE);
+    }
+    if (lcd_bl_pin.port) {
+        gpio_pin_configure_dt(&lcd_bl_pin, GPIO_OUTPUT_INACTIVE);
+    }
 
-    lcd_write_cmd(0x3A); /* COLMOD */
-    uint8_t colmod = 0x55; /* 16-bit */
-    lcd_write_data(&colmod, 1);
+    lcd_reset_panel();
 
-    lcd_write_cmd(0x21); /* INVON */
-    lcd_write_cmd(0x11); /* SLPOUT */
-    k_msleep(120);
+    st7789_init(&lcd_bus, &lcd_panel);
 
-    lcd_set_addr_window(0, 0, LCD_WIDTH, LCD_HEIGHT);
-    lcd_write_cmd(0x29); /* DISPON */
+    if (lcd_bl_pin.port) {
+        gpio_pin_set_dt(&lcd_bl_pin, 1);
+    }
+}
 
-    lcd_gpio_set(LCD_PIN_BL, 1);
+#if !GFX_FB_INDEXED
+/* Completion of one window's pixels; data is non-NULL for the flush's last window. */
+static void lcd_pixels_done(const struct device *dev, int result, void *data) {
+    ARG_UNUSED(dev);
+    if (result < 0) {
+        LOG_ERR("lcd pixel transfer failed (%d)", result);
+    }
+    if (data) {
+        lcd_flush_done(lcd_flush_px);
+    }
+    k_sem_give(&lcd_tx_idle);
 }
 
-static void lcd_flush_framebuffer(void) {
-    lcd_set_addr_window(0, 0, LCD_WIDTH, LCD_HEIGHT);
-    lcd_cs(0);
-    lcd_dc(1);
+/* Starts a window's pixels after RAMWR; lcd_tx_idle is held until they are out. */
+static void lcd_write_window(const gfx_fb_t *frame, const gfx_rect_t *r, bool last) {
+    uint16_t w = (uint16_t)(r->x1 - r->x0);
+    uint16_t h = (uint16_t)(r->y1 - r->y0);
+    const uint16_t *row = &frame->pixels[r->y0 * frame->stride + r->x0];
+    struct spi_buf_set tx = { .buffers = lcd_tx_bufs };
 
-    const size_t total = LCD_WIDTH * LCD_HEIGHT;
-    uint8_t chunk[256];
-    size_t sent = 0;
-    while (sent < total) {
-        size_t px = MIN(total - sent, (size_t)128);
-        for (size_t i = 0; i < px; i++) {
-            uint16_t c = lcd_fb[sent + i];
-            chunk[2 * i] = (uint8_t)(c >> 8);
-            chunk[2 * i + 1] = (uint8_t)(c & 0xFF);
+    if (w == frame->stride) {
+        lcd_tx_bufs[0] = (struct spi_buf){ .buf = (void *)row, .len = (size_t)w * h * sizeof(uint16_t) };
+        tx.count = 1;
+    } else {
+        for (uint16_t y = 0; y < h; ++y, row += frame->stride) {
+            lcd_tx_bufs[y] = (struct spi_buf){ .buf = (void *)row, .len = (size_t)w * sizeof(uint16_t) };
         }
-        lcd_write_bytes(chunk, px * 2);
-        sent += px;
+        tx.count = h;
     }
+    lcd_flush_px += (uint32_t)w * h;
 
-    lcd_cs(1);
+    gpio_pin_set_dt(&lcd_dc_pin, 1);
+    void *user = last ? (void *)frame : NULL;
+    int ret = -ENOTSUP;
+#if defined(CONFIG_SPI_ASYNC)
+    ret = spi_transceive_cb(lcd_spi.bus, &lcd_pixel_cfg, &tx, NULL, lcd_pixels_done, user);
+#endif
+    if (ret == -ENOTSUP) {
+        /* Controller without async support (e.g. the native_sim emulator). */
+        ret = spi_write(lcd_spi.bus, &lcd_pixel_cfg, &tx);
+        lcd_pixels_done(lcd_spi.bus, ret, user);
+    } else if (ret < 0) {
+        lcd_pixels_done(lcd_spi.bus, ret, user);
+    }
 }
+#endif
 
-static inline void fb_set_pixel(int x, int y, uint16_t color) {
-    if ((unsigned)x < LCD_WIDTH && (unsigned)y < LCD_HEIGHT) {
-        lcd_fb[y * LCD_WIDTH + x] = color;
-    }
+/* Blocks until the last pixel transfer has released lcd_fb. */
+static void lcd_flush_wait(void) {
+    k_sem_take(&lcd_tx_idle, K_FOREVER);
+    k_sem_give(&lcd_tx_idle);
 }
 
-static void fb_clear(uint16_t color) {
-    for (size_t i = 0; i < LCD_WIDTH * LCD_HEIGHT; ++i) {
-        lcd_fb[i] = color;
+/* Pushes only the windows the fb_* primitives marked since the last flush,
+ * with the frame's row 0 at panel row origin_y (non-zero for strips). Each
+ * window's pixels are DMAed while this thread waits on a semaphore, and the
+ * final window is still in flight when this returns. An indexed framebuffer
+ * (RP2350_GEEK_GFX_BPP=8/4) is looked up in its palette by the library's
+ * blocking flush instead. */
+static void lcd_flush_frame(gfx_fb_t *frame, int origin_y) {
+    lcd_flush_wait();
+    lcd_flush_started = gfx_perf_now();
+    lcd_flush_px = 0;
+#if GFX_FB_INDEXED
+    st7789_config_t panel = lcd_panel;
+    panel.y_offset = (uint16_t)(panel.y_offset + origin_y);
+    lcd_flush_done((uint32_t)st7789_flush_dirty(&lcd_bus, &panel, frame));
+#else
+    for (uint8_t i = 0; i < frame->dirty_count; ++i) {
+        k_sem_take(&lcd_tx_idle, K_FOREVER);
+        const gfx_rect_t *r = &frame->dirty[i];
+        st7789_set_window(&lcd_bus, &lcd_panel, (uint16_t)r->x0, (uint16_t)(r->y0 + origin_y),
+                          (uint16_t)(r->x1 - r->x0), (uint16_t)(r->y1 - r->y0));
+        lcd_write_window(frame, r, i + 1 == frame->dirty_count);
     }
+    frame->dirty_count = 0;
+#endif
 }
 
-static void fb_draw_rect(int x, int y, int w, int h, uint16_t color) {
-    for (int iy = 0; iy < h; ++iy) {
-        int yy = y + iy;
-        if (yy < 0 || yy >= LCD_HEIGHT) continue;
-        for (int ix = 0; ix < w; ++ix) {
-            int xx = x + ix;
-            if (xx < 0 || xx >= LCD_WIDTH) continue;
-            fb_set_pixel(xx, yy, color);
-        }
+static gfx_pacer_t lcd_pacer;
+static K_SEM_DEFINE(lcd_slot_sem, 0, 1);
+
+static inline uint64_t lcd_pace_now_us(void) {
+    return k_ticks_to_us_floor64(k_uptime_ticks());
+}
+
+/* ISR context: one panel refresh. At a frame slot with the bus idle, the
+ * waiting frame is released to flush. */
+static void lcd_vsync(void) {
+    if (gfx_pacer_tick(&lcd_pacer, lcd_pace_now_us(), k_sem_count_get(&lcd_tx_idle) > 0)) {
+        k_sem_give(&lcd_slot_sem);
     }
 }
 
-static const uint8_t font5x7[96][5] = {
-#include "font5x7.inc"
-};
+static void lcd_te_isr(const struct device *dev, struct gpio_callback *cb, uint32_t pins) {
+    ARG_UNUSED(dev);
+    ARG_UNUSED(cb);
+    ARG_UNUSED(pins);
+    lcd_vsync();
+}
 
-static void fb_draw_char(int x, int y, char c, uint16_t fg, uint16_t bg) {
-    if (c < 32 || c > 127) c = '?';
-    const uint8_t *glyph = font5x7[c - 32];
-    for (int row = 0; row < 7; ++row) {
-        for (int col = 0; col < 5; ++col) {
-            bool on = (glyph[col] >> row) & 0x01;
-            fb_set_pixel(x + col, y + row, on ? fg : bg);
-        }
-        fb_set_pixel(x + 5, y + row, bg);
-    }
+static void lcd_refresh_expiry(struct k_timer *timer) {
+    ARG_UNUSED(timer);
+    lcd_vsync();
 }
 
-static void fb_draw_text(int x, int y, const char *text, uint16_t fg, uint16_t bg) {
-    int cursor_x = x;
-    while (*text) {
-        if (*text == '\n') {
-            y += 8;
-            cursor_x = x;
-            text++;
-            continue;
-        }
-        fb_draw_char(cursor_x, y, *text, fg, bg);
-        cursor_x += 6;
-        text++;
+static K_TIMER_DEFINE(lcd_refresh_timer, lcd_refresh_expiry, NULL);
+static struct gpio_callback lcd_te_cb;
+
+static void lcd_pace_start(void) {
+    gfx_pacer_init(&lcd_pacer, LCD_REFRESH_HZ / LCD_FRAME_HZ);
+    if (lcd_te_pin.port) {
+        gpio_pin_configure_dt(&lcd_te_pin, GPIO_INPUT);
+        gpio_init_callback(&lcd_te_cb, lcd_te_isr, BIT(lcd_te_pin.pin));
+        gpio_add_callback(lcd_te_pin.port, &lcd_te_cb);
+        gpio_pin_interrupt_configure_dt(&lcd_te_pin, GPIO_INT_EDGE_TO_ACTIVE);
+    } else {
+        k_timer_start(&lcd_refresh_timer, K_USEC(1000000 / LCD_REFRESH_HZ), K_USEC(1000000 / LCD_REFRESH_HZ));
     }
 }
 
-static void fb_draw_char_2x(int x, int y, char c, uint16_t fg, uint16_t bg) {
-    if (c < 32 || c > 127) c = '?';
-    const uint8_t *glyph = font5x7[c - 32];
-    for (int row = 0; row < 7; ++row) {
-        for (int col = 0; col < 5; ++col) {
-            bool on = (glyph[col] >> row) & 0x01;
-            uint16_t color = on ? fg : bg;
-            fb_draw_rect(x + col * 2, y + row * 2, 2, 2, color);
-        }
-        fb_draw_rect(x + 10, y + row * 2, 2, 2, bg);
-    }
+/* Holds the LCD thread until the slot for the frame begun with
+ * gfx_pacer_begin(). */
+static void lcd_wait_slot(void) {
+    gfx_pacer_submit(&lcd_pacer, lcd_pace_now_us());
+    k_sem_take(&lcd_slot_sem, K_FOREVER);
 }
 
-static void fb_draw_text_2x(int x, int y, const char *text, uint16_t fg, uint16_t bg) {
-    int cursor_x = x;
-    while (*text) {
-        if (*text == '\n') {
-            y += 16;
-            cursor_x = x;
-            text++;
-            continue;
-        }
-        fb_draw_char_2x(cursor_x, y, *text, fg, bg);
-        cursor_x += 12;
-        text++;
-    }
+#if LCD_STRIP_LINES
+static void lcd_strip_send(void *ctx, gfx_fb_t *strip, int y, bool last) {
+    ARG_UNUSED(ctx);
+    ARG_UNUSED(last);
+    lcd_flush_frame(strip, y);
 }
 
-static void fb_draw_icon16(int x, int y, const uint8_t *pixels, const uint16_t *palette) {
-    for (int iy = 0; iy < 16; ++iy) {
-        for (int ix = 0; ix < 16; ++ix) {
-            uint8_t idx = pixels[iy * 16 + ix];
-            fb_set_pixel(x + ix, y + iy, palette[idx]);
-        }
-    }
+static void lcd_strip_wait(void *ctx) {
+    ARG_UNUSED(ctx);
+    lcd_flush_wait();
 }
 
-static const uint8_t heart_icon[16 * 16] = {
-#include "heart_icon.inc"
-};
+static const gfx_strip_sink_t lcd_strip_sink = { lcd_strip_send, lcd_strip_wait, NULL };
+#endif
 
-static const uint16_t heart_palette[4] = {
-    0x5294, /* rgb565(10,10,20) */
-    0xFAD7, /* rgb565(255,120,120) */
-    0xF9B2, /* rgb565(255,70,70) */
-    0xE984, /* rgb565(200,20,20) */
-};
+/* Records a render begun at start (in strip mode, render and send together)
+ * and puts the overlay on top, outside the measured time. */
+static void lcd_render_done(uint32_t start) {
+    uint32_t ticks = gfx_perf_now() - start;
+    lcd_last_render_us = gfx_perf_us(ticks);
+    lcd_perf_add(&lcd_perf_render, ticks, 0);
+#if LCD_PERF_OVERLAY
+    uint16_t fg = rgb565(255, 255, 0), bg = rgb565(0, 0, 0);
+    int x = LCD_WIDTH - (int)strlen(lcd_perf_overlay[0]) * 6;
+    fb_draw_text(x, 0, lcd_perf_overlay[0], fg, bg);
+    fb_draw_text(x, 8, lcd_perf_overlay[1], fg, bg);
+#endif
+}
 
-static const uint16_t gif_palette[3] = {
-    0x0000,
-    0x57BF, /* rgb565(80,220,255) */
-    0xFFFF,
-};
+/* Logs the render and flush times since the last report and, with the
+ * overlay, keeps their averages and p99s for the following frames. */
+static void lcd_perf_report(void) {
+    gfx_perf_stage_t render, flush;
+    k_spinlock_key_t key = k_spin_lock(&lcd_perf_lock);
+    gfx_perf_take(&lcd_perf_render, &render);
+    gfx_perf_take(&lcd_perf_flush, &flush);
+    k_spin_unlock(&lcd_perf_lock, key);
+
+    gfx_perf_summary_t r, f;
+    gfx_perf_summarize(&render, &r);
+    gfx_perf_summarize(&flush, &f);
+    LOG_INF("perf render n=%u min/avg/p99/max=%u/%u/%u/%uus", r.count, r.min_us, r.avg_us, r.p99_us, r.max_us);
+    LOG_INF("perf flush n=%u min/avg/p99/max=%u/%u/%u/%uus %u.%02uMB/s", f.count, f.min_us, f.avg_us, f.p99_us,
+            f.max_us, f.units_per_s / 1000000u, f.units_per_s / 10000u % 100u);
+#if LCD_PERF_OVERLAY
+    snprintf(lcd_perf_overlay[0], sizeof(lcd_perf_overlay[0]), "rnd %5u/%5uus", r.avg_us, r.p99_us);
+    snprintf(lcd_perf_overlay[1], sizeof(lcd_perf_overlay[1]), "spi %5u/%5uus", f.avg_us, f.p99_us);
+#endif
+}
 
-static const uint8_t gif_frames[3][12 * 12] = {
-#include "gif_frames.inc"
-};
+/* Renders and flushes area of a page (NULL for all of it); only that area is
+ * redrawn and sent. */
+static void lcd_show(const gfx_dlist_t *dl, const gfx_rect_t *area) {
+    gfx_pacer_begin(&lcd_pacer, lcd_pace_now_us());
+#if LCD_STRIP_LINES
+    lcd_wait_slot();
+    uint32_t start = gfx_perf_now();
+    gfx_dl_render_strips(dl, lcd_frames, LCD_HEIGHT, area, &lcd_strip_sink);
+    lcd_render_done(start);
+#else
+    lcd_flush_wait();
+    uint32_t start = gfx_perf_now();
+    gfx_dl_render_area(dl, area);
+    lcd_render_done(start);
+    lcd_wait_slot();
+    lcd_flush_frame(&lcd_frames[0], 0);
+#endif
+}
+
+/* Redraws and flushes only what the gfx_dl_set_*() calls changed. */
+static void lcd_update(gfx_dlist_t *dl) {
+    if (!dl->damage_count) {
+        return;
+    }
+    gfx_pacer_begin(&lcd_pacer, lcd_pace_now_us());
+#if LCD_STRIP_LINES
+    lcd_wait_slot();
+    uint32_t start = gfx_perf_now();
+    gfx_dl_render_damage_strips(dl, lcd_frames, LCD_HEIGHT, &lcd_strip_sink);
+    lcd_render_done(start);
+#else
+    lcd_flush_wait();
+    uint32_t start = gfx_perf_now();
+    gfx_dl_render_damage(dl);
+    lcd_render_done(start);
+    lcd_wait_slot();
+    lcd_flush_frame(&lcd_frames[0], 0);
+#endif
+}
+
+/* Pages are display lists, so the same description is drawn into the whole
+ * frame or replayed strip by strip. */
+static gfx_dlist_t lcd_page_dl;
 
 static void render_text_page(void) {
+    gfx_dlist_t *dl = &lcd_page_dl;
     uint16_t bg = rgb565(8, 16, 32);
-    fb_clear(bg);
-    fb_draw_text_2x(8, 10, "RP2350-GEEK", rgb565(255, 215, 64), bg);
-    fb_draw_text_2x(8, 34, "Zephyr LCD demo", rgb565(200, 240, 255), bg);
-    fb_draw_text_2x(8, 58, "Heartbeat+pages", rgb565(180, 255, 200), bg);
-    fb_draw_text_2x(8, 82, "UART0@115200", rgb565(180, 180, 255), bg);
+    gfx_dl_reset(dl);
+    gfx_dl_clear(dl, bg);
+    gfx_dl_text(dl, 8, 10, "RP2350-GEEK", rgb565(255, 215, 64), bg, 2);
+    gfx_dl_label(dl, 8, 34, &sans16, "Zephyr LCD demo", rgb565(200, 240, 255));
+    gfx_dl_label(dl, 8, 54, &sans16, "Heartbeat+pages", rgb565(180, 255, 200));
+    gfx_dl_label(dl, 8, 74, &sans16, "UART0@115200", rgb565(180, 180, 255));
+    gfx_dl_label(dl, 8, 104, &sans11, "Anti-aliased text: 4-bit 16 px, 2-bit 11 px", rgb565(140, 160, 190));
+    lcd_show(dl, NULL);
+}
+
+/* The gradient is laid out over the whole panel; (ox, oy) is where the
+ * current view (a strip or damaged area) sits in it. */
+static void draw_gradient(int ox, int oy, void *user) {
+    ARG_UNUSED(user);
+    gfx_gradient_t g = {
+        .r = gfx_ramp(0, 255, 1, 0, LCD_WIDTH),
+        .g = gfx_ramp(0, 255, 0, 1, LCD_HEIGHT),
+        .b = gfx_ramp(0, 255, 1, 1, LCD_WIDTH + LCD_HEIGHT),
+        .x0 = (int16_t)-ox,
+        .y0 = (int16_t)-oy,
+    };
+    fb_fill_gradient(0, 0, fb_target->width, fb_target->height, &g);
 }
 
 static void render_gradient_page(void) {
-    for (int y = 0; y < LCD_HEIGHT; ++y) {
-        for (int x = 0; x < LCD_WIDTH; ++x) {
-            uint8_t r = (uint8_t)((x * 255) / LCD_WIDTH);
-            uint8_t g = (uint8_t)((y * 255) / LCD_HEIGHT);
-            uint8_t b = (uint8_t)(((x + y) * 255) / (LCD_WIDTH + LCD_HEIGHT));
-            lcd_fb[y * LCD_WIDTH + x] = rgb565(r, g, b);
-        }
-    }
-    fb_draw_rect(12, 12, LCD_WIDTH - 24, LCD_HEIGHT - 24, rgb565(0, 0, 0));
-    fb_draw_rect(14, 14, LCD_WIDTH - 28, LCD_HEIGHT - 28, rgb565(255, 255, 255));
-    fb_draw_text_2x(20, 18, "Gradient + frame", rgb565(0, 0, 0), rgb565(255, 255, 255));
+    gfx_dlist_t *dl = &lcd_page_dl;
+    gfx_dl_reset(dl);
+    gfx_dl_custom(dl, 0, 0, LCD_WIDTH, LCD_HEIGHT, draw_gradient, NULL);
+    gfx_dl_rect(dl, 12, 12, LCD_WIDTH - 24, LCD_HEIGHT - 24, rgb565(0, 0, 0));
+    gfx_dl_rect(dl, 14, 14, LCD_WIDTH - 28, LCD_HEIGHT - 28, rgb565(255, 255, 255));
+    gfx_dl_text(dl, 20, 18, "Gradient + frame", rgb565(0, 0, 0), rgb565(255, 255, 255), 2);
+    lcd_show(dl, NULL);
 }
 
 static void render_icon_page(void) {
-    fb_clear(rgb565(12, 12, 18));
-    fb_draw_text_2x(12, 12, "Icon demo", rgb565(220, 220, 255), rgb565(12, 12, 18));
-    fb_draw_icon16((LCD_WIDTH - 16) / 2, (LCD_HEIGHT - 16) / 2, heart_icon, heart_palette);
+    gfx_dlist_t *dl = &lcd_page_dl;
+    gfx_dl_reset(dl);
+    gfx_dl_clear(dl, rgb565(12, 12, 18));
+    gfx_dl_text(dl, 12, 12, "Icon demo", rgb565(220, 220, 255), rgb565(12, 12, 18), 2);
+    gfx_dl_sheet(dl, (LCD_WIDTH - HEART_W) / 2, (LCD_HEIGHT - HEART_H) / 2, &heart_sheet, 0, GFX_SHEET_OPAQUE);
+    lcd_show(dl, NULL);
 }
 
+/* The pulse loops on gif_timeline while the page is shown; each step only
+ * changes the pulse node, so only its 12x12 window is redrawn and sent. */
+static struct {
+    gfx_anim_t anim;
+    gfx_dl_op_t *pulse;
+} lcd_gif;
+
 static void render_gif_page(void) {
-    fb_clear(rgb565(0, 0, 0));
-    fb_draw_text_2x(8, 8, "GIF-ish pulse", rgb565(120, 220, 255), rgb565(0, 0, 0));
-    int origin_x = (LCD_WIDTH - 12) / 2;
-    int origin_y = (LCD_HEIGHT - 12) / 2;
-    for (int f = 0; f < 3; ++f) {
-        fb_draw_rect(0, 32, LCD_WIDTH, LCD_HEIGHT - 32, rgb565(0, 0, 0));
-        for (int iy = 0; iy < 12; ++iy) {
-            for (int ix = 0; ix < 12; ++ix) {
-                uint8_t idx = gif_frames[f][iy * 12 + ix];
-                fb_set_pixel(origin_x + ix, origin_y + iy, gif_palette[idx]);
+    gfx_dlist_t *dl = &lcd_page_dl;
+    gfx_dl_reset(dl);
+    gfx_dl_clear(dl, rgb565(0, 0, 0));
+    gfx_dl_text(dl, 8, 8, "GIF-ish pulse", rgb565(120, 220, 255), rgb565(0, 0, 0), 2);
+    gfx_anim_start(&lcd_gif.anim, gif_timeline, GIF_TIMELINE_STEPS, true);
+    lcd_gif.pulse = gfx_dl_sheet(dl, (LCD_WIDTH - GIF_W) / 2, (LCD_HEIGHT - GIF_H) / 2, &gif_sheet,
+                                 gfx_anim_frame(&lcd_gif.anim), GFX_SHEET_OPAQUE);
+    lcd_show(dl, NULL);
+}
+
+/* The console page shows the log. A log backend formats each message into
+ * lcd_console_ring and the LCD thread draws it into a framebuffer used as a
+ * ring of text lines, so a new line costs one line of text plus one cleared
+ * line on the wire and the panel's vertical scroll does the rest. The
+ * controller scrolls along frame-memory lines, which with MV set (the
+ * landscape addressing of the other pages) run across the screen, so the
+ * console page clears MV and reads in portrait, 22 columns by 30 lines. */
+#define LCD_CONSOLE_POLL_MS 50
+
+static const st7789_config_t lcd_console_panel = {
+    .width = LCD_HEIGHT,
+    .height = LCD_WIDTH,
+    .x_offset = LCD_Y_OFFSET,
+    .y_offset = LCD_X_OFFSET,
+    .madctl = LCD_MADCTL & ~ST7789_MADCTL_MV,
+    .invert = true,
+};
+
+static gfx_pixel_t lcd_console_pixels[GFX_FB_LEN(LCD_HEIGHT, LCD_WIDTH)];
+static gfx_fb_t lcd_console_fb;
+static gfx_console_t lcd_console;
+static bool lcd_console_shown; /* the panel is in console (portrait, scrolled) mode */
+
+RING_BUF_DECLARE(lcd_console_ring, 1024);
+static struct k_spinlock lcd_console_lock;
+
+/* Runs wherever the message was logged, ISRs included; output that does not
+ * fit is lost to the console only. */
+static int lcd_console_out(uint8_t *data, size_t length, void *ctx) {
+    ARG_UNUSED(ctx);
+    k_spinlock_key_t key = k_spin_lock(&lcd_console_lock);
+    ring_buf_put(&lcd_console_ring, data, length);
+    k_spin_unlock(&lcd_console_lock, key);
+    return (int)length;
+}
+
+static uint8_t lcd_console_fmt[64];
+LOG_OUTPUT_DEFINE(lcd_console_output, lcd_console_out, lcd_console_fmt, sizeof(lcd_console_fmt));
+
+static void lcd_console_process(const struct log_backend *const backend, union log_msg_generic *msg) {
+    ARG_UNUSED(backend);
+    log_output_msg_process(&lcd_console_output, &msg->log, LOG_OUTPUT_FLAG_LEVEL);
+}
+
+static void lcd_console_panic(const struct log_backend *const backend) {
+    ARG_UNUSED(backend);
+}
+
+static const struct log_backend_api lcd_console_api = {
+    .process = lcd_console_process,
+    .panic = lcd_console_panic,
+};
+
+LOG_BACKEND_DEFINE(lcd_console_log, lcd_console_api, true);
+
+static void lcd_console_init(void) {
+    gfx_fb_init(&lcd_console_fb, lcd_console_pixels, LCD_HEIGHT, LCD_WIDTH);
+    gfx_console_init(&lcd_console, &lcd_console_fb, rgb565(140, 230, 140), rgb565(8, 16, 12));
+}
+
+/* Draws what has been logged since the last call. */
+static void lcd_console_drain(void) {
+    uint8_t chunk[64];
+    uint32_t n;
+    do {
+        k_spinlock_key_t key = k_spin_lock(&lcd_console_lock);
+        n = ring_buf_get(&lcd_console_ring, chunk, sizeof(chunk));
+        k_spin_unlock(&lcd_console_lock, key);
+        gfx_console_write(&lcd_console, (const char *)chunk, n);
+    } while (n);
+}
+
+/* Sends the changed lines (blocking) and scrolls the oldest one to the top. */
+static void lcd_console_present(void) {
+    lcd_flush_started = gfx_perf_now();
+    uint32_t px = (uint32_t)st7789_flush_dirty(&lcd_bus, &lcd_console_panel, &lcd_console_fb);
+    st7789_scroll_to(&lcd_bus, &lcd_console_panel, gfx_console_scroll_row(&lcd_console));
+    lcd_flush_done(px);
+}
+
+static void render_console_page(void) {
+    lcd_flush_wait();
+    lcd_console_drain();
+    gfx_fb_t *prev = fb_target;
+    fb_bind(&lcd_console_fb);
+    fb_mark_all_dirty();
+    fb_bind(prev);
+    st7789_scroll_begin(&lcd_bus, &lcd_console_panel);
+    lcd_console_shown = true;
+    lcd_console_present();
+}
+
+/* Puts the panel back into landscape before another page is drawn; the page
+ * overwrites the whole screen. */
+static void lcd_console_leave(void) {
+    if (lcd_console_shown) {
+        st7789_scroll_end(&lcd_bus, &lcd_panel);
+        lcd_console_shown = false;
+    }
+}
+
+/* Advances a live page by elapsed_ms, flushing whatever changed; returns the
+ * ms until it next needs a step (UINT32_MAX for a static page). */
+static uint32_t lcd_page_step(int page, uint32_t elapsed_ms) {
+    switch (page) {
+        case 3:
+            if (gfx_anim_advance(&lcd_gif.anim, elapsed_ms)) {
+                gfx_dl_set_frame(&lcd_page_dl, lcd_gif.pulse, gfx_anim_frame(&lcd_gif.anim));
+                lcd_update(&lcd_page_dl);
             }
-        }
-        lcd_flush_framebuffer();
-        k_msleep(160);
+            return gfx_anim_next_ms(&lcd_gif.anim);
+        case 4:
+            if (elapsed_ms) {
+                lcd_console_drain();
+                lcd_console_present();
+            }
+            return LCD_CONSOLE_POLL_MS;
+        default:
+            return UINT32_MAX;
     }
 }
 
+/* Live pages are stepped when lcd_step_timer, set for their next change,
+ * fires; the LCD thread blocks on lcd_step_sem in between. Each step gets the
+ * real elapsed time, so a late wakeup skips frames instead of stretching the
+ * timeline. On native_sim this runs headless against the emulated panel. */
+static K_SEM_DEFINE(lcd_step_sem, 0, 1);
+
+static void lcd_step_expiry(struct k_timer *timer) {
+    ARG_UNUSED(timer);
+    k_sem_give(&lcd_step_sem);
+}
+
+static K_TIMER_DEFINE(lcd_step_timer, lcd_step_expiry, NULL);
+
+static void lcd_page_hold(int page, uint32_t ms) {
+    int64_t last = k_uptime_get();
+    int64_t end = last + ms;
+    uint32_t next = lcd_page_step(page, 0);
+    while (next != UINT32_MAX && last + next < end) {
+        k_timer_start(&lcd_step_timer, K_TIMEOUT_ABS_MS(last + next), K_NO_WAIT);
+        k_sem_take(&lcd_step_sem, K_FOREVER);
+        int64_t now = k_uptime_get();
+        next = lcd_page_step(page, (uint32_t)(now - last));
+        last = now;
+    }
+    k_sleep(K_TIMEOUT_ABS_MS(end));
+}
+
 static const char *lcd_page_name(int page) {
     switch (page) {
         case 0: return "text";
         case 1: return "gradient";
         case 2: return "icon";
         case 3: return "pulse";
+        case 4: return "console";
         default: return "unknown";
     }
 }
@@ -363,30 +708,39 @@ static void lcd_task(void *p1, void *p2, void *p3) {
 
     int page = 0;
     while (true) {
-        LOG_INF("lcd page=%s", lcd_page_name(page));
+        gfx_pace_stats_t pace;
+        unsigned int key = irq_lock(); /* against lcd_vsync() */
+        gfx_pacer_take_stats(&lcd_pacer, &pace);
+        irq_unlock(key);
+        uint32_t pace_mean_us = pace.latency_count ? (uint32_t)(pace.latency_sum_us / pace.latency_count) : 0;
+        LOG_INF("lcd page=%s last_render=%uus last_flush=%uus/%upx frames=%u drop=%u lat=%u/%uus",
+                lcd_page_name(page), lcd_last_render_us, lcd_last_flush_us, lcd_last_flush_px, pace.frames,
+                pace.dropped, pace_mean_us, pace.latency_max_us);
+        lcd_perf_report();
+        lcd_console_leave();
         switch (page) {
             case 0:
                 render_text_page();
-                lcd_flush_framebuffer();
                 break;
             case 1:
                 render_gradient_page();
-                lcd_flush_framebuffer();
                 break;
             case 2:
                 render_icon_page();
-                lcd_flush_framebuffer();
                 break;
             case 3:
                 render_gif_page();
                 break;
+            case 4:
+                render_console_page();
+                break;
             default:
                 page = 0;
                 continue;
         }
 
-        page = (page + 1) % 4;
-        k_msleep(LCD_STEP_MS);
+        lcd_page_hold(page, LCD_STEP_MS);
+        page = (page + 1) % 5;
     }
 }
 
@@ -398,8 +752,8 @@ static struct k_thread hb1_thread;
 static struct k_thread lcd0_thread;
 
 int main(void) {
-    if (!device_is_ready(gpio_dev)) {
-        LOG_ERR("gpio0 not ready");
+    if (!spi_is_ready_dt(&lcd_spi) || !gpio_is_ready_dt(&lcd_dc_pin)) {
+        LOG_ERR("LCD SPI bus or DC pin not ready");
         return 0;
     }
 
@@ -415,6 +769,11 @@ int main(void) {
     }
 
     lcd_init_panel();
+    gfx_perf_reset(&lcd_perf_render);
+    gfx_perf_reset(&lcd_perf_flush);
+    gfx_perf_init(DT_PROP_OR(DT_PATH(cpus, cpu_0), clock_frequency, 150000000));
+    lcd_console_init();
+    lcd_pace_start();
 
     k_tid_t hb0 = k_thread_create(&hb0_thread, hb0_stack, K_THREAD_STACK_SIZEOF(hb0_stack),
                                   heartbeat_task, UINT_TO_POINTER(0), NULL, NULL,